@@ -0,0 +1,96 @@
+$VAR1 = {
+  'id' => 'Check-Quoting_Printer',
+  'make' => 'Check',
+  'model' => 'Quoting Printer',
+  'recdriver' => 'quoting',
+  'drivers' => [
+                 {
+                   'name' => 'quoting',
+                   'id' => 'quoting',
+                   'comment' => 'Comment with \\\' inside',
+                 },
+               ],
+  'pcmodel' => undef,
+  'color' => 0,
+  'ascii' => 0,
+  'pjl' => undef,
+  'printerppdentry' => undef,
+  'pnp_ieee' => undef,
+  'general_ieee' => undef,
+  'pnp_mfg' => undef,
+  'general_mfg' => undef,
+  'pnp_mdl' => undef,
+  'general_mdl' => undef,
+  'pnp_des' => undef,
+  'general_des' => undef,
+  'pnp_cmd' => undef,
+  'general_cmd' => undef,
+  'par_ieee' => undef,
+  'par_mfg' => undef,
+  'par_mdl' => undef,
+  'par_des' => undef,
+  'par_cmd' => undef,
+  'usb_ieee' => undef,
+  'usb_mfg' => undef,
+  'usb_mdl' => undef,
+  'usb_des' => undef,
+  'usb_cmd' => undef,
+  'snmp_ieee' => undef,
+  'snmp_mfg' => undef,
+  'snmp_mdl' => undef,
+  'snmp_des' => undef,
+  'snmp_cmd' => undef,
+  'driver' => 'quoting',
+  'pcdriver' => undef,
+  'type' => 'G',
+  'comment' => 'Driver quoting, see <docs> it\'s fine, write \\\' for a quote in C:\\\\',
+  'url' => 'http://www.example.com/drivers/quoting',
+  'supplier' => 'Supplier\'s \\ name',
+  'license' => 'GPL',
+  'free' => '1',
+  'cmd' => 'gs -q -dBATCH -sDEVICE=quoting%A%Z -sOutputFile=- -c \'\\\'\' -',
+  'cmd_pdf' => undef,
+  'drivernopjl' => 0,
+  'drivernopageaccounting' => 0,
+  'driverppdentry' => undef,
+  'comboppdentry' => undef,
+  'maxspot' => 'A',
+  'args_byname' => {
+    'Quoting' => {},
+  },
+  'args' => [
+    {
+      'name' => 'Quoting',
+      'comment' => 'Back\\slash \'Option\'',
+      'idx' => 'opt/quoting',
+      'type' => 'enum',
+      'style' => 'C',
+      'spot' => 'A',
+      'order' => '10',
+      'group' => 'General',
+      'proto' => '-sQuoting=\'%s\\\'',
+      'default' => 'V0',
+      'vals_byname' => {
+        'V0' => {
+          'value' => 'V0',
+          'comment' => 'Value with \\\' and \\\\',
+          'idx' => 'ev/quoting-0',
+          'driverval' => '\\\''
+        },
+        'V1' => {
+          'value' => 'V1',
+          'comment' => 'Plain \'value\'',
+          'idx' => 'ev/quoting-1',
+          'driverval' => '1'
+        },
+      },
+      'vals' => [
+        {},
+        {},
+      ]
+    },
+  ]
+};
+$VAR1->{'args'}[0]{'vals'}[0] = $VAR1->{'args'}[0]{'vals_byname'}{'V0'};
+$VAR1->{'args'}[0]{'vals'}[1] = $VAR1->{'args'}[0]{'vals_byname'}{'V1'};
+$VAR1->{'args_byname'}{'Quoting'} = $VAR1->{'args'}[0];
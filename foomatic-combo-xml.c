@@ -33,55 +33,788 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <ctype.h>
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
 #include <dirent.h>
 #include <assert.h>
+#include <pthread.h>
+#include <signal.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "foomatic-combo-xml.h"
+
+/* Files smaller than this are read by mapfile(), mapping them costs more
+   than copying them. With 8000 printer files "-O" takes 17% longer when
+   files of 2 KB are mapped, both ways are equally fast at 32 KB, and
+   mapping wins from 64 KB on */
+#define MAPFILE_MIN_SIZE (32 * 1024)
+
+/* First line of the option index file, to be changed when the format of
+   the index changes */
+#define OPTINDEX_HEADER "foomatic-combo-xml option index 1\n"
+
+/* Size of the blocks of the memory pool for the overview */
+#define POOL_BLOCK_SIZE (256 * 1024)
+
+/* With "-j" the threads parse at most this many overview files per
+   thread ahead of the output */
+#define OVERVIEW_WINDOW 16
+
+/* First line of the overview cache file, to be changed when the format
+   of the cache changes */
+#define OVCACHE_HEADER "foomatic-combo-xml overview cache 1\n"
+
+/* Initial size of the working buffers of parse(), they grow when a tag
+   name, tag parameter, or value which gets copied into them is longer */
+#define PARSER_BUFFER_MIN 256
+
+/* Maximum length of a request line to the server ("-S") and maximum
+   number of its fields */
+#define SERVER_LINE_SIZE 4096
+#define SERVER_MAX_FIELDS 256
+
+/* Maximum length of a printer ID, driver name, or option setting in a
+   request to the server, they go into buffers of this size in combo()
+   and evaloption() */
+#define SERVER_FIELD_SIZE 256
+
+/* Seconds the server ("-S") waits for the next request line of a client
+   and for a client to take an answer before it closes the connection */
+#define SERVER_TIMEOUT 30
+
+/* Identification of the compiled database snapshot ("-W", "-s"), the
+   version is to be changed when the format of the snapshot changes, the
+   byte order mark rejects snapshots of machines with another byte order */
+#define SNAPSHOT_MAGIC "foomatic-combo-xml snapshot\n"
+#define SNAPSHOT_VERSION 2
+#define SNAPSHOT_BYTEORDER 0x01020304
 
 /*
  * Data structures for the printer/driver combo by printer list for the
- * overview ("-O" option)
+ * overview ("-O" option). The printers are found through a hash table
+ * on their IDs, all entries and strings are allocated from a memory pool
+ * which is freed as a whole when the overview is done.
  */
 
+typedef struct { /* structure for a memory pool (linear list of blocks) */
+  char                  *block;    /* current block, it starts with a
+				      pointer to the block before */
+  size_t                used;      /* bytes used in the current block */
+  size_t                size;      /* size of the current block */
+} pool_t;
+
 typedef struct { /* structure for a driver entry (linear list) */
-  char                  name[128]; /* Name of driver */
+  char                  *name;     /* Name of driver */
   char                  *functionality; /* Exceptions in driver
                                       functionality profile for this
 				      printer */
   struct driverlist_t   *next;     /* pointer to next driver */
 } driverlist_t;
 
-typedef struct { /* structure for a printer entry (linear list) */
-  char                  id[128];   /* ID of printer */
+typedef struct { /* structure for a set of driver names (hash table) */
+  driverlist_t          **buckets; /* first entry for each hash value,
+				      chained by the "next" pointers */
+  unsigned int          numbuckets; /* number of hash values, power of 2 */
+  int                   numdrivers;
+} driverset_t;
+
+typedef struct { /* structure for a printer entry (hash table) */
+  char                  *id;       /* ID of printer */
   driverlist_t          *drivers;  /* pointer to the list of the drivers
 				      with which this printer works */
-  struct printerlist_t  *next;     /* pointer to next printer */
+  driverlist_t          *lastdriver; /* last entry of the driver list */
+  int                   removed;   /* 1: the printer XML file was found,
+				      the entry is already put out */
+  int                   driverfile; /* number of the last driver file
+				      which added itself to this printer */
+  struct printerlist_t  *next;     /* pointer to next printer with the
+				      same hash value */
 } printerlist_t;
 
+typedef struct { /* structure for the printer/driver combos */
+  pool_t                pool;      /* memory for all entries */
+  printerlist_t         **printers; /* printers in the order in which they
+				      were added */
+  int                   numprinters;
+  int                   sizeprinters;
+  printerlist_t         **buckets; /* first printer for each hash value */
+  unsigned int          numbuckets; /* number of hash values, power of 2 */
+  driverset_t           protodrivers; /* drivers with a command line
+				      prototype, they produce PPD files */
+  driverset_t           listeddrivers; /* drivers which added themselves
+				      to printers */
+  int                   driverfile; /* number of the current driver file */
+  printerlist_t         **touched; /* printers to which the current
+				      driver file added itself */
+  int                   numtouched;
+  int                   sizetouched;
+  int                   sharedname; /* 1: an earlier driver file has the
+				      same driver name (in another case) */
+} overview_t;
+
 typedef struct { /* structure for a ready-made PPD entry (linear list) */
   char                  driver[128]; /* ID of driver */
   char                  ppd[1024];   /* ID of PPD URL */
   struct ppdlist_t  *next;           /* pointer to next PPD */
 } ppdlist_t;
 
-typedef struct { /* structure for printer ID translations (linear list) */
+typedef struct { /* structure for a printer ID translation (array) */
   char                  *oldid,    /* old ID of printer */
                         *newid;    /* current ID of printer */
-  struct idlist_t       *next;     /* pointer to next entry */
+  int                   next;      /* index of next entry with the same
+				      hash value, -1: none */
+} idpair_t;
+
+typedef struct { /* structure for printer ID translations (hash table) */
+  char                  *buffer;   /* contents of the file, the IDs
+				      point into it */
+  idpair_t              *pairs;    /* translations, in the order of the
+				      file */
+  int                   numpairs;
+  int                   sizepairs;
+  int                   *buckets;  /* index of first entry for each hash
+				      value, -1: none */
+  unsigned int          numbuckets; /* number of hash values, power of 2 */
+  long                  lookups;   /* number of translateid() calls */
 } idlist_t;
 
+/*
+ * Data structures for an XML file in memory and the parts of it which go
+ * into the output. parse() does not modify the file, it records the
+ * byte ranges which are kept and the data which gets inserted.
+ */
+
+typedef struct { /* structure for a part of the output (array) */
+  const char            *start;    /* pointer to the data */
+  int                   length;    /* length of the data */
+  int                   pos;       /* offset in the file where the part
+				      begins or where it is inserted */
+  int                   allocated; /* 1: inserted data, to be freed,
+				      0: range of the file */
+} span_t;
+
+typedef struct { /* structure for an XML file and its output */
+  char                  *data;     /* contents of the file */
+  int                   length;    /* length of the contents */
+  int                   mapped;    /* 1: mapped by mapfile(), 0: malloc()ed,
+				      2: part of the snapshot */
+  span_t                *spans;    /* parts of the output, in order, NULL
+				      when the file does not go into the
+				      output */
+  int                   numspans;  /* number of parts */
+  int                   sizespans; /* allocated entries in spans */
+} xmlfile_t;
+
+/*
+ * Data structures for the overview files. parse() does not change the
+ * printer/driver combos, it records the changes which a file makes to
+ * them, they are applied to the combos in the order of the file names,
+ * so that the files can be parsed in parallel ("-j" option).
+ */
+
+enum combo_change_types
+{
+  COMBO_ADD_PRINTER,   /* Driver file: add the driver to the printer */
+  COMBO_PROTOTYPE,     /* Driver file: the driver has a command line
+			  prototype */
+  COMBO_NO_PROTOTYPE,  /* Driver file: the driver does not have a command
+			  line prototype, remove it from the printers */
+  COMBO_ADD_DRIVER,    /* Printer file: add the driver to the printer if
+			  it is not there yet */
+  COMBO_REMOVE_DRIVER  /* Printer file: remove the driver from the
+			  printer */
+};
+
+typedef struct { /* structure for a change of the combos (array) */
+  int                   type;      /* See "enum combo_change_types" */
+  char                  *printer;  /* printer ID, untranslated */
+  char                  *driver;   /* driver name */
+  char                  *functionality; /* Exceptions in driver
+				      functionality profile */
+} combochange_t;
+
+typedef struct { /* structure for a file of the overview */
+  char                  filename[1024]; /* Name of the file */
+  xmlfile_t             file;      /* the XML file and its output */
+  const driverset_t     *protodrivers; /* drivers with command line
+				      prototype, for the printer files */
+  combochange_t         *changes;  /* changes of the combos, in the order
+				      in which parse() found them */
+  int                   numchanges;
+  int                   sizechanges;
+  char                  *printer;  /* printer ID of the overview entry
+				      (printer files), NULL: no entry */
+  char                  *entry;    /* overview entry without the
+				      printer ID and the drivers */
+  int                   driverspos; /* position in the entry where the
+				      drivers get inserted */
+  int                   status;    /* 0: not parsed yet, 1: parsed,
+				      -1: file not readable */
+  long                  mtime;     /* modification time, size, and */
+  long                  size;      /* inode number of the file, for the */
+  unsigned long         inode;     /* overview cache, mtime is -1 if
+				      unknown */
+  const struct ovcacheentry_t *cached; /* entry of the overview cache
+				      which replaces parsing the file,
+				      NULL: file gets parsed */
+} ovfile_t;
+
+typedef struct { /* structure for the overview files of a directory */
+  ovfile_t              *files;    /* the files, sorted by name */
+  int                   numfiles;
+  int                   next;      /* next file to be parsed */
+  int                   written;   /* number of files put out */
+  int                   window;    /* how many files the threads may be
+				      ahead of the output */
+  pthread_mutex_t       lock;      /* protects next, written, and the
+				      status of the files */
+  pthread_cond_t        cond;      /* signals changes of them */
+  int                   operation; /* PARSE_OP_OV_DRIVER or
+				      PARSE_OP_OV_PRINTER */
+  const char            *pid;      /* overview mode, see parse() */
+  const char            **defaultsettings;
+  int                   num_defaultsettings;
+  idlist_t              *idlist;   /* ID translation table */
+  int                   debug;
+  int                   debug2;
+} ovjobs_t;
+
+/*
+ * Data structures for the overview cache ("-c" option). For every driver
+ * and printer file it holds what parse() found in the file, keyed by the
+ * file name, modification time, size, and inode number, so that only the
+ * files which changed get parsed again. The printer files of the CUPS
+ * overview depend on which drivers have a command line prototype, so this
+ * set of drivers is cached, too.
+ */
+
+typedef struct { /* structure for a cached overview file (array) */
+  char                  *filename; /* Name of the file */
+  long                  mtime;     /* modification time of the file */
+  long                  size;      /* size of the file */
+  unsigned long         inode;     /* inode number of the file */
+  combochange_t         *changes;  /* changes of the combos */
+  int                   numchanges;
+  char                  *printer;  /* printer ID of the overview entry,
+				      NULL: no entry, see ovfile_t */
+  char                  *entry;    /* overview entry, see ovfile_t */
+  int                   driverspos; /* see ovfile_t */
+  char                  *output;   /* output of the file, NULL: none */
+  int                   outputlength;
+} ovcacheentry_t;
+
+typedef struct { /* structure for the overview cache */
+  char                  *data;     /* contents of the cache file, the
+				      strings of the entries point into
+				      it */
+  ovcacheentry_t        *entries;  /* files, sorted by name */
+  int                   numentries;
+  int                   sizeentries;
+  pool_t                pool;      /* memory for the changes and the set
+				      of drivers */
+  driverset_t           protodrivers; /* drivers with command line
+				      prototype when the cache was
+				      written */
+  const char            *filename; /* Name of the cache file */
+  char                  tmpfilename[1024]; /* New cache file, it replaces
+				      the old one when complete */
+  FILE                  *out;      /* New cache file, NULL if it cannot
+				      be written */
+  time_t                now;       /* Start time, files modified since
+				      then are not cached */
+} ovcache_t;
+
+/*
+ * Data structures for the option model. parse() turns an option XML file
+ * into the list of the events in it which decide whether the option and
+ * its enum values apply to a printer/driver combo and what its default
+ * is, in the order of the file. evaloption() goes through them for a
+ * given combo, so an option file needs to be scanned only once.
+ */
+
+enum option_types 
+{ 
+  OPTION_TYPE_ENUM, OPTION_TYPE_BOOL, 
+  OPTION_TYPE_INT, OPTION_TYPE_FLOAT };
+
+enum option_event_types
+{
+  OPTEV_OPTION,          /* <option> tag, the file header ends here */
+  OPTEV_SHORTNAME,       /* Option short name (<en> in <arg_shortname>) */
+  OPTEV_ARG_MAX,         /* <arg_max> */
+  OPTEV_ARG_MIN,         /* <arg_min> */
+  OPTEV_ARG_PJL,         /* <arg_pjl /> in <arg_execution> */
+  OPTEV_ENUM_VAL,        /* Start of an <enum_val> */
+  OPTEV_ENUM_VAL_ID,     /* ID of the enum value */
+  OPTEV_EV_SHORTNAME,    /* Enum value short name */
+  OPTEV_ENUM_VAL_END,    /* End of an <enum_val> */
+  OPTEV_CONSTRAINTS,     /* Start of a <constraints> block */
+  OPTEV_CONSTRAINT,      /* A complete <constraint> */
+  OPTEV_CONSTRAINTS_END, /* End of a <constraints> block */
+  OPTEV_OPTION_END };    /* End of the option */
+
+typedef struct { /* structure for an event in an option file (array) */
+  int                   type;      /* See "enum option_event_types" */
+  int                   from, to;  /* Range of the file to remove or
+				      position to insert, -1 if unknown */
+  int                   inenumval; /* 1: Event is inside an <enum_val> */
+  int                   line;      /* Line number for warnings */
+  char                  *text;     /* Short name, enum value ID, or
+				      number */
+  int                   sense;     /* Constraint: 1: true, 0: false */
+  char                  *printer;  /* Constraint: short printer ID */
+  char                  *make;     /* Constraint: make */
+  char                  *model;    /* Constraint: model */
+  char                  *driver;   /* Constraint: driver */
+  char                  *argdefault; /* Constraint: default setting */
+} optevent_t;
+
+typedef struct { /* structure for the model of an option */
+  int                   optiontype; /* See "enum option_types" */
+  int                   numenumvals; /* Number of enumeration values
+					to start with, 0 for enum options,
+					they do not apply without
+					qualifying values, 1 for the others */
+  int                   partial;   /* 1: parse() stopped as the option
+				      does not apply to the combo it got,
+				      the model is only good for that */
+  optevent_t            *events;   /* Events in the order of the file */
+  int                   numevents;
+  int                   sizeevents;
+} optionmodel_t;
+
+/*
+ * Data structures for the driver model. parse() turns a driver XML file
+ * into the list of the events in it which decide which of its printer
+ * entries go into the combo, in the order of the file. evaldriver() goes
+ * through them for a given combo, so that a driver file, which can list
+ * thousands of printers, is scanned only once for all the combos with
+ * this driver (batch mode, server).
+ */
+
+enum driver_event_types
+{
+  DRVEV_DRIVER,          /* <driver> tag, the file header ends here */
+  DRVEV_PRINTERS,        /* Start of a <printers> block */
+  DRVEV_PRINTERS_END,    /* End of a <printers> block */
+  DRVEV_PRINTER_END,     /* End of a <printer> entry */
+  DRVEV_ID };            /* A printer ID (<id>) */
+
+typedef struct { /* structure for an event in a driver file (array) */
+  int                   type;      /* See "enum driver_event_types" */
+  int                   from, to;  /* Range of the file to remove or to
+				      copy, -1 if unknown */
+  char                  *id;       /* Printer ID, translated */
+} drvevent_t;
+
+typedef struct { /* structure for the model of a driver */
+  int                   nopjl;     /* 1: driver does not allow PJL
+				      options (<nopjl /> in
+				      <execution>) */
+  drvevent_t            *events;   /* Events in the order of the file */
+  int                   numevents;
+  int                   sizeevents;
+} drivermodel_t;
+
+/*
+ * Data structures of the compiled database snapshot. The snapshot is one
+ * file which gets mapped into the memory as it is, so it does not contain
+ * any pointers: the tables are referenced by their offset from the start
+ * of the file, strings and file contents by their offset from the start
+ * of the string area, 0 meaning NULL. Every string is stored only once.
+ * The numbers have the byte order of the machine which wrote the file.
+ */
+
+typedef struct { /* structure for the header of a snapshot */
+  char                  magic[32]; /* SNAPSHOT_MAGIC */
+  unsigned int          version;   /* SNAPSHOT_VERSION */
+  unsigned int          byteorder; /* SNAPSHOT_BYTEORDER */
+  unsigned int          size;      /* size of the whole file */
+  unsigned int          strings;   /* string area */
+  unsigned int          stringslength;
+  unsigned int          printers;  /* printer files (snapfile_t), sorted
+				      by printer ID */
+  unsigned int          numprinters;
+  unsigned int          drivers;   /* driver files (snapfile_t), sorted
+				      by driver name */
+  unsigned int          numdrivers;
+  unsigned int          options;   /* option files (snapoption_t), in the
+				      order of the option index */
+  unsigned int          numoptions;
+  unsigned int          events;    /* events of the option models
+				      (snapevent_t) */
+  unsigned int          numevents;
+  unsigned int          idpairs;   /* printer ID translations
+				      (snapidpair_t), in the order of the
+				      file */
+  unsigned int          numidpairs;
+  unsigned int          hasidlist; /* 1: translation table was readable */
+  unsigned int          overviews[3]; /* overview XML ("-O", "-C", "-C
+					 -n") */
+  unsigned int          overviewlengths[3];
+  unsigned int          libdir;    /* database location the snapshot was
+				      compiled from, for messages */
+} snapheader_t;
+
+typedef struct { /* structure for an XML file in a snapshot (array) */
+  unsigned int          name;      /* printer ID, driver name, or name of
+				      the option file */
+  unsigned int          data;      /* contents of the file, followed by a
+				      zero byte */
+  unsigned int          length;    /* length of the contents */
+} snapfile_t;
+
+typedef struct { /* structure for an option in a snapshot (array) */
+  snapfile_t            file;      /* the option file */
+  unsigned int          keys;      /* keys of the option index */
+  int                   optiontype; /* complete model of the option, see */
+  int                   numenumvals; /* optionmodel_t */
+  unsigned int          events;    /* index of the first event */
+  unsigned int          numevents;
+} snapoption_t;
+
+typedef struct { /* structure for an option event in a snapshot (array) */
+  int                   type;      /* See optevent_t */
+  int                   from, to;
+  int                   inenumval;
+  int                   line;
+  int                   sense;
+  unsigned int          text;
+  unsigned int          printer;
+  unsigned int          make;
+  unsigned int          model;
+  unsigned int          driver;
+  unsigned int          argdefault;
+} snapevent_t;
+
+typedef struct { /* structure for a printer ID translation in a snapshot
+		    (array) */
+  unsigned int          oldid,     /* old ID of printer */
+                        newid;     /* current ID of printer */
+} snapidpair_t;
+
+typedef struct { /* structure for a mapped snapshot */
+  char                  *data;     /* the mapped file */
+  size_t                size;      /* size of the file */
+  const snapheader_t    *header;
+  const char            *strings;  /* string area */
+  const snapfile_t      *printers;
+  const snapfile_t      *drivers;
+  const snapoption_t    *options;
+  const snapevent_t     *events;
+  const snapidpair_t    *idpairs;
+} snapshot_t;
+
+typedef struct { /* structure for a snapshot being compiled */
+  char                  *strings;  /* string area */
+  int                   stringslength;
+  int                   sizestrings;
+  unsigned int          *interned; /* offsets of the strings stored so
+				      far (hash table), 0: free */
+  unsigned int          numinterned;
+  unsigned int          sizeinterned; /* power of 2 */
+  snapfile_t            *printers; /* tables, see snapheader_t */
+  int                   numprinters, sizeprinters;
+  snapfile_t            *drivers;
+  int                   numdrivers, sizedrivers;
+  snapoption_t          *options;
+  int                   numoptions, sizeoptions;
+  snapevent_t           *events;
+  int                   numevents, sizeevents;
+} snapwriter_t;
+
+/*
+ * Data structure for the option index. For every option XML file it
+ * holds the keys which the option's own <constraints> with sense="true"
+ * can match, only options with a matching key can apply to a given
+ * printer/driver combo. The keys are lines "d <driver>", "p <printer>",
+ * "m <make>", or "*" if the option is always a candidate.
+ */
+
+typedef struct { /* structure for an option file entry (linear list) */
+  char                  name[256]; /* file name, without directory */
+  long                  mtime;     /* modification time of the file */
+  long                  size;      /* size of the file */
+  char                  *keys;     /* keys, see above */
+  xmlfile_t             file;      /* the option file, once it is loaded */
+  optionmodel_t         *model;    /* model of the option, once it is
+				      parsed */
+  const snapoption_t    *snapshot; /* the option in the snapshot, NULL:
+				      the option file gets parsed */
+  struct optindex_t     *next;     /* pointer to next entry */
+} optindex_t;
+
+/*
+ * Data structures for the part of the database which is kept in memory
+ * while computing combos. In batch mode ("-b") the option index, the
+ * option files, and the driver files are loaded only once for all
+ * combos, the files are not modified by parse(), only their output is
+ * recomputed for every combo.
+ */
+
+typedef struct { /* structure for a loaded driver file (linear list) */
+  char                  name[256]; /* driver name */
+  xmlfile_t             file;      /* the driver file, data is NULL if it
+				      is missing */
+  drivermodel_t         *model;    /* model of the driver file, NULL if it
+				      is not parsed yet */
+  struct drivercache_t  *next;     /* pointer to next driver */
+} drivercache_t;
+
+typedef struct { /* structure for the database */
+  const char            *libdir;   /* Database location */
+  const char            *optindexfilename; /* Option index file */
+  int                   optindexsave; /* 1: write the option index file
+					 when it changed ("-i") */
+  idlist_t              *idlist;   /* ID translation table */
+  optindex_t            *optindex; /* Option index with the option files */
+  int                   optindexloaded; /* 1: option index is loaded */
+  drivercache_t         *drivers;  /* Driver files loaded so far */
+  const char            **defaultsettings; /* User-supplied option
+					      settings */
+  int                   num_defaultsettings;
+  int                   numthreads; /* Threads for the option files, 1: do
+				       not start threads */
+  snapshot_t            *snapshot; /* Compiled database ("-s"), NULL: the
+				      XML files are read */
+  const char            *snapshotfilename;
+  xmlfile_t             printerfile; /* Printer file of the last combo
+					which combo() did not put out, its
+					output stays with the option
+					files' until the next combo */
+  xmlfile_t             fallbackdriverfile; /* Driver entry of that combo
+					       when there is no driver
+					       file */
+  xmlfile_t             *driverfile; /* Driver file of that combo, NULL:
+					none */
+} database_t;
+
+/*
+ * Data structure for the state of the parser. parse() has no static
+ * data, everything which it keeps from one file to the next is in the
+ * parser, and its buffers are allocated in the parser, they grow with
+ * the longest value copied into them. Every thread needs its own parser.
+ */
+
+enum parser_buffer { /* Working buffers of parse() */
+  PB_TAGNAME, PB_TAGPARAM, PB_TAGBODY, PB_EVID, PB_PRINTER, PB_MAKE,
+  PB_MODEL, PB_DRIVER, PB_ID, PB_PPD, PB_FUNCTIONALITY, PB_AUTODETECTENTRY,
+  PB_ARGDEFAULT, PB_DFUNCTIONALITYENTRY, PARSER_NUM_BUFFERS };
+
+typedef struct { /* structure for the parser state */
+  char                  *printermake;  /* Printer make/model read from
+					  printer XML file needed by */
+  char                  *printermodel; /* constraints in option XML files
+					  and for finding the candidate
+					  option files in the option
+					  index */
+  int                   sizemake;      /* allocated size of printermake */
+  int                   sizemodel;     /* allocated size of printermodel */
+  char                  *buffers[PARSER_NUM_BUFFERS];
+				       /* working buffers for parse() */
+  int                   buffersizes[PARSER_NUM_BUFFERS];
+				       /* allocated sizes of the buffers */
+} parser_t;
+
+/*
+ * Data structure for the option files of a printer/driver combo which are
+ * parsed and evaluated by threads ("-j"). Every file is independent of
+ * the others, its result stays in its option index entry, so the threads
+ * can take the files in any order.
+ */
+
+typedef struct { /* structure for the option files of a combo */
+  database_t            *db;       /* Database */
+  optindex_t            **entries; /* the candidate option files */
+  int                   numentries;
+  int                   sizeentries;
+  int                   next;      /* next file to be parsed */
+  int                   failed;    /* first file which is not readable,
+				      -1 if all are */
+  pthread_mutex_t       lock;      /* protects next and failed */
+  const char            *pid;      /* Printer ID for parse(), NULL in
+				      batch mode */
+  const char            *evalpid;  /* Printer ID for evaloption() */
+  const char            *driver;   /* Driver name */
+  const parser_t        *printer;  /* Parser with the printer make and
+				      model */
+  int                   nopjl;     /* 1: driver does not allow PJL
+				      options */
+  int                   debug;
+  int                   debug2;
+} optjobs_t;
+
+/*
+ * Data structures for the server ("-S"). Every connection is served by
+ * its own thread, so that a slow or silent client does not hold up the
+ * others. The database caches and the parser are shared, the requests
+ * are answered one after the other under the lock, the answers are sent
+ * without it.
+ */
+
+typedef struct { /* structure for the server */
+  database_t            *db;       /* Database */
+  parser_t              *parser;   /* Parser */
+  pthread_mutex_t       lock;      /* protects db and parser */
+  int                   debug;
+} server_t;
+
+typedef struct { /* structure for a connection to the server */
+  server_t              *server;   /* Server */
+  int                   fd;        /* Socket of the connection */
+} serverconn_t;
+
+/*
+ * Statistics for "--stats", see foomatic-combo-xml.h. The phases are
+ * timed by the main thread only, the counters are incremented by the
+ * threads of "-j" as well.
+ */
+
+typedef struct { /* structure for the statistics */
+  int                   enabled;   /* 1: "--stats" given */
+  int                   json;      /* 1: put out as JSON */
+  double                wall[STATS_NUM_PHASES]; /* time of the phases */
+  double                cpu[STATS_NUM_PHASES];
+  long                  calls[STATS_NUM_PHASES]; /* 0: phase not run */
+  long                  counters[STATS_NUM_COUNTERS];
+} stats_t;
+
+stats_t combostats;
+
+/* Names of the phases and counters in the output */
+const char *statsphasenames[STATS_NUM_PHASES] = {
+  "idlist_load", "printer_parse", "driver_parse", "option_scan", "output",
+  "xml_parse", "perl_generation"
+};
+const char *statscounternames[STATS_NUM_COUNTERS] = {
+  "files_opened", "bytes_read", "options_skipped", "options_qualified",
+  "options_rejected", "enumvals_pruned", "idlist_lookups"
+};
+
+/*
+ * function to turn on the statistics
+ */
+
+void
+enablestats(int json) { /* I - 1: JSON output, 0: key=value pairs */
+  combostats.enabled = 1;
+  combostats.json = json;
+}
+
+/*
+ * function to get the current wall clock and CPU time
+ */
+
+void
+statsnow(statsclock_t *now) { /* O - Current time */
+  struct timeval tv;
+  struct rusage usage;
+
+  gettimeofday(&tv, NULL);
+  now->wall = tv.tv_sec + tv.tv_usec / 1000000.0;
+  /* RUSAGE_SELF includes the threads of "-j" */
+  getrusage(RUSAGE_SELF, &usage);
+  now->cpu = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1000000.0 +
+    usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1000000.0;
+}
+
+/*
+ * function to note the start of a phase
+ */
+
+void
+startphase(statsclock_t *start) { /* O - Start of the phase */
+  if (combostats.enabled) statsnow(start);
+}
+
+/*
+ * function to add the time since the start to a phase, the start becomes
+ * the start of the next phase
+ */
+
+void
+endphase(int phase,            /* I - Phase (STATS_...) */
+	 statsclock_t *start) { /* I/O - Start of the phase */
+  statsclock_t  now;
+
+  if (!combostats.enabled) return;
+  statsnow(&now);
+  combostats.wall[phase] += now.wall - start->wall;
+  combostats.cpu[phase] += now.cpu - start->cpu;
+  combostats.calls[phase] ++;
+  *start = now;
+}
+
+/*
+ * function to add to a counter
+ */
+
+void
+countstat(int counter, /* I - Counter (STATS_...) */
+	  long n) {    /* I - Amount to add */
+  __sync_fetch_and_add(&(combostats.counters[counter]), n);
+}
+
+/*
+ * function to put out the statistics on one line, the phases which were
+ * not run are left out
+ */
+
+void
+putstats(FILE *out) { /* I - Output stream */
+  struct rusage usage;
+  const char    *separator = (combostats.json ? "{" : "");
+  const char    *assign = (combostats.json ? "\": " : "=");
+  const char    *quote = (combostats.json ? "\"" : "");
+  int           i;
+
+  if (!combostats.enabled) return;
+  for (i = 0; i < STATS_NUM_PHASES; i ++) {
+    if (combostats.calls[i] == 0) continue;
+    fprintf(out, "%s%s%s_wall%s%.6f", separator, quote, statsphasenames[i],
+	    assign, combostats.wall[i]);
+    separator = (combostats.json ? ", " : " ");
+    fprintf(out, "%s%s%s_cpu%s%.6f", separator, quote, statsphasenames[i],
+	    assign, combostats.cpu[i]);
+  }
+  for (i = 0; i < STATS_NUM_COUNTERS; i ++) {
+    fprintf(out, "%s%s%s%s%ld", separator, quote, statscounternames[i],
+	    assign, combostats.counters[i]);
+    separator = (combostats.json ? ", " : " ");
+  }
+  /* ru_maxrss is in kilobytes */
+  getrusage(RUSAGE_SELF, &usage);
+  fprintf(out, "%s%speak_rss_kb%s%ld%s\n", separator, quote, assign,
+	  (long)usage.ru_maxrss, (combostats.json ? "}" : ""));
+}
+
 /*
  * function to load a file into the memory
  */
 
 char  /* O - pointer to the file in memory */
-*loadfile(const char *filename) { /* I - file name */
-  
-  const int blocksize = 1024 * 1024;
+*loadfile(const char *filename, /* I - file name */
+	  int *length) { /* O - length of the file, without the
+			        terminating zero byte */
+
   FILE *inputfile;          /* file to be read currently */
-  char buffer[blocksize + 1];/* data block currently read */
+  struct stat st;           /* file status, to get the file size */
   char *data = NULL;        /* the read data */
-  int size = 1;             /* size of the data in memory */
-  int bytesread;            /* bytes actually read */
+  size_t size;              /* size of the file */
+  size_t bytesread;         /* bytes actually read */
 
   /* Open the file */
 
@@ -89,21 +822,421 @@ char  /* O - pointer to the file in memory */
   if (inputfile == NULL) {
     return NULL;
   }
+  countstat(STATS_FILES, 1);
 
-  /* Read the whole file into the memory */
+  /* Allocate a buffer of exactly the file's size (plus the terminating
+     zero byte) and read the whole file into the memory in one pass */
 
-  data = (char *)malloc(size);
-  data[0] = '\0';
-  while((bytesread = fread(buffer,1,blocksize,inputfile))) {
-    data = (char *)realloc(data, size + bytesread); 
-    buffer[bytesread] = '\0';
-    strcat(data, buffer);
-    size += bytesread;
+  if ((fstat(fileno(inputfile), &st) != 0) || (st.st_size <= 0)) {
+    fclose(inputfile);
+    return NULL;
+  }
+  size = (size_t)st.st_size;
+  data = (char *)malloc(size + 1);
+  if (data == NULL) {
+    fprintf(stderr, "Out of memory!\n");
+    exit(1);
   }
+  bytesread = fread(data, 1, size, inputfile);
   fclose(inputfile);
-  /* Make space for additional data */
-  data = (char *)realloc(data, size + 4096); 
-  if (strcmp(data, "")) return(data); else { free((void *)data); return(NULL); }
+  countstat(STATS_BYTES, (long)bytesread);
+  data[bytesread] = '\0';
+  /* The parser stops at the first zero byte, so do we */
+  bytesread = strlen(data);
+  if (bytesread == 0) {
+    free((void *)data);
+    return(NULL);
+  }
+  if (length) *length = (int)bytesread;
+  return(data);
+}
+
+/*
+ * function to map a file read-only into the memory, so that it does not
+ * get copied. If the file cannot be mapped it is loaded with loadfile()
+ * instead, "mapped" tells which of both happened, to free the data with
+ * unloadfile() afterwards.
+ */
+
+char  /* O - pointer to the file in memory */
+*mapfile(const char *filename, /* I - file name */
+	 int *length,  /* O - length of the data, up to the first zero byte */
+	 int *mapped) { /* O - 1: file is mapped, 0: file is loaded */
+
+  int fd;                   /* file to be mapped */
+  struct stat st;           /* file status, to get the file size */
+  char *data;               /* the mapped data */
+  size_t size;              /* size of the file */
+
+  *mapped = 0;
+  fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+  if ((fstat(fd, &st) != 0) || (st.st_size <= 0)) {
+    close(fd);
+    return NULL;
+  }
+  size = (size_t)st.st_size;
+  /* The parser needs a zero byte after the data. The rest of the last
+     page of a mapping is filled with zeros, so we have one, except the
+     file fills its last page completely. Small files are cheaper to read
+     than to map. Use loadfile() for both. */
+  if ((size < MAPFILE_MIN_SIZE) ||
+      (size % (size_t)sysconf(_SC_PAGESIZE) == 0)) {
+    close(fd);
+    return(loadfile(filename, length));
+  }
+  data = (char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == (char *)MAP_FAILED) {
+    /* File system without mmap() support, read the file the classic way */
+    return(loadfile(filename, length));
+  }
+  posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+  countstat(STATS_FILES, 1);
+  countstat(STATS_BYTES, (long)size);
+  if (data[0] == '\0') {
+    munmap(data, size);
+    return(NULL);
+  }
+  if (length) *length = (int)size;
+  *mapped = 1;
+  return(data);
+}
+
+/*
+ * function to free a file read with mapfile()
+ */
+
+void
+unloadfile(char *data,  /* I - Data as returned by mapfile() */
+	   int length,  /* I - Length as returned by mapfile() */
+	   int mapped) { /* I - Mapping flag as returned by mapfile() */
+  if (data == NULL) return;
+  if (mapped)
+    munmap(data, length);
+  else
+    free((void *)data);
+}
+
+/*
+ * function to make sure that a buffer loaded by loadfile() can hold at
+ * least the given number of bytes, the buffer is grown geometrically
+ */
+
+void
+growdata(char **data,     /* I/O - Data buffer */
+	 int *datasize,   /* I/O - Allocated size of the buffer */
+	 int needed) {    /* I - Number of bytes needed, including the
+			         terminating zero byte */
+  if (needed <= *datasize) return;
+  if (*datasize * 2 > needed) needed = *datasize * 2;
+  *data = (char *)realloc(*data, needed);
+  if (*data == NULL) {
+    fprintf(stderr, "Out of memory!\n");
+    exit(1);
+  }
+  *datasize = needed;
+}
+
+/*
+ * function to append a string to a buffer loaded by loadfile(), without
+ * rescanning the buffer for its end as strcat() would do
+ */
+
+void
+appenddata(char **data,     /* I/O - Data buffer */
+	   int *datalength, /* I/O - Length of the data in the buffer */
+	   int *datasize,   /* I/O - Allocated size of the buffer */
+	   const char *str) { /* I - String to append */
+  int l = strlen(str);
+
+  growdata(data, datasize, *datalength + l + 1);
+  memcpy(*data + *datalength, str, l + 1);
+  *datalength += l;
+}
+
+/*
+ * function to make the output of an XML file being the whole file
+ */
+
+void
+initspans(xmlfile_t *file) { /* I/O - XML file */
+  file->sizespans = 16;
+  file->spans = (span_t *)malloc(sizeof(span_t) * file->sizespans);
+  if (file->spans == NULL) {
+    fprintf(stderr, "Out of memory!\n");
+    exit(1);
+  }
+  file->spans[0].start = file->data;
+  file->spans[0].length = file->length;
+  file->spans[0].pos = 0;
+  file->spans[0].allocated = 0;
+  file->numspans = (file->length > 0 ? 1 : 0);
+}
+
+/*
+ * function to remove the output of an XML file, the file does not go into
+ * the output at all then
+ */
+
+void
+freespans(xmlfile_t *file) { /* I/O - XML file */
+  int i;
+
+  if (file->spans == NULL) return;
+  for (i = 0; i < file->numspans; i ++)
+    if (file->spans[i].allocated)
+      free((void *)(file->spans[i].start));
+  free((void *)(file->spans));
+  file->spans = NULL;
+  file->numspans = 0;
+  file->sizespans = 0;
+}
+
+/*
+ * function to make room for a new part of the output at the given index
+ */
+
+void
+openspan(xmlfile_t *file, /* I/O - XML file */
+	 int index) {     /* I - Index for the new part */
+  if (file->numspans >= file->sizespans) {
+    file->sizespans *= 2;
+    file->spans = (span_t *)realloc((span_t *)(file->spans),
+				    sizeof(span_t) * file->sizespans);
+    if (file->spans == NULL) {
+      fprintf(stderr, "Out of memory!\n");
+      exit(1);
+    }
+  }
+  memmove(file->spans + index + 1, file->spans + index,
+	  sizeof(span_t) * (file->numspans - index));
+  file->numspans ++;
+}
+
+/*
+ * function to remove a range of an XML file from the output. parse()
+ * removes only ranges which it has already scanned, so the parts
+ * concerned are at the end of the list.
+ */
+
+void
+cutspans(xmlfile_t *file, /* I/O - XML file */
+	 int from,        /* I - Offset of the first byte to remove */
+	 int to) {        /* I - Offset after the last byte to remove */
+  int i;
+  int end;
+  span_t *span;
+
+  if ((file->spans == NULL) || (from >= to)) return;
+  for (i = file->numspans - 1; i >= 0; i --) {
+    span = file->spans + i;
+    if (span->allocated) {
+      /* Inserted data, goes away with the range it was inserted into */
+      if (span->pos >= to) continue;
+      if (span->pos < from) break;
+      free((void *)(span->start));
+      memmove(span, span + 1, sizeof(span_t) * (file->numspans - i - 1));
+      file->numspans --;
+      continue;
+    }
+    end = span->pos + span->length;
+    if (end <= from) break;
+    if (span->pos >= to) continue;
+    if ((span->pos < from) && (end > to)) {
+      /* The range is inside this part, split it */
+      openspan(file, i + 1);
+      span = file->spans + i;
+      span[1].start = span->start + (to - span->pos);
+      span[1].length = end - to;
+      span[1].pos = to;
+      span[1].allocated = 0;
+      span->length = from - span->pos;
+    } else if (span->pos < from) {
+      span->length = from - span->pos;
+    } else if (end > to) {
+      span->start += to - span->pos;
+      span->length = end - to;
+      span->pos = to;
+    } else {
+      memmove(span, span + 1, sizeof(span_t) * (file->numspans - i - 1));
+      file->numspans --;
+    }
+  }
+}
+
+/*
+ * function to insert data into the output of an XML file, at a position
+ * which parse() has already scanned
+ */
+
+void
+insertspan(xmlfile_t *file, /* I/O - XML file */
+	   int pos,         /* I - Offset in the file where to insert */
+	   const char *str, /* I - Data to insert */
+	   int length) {    /* I - Length of the data */
+  int i;
+  int end;
+  char *copy;
+  span_t *span;
+
+  if ((file->spans == NULL) || (length <= 0)) return;
+  copy = (char *)malloc(length);
+  if (copy == NULL) {
+    fprintf(stderr, "Out of memory!\n");
+    exit(1);
+  }
+  memcpy(copy, str, length);
+  for (i = file->numspans - 1; i >= 0; i --) {
+    span = file->spans + i;
+    if (span->allocated) {
+      if (span->pos <= pos) break;
+      continue;
+    }
+    end = span->pos + span->length;
+    if (end <= pos) break;
+    if (span->pos < pos) {
+      /* Insertion point inside this part, split it */
+      openspan(file, i + 1);
+      span = file->spans + i;
+      span[1].start = span->start + (pos - span->pos);
+      span[1].length = end - pos;
+      span[1].pos = pos;
+      span[1].allocated = 0;
+      span->length = pos - span->pos;
+      break;
+    }
+  }
+  openspan(file, i + 1);
+  span = file->spans + i + 1;
+  span->start = copy;
+  span->length = length;
+  span->pos = pos;
+  span->allocated = 1;
+}
+
+/*
+ * function to put out the output of an XML file
+ */
+
+void
+writespans(FILE *out,          /* I - Output stream */
+	   const xmlfile_t *file) { /* I - XML file */
+  int i;
+
+  if (file->spans == NULL) return;
+  for (i = 0; i < file->numspans; i ++)
+    fwrite(file->spans[i].start, 1, file->spans[i].length, out);
+}
+
+/*
+ * function to compute the length of the output of an XML file
+ */
+
+int  /* O - Number of bytes writespans() puts out */
+spanslength(const xmlfile_t *file) { /* I - XML file */
+  int i;
+  int length = 0;
+
+  if (file->spans == NULL) return 0;
+  for (i = 0; i < file->numspans; i ++)
+    length += file->spans[i].length;
+  return length;
+}
+
+/*
+ * function to load an XML file with mapfile(), the output is the whole
+ * file until parse() changes it
+ */
+
+int  /* O - 1: file loaded, 0: file missing, empty, or not readable */
+loadxmlfile(xmlfile_t *file,       /* O - XML file */
+	    const char *filename) { /* I - file name */
+  file->spans = NULL;
+  file->numspans = 0;
+  file->sizespans = 0;
+  file->length = 0;
+  file->data = mapfile(filename, &file->length, &file->mapped);
+  if (file->data == NULL) return 0;
+  initspans(file);
+  return 1;
+}
+
+/*
+ * function to free an XML file and its output
+ */
+
+void
+freexmlfile(xmlfile_t *file) { /* I/O - XML file */
+  freespans(file);
+  if (file->mapped != 2) unloadfile(file->data, file->length, file->mapped);
+  file->data = NULL;
+  file->length = 0;
+}
+
+/*
+ * function to compute the hash value of a printer ID
+ */
+
+unsigned int  /* O - Hash value */
+hashid(const char *id) { /* I - Printer ID */
+  unsigned int h = 2166136261U;
+
+  while (*id) {
+    h ^= (unsigned char)*id++;
+    h *= 16777619U;
+  }
+  return h;
+}
+
+/*
+ * function to find an old printer ID in the translation table
+ */
+
+idpair_t  /* O - Translation, NULL if the ID is not in the table */
+*findid(const idlist_t *idlist, /* I - ID translation table */
+	const char *oldid) {    /* I - Old ID */
+  int i;
+
+  for (i = idlist->buckets[hashid(oldid) & (idlist->numbuckets - 1)];
+       i >= 0; i = idlist->pairs[i].next)
+    if (strcmp(oldid, idlist->pairs[i].oldid) == 0)
+      return idlist->pairs + i;
+  return NULL;
+}
+
+/*
+ * function to build the hash table of the printer ID translation table
+ */
+
+void
+hashidlist(idlist_t *idlist) { /* I/O - ID translation table */
+  idpair_t      *item;
+  unsigned int  i, h;
+
+  /* At least twice as many hash values as entries. If an old ID appears
+     more than once, the first entry is valid, as with the linear search
+     done before */
+  for (idlist->numbuckets = 64;
+       idlist->numbuckets < 2 * (unsigned int)idlist->numpairs;
+       idlist->numbuckets *= 2);
+  idlist->buckets = (int *)malloc(sizeof(int) * idlist->numbuckets);
+  if (idlist->buckets == NULL) {
+    fprintf(stderr, "Out of memory!\n");
+    exit(1);
+  }
+  for (i = 0; i < idlist->numbuckets; i ++)
+    idlist->buckets[i] = -1;
+  for (i = 0; i < (unsigned int)idlist->numpairs; i ++) {
+    item = idlist->pairs + i;
+    item->next = -1;
+    if (findid(idlist, item->oldid) != NULL) continue;
+    h = hashid(item->oldid) & (idlist->numbuckets - 1);
+    item->next = idlist->buckets[h];
+    idlist->buckets[h] = i;
+  }
 }
 
 /*
@@ -118,15 +1251,20 @@ idlist_t /* O - pointer to the printer ID translation table */
                 *newid = NULL; /* pointers to IDs in the current line */
   int           inoldid = 0, /* Are we reading and old or a new ID */
                 innewid = 0; /* currently */
-  idlist_t      *idlist = NULL, /* Pointer to ID list */
-                *currentitem = NULL, /* Pointer to current ID list item */
-                *newitem; /* Pointer to newly created ID list item */
+  idlist_t      *idlist = NULL; /* Pointer to ID table */
+  idpair_t      *newitem; /* Pointer to newly created ID table entry */
 
-  idlistbuffer = loadfile(filename);
+  idlistbuffer = loadfile(filename, NULL);
   if (!idlistbuffer) {
     fprintf(stderr, "Cannot read file %s!\n", filename);
     return NULL;
   }
+  idlist = (idlist_t *)calloc(1, sizeof(idlist_t));
+  if (idlist == NULL) {
+    fprintf(stderr, "Out of memory!\n");
+    exit(1);
+  }
+  idlist->buffer = idlistbuffer;
   for (scan = idlistbuffer; *scan != '\0'; scan++) {
     switch(*scan) {
     case '\r':
@@ -152,18 +1290,23 @@ idlist_t /* O - pointer to the printer ID translation table */
 	*scan = '\0';
 	if (oldid && newid && (*oldid != '#')) {
 	  /* found a pair of old ID and new ID, add it to the translation
-	     list */
-	  newitem = 
-	    (idlist_t *)malloc(sizeof(idlist_t));
+	     table */
+	  if (idlist->numpairs >= idlist->sizepairs) {
+	    idlist->sizepairs = (idlist->sizepairs ?
+				 idlist->sizepairs * 2 : 256);
+	    idlist->pairs =
+	      (idpair_t *)realloc((idpair_t *)(idlist->pairs),
+				  sizeof(idpair_t) * idlist->sizepairs);
+	    if (idlist->pairs == NULL) {
+	      fprintf(stderr, "Out of memory!\n");
+	      exit(1);
+	    }
+	  }
+	  newitem = idlist->pairs + idlist->numpairs;
+	  idlist->numpairs ++;
 	  newitem->oldid = oldid;
 	  newitem->newid = newid;
-	  newitem->next = NULL;
-	  if (currentitem) {
-	    currentitem->next = (struct idlist_t *)newitem;
-	  } else {
-	    idlist = newitem;
-	  }
-	  currentitem = newitem;
+	  newitem->next = -1;
 	}
 	oldid = NULL;
 	newid = NULL;
@@ -185,6 +1328,8 @@ idlist_t /* O - pointer to the printer ID translation table */
       }
     }
   }
+
+  hashidlist(idlist);
   return idlist;
 }
 
@@ -195,424 +1340,2456 @@ idlist_t /* O - pointer to the printer ID translation table */
 char  /* O - new ID */
 *translateid(const char *oldid, /* I - Old ID */
 	     idlist_t *idlist) { /* I - ID translation table */
-  idlist_t      *currentitem = idlist; /* Pointer to current ID list item */
+  idpair_t      *item;
 
-  while(currentitem) {
-    if (strcmp(oldid, currentitem->oldid) == 0) {
-      return currentitem->newid;
-    }
-    currentitem = (idlist_t *)(currentitem->next);
-  }
+  if (idlist == NULL) return (char *)oldid;
+  /* The threads of "-j" translate IDs at the same time */
+  __sync_fetch_and_add(&(idlist->lookups), 1);
+  countstat(STATS_IDLOOKUPS, 1);
+  if ((item = findid(idlist, oldid)) != NULL) return item->newid;
   return (char *)oldid;
 }
 
 /*
- * function to parse an XML file and do a task on it
+ * function to free the printer ID translation table
  */
 
-enum parse_operation 
-{ 
-	PARSE_OP_PRINTER, PARSE_OP_DRIVER, PARSE_OP_OPTION, 
-	PARSE_OP_OV_DRIVER, PARSE_OP_OV_PRINTER };
+void
+freeidlist(idlist_t *idlist) { /* I - ID translation table */
+  if (idlist == NULL) return;
+  free(idlist->buffer);
+  free(idlist->pairs);
+  free(idlist->buckets);
+  free(idlist);
+}
 
-int /* O - Is the requested printer/driver combo already confirmed by the
-           <drivers> section in the printer XML file (operation = 
-	   PARSE_OP_PRINTER only) or by the <printers> section in the driver
-           XML file (operation = PARSE_OP_DRIVER only). 1: yes, 0: no. For
-           all other operations there will be returned always 0. */
-parse(char **data, /* I/O - Data to process */
-      const char *pid,   /* I - Foomatic printer ID */
-      const char *driver,/* I - driver name */
-      const char *filename, /* I - file name for error messages */
-      printerlist_t **printerlist, /* I/O printer list for overview */
-      int operation,     /* I - See "enum parse_operation" above */
-      const char **defaultsettings, /* I - Default option settings given on
-				       the command line */
-      int num_defaultsettings, /* I - Number of default option settings */
-      int *nopjl,        /* I/O - 0: driver allows PJL options, 1: driver
-			    does not allow PJL options (has "<nnpjl />"
-			    flag in "<execution>" section) */
-      idlist_t *idlist,  /* I - ID translation table */
-      int debug) {       /* I - Debug flag: If set, debugging output is
-			        produced */
+/*
+ * function to allocate memory from a pool, it is freed only with the
+ * whole pool
+ */
 
-  char          *trpid = NULL; /* current printer ID translated according
-				  to translation table */
-  int           datalength = 0;  /* length of the XML file */
-  int           linecount = 1;   /* Count the lines for error messages */
-  int           nestinglevel = 0;/* How many XML environments are nested
-				    at the point where we are */
-  int           inxmlheader = 1;
-  int           intag = 0;
-  int           incomment = 0;
-  int           tagnamefound = 0;
-  int           intagword = 0;
-  int           inquotes = 0;
-  int           insinglequotes = 0;
-  int           indoublequotes = 0;
-  enum tag_type /* Arithmetic values, do not change! */ 
-  { TAG_OPEN = 01, TAG_CLOSE = -01, TAG_EMPTY = 0 };
-  int           tagtype = 0; /*1: opening, -1: closing, 0: opening & closing*/
-  int           inprinter = 0;
-  int           inmake = 0;
-  int           inmodel = 0;
-  int           inautodetect = 0;
-  int           indriver = 0;
-  int           indrivers = 0;
-  int           inexecution = 0;
-  int           inprototype = 0;
-  int           innopjl = 0;
-  int           inprinters = 0;
-  int           inid = 0;
-  int           inppd = 0;
-  int           inlang = 0;
-  int           inpostscript = 0;
-  int           inoption = 0;
-  int           inargshortname = 0;
-  int           inargexecution = 0;
-  int           inargpjl = 0;
-  int           inevshortname = 0;
-  int           inen = 0;
-  int           inargmax = 0;
-  int           inargmin = 0;
-  int           inenumval = 0;
-  int           inconstraints = 0;
-  int           inconstraint = 0;
-  int           inargdefault = 0;
-  int           infunctionality = 0;
-  int           inunverified = 0;
-  int           indfunctionality = 0;
-  int           incomments = 0;
-  int           printertobesaved = 0;
-  int           printerentryfound = 0;
-  int           enumvaltoberemoved = 0;
-  int           optionqualified = 0;
-  int           enumvalqualified = 1;
-  int           numenumvals = 1; /* Number of enumeration values,
-				    disqualifies option when 0 at the end of
-				    the file. It is set to zero in the 
-				    beginning of an enum option, for boolean
-				    or numerical options it stays 1 to not
-				    disqualify the option */ 
-	enum option_types 
-	{ 
-		OPTION_TYPE_ENUM, OPTION_TYPE_BOOL, 
-		OPTION_TYPE_INT, OPTION_TYPE_FLOAT };
-  int           optiontype = 0; /* 0: enum, 1: bool, 2: int, 3: float */
-  int           printerscore = 0;
-  int           driverscore = 0;
-  int           printerhiscore = 0;
-  int           driverhiscore = 0;
-  int           defaultlinelength = 0;
-  char          currtagname[256];
-  char          currtagparam[256];
-  char          currtagbody[65536];
-  int           userdefault = 0;
-  int           userdefaultfound = 0;
-  char          userdefaultvalue[256];
-  char          userdefaultid[256];
-  char          currevid[256];
-  double        maxnumvalue = 0;
-  double        minnumvalue = 0;
-  int           csense = 0;
-  char          cprinter[256];
-  char          cmake[256];
-  char          cmodel[256];
-  char          cdriver[256];
-  char          cid[256];
-  char          cppd[1024];
-  char          cfunctionality[256];
-  int           cunverified = 0;
-  char          cautodetectentry[4096];
-  char          cargdefault[256];
-  char          argdefault[256];
-  char          defaultline[256];
-  char          printerentry[1024*1024];
-  char          dfunctionalityentry[10240];
-  const char    *scan;               /* pointer for scanning through the file*/
-  const char    *lasttag = NULL;     /* Start of last XML tag */
-  const char    *lasttagend = NULL;  /* End of last XML tag */
-  const char    *tagwordstart = NULL;/* Beginning of tagname */
-  char    *lastprinters = NULL;      /* Start of last <printers> tag */
-  char    *lastprinter = NULL;       /* Start of last <printer> tag */
-  char    *lastenumval = NULL;       /* Start of last <enum_val> tag */
-  char    *lastconstraints = NULL;   /* Start of last <constraints> tag */
-  char    *lastoption = NULL;        /* Start of last <option> tag */
-  char    *lastautodetect = NULL;    /* Start of last <autodetect> tag */
-  char    *lastdfunctionality = NULL;/* Start of last <functionality> tag */
-  char    *lastcomments = NULL;      /* Start of last <comments> tag */
-  char    *lastprototype = NULL;     /* Start of last <prototype> tag */
-  static char   make[256];           /* Printer make/model read from printer */
-  static char   model[256];          /* XML file needed by constraints in */
-                                     /* option XML files */
-  int           comboconfirmed = 0;
-  int           driverhasproto = 0;
-  int           exceptionfound = 0;
+void  /* O - Allocated memory */
+*poolalloc(pool_t *pool,   /* I/O - Memory pool */
+	   size_t size) {  /* I - Number of bytes needed */
+  char          *block;
+  size_t        blocksize;
+  const size_t  header = (sizeof(char *) + 7) & ~(size_t)7;
 
-  char          *s;
-  int           l;
-  int           j;
-  int           k;
-  printerlist_t *plistpointer;   /* pointers to navigate through the printer */
-  driverlist_t  *dlistpointer;   /* list for the overview */
-  ppdlist_t     *ppdlistpointer;
-  printerlist_t *plistpreventry;
-  driverlist_t  *dlistpreventry;
+  size = (size + 7) & ~(size_t)7;
+  if ((pool->block == NULL) || (pool->used + size > pool->size)) {
+    blocksize = (size + header > POOL_BLOCK_SIZE ?
+		 size + header : POOL_BLOCK_SIZE);
+    block = (char *)malloc(blocksize);
+    if (block == NULL) {
+      fprintf(stderr, "Out of memory!\n");
+      exit(1);
+    }
+    *(char **)block = pool->block;
+    pool->block = block;
+    pool->used = header;
+    pool->size = blocksize;
+  }
+  block = pool->block + pool->used;
+  pool->used += size;
+  return block;
+}
+
+/*
+ * function to copy a string into a pool
+ */
+
+char  /* O - Copy of the string */
+*poolstrdup(pool_t *pool,      /* I/O - Memory pool */
+	    const char *s) {   /* I - String */
+  size_t l = strlen(s) + 1;
+
+  return (char *)memcpy(poolalloc(pool, l), s, l);
+}
+
+/*
+ * function to free a pool with all memory allocated from it
+ */
+
+void
+freepool(pool_t *pool) { /* I/O - Memory pool */
+  char *block;
+
+  while ((block = pool->block) != NULL) {
+    pool->block = *(char **)block;
+    free(block);
+  }
+  pool->used = 0;
+  pool->size = 0;
+}
+
+/*
+ * function to compute the hash value of a driver name, upper and lower
+ * case do not matter, as for strcasecmp()
+ */
+
+unsigned int  /* O - Hash value */
+hashdriver(const char *name) { /* I - Driver name */
+  unsigned int h = 2166136261U;
+
+  while (*name) {
+    h ^= (unsigned char)tolower((unsigned char)*name++);
+    h *= 16777619U;
+  }
+  return h;
+}
+
+/*
+ * function to find a driver in a set of driver names
+ */
+
+driverlist_t  /* O - Driver entry, NULL if the driver is not in the set */
+*findsetdriver(const driverset_t *set, /* I - Set of driver names */
+	       const char *name) {     /* I - Driver name */
+  driverlist_t  *dlistpointer;
+
+  if (set->numbuckets == 0) return NULL;
+  for (dlistpointer = set->buckets[hashdriver(name) &
+				   (set->numbuckets - 1)];
+       dlistpointer != NULL;
+       dlistpointer = (driverlist_t *)(dlistpointer->next))
+    if (strcasecmp(dlistpointer->name, name) == 0) return dlistpointer;
+  return NULL;
+}
+
+/*
+ * function to add a driver to a set of driver names
+ */
+
+void
+addsetdriver(pool_t *pool,       /* I/O - Memory pool for the entry */
+	     driverset_t *set,   /* I/O - Set of driver names */
+	     const char *name) { /* I - Driver name */
+  driverlist_t  *dlistpointer;
   driverlist_t  *dlistnextentry;
-  ppdlist_t     *ppdlistpreventry;
-  ppdlist_t     *ppdlist = NULL;
+  driverlist_t  **buckets;
+  unsigned int  numbuckets;
+  unsigned int  i, h;
 
-  /* Translate printer ID */
-  if ((pid) && (operation < 3)) trpid = translateid(pid, idlist);
+  if (findsetdriver(set, name) != NULL) return;
+  if ((unsigned int)set->numdrivers >= set->numbuckets) {
+    /* Double the number of hash values */
+    numbuckets = (set->numbuckets ? set->numbuckets * 2 : 64);
+    buckets = (driverlist_t **)calloc(numbuckets, sizeof(driverlist_t *));
+    if (buckets == NULL) {
+      fprintf(stderr, "Out of memory!\n");
+      exit(1);
+    }
+    for (i = 0; i < set->numbuckets; i ++)
+      for (dlistpointer = set->buckets[i]; dlistpointer != NULL;
+	   dlistpointer = dlistnextentry) {
+	dlistnextentry = (driverlist_t *)(dlistpointer->next);
+	h = hashdriver(dlistpointer->name) & (numbuckets - 1);
+	dlistpointer->next = (struct driverlist_t *)buckets[h];
+	buckets[h] = dlistpointer;
+      }
+    free(set->buckets);
+    set->buckets = buckets;
+    set->numbuckets = numbuckets;
+  }
+  dlistpointer = (driverlist_t *)poolalloc(pool, sizeof(driverlist_t));
+  dlistpointer->name = poolstrdup(pool, name);
+  dlistpointer->functionality = NULL;
+  h = hashdriver(name) & (set->numbuckets - 1);
+  dlistpointer->next = (struct driverlist_t *)set->buckets[h];
+  set->buckets[h] = dlistpointer;
+  set->numdrivers ++;
+}
 
-  j = 0;
-  datalength = strlen(*data); /* Compute the length of the file once,
-			         this is very time-intensive */
-  if (operation == 1) *nopjl = 0; /* When we parse a driver, put the nopjl
-				     flag to zero, the driver can switch it
-				     to 1 when it contains "<nopjl />" */
-  for (scan = *data; *scan != '\0'; scan++) {
-    switch(*scan) {
-    case '<': /* open angle bracket */
-      if (!inquotes) {
-	if (intag) {
-	  if (!incomment && !inxmlheader) {
-	    /* Unless a tag is a comment, angle brackets cannot appear inside
-	       the tag. */
-	    fprintf(stderr, "XML error: Nested angle brackets in %s, line %d!\n",
-		    filename, linecount);
-	    exit(1);
-	  }
-          /* In a comment angle brackets are treated as a part of a word */
-	  /*if (!intagword) {
-	    intagword = 1;
-	    tagwordstart = scan;
-	    }*/
-	} else {
-	  intag = 1;
-	  if (scan + 3 < *data + datalength) {
-	    if ((*(scan + 1) == '!') && (*(scan + 2) == '-') &&
-		(*(scan + 3) == '-')) {
-	      incomment = 1;
-	      tagtype = TAG_EMPTY;
-	      if (debug) fprintf(stderr, "    Start of a comment\n");
-	    }
-	  }
-	  if (!incomment) {
-	    tagnamefound = 0;
-	    tagtype = TAG_OPEN;
-	    lasttag = scan;
-	  }
-	}
+/*
+ * function to remove a driver from a set of driver names
+ */
+
+void
+removesetdriver(driverset_t *set,   /* I/O - Set of driver names */
+		const char *name) { /* I - Driver name */
+  driverlist_t  **dlistpointer;
+
+  if (set->numbuckets == 0) return;
+  for (dlistpointer = set->buckets + (hashdriver(name) &
+				      (set->numbuckets - 1));
+       *dlistpointer != NULL;
+       dlistpointer = (driverlist_t **)&((*dlistpointer)->next))
+    if (strcasecmp((*dlistpointer)->name, name) == 0) {
+      *dlistpointer = (driverlist_t *)((*dlistpointer)->next);
+      set->numdrivers --;
+      return;
+    }
+}
+
+/*
+ * function to find a printer in the printer/driver combos
+ */
+
+printerlist_t  /* O - Printer entry, NULL if the printer is not there */
+*findprinter(const overview_t *overview, /* I - Printer/driver combos */
+	     const char *id) {           /* I - Printer ID */
+  printerlist_t *plistpointer;
+
+  if (overview->numbuckets == 0) return NULL;
+  for (plistpointer = overview->buckets[hashid(id) &
+					(overview->numbuckets - 1)];
+       plistpointer != NULL;
+       plistpointer = (printerlist_t *)(plistpointer->next))
+    if (strcmp(plistpointer->id, id) == 0) return plistpointer;
+  return NULL;
+}
+
+/*
+ * function to find a printer in the printer/driver combos, a new entry
+ * without drivers is created if the printer is not there
+ */
+
+printerlist_t  /* O - Printer entry */
+*addprinter(overview_t *overview, /* I/O - Printer/driver combos */
+	    const char *id) {     /* I - Printer ID */
+  printerlist_t *plistpointer;
+  printerlist_t **buckets;
+  unsigned int  numbuckets;
+  unsigned int  h;
+  int           i;
+
+  if ((plistpointer = findprinter(overview, id)) != NULL)
+    return plistpointer;
+  if ((unsigned int)overview->numprinters >= overview->numbuckets) {
+    /* Double the number of hash values, removed printers are not in
+       the hash table any more */
+    numbuckets = (overview->numbuckets ? overview->numbuckets * 2 : 1024);
+    buckets = (printerlist_t **)calloc(numbuckets, sizeof(printerlist_t *));
+    if (buckets == NULL) {
+      fprintf(stderr, "Out of memory!\n");
+      exit(1);
+    }
+    for (i = 0; i < overview->numprinters; i ++) {
+      plistpointer = overview->printers[i];
+      if (plistpointer->removed) continue;
+      h = hashid(plistpointer->id) & (numbuckets - 1);
+      plistpointer->next = (struct printerlist_t *)buckets[h];
+      buckets[h] = plistpointer;
+    }
+    free(overview->buckets);
+    overview->buckets = buckets;
+    overview->numbuckets = numbuckets;
+  }
+  if (overview->numprinters >= overview->sizeprinters) {
+    overview->sizeprinters = (overview->sizeprinters ?
+			      overview->sizeprinters * 2 : 1024);
+    overview->printers =
+      (printerlist_t **)realloc(overview->printers, sizeof(printerlist_t *) *
+				overview->sizeprinters);
+    if (overview->printers == NULL) {
+      fprintf(stderr, "Out of memory!\n");
+      exit(1);
+    }
+  }
+  plistpointer = (printerlist_t *)poolalloc(&(overview->pool),
+					    sizeof(printerlist_t));
+  plistpointer->id = poolstrdup(&(overview->pool), id);
+  plistpointer->drivers = NULL;
+  plistpointer->lastdriver = NULL;
+  plistpointer->removed = 0;
+  plistpointer->driverfile = 0;
+  h = hashid(id) & (overview->numbuckets - 1);
+  plistpointer->next = (struct printerlist_t *)overview->buckets[h];
+  overview->buckets[h] = plistpointer;
+  overview->printers[overview->numprinters ++] = plistpointer;
+  return plistpointer;
+}
+
+/*
+ * function to remove a printer from the printer/driver combos, it stays
+ * in the list of printers, marked as removed
+ */
+
+void
+removeprinter(overview_t *overview,          /* I/O - Printer/driver
+						combos */
+	      printerlist_t *printerentry) { /* I - Printer entry */
+  printerlist_t **plistpointer;
+
+  for (plistpointer = overview->buckets + (hashid(printerentry->id) &
+					   (overview->numbuckets - 1));
+       *plistpointer != printerentry;
+       plistpointer = (printerlist_t **)&((*plistpointer)->next));
+  *plistpointer = (printerlist_t *)(printerentry->next);
+  printerentry->next = NULL;
+  printerentry->drivers = NULL;
+  printerentry->lastdriver = NULL;
+  printerentry->removed = 1;
+}
+
+/*
+ * function to find a driver in the driver list of a printer
+ */
+
+driverlist_t  /* O - Driver entry, NULL if the driver is not there */
+*finddriver(const printerlist_t *printerentry, /* I - Printer entry */
+	    const char *name) {                /* I - Driver name */
+  driverlist_t  *dlistpointer;
+
+  for (dlistpointer = printerentry->drivers; dlistpointer != NULL;
+       dlistpointer = (driverlist_t *)(dlistpointer->next))
+    if (strcasecmp(dlistpointer->name, name) == 0) return dlistpointer;
+  return NULL;
+}
+
+/*
+ * function to append a driver to the driver list of a printer
+ */
+
+void
+adddriver(overview_t *overview,          /* I/O - Printer/driver combos */
+	  printerlist_t *printerentry,   /* I/O - Printer entry */
+	  const char *name,              /* I - Driver name */
+	  const char *functionality) {   /* I - Exceptions in the driver's
+					    functionality profile, NULL
+					    for none */
+  driverlist_t  *dlistpointer;
+
+  dlistpointer = (driverlist_t *)poolalloc(&(overview->pool),
+					   sizeof(driverlist_t));
+  dlistpointer->name = poolstrdup(&(overview->pool), name);
+  if ((functionality != NULL) && (functionality[0]))
+    dlistpointer->functionality =
+      poolstrdup(&(overview->pool), functionality);
+  else dlistpointer->functionality = NULL;
+  dlistpointer->next = NULL;
+  if (printerentry->lastdriver != NULL)
+    printerentry->lastdriver->next = (struct driverlist_t *)dlistpointer;
+  else
+    printerentry->drivers = dlistpointer;
+  printerentry->lastdriver = dlistpointer;
+}
+
+/*
+ * function to remove the first entry of a driver from the driver list of
+ * a printer
+ */
+
+int  /* O - 1: driver removed, 0: driver not found */
+removedriver(printerlist_t *printerentry, /* I/O - Printer entry */
+	     const char *name) {          /* I - Driver name */
+  driverlist_t  *dlistpointer;
+  driverlist_t  *dlistpreventry = NULL;
+
+  for (dlistpointer = printerentry->drivers; dlistpointer != NULL;
+       dlistpointer = (driverlist_t *)(dlistpointer->next)) {
+    if (strcasecmp(dlistpointer->name, name) == 0) {
+      if (dlistpreventry != NULL)
+	dlistpreventry->next = dlistpointer->next;
+      else
+	printerentry->drivers = (driverlist_t *)(dlistpointer->next);
+      if (printerentry->lastdriver == dlistpointer)
+	printerentry->lastdriver = dlistpreventry;
+      return 1;
+    }
+    dlistpreventry = dlistpointer;
+  }
+  return 0;
+}
+
+/*
+ * function to add a driver to a printer while reading the driver's XML
+ * file, the printers are recorded to remove the driver from them again
+ * if it turns out not to produce PPD files
+ */
+
+void
+addcombo(overview_t *overview,        /* I/O - Printer/driver combos */
+	 const char *printer,         /* I - Printer ID */
+	 const char *driver,          /* I - Driver name */
+	 const char *functionality) { /* I - Exceptions in the driver's
+					 functionality profile */
+  printerlist_t *plistpointer;
+
+  if (overview->numtouched == 0) {
+    /* First printer of this driver file */
+    if (findsetdriver(&(overview->listeddrivers), driver) != NULL)
+      overview->sharedname = 1;
+    else
+      addsetdriver(&(overview->pool), &(overview->listeddrivers), driver);
+  }
+  plistpointer = addprinter(overview, printer);
+  adddriver(overview, plistpointer, driver, functionality);
+  if (plistpointer->driverfile != overview->driverfile) {
+    plistpointer->driverfile = overview->driverfile;
+    if (overview->numtouched >= overview->sizetouched) {
+      overview->sizetouched = (overview->sizetouched ?
+			       overview->sizetouched * 2 : 256);
+      overview->touched =
+	(printerlist_t **)realloc(overview->touched,
+				  sizeof(printerlist_t *) *
+				  overview->sizetouched);
+      if (overview->touched == NULL) {
+	fprintf(stderr, "Out of memory!\n");
+	exit(1);
       }
-      break;
-    case '\n': /* line break */
-      linecount ++;
-    case '/': /* tag closing */
-    case '>': /* close angle bracket */
-    case ' ': /* white space */
-    case '\t':
-    case '\r': /* Carriage return of dossy XML file */
-      /* word delimiters */
-      if (!inquotes) {
-	if (intag) {
-	  if (!incomment) {
-	    if (intagword) { /* a word in the XML tag finished */
-	      intagword = 0;
-	      if (!tagnamefound) { /* 1st word = tag name */
-		tagnamefound = 1;
-		memmove(currtagname, tagwordstart, scan - tagwordstart);
-		currtagname[scan - tagwordstart] = '\0';
-		if (debug)
-				fprintf(stderr, "    Tag Name: '%s'\n", currtagname);
+    }
+    overview->touched[overview->numtouched ++] = plistpointer;
+  }
+}
+
+/*
+ * function to remove a driver from all printers, for a driver which
+ * does not produce PPD files. Only the printers to which the current
+ * driver file added itself need to be searched, unless an earlier driver
+ * file has the same name.
+ */
+
+void
+removecombos(overview_t *overview, /* I/O - Printer/driver combos */
+	     const char *driver) { /* I - Driver name */
+  int           i;
+
+  /* A driver with the same name in another case does not have a
+     command line prototype any more */
+  removesetdriver(&(overview->protodrivers), driver);
+  if ((overview->numtouched == 0) &&
+      (findsetdriver(&(overview->listeddrivers), driver) != NULL))
+    overview->sharedname = 1;
+  if (overview->sharedname) {
+    for (i = 0; i < overview->numprinters; i ++)
+      if (!overview->printers[i]->removed)
+	removedriver(overview->printers[i], driver);
+  } else {
+    for (i = 0; i < overview->numtouched; i ++)
+      removedriver(overview->touched[i], driver);
+  }
+}
+
+/*
+ * function to free the printer/driver combos
+ */
+
+void
+freeoverview(overview_t *overview) { /* I/O - Printer/driver combos */
+  freepool(&(overview->pool));
+  free(overview->printers);
+  free(overview->buckets);
+  free(overview->protodrivers.buckets);
+  free(overview->listeddrivers.buckets);
+  free(overview->touched);
+  memset(overview, 0, sizeof(overview_t));
+}
+
+/*
+ * function to record a change of the printer/driver combos made by an
+ * overview file
+ */
+
+void
+addcombochange(ovfile_t *ovfile,             /* I/O - Overview file */
+	       int type,                     /* I - See "enum
+						combo_change_types" */
+	       const char *printer,          /* I - Printer ID or NULL */
+	       const char *driver,           /* I - Driver name */
+	       const char *functionality) {  /* I - Exceptions in driver
+						functionality profile or
+						NULL */
+  combochange_t *change;
+
+  if (ovfile->numchanges >= ovfile->sizechanges) {
+    ovfile->sizechanges = (ovfile->sizechanges ?
+			   ovfile->sizechanges * 2 : 64);
+    ovfile->changes =
+      (combochange_t *)realloc(ovfile->changes, sizeof(combochange_t) *
+			       ovfile->sizechanges);
+    if (ovfile->changes == NULL) {
+      fprintf(stderr, "Out of memory!\n");
+      exit(1);
+    }
+  }
+  change = ovfile->changes + ovfile->numchanges;
+  ovfile->numchanges ++;
+  change->type = type;
+  change->printer = (printer ? strdup(printer) : NULL);
+  change->driver = strdup(driver);
+  change->functionality = (functionality && functionality[0] ?
+			   strdup(functionality) : NULL);
+}
+
+/*
+ * function to free an overview file with its output and its changes of
+ * the printer/driver combos
+ */
+
+void
+freeovfile(ovfile_t *ovfile) { /* I/O - Overview file */
+  int i;
+
+  if (ovfile->file.data != NULL) freexmlfile(&(ovfile->file));
+  else freespans(&(ovfile->file));
+  for (i = 0; i < ovfile->numchanges; i ++) {
+    free(ovfile->changes[i].printer);
+    free(ovfile->changes[i].driver);
+    free(ovfile->changes[i].functionality);
+  }
+  free(ovfile->changes);
+  ovfile->changes = NULL;
+  ovfile->numchanges = 0;
+  ovfile->sizechanges = 0;
+  free(ovfile->printer);
+  ovfile->printer = NULL;
+  free(ovfile->entry);
+  ovfile->entry = NULL;
+}
+
+/*
+ * function to apply the changes of an overview file to the printer/driver
+ * combos. For a printer file the overview entry gets completed with the
+ * printer's drivers, it becomes the output of the file.
+ */
+
+void
+applycombochanges(overview_t *overview, /* I/O - Printer/driver combos */
+		  ovfile_t *ovfile,     /* I/O - Overview file */
+		  int driverfile,       /* I - 1: driver file, 0: printer
+					   file */
+		  idlist_t *idlist,     /* I - ID translation table */
+		  int debug) {          /* I - Debug flag */
+  combochange_t *change;
+  printerlist_t *plistpointer;
+  driverlist_t  *dlistpointer;
+  char          *entry = NULL;   /* Printer entry for the overview */
+  int           entrylength = 0; /* Length of the printer entry */
+  int           entrysize = 0;   /* Allocated size of the printer entry */
+  int           exceptionfound = 0;
+  char          *id;             /* Translated printer ID */
+  int           i;
+
+  if (driverfile) {
+    /* A new driver file starts, it did not add itself to any printer
+       yet */
+    overview->driverfile ++;
+    overview->numtouched = 0;
+    overview->sharedname = 0;
+  }
+  for (i = 0; i < ovfile->numchanges; i ++) {
+    change = ovfile->changes + i;
+    switch (change->type) {
+    case COMBO_ADD_PRINTER:
+      addcombo(overview, translateid(change->printer, idlist),
+	       change->driver, change->functionality);
+      break;
+    case COMBO_PROTOTYPE:
+      addsetdriver(&(overview->pool), &(overview->protodrivers),
+		   change->driver);
+      break;
+    case COMBO_NO_PROTOTYPE:
+      removecombos(overview, change->driver);
+      break;
+    case COMBO_ADD_DRIVER:
+      plistpointer = addprinter(overview, change->printer);
+      if (finddriver(plistpointer, change->driver) == NULL)
+	adddriver(overview, plistpointer, change->driver, NULL);
+      break;
+    case COMBO_REMOVE_DRIVER:
+      plistpointer = findprinter(overview, change->printer);
+      if (plistpointer != NULL)
+	removedriver(plistpointer, change->driver);
+      break;
+    }
+  }
+  if (ovfile->printer == NULL) return;
+
+  /* Put together the printer entry for the overview: ID, the part
+     built by parse(), the drivers, and the rest of the part built by
+     parse() */
+  appenddata(&entry, &entrylength, &entrysize, "  <printer>\n    <id>");
+  id = translateid(ovfile->printer, idlist);
+  appenddata(&entry, &entrylength, &entrysize, id);
+  growdata(&entry, &entrysize, entrylength + ovfile->driverspos + 1);
+  memcpy(entry + entrylength, ovfile->entry, ovfile->driverspos);
+  entrylength += ovfile->driverspos;
+  entry[entrylength] = '\0';
+  plistpointer = findprinter(overview, id);
+  if (plistpointer) /* ?P_LIST_POINTER Y */ {
+    appenddata(&entry, &entrylength, &entrysize, "\n    <drivers>\n");
+    dlistpointer = plistpointer->drivers;
+    while (dlistpointer) /* @D_LIST_POINTER */ {
+      appenddata(&entry, &entrylength, &entrysize, "      <driver>");
+      appenddata(&entry, &entrylength, &entrysize, dlistpointer->name);
+      appenddata(&entry, &entrylength, &entrysize, "</driver>\n");
+      if (dlistpointer->functionality != NULL) exceptionfound = 1;
+      dlistpointer = (driverlist_t *)(dlistpointer->next);
+    } /* @D_LIST_POINTER X */
+    appenddata(&entry, &entrylength, &entrysize, "    </drivers>\n");
+    if (exceptionfound) /* ?EXCEPTION_FOUND Y */ {
+      appenddata(&entry, &entrylength, &entrysize, "    <driverfunctionalityexceptions>\n");
+      dlistpointer = plistpointer->drivers;
+      while (dlistpointer) /* @D_LIST_POINTER */ { 
+	if ((dlistpointer->name != NULL) &&
+	    (dlistpointer->functionality != NULL)) /* ?D_LIST_PTR_FUNCT Y */ {
+	  appenddata(&entry, &entrylength, &entrysize,
+		     "      <driverfunctionalityexception>\n");
+	  appenddata(&entry, &entrylength, &entrysize, "        <driver>");
+	  appenddata(&entry, &entrylength, &entrysize, dlistpointer->name);
+	  appenddata(&entry, &entrylength, &entrysize, "</driver>\n");
+	  appenddata(&entry, &entrylength, &entrysize, dlistpointer->functionality);
+	  appenddata(&entry, &entrylength, &entrysize,
+		     "\n      </driverfunctionalityexception>\n");
+	} /* ?D_LIST_PTR_FUNCT */
+	dlistpointer = (driverlist_t *)(dlistpointer->next);
+      } /* @D_LIST_POINTER X */
+      appenddata(&entry, &entrylength, &entrysize, "    </driverfunctionalityexceptions>\n");
+    } /* ?EXCEPTION_FOUND */
+    /* We remove every printer entry in the list for which we have found
+       a printer XML file in the database, so all remaining entries are
+       of printers which are only mentioned in a driver's printer list
+       but do not have an XML file in the database. We will treat these
+       printers later */
+    removeprinter(overview, plistpointer);
+  } /* ?P_LIST_POINTER */ 
+  appenddata(&entry, &entrylength, &entrysize,
+	     ovfile->entry + ovfile->driverspos);
+  if (debug)
+    fprintf(stderr, "    Overview entry for printer %s completed\n", id);
+  freespans(&(ovfile->file));
+  initspans(&(ovfile->file));
+  ovfile->file.spans[0].start = entry;
+  ovfile->file.spans[0].length = entrylength;
+  ovfile->file.spans[0].allocated = 1;
+  ovfile->file.numspans = 1;
+}
+
+/*
+ * function to add an event to an option model
+ */
+
+optevent_t  /* O - The new event, all fields empty */
+*addoptevent(optionmodel_t *model, /* I/O - Option model */
+	     int type,             /* I - Event type */
+	     int inenumval,        /* I - Inside an <enum_val>? */
+	     int line) {           /* I - Line number */
+  optevent_t *event;
+
+  if (model->numevents >= model->sizeevents) {
+    model->sizeevents = (model->sizeevents ? model->sizeevents * 2 : 64);
+    model->events =
+      (optevent_t *)realloc((optevent_t *)(model->events),
+			    sizeof(optevent_t) * model->sizeevents);
+    if (model->events == NULL) {
+      fprintf(stderr, "Out of memory!\n");
+      exit(1);
+    }
+  }
+  event = model->events + model->numevents;
+  model->numevents ++;
+  memset(event, 0, sizeof(optevent_t));
+  event->type = type;
+  event->from = -1;
+  event->to = -1;
+  event->inenumval = (inenumval != 0);
+  event->line = line;
+  return event;
+}
+
+/*
+ * function to create an empty option model
+ */
+
+optionmodel_t  /* O - New option model */
+*newoptionmodel(void) {
+  optionmodel_t *model = (optionmodel_t *)calloc(1, sizeof(optionmodel_t));
+
+  if (model == NULL) {
+    fprintf(stderr, "Out of memory!\n");
+    exit(1);
+  }
+  model->optiontype = +OPTION_TYPE_ENUM;
+  model->numenumvals = 1;
+  return model;
+}
+
+/*
+ * function to copy a string for an option event
+ */
+
+char  /* O - Copy of the string */
+*eventstring(const char *str) { /* I - String */
+  char *copy = strdup(str);
+
+  if (copy == NULL) {
+    fprintf(stderr, "Out of memory!\n");
+    exit(1);
+  }
+  return copy;
+}
+
+/*
+ * function to free an option model
+ */
+
+void
+freeoptionmodel(optionmodel_t *model) { /* I - Option model */
+  int i;
+  optevent_t *event;
+
+  if (model == NULL) return;
+  for (i = 0; i < model->numevents; i ++) {
+    event = model->events + i;
+    free((void *)(event->text));
+    free((void *)(event->printer));
+    free((void *)(event->make));
+    free((void *)(event->model));
+    free((void *)(event->driver));
+    free((void *)(event->argdefault));
+  }
+  free((void *)(model->events));
+  free((void *)model);
+}
+
+/*
+ * function to add an event to a driver model
+ */
+
+drvevent_t  /* O - New event, ranges set to -1 */
+*adddrvevent(drivermodel_t *model, /* I/O - Driver model */
+	     int type) {           /* I - Event type */
+  drvevent_t *event;
+
+  if (model->numevents >= model->sizeevents) {
+    model->sizeevents = (model->sizeevents ? model->sizeevents * 2 : 64);
+    model->events =
+      (drvevent_t *)realloc((drvevent_t *)(model->events),
+			    sizeof(drvevent_t) * model->sizeevents);
+    if (model->events == NULL) {
+      fprintf(stderr, "Out of memory!\n");
+      exit(1);
+    }
+  }
+  event = model->events + model->numevents;
+  model->numevents ++;
+  memset(event, 0, sizeof(drvevent_t));
+  event->type = type;
+  event->from = -1;
+  event->to = -1;
+  return event;
+}
+
+/*
+ * function to create an empty driver model
+ */
+
+drivermodel_t  /* O - New driver model */
+*newdrivermodel(void) {
+  drivermodel_t *model = (drivermodel_t *)calloc(1, sizeof(drivermodel_t));
+
+  if (model == NULL) {
+    fprintf(stderr, "Out of memory!\n");
+    exit(1);
+  }
+  return model;
+}
+
+/*
+ * function to free a driver model
+ */
+
+void
+freedrivermodel(drivermodel_t *model) { /* I - Driver model */
+  int i;
+
+  if (model == NULL) return;
+  for (i = 0; i < model->numevents; i ++)
+    free((void *)(model->events[i].id));
+  free((void *)(model->events));
+  free((void *)model);
+}
+
+/*
+ * function to check whether an XML tag name starts at the given position
+ */
+
+int  /* O - 1: tag name found, 0: other tag */
+istag(const char *s,      /* I - Position after the '<' */
+      const char *name) { /* I - Tag name */
+  int l = strlen(name);
+
+  return ((strncmp(s, name, l) == 0) && 
+	  (s[l] != '\0') && (strchr(" \t\r\n/>", s[l]) != NULL));
+}
+
+/*
+ * function to extract the body of an element of a constraint, for the
+ * index. Returns 0 if the element is not there, 1 if it is there once,
+ * and -1 if the constraint is too unusual to be indexed (element
+ * appearing twice, with attributes, or containing line breaks, or a
+ * comment in the constraint).
+ */
+
+int  /* O - See above */
+constraintfield(const char *start, /* I - Start of the constraint */
+		const char *end,   /* I - End of the constraint */
+		const char *name,  /* I - Element name */
+		char *body) {      /* O - Body of the element */
+  const char *s, *e;
+  int found = 0;
+  int l = strlen(name);
+
+  body[0] = '\0';
+  for (s = start; (s < end) && ((s = strchr(s, '<')) != NULL) && (s < end);
+       s ++) {
+    if (strncmp(s, "<!--", 4) == 0) return -1;
+    if (!istag(s + 1, name)) continue;
+    if (found || (s[l + 1] != '>')) return -1;
+    found = 1;
+    s += l + 2;
+    e = strchr(s, '<');
+    if ((e == NULL) || (e > end) || (e - s > 255) ||
+	(memchr(s, '\n', e - s) != NULL)) return -1;
+    memcpy(body, s, e - s);
+    body[e - s] = '\0';
+  }
+  return found;
+}
+
+/*
+ * function to compute the index keys of an option XML file, from the
+ * option's own constraints. This must match the evaluation of the
+ * constraints in parse(): a constraint can only qualify the option if
+ * its sense is true and its driver, printer, or make matches.
+ */
+
+char  /* O - Keys of the option, see optindex_t */
+*indexoption(const char *filename) { /* I - Option XML file name */
+  char          *data;
+  int           length, mapped;
+  const char    *scan, *tagend, *end;
+  char          *keys = NULL;
+  int           keyslength = 0, keyssize = 0;
+  int           enumvallevel = 0;
+  int           hasdriver, hasprinter, hasmake;
+  char          cdriver[256], cprinter[256], cmake[256], tag[256];
+  char          *s;
+
+  data = mapfile(filename, &length, &mapped);
+  if (data == NULL) {
+    /* Let the combo mode report the error */
+    appenddata(&keys, &keyslength, &keyssize, "*\n");
+    return keys;
+  }
+  for (scan = data; (scan = strchr(scan, '<')) != NULL; scan ++) {
+    if (strncmp(scan, "<!--", 4) == 0) {
+      if ((scan = strstr(scan + 4, "-->")) == NULL) break;
+      continue;
+    }
+    if (istag(scan + 1, "enum_val")) {
+      enumvallevel ++;
+    } else if (istag(scan + 1, "/enum_val")) {
+      enumvallevel --;
+    } else if ((enumvallevel == 0) && istag(scan + 1, "constraint")) {
+      /* A constraint of the option itself, only with sense="true" it can
+	 qualify the option */
+      tagend = strchr(scan, '>');
+      end = strstr(scan, "</constraint>");
+      if ((tagend == NULL) || (end == NULL)) break;
+      if (tagend - scan > 255) {
+	appenddata(&keys, &keyslength, &keyssize, "*\n");
+	break;
+      }
+      memcpy(tag, scan, tagend - scan);
+      tag[tagend - scan] = '\0';
+      if (((s = strstr(tag, "sense")) == NULL) ||
+	  (strstr(s + 5, "true") == NULL)) {
+	scan = end;
+	continue;
+      }
+      hasdriver = constraintfield(tagend, end, "driver", cdriver);
+      hasprinter = constraintfield(tagend, end, "printer", cprinter);
+      hasmake = constraintfield(tagend, end, "make", cmake);
+      if ((hasdriver < 0) || (hasprinter < 0) || (hasmake < 0)) {
+	appenddata(&keys, &keyslength, &keyssize, "*\n");
+	break;
+      }
+      if (hasdriver && cdriver[0]) {
+	/* parse() compares the driver with and without "driver/" */
+	appenddata(&keys, &keyslength, &keyssize, "d ");
+	appenddata(&keys, &keyslength, &keyssize, cdriver);
+	appenddata(&keys, &keyslength, &keyssize, "\n");
+	if (strncmp(cdriver, "driver/", 7) == 0) {
+	  appenddata(&keys, &keyslength, &keyssize, "d ");
+	  appenddata(&keys, &keyslength, &keyssize, cdriver + 7);
+	  appenddata(&keys, &keyslength, &keyssize, "\n");
+	}
+      } else if (hasprinter && cprinter[0]) {
+	/* Short printer ID (w/o "printer/") as in parse() */
+	appenddata(&keys, &keyslength, &keyssize, "p ");
+	appenddata(&keys, &keyslength, &keyssize,
+		   (cprinter[0] == 'p' ? cprinter + 8 : cprinter));
+	appenddata(&keys, &keyslength, &keyssize, "\n");
+      } else if (hasmake && cmake[0]) {
+	appenddata(&keys, &keyslength, &keyssize, "m ");
+	appenddata(&keys, &keyslength, &keyssize, cmake);
+	appenddata(&keys, &keyslength, &keyssize, "\n");
+      }
+      /* Constraints with only a model cannot match */
+      scan = end;
+    }
+  }
+  unloadfile(data, length, mapped);
+  if (keys == NULL) keys = strdup("");
+  return keys;
+}
+
+/*
+ * function to check whether an option can apply to a printer/driver
+ * combo, according to its index keys
+ */
+
+int  /* O - 1: option file needs to be parsed, 0: option does not apply */
+optioncandidate(const char *keys,   /* I - Keys of the option */
+		const char *driver, /* I - Driver name */
+		const char *trpid,  /* I - Translated printer ID */
+		const char *make,   /* I - Printer manufacturer */
+		idlist_t *idlist) { /* I - ID translation table */
+  const char *line, *e;
+  char key[256];
+  int l;
+
+  for (line = keys; *line; line = e + 1) {
+    if ((e = strchr(line, '\n')) == NULL) break;
+    if (line[0] == '*') return 1;
+    l = e - line - 2;
+    if ((l < 0) || (l > 255)) continue;
+    memcpy(key, line + 2, l);
+    key[l] = '\0';
+    switch (line[0]) {
+    case 'd':
+      if (strcmp(key, driver) == 0) return 1;
+      break;
+    case 'p':
+      if (strcmp(translateid(key, idlist), trpid) == 0) return 1;
+      break;
+    case 'm':
+      if (strcmp(key, make) == 0) return 1;
+      break;
+    }
+  }
+  return 0;
+}
+
+/*
+ * function to free the option index
+ */
+
+void
+freeoptindex(optindex_t *optindex) { /* I - Option index */
+  optindex_t *next;
+
+  while (optindex) {
+    next = (optindex_t *)(optindex->next);
+    if (optindex->file.data != NULL) freexmlfile(&(optindex->file));
+    freeoptionmodel(optindex->model);
+    free((void *)(optindex->keys));
+    free((void *)optindex);
+    optindex = next;
+  }
+}
+
+/*
+ * function to load the option index file
+ */
+
+optindex_t  /* O - Option index, NULL if there is no valid one */
+*loadoptindex(const char *filename, /* I - Index file name */
+	      long *dirmtime) {     /* O - Modification time of the
+				       option directory */
+  char          *data;
+  char          *line, *e;
+  char          *keys = NULL;
+  optindex_t    *optindex = NULL, *last = NULL, *entry;
+  char          name[256];
+
+  data = loadfile(filename, NULL);
+  if (data == NULL) return NULL;
+  if ((strncmp(data, OPTINDEX_HEADER, strlen(OPTINDEX_HEADER)) != 0) ||
+      (sscanf(data + strlen(OPTINDEX_HEADER), "D %ld\n", dirmtime) != 1)) {
+    free((void *)data);
+    return NULL;
+  }
+  line = strchr(data + strlen(OPTINDEX_HEADER), '\n') + 1;
+  for (; *line; line = e + 1) {
+    if ((e = strchr(line, '\n')) == NULL) break;
+    if (line[0] == 'F') {
+      entry = (optindex_t *)calloc(1, sizeof(optindex_t));
+      if ((entry == NULL) ||
+	  (sscanf(line, "F %ld %ld %255[^\n]", &entry->mtime, &entry->size,
+		  name) != 3)) {
+	free((void *)entry);
+	freeoptindex(optindex);
+	free((void *)data);
+	return NULL;
+      }
+      strcpy(entry->name, name);
+      entry->keys = strdup("");
+      if (last) last->next = (struct optindex_t *)entry;
+      else optindex = entry;
+      last = entry;
+      keys = NULL;
+    } else if (last != NULL) {
+      /* Key line of the current entry */
+      *e = '\0';
+      keys = (char *)realloc(last->keys, strlen(last->keys) + e - line + 2);
+      if (keys == NULL) {
+	fprintf(stderr, "Out of memory!\n");
+	exit(1);
+      }
+      strcat(keys, line);
+      strcat(keys, "\n");
+      last->keys = keys;
+    }
+  }
+  free((void *)data);
+  return optindex;
+}
+
+/*
+ * function to write the option index file, it is written to a temporary
+ * file and renamed, so that concurrent processes see either the old or
+ * the new index
+ */
+
+void
+saveoptindex(const char *filename, /* I - Index file name */
+	     long dirmtime,        /* I - Modification time of the
+				      option directory */
+	     optindex_t *optindex, /* I - Option index */
+	     int debug) {          /* I - Debug mode flag */
+  char          tmpfilename[1024];
+  FILE          *indexfile;
+  optindex_t    *entry;
+  int           ok;
+
+  snprintf(tmpfilename, sizeof(tmpfilename), "%s.%d", filename,
+	   (int)getpid());
+  indexfile = fopen(tmpfilename, "w");
+  if (indexfile == NULL) {
+    if (debug)
+      fprintf(stderr, "Cannot write option index %s!\n", tmpfilename);
+    return;
+  }
+  fprintf(indexfile, "%sD %ld\n", OPTINDEX_HEADER, dirmtime);
+  for (entry = optindex; entry; entry = (optindex_t *)(entry->next))
+    fprintf(indexfile, "F %ld %ld %s\n%s", entry->mtime, entry->size,
+	    entry->name, entry->keys);
+  ok = !ferror(indexfile);
+  if (fclose(indexfile) != 0) ok = 0;
+  if (!ok || (rename(tmpfilename, filename) != 0)) {
+    if (debug)
+      fprintf(stderr, "Cannot write option index %s!\n", filename);
+    unlink(tmpfilename);
+  }
+}
+
+/*
+ * function to get the option index up to date: it is loaded from the
+ * index file and entries of option files which have changed are
+ * recomputed. If files were added or removed the whole index is rebuilt.
+ * The index file is only written back when "save" is set, the database
+ * is usually installed read-only and a query should not write into it.
+ */
+
+optindex_t  /* O - Option index, in the order of the directory */
+*updateoptindex(const char *optiondirname, /* I - Option directory */
+		const char *filename,      /* I - Index file name */
+		int save,                  /* I - 1: write the index file
+					      when it changed */
+		int debug) {               /* I - Debug mode flag */
+  optindex_t    *optindex, *entry, *last = NULL;
+  long          dirmtime = 0;
+  struct stat   st;
+  char          optionfilename[1024];
+  DIR           *optiondir;
+  struct dirent *direntry;
+  int           changed = 0;
+  int           racy = 0;
+  time_t        now = time(NULL);
+
+  if (stat(optiondirname, &st) != 0) {
+    fprintf(stderr, "Cannot read directory %s!\n", optiondirname);
+    exit(1);
+  }
+  optindex = loadoptindex(filename, &dirmtime);
+  if ((optindex == NULL) || (dirmtime != (long)st.st_mtime)) {
+    /* Files added or removed, or no index yet, rebuild it */
+    if (debug) fprintf(stderr, "Building option index %s\n", filename);
+    freeoptindex(optindex);
+    optindex = NULL;
+    dirmtime = (long)st.st_mtime;
+    changed = 1;
+    optiondir = opendir(optiondirname);
+    if (optiondir == NULL) {
+      fprintf(stderr, "Cannot read directory %s!\n", optiondirname);
+      exit(1);
+    }
+    while((direntry = readdir(optiondir)) != NULL) {
+      if ((strlen(direntry->d_name) < 4) ||
+	  (strlen(direntry->d_name) > 255) ||
+	  (strcmp(direntry->d_name + strlen(direntry->d_name) - 4, ".xml")
+	   != 0))
+	continue;
+      entry = (optindex_t *)calloc(1, sizeof(optindex_t));
+      if (entry == NULL) {
+	fprintf(stderr, "Out of memory!\n");
+	exit(1);
+      }
+      strcpy(entry->name, direntry->d_name);
+      entry->mtime = -1;
+      if (last) last->next = (struct optindex_t *)entry;
+      else optindex = entry;
+      last = entry;
+    }
+    closedir(optiondir);
+  }
+  for (entry = optindex; entry; entry = (optindex_t *)(entry->next)) {
+    snprintf(optionfilename, sizeof(optionfilename), "%s/%s",
+	     optiondirname, entry->name);
+    if (stat(optionfilename, &st) != 0) {
+      st.st_mtime = 0;
+      st.st_size = 0;
+    }
+    if ((entry->mtime != (long)st.st_mtime) ||
+	(entry->size != (long)st.st_size)) {
+      if (debug > 1) fprintf(stderr, "Indexing option file %s\n",
+			     optionfilename);
+      free((void *)(entry->keys));
+      entry->keys = indexoption(optionfilename);
+      entry->mtime = (long)st.st_mtime;
+      entry->size = (long)st.st_size;
+      changed = 1;
+    }
+    /* A file changed in the same second as now could be changed again
+       without its modification time changing, do not save the index then,
+       so that it gets checked again next time */
+    if ((long)st.st_mtime >= (long)now) racy = 1;
+  }
+  if (dirmtime >= (long)now) racy = 1;
+  if (changed && !racy && save)
+    saveoptindex(filename, dirmtime, optindex, debug);
+  return optindex;
+}
+
+/*
+ * function to evaluate the model of an option for a printer/driver combo:
+ * the constraints decide whether the option and its enum values apply,
+ * and the output of the option file is cut down accordingly. With a file
+ * without output (spans NULL) only the decision is made, without
+ * warnings.
+ */
+
+int  /* O - 1: option applies, 0: option does not apply */
+evaloption(const optionmodel_t *optionmodel, /* I - Model of the option */
+	   xmlfile_t *file, /* I/O - Option XML file, its output is
+			       computed for the combo */
+	   const char *pid,   /* I - Foomatic printer ID */
+	   const char *driver,/* I - driver name */
+	   const char *printermake,  /* I - Make of the printer */
+	   const char *printermodel, /* I - Model of the printer */
+	   const char *filename, /* I - file name for error messages */
+	   const char **defaultsettings, /* I - Default option settings
+					    given on the command line */
+	   int num_defaultsettings, /* I - Number of default option
+				       settings */
+	   int nopjl,         /* I - 1: driver does not allow PJL options */
+	   idlist_t *idlist,  /* I - ID translation table */
+	   int debug) {       /* I - Debug flag: If set, debugging output is
+			            produced */
+  const char    *trpid;          /* printer ID translated according to
+				    translation table */
+  const optevent_t *event;
+  int           i, k;
+  const char    *s;
+  int           enumvaltoberemoved = 0;
+  int           optionqualified = 0;
+  int           enumvalqualified = 1;
+  int           numenumvals = optionmodel->numenumvals; /* Number of
+				    enumeration values, disqualifies
+				    option when 0 at the end of the file */
+  int           optiontype = optionmodel->optiontype;
+  int           printerscore = 0;
+  int           driverscore = 0;
+  int           printerhiscore = 0;
+  int           driverhiscore = 0;
+  int           userdefault = 0;
+  int           userdefaultfound = 0;
+  char          userdefaultvalue[256];
+  char          userdefaultid[256];
+  char          currevid[256];
+  double        maxnumvalue = 0;
+  double        minnumvalue = 0;
+  char          argdefault[256];
+  char          defaultline[sizeof(argdefault) + 32];
+
+  trpid = translateid(pid, idlist);
+  userdefaultvalue[0] = '\0';
+  currevid[0] = '\0';
+  argdefault[0] = '\0';
+
+  for (i = 0; i < optionmodel->numevents; i ++) {
+    event = optionmodel->events + i;
+    switch (event->type) {
+    case OPTEV_OPTION:
+      argdefault[0] = '\0';
+      /* Remove the whole header of the XML file */
+      if (debug) 
+	fprintf(stderr,
+		"    Removing XML file header\n");
+      cutspans(file, 0, event->to);
+      break;
+    case OPTEV_SHORTNAME:
+      /* We have the short name of the option, check whether the user
+	 has defined a default value for it */
+      for (k = 0; k < num_defaultsettings; k ++) /* @DEFAULT_SETTINGS */ 
+      {
+	if ((strstr(defaultsettings[k], event->text) == 
+	     defaultsettings[k]) && 
+	    (*(defaultsettings[k] + strlen(event->text))
+	     == '=')) /* ?FOUND_DEFAULT_SETTING Y */ {
+	  s = defaultsettings[k] + strlen(event->text) + 1;
+	  userdefault = 1;
+	  switch (+optiontype)  /* *OPTION_TYPE */ {
+	  case (+OPTION_TYPE_BOOL): {
+	    /* Boolean options */
+	    if ((strcasecmp(s, "true") == 0) ||
+		(strcasecmp(s, "yes") == 0) ||
+		(strcasecmp(s, "on") == 0)) 
+	      /* "True" */
+	      s = "1";
+	    else if ((strcasecmp(s, "false") == 0) ||
+		     (strcasecmp(s, "no") == 0) ||
+		     (strcasecmp(s, "off") == 0)) 
+	      /* "False" */
+	      s = "0";
+	    else if ((strcasecmp(s, "0") != 0) &&
+		     (strcasecmp(s, "1") != 0)) 
+	      /* No valid value for a bool option */
+	      userdefault = 0;
+	  } break;
+	  case (+OPTION_TYPE_INT): {
+	    /* Integer options */
+	    if (strspn(s, "+-0123456789") < strlen(s)) 
+	      userdefault = 0;
+	  } break;
+	  case (+OPTION_TYPE_FLOAT): {
+	    /* Float options */
+	    if (strspn(s, "+-0123456789.eE") < strlen(s)) 
+	      userdefault = 0;
+	  } break; } /* *OPTION_TYPE X */ 
+	  /* A value which does not fit is not valid for any option */
+	  if (snprintf(userdefaultvalue, sizeof(userdefaultvalue), "%s", s)
+	      >= (int)sizeof(userdefaultvalue)) {
+	    userdefaultvalue[0] = '\0';
+	    userdefault = 0;
+	  }
+	  if ((debug) && (userdefault))
+	    fprintf
+	      (stderr,
+	       "      User default setting: '%s'\n",
+	       userdefaultvalue);
+	} else /* ?FOUND_DEFAULT_SETTING N */
+	if ((strcmp(defaultsettings[k], event->text) ==
+	     0) && (+optiontype == +OPTION_TYPE_BOOL)) 
+	  /* ?DEFAULT_TRUE Y */ {
+	  /* "True" for boolean options */
+	  strcpy(userdefaultvalue, "1");
+	  userdefault = 1;
+	  if (debug)
+	    fprintf
+	      (stderr,
+	       "      User default setting: '%s'\n",
+	       userdefaultvalue);
+	} else /* ?DEFAULT_TRUE N */ 
+	if ((strncasecmp(defaultsettings[k], "no", 2)
+	     == 0) &&
+	    (strcmp(defaultsettings[k] + 2, event->text)
+	     == 0) && (+optiontype == +OPTION_TYPE_BOOL)) 
+	  /* ?DEFAULT_FALSE Y */ {
+	  /* "False" for boolean options */
+	  strcpy(userdefaultvalue, "0");
+	  userdefault = 1;
+	  if (debug)
+	    fprintf
+	      (stderr,
+	       "      User default setting: '%s'\n",
+	       userdefaultvalue);
+	} /* ?DEFAULT_FALSE ?DEFAULT_TRUE ?FOUND_DEFAULT_SETTING */
+      } /* @DEFAULT_SETTINGS X */
+      break;
+    case OPTEV_EV_SHORTNAME:
+      /* We have the short name of the enum value, check whether the
+	 user chose this value as default, extract the enum value ID
+	 then and mark the user's default value as found */
+      if ((userdefault) &&
+	  (strcmp(userdefaultvalue, event->text) == 0)) 
+	/* ?DEFAULT_IN_TAG_BODY Y */ {
+	strcpy(userdefaultid, currevid);
+	userdefaultfound = 1;
+	if (debug)
+	  fprintf
+	    (stderr,
+	     "      User default setting found!\n");
+      } /* ?DEFAULT_IN_TAG_BODY Y */
+      break;
+    case OPTEV_ARG_MAX:
+      if ((+optiontype == +OPTION_TYPE_INT) ||
+	  (+optiontype == +OPTION_TYPE_FLOAT)) /* ?OPTION_NUMERIC Y */ {
+	maxnumvalue = atof(event->text);
+	if (userdefault &&
+	    /* Range-check user default and make it invalid if
+	       necessary */
+	    +atof(userdefaultvalue) > +maxnumvalue) 
+	  userdefault = 0;
+      } /* ?OPTION_NUMERIC */
+      break;
+    case OPTEV_ARG_MIN:
+      if ((+optiontype == +OPTION_TYPE_INT) ||
+	  (+optiontype == +OPTION_TYPE_FLOAT)) /* ?OPTION_NUMERIC Y */ {
+	minnumvalue = atof(event->text);
+	if (userdefault) /* ?USER_DEFAULT Y */ {
+	  /* Range-check user default and make it invalid if
+	     necessary */
+	  if (atof(userdefaultvalue) < minnumvalue) {
+	    userdefault = 0;
+	  }
+	} /* ?USER_DEFAULT */
+      } /* ?OPTION_NUMERIC */
+      break;
+    case OPTEV_ARG_PJL:
+      /* We have a PJL option ... */
+      if (nopjl) /* ?NO_PJL Y */ {
+	/* ... and the driver does not allow it. 
+	   So skip this option. */
+	freespans(file);
+	if (debug)
+	  fprintf
+	    (stderr,
+"      Driver does not allow PJL options and this is a PJL option -->\n"
+"    Option does not apply!\n");
+	return 0;
+      } /* ?NO_PJL */
+      break;
+    case OPTEV_ENUM_VAL:
+      /* New enum value, enum values are qualified by default and can be
+	 disqualified by constraints */
+      enumvalqualified = 1;
+      enumvaltoberemoved = 0;
+      break;
+    case OPTEV_ENUM_VAL_ID:
+      strcpy(currevid, event->text);
+      break;
+    case OPTEV_CONSTRAINTS:
+      /* Reset high scores */
+      printerhiscore = 0;
+      driverhiscore = 0;
+      break;
+    case OPTEV_CONSTRAINT:
+      /* Here we evaluate the constraint */
+      if (debug) /* ?DEBUG Y */ {
+	fprintf(stderr,"    Evaluation of constraint\n");
+	fprintf(stderr,"      Values given in constraint:\n");
+	fprintf(stderr,"        make: |%s|, model: |%s|, printer: |%s|\n",
+		event->make, event->model, event->printer);
+	fprintf(stderr,"        driver: |%s|, argdefault: |%s|, sense: |%d|\n",
+		event->driver, event->argdefault, event->sense);
+	fprintf(stderr,"      Values of current printer/driver combo:\n");
+	fprintf(stderr,"        make: |%s|, model: |%s|\n",
+		printermake, printermodel);
+	fprintf(stderr,"        PID: |%s|, driver: |%s|\n",
+		pid, driver);
+      } /* ?DEBUG */
+      if (!((event->make[0]) || (event->model[0]) || 
+	    (event->printer[0]) || (event->driver[0]))) /* ?NULL_CONSTRAINT Y */ {
+	if (file->spans != NULL)
+	  fprintf(stderr, "WARNING: Illegal null constraint in %s, line %d!\n",
+		  filename, event->line);
+      } else  /* ?NULL_CONSTRAINT N */ 
+      if (((event->make[0]) || (event->model[0])) && (event->printer[0])) 
+      /* ?PRINTER_AND_MAKE Y */ {
+	if (file->spans != NULL)
+	  fprintf(stderr, "WARNING: Both printer id and make/model in constraint in %s, line %d!\n",
+		  filename, event->line);
+      } else /* ?PRINTER_AND_MAKE N */ {
+	if (debug) 
+	  fprintf(stderr,
+		  "      Highest scores for printer: |%d|, driver: |%d|\n",
+		  printerhiscore, driverhiscore);
+	/* if make matches, printerscore match grade 1 */
+	/* if model matches, printerscore match grade 2 */
+	/* no information, printerscore = 0 */
+	/* mismatch, printerscore = -1 */
+	printerscore = 0;
+	/* driverscore: -1 = mismatch, 1 = match, 0 = no info */
+	driverscore = 0;
+	/* The per-printer constraining can happen by poid or by
+	   a make[/model] pair */
+	if (event->printer[0]) /* ?HAVE_PRINTER Y */ {
+	  if (debug) fprintf(stderr,"        Checking PID\n");
+	  if (strcmp(translateid(event->printer, idlist), trpid) == 0)
+	    printerscore = 2;
+	  else
+	    printerscore = -1;
+	} else /* ?HAVE_PRINTER N */ if (event->make[0]) /* ?HAVE_MAKE Y */ {
+	  if (debug) fprintf(stderr,"        Checking make\n");
+	  /* We have a requested make, so it can't be zero.
+	     You can't request or constraint by model only! */
+	  if (strcmp(event->make, printermake) == 0) /* ?GOT_MAKE Y */ {
+	    printerscore = 1; /* make matches */
+	    if (event->model[0]) /* ?HAVE_MODEL Y */ {
+	      if (debug)
+		fprintf(stderr,"        Checking model\n");
+	      if (strcmp(event->model, printermodel) == 0)
+		printerscore = 2; /* model matches, too */
+	      else
+		printerscore = -1; /* model mismatch */
+	    } /* ?HAVE_MODEL */
+	  } else /* ?GOT_MAKE N */ printerscore = -1; /* make mismatch */ 
+	  /* ?GOT_MAKE */
+	}  /* ?HAVE_MAKE  ?HAVE_PRINTER */
+	/* Is a driver requested? */
+	if (event->driver[0]) /* ?HAVE_DRIVER Y */ {
+	  if (debug) 
+	    fprintf(stderr,"        Checking driver\n");
+	  /* Driver name with or without "driver/". Only a
+	     "driver/" prefix is skipped, not any 7 characters,
+	     and not beyond the end of shorter names */
+	  if ((strcmp(event->driver, driver) == 0) ||
+	      ((strncmp(event->driver, "driver/", 7) == 0) &&
+	       (strcmp(event->driver + 7, driver) == 0))) 
+	    driverscore = 1; /* driver matches */
+	  else
+	    driverscore = -1; /* driver mismatch */
+	} /* ?HAVE_DRIVER */
+	if (debug)
+	  fprintf(stderr,
+		  "      Scores for this constraint: printer: |%d|, driver: |%d|\n",
+		  printerscore, driverscore);
+	/* Now compare the scores with the ones of the currently
+	   best-matching constraint */
+	/* Any sort of match? */
+	if (((printerscore > 0) || (driverscore > 0)) &&
+	    ((printerscore > -1) && (driverscore > -1))) /* ?GOT_MATCH Y */ {
+	  if (debug) fprintf(stderr,
+			     "      Something matches\n");
+	  /* Does this beat the best match to date? */
+	  if (((printerscore >= printerhiscore) &&
+	       (driverscore >= driverhiscore)) ||
+	      /* They're equal or better in both categories */
+	      (printerscore == 2)) /* ?BEST_PRINTER_DRIVER Y */ {
+	    /* A specific printer always wins */
+	    if (debug)
+	      fprintf(stderr,"      This constraint wins\n");
+	    /* Set the high scores */
+	    if (printerscore > printerhiscore) {
+	      printerhiscore = printerscore;
+	    }
+	    if (driverscore > driverhiscore) {
+	      driverhiscore = driverscore;
+	    }
+	    /* Constraint applies */
+	    if (event->inenumval) /* ?IN_ENUM_VAL Y */ {
+	      /* The winning constraint determines with its
+		 sense whether the option/the enum value
+		 qualifies for our printer/driver combo */
+	      enumvalqualified = event->sense;
+	      if (debug) 
+		fprintf(stderr,
+			"      Enumeration choice qualifies? %d (0: No, 1: Yes)\n",
+			enumvalqualified);
+	    } else /* ?IN_ENUM_VAL N */ {
+	      optionqualified = event->sense;
+	      if (debug) 
+		fprintf(stderr,
+			"      Option qualifies? %d (0: No, 1: Yes)\n",
+			optionqualified);
+	      /* The winning constraint for the option
+		 determines the default setting for this
+		 option */
+	      strcpy(argdefault, event->argdefault);
+	    } /* ?IN_ENUM_VAL */
+	  } /* ?BEST_PRINTER_DRIVER */
+	} /* ?GOT_MATCH */
+      } /* ?PRINTER_AND_MAKE ?NULL_CONSTRAINT */
+      break;
+    case OPTEV_CONSTRAINTS_END:
+      /* End of <constraints> block, did the option/the enum
+	 value qualify for our printer/driver combo? */
+      if (event->inenumval) /* ?IN_ENUM_VAL Y */ {
+	if (debug)
+	  fprintf(stderr,
+		  "    This enumeration value finally qualified? %d (0: No, 1: Yes)\n",
+		  enumvalqualified);
+	if (!enumvalqualified) enumvaltoberemoved = 1;
+      } else  /* ?IN_ENUM_VAL N */ {
+	if (debug)
+	  fprintf(stderr,
+		  "    This option finally qualified?  %d (0: No, 1: Yes)\n",
+		  optionqualified);
+	if (!optionqualified) /* ?OPTION_QUALIFIED Y */ {
+	  /* We have reached the end of the <constraints> block
+	     for this option, and the option's constraints 
+	     didn't qualify the option for our printer/driver
+	     combo => the option does not go into the output. */
+	  freespans(file);
+	  if (debug)
+	    fprintf(stderr, "    Option does not apply!\n");
+	  return 0;
+	} /* ?OPTION_QUALIFIED */
+      } /* ?IN_ENUM_VAL */
+      if (debug)
+	fprintf(stderr,
+		"    Constr. for enum. value? %d, enum value disqualified? %d (0: No, 1: Yes)\n",
+		event->inenumval, enumvaltoberemoved);
+      if ((!event->inenumval) || (!enumvaltoberemoved)) /* ?REMOVE_CONSTRAINTS Y */ {
+	/* Remove the read <constraints> block, it will not
+	   appear in the output, but don't remove it if the
+	   current enum value will be removed anyway */
+	if (event->from >= 0) /* ?LAST_CONSTRAINTS Y */ {
+	  if (debug)
+	    fprintf(stderr, "    Removing constraints block\n");
+	  cutspans(file, event->from, event->to);
+	} else /* ?LAST_CONSTRAINTS N */ {
+	  if (debug)
+	    fprintf(stderr, "    This enum value will be removed anyway, so constraints block does not  \n    need to be removed.\n");
+	} /* ?LAST_CONSTRAINTS */
+      } /* ?REMOVE_CONSTRAINTS */ 
+      break;
+    case OPTEV_ENUM_VAL_END:
+      if (debug) 
+	fprintf(stderr,
+		"    End of enumeration value block, to be removed? %d (0: No, 1: Yes)\n",
+		enumvaltoberemoved);
+      if (enumvaltoberemoved) /* ?ENUM_VAL_TO_BE_REMOVED Y */ {
+	/* This enum value does not apply to our printer/driver
+	   combo, remove it */
+	if (event->from >= 0) /* ?LAST_ENUM_VAL Y */ {
+	  if (debug) fprintf(stderr, "    Removing enumeration value\n");
+	  cutspans(file, event->from, event->to);
+	  countstat(STATS_ENUMVALSPRUNED, 1);
+	} else  /* ?LAST_ENUM_VAL N */ {
+	  if (file->spans != NULL)
+	    fprintf (stderr, "    Cannot remove this evaluation value.\n");
+	}  /* ?LAST_ENUM_VAL */
+      } else /* ?ENUM_VAL_TO_BE_REMOVED N */ 
+	/* This enum value applies to our printer/driver combo */
+	numenumvals++;
+      /* ?ENUM_VAL_TO_BE_REMOVED */
+      break;
+    case OPTEV_OPTION_END:
+      if (debug)
+	fprintf(stderr,
+		"End of option block:\n      No. of enum. values: %d, qualified by constraints? %d (0: No, 1: Yes)\n",
+		numenumvals, optionqualified);
+      if ((!numenumvals) || (!optionqualified)) /* ?NO_VALUES_APPLY Y */ {
+	/* We have reached the end of the option file, but there
+	   are no enum values which qualified for our combo
+	   or there were no constraints at all =>
+	   the option does not go into the output. */
+	freespans(file);
+	if (debug) fprintf (stderr, "    No enum. values, no constraints => Removing option!\n");
+	return 0;
+      } /* ?NO_VALUES_APPLY */
+      /* Insert the line determining the default setting */
+      if ((argdefault[0]) || (userdefault)) {
+	if (event->to >= 0) {
+	  if (debug) 
+	    fprintf(stderr, 
+		    "    Inserting default value\n");
+	  if (userdefault) {
+	    /* There is a user-defined default setting */
+	    if ((+optiontype == +OPTION_TYPE_ENUM)) {
+	      /* enumerated option */
+	      if (userdefaultfound) {
+		strcpy(argdefault, userdefaultid);
+	      }
+	    } else {
+	      /* Boolean or numerical option */
+	      assert 
+		(+optiontype == +OPTION_TYPE_BOOL || +optiontype == +OPTION_TYPE_INT 
+		 || +optiontype == +OPTION_TYPE_FLOAT);
+	      strcpy(argdefault, userdefaultvalue);
+	    }  
+	  }
+	  snprintf(defaultline, sizeof(defaultline),
+		   "\n  <arg_defval>%s</arg_defval>",
+		   argdefault);
+	  insertspan(file, event->to, defaultline, strlen(defaultline));
+	  if (debug) 
+	    fprintf(stderr,
+		    "      Default value line: %s\n",
+		    defaultline);
+	}
+      }
+      break;
+    }
+  }
+  if (debug) {
+    fprintf(stderr, "    Resulting option XML:\n");
+    writespans(stderr, file);
+    fprintf(stderr, "\n");
+  }
+  return 1;
+}
+
+/*
+ * function to evaluate the model of a driver for a printer: the
+ * <printers> blocks of the driver file are replaced by the entries of
+ * the printer, the output of the file is cut down accordingly
+ */
+
+int  /* O - 1: printer is in the driver's printer list, 0: it is not */
+evaldriver(const drivermodel_t *drivermodel, /* I - Model of the driver */
+	   xmlfile_t *file,    /* I/O - Driver file, its output is cut */
+	   const char *pid,    /* I - Foomatic printer ID */
+	   idlist_t *idlist,   /* I - ID translation table */
+	   int *nopjl,         /* O - 1: driver does not allow PJL
+				  options */
+	   int debug) {        /* I - Debug flag */
+  const drvevent_t *event;
+  const char    *trpid = translateid(pid, idlist);
+  char          *printerentry = NULL; /* Entries of the printer, they
+					 replace the <printers> block */
+  int           entrylength = 0;
+  int           entrysize = 0;
+  int           printertobesaved = 0;
+  int           printerentryfound = 0;
+  int           i;
+
+  *nopjl = drivermodel->nopjl;
+  growdata(&printerentry, &entrysize, 1024);
+  printerentry[0] = '\0';
+  for (i = 0; i < drivermodel->numevents; i ++) {
+    event = drivermodel->events + i;
+    switch (event->type) {
+    case DRVEV_DRIVER:
+      /* Remove the whole header of the XML file */
+      if (debug)
+	fprintf(stderr, "    Removing XML file header\n");
+      cutspans(file, 0, event->to);
+      break;
+    case DRVEV_PRINTERS:
+      entrylength = 0;
+      printerentry[0] = '\0';
+      break;
+    case DRVEV_PRINTERS_END:
+      /* Remove the whole <printers> block */
+      if (event->from >= 0) {
+	if (debug) 
+	  fprintf(stderr, "    Removing <printers> block\n");
+	cutspans(file, event->from, event->to);
+	if (debug) 
+	  fprintf(stderr, "    Inserting saved printer\n");
+	if (entrylength != 0)
+	  insertspan(file, event->from, printerentry, entrylength);
+      }
+      break;
+    case DRVEV_PRINTER_END:
+      /* Save the printer entry to reinsert it after deleting the
+	 <printers> block */
+      if (printertobesaved) {
+	printertobesaved = 0;
+	if (event->from >= 0) {
+	  if (debug) fprintf(stderr, "    Saving printer\n");
+	  growdata(&printerentry, &entrysize,
+		   entrylength + event->to - event->from + 32);
+	  appenddata(&printerentry, &entrylength, &entrysize,
+		     "\n <printers>\n  ");
+	  memcpy(printerentry + entrylength, file->data + event->from,
+		 event->to - event->from);
+	  entrylength += event->to - event->from;
+	  printerentry[entrylength] = '\0';
+	  appenddata(&printerentry, &entrylength, &entrysize,
+		     "\n </printers>");
+	}
+      }
+      break;
+    case DRVEV_ID:
+      if (strcmp(trpid, event->id) == 0) {
+	/* Found printer entry in driver file */
+	printerentryfound = 1;
+	printertobesaved = 1;
+	if (debug) fprintf(stderr, "    Found printer\n");
+      } else {
+	if (debug) fprintf(stderr, "    Other printer\n");
+      }
+      break;
+    }
+  }
+  free(printerentry);
+  if (debug) {
+    fprintf(stderr,
+	    "    nopjl: %d (1: driver does not allow PJL options)\n",
+	    *nopjl);
+    fprintf(stderr, "    Printer in driver's printer list: %d\n",
+	    printerentryfound);
+  }
+  return printerentryfound;
+}
+
+/*
+ * function to initialize a parser, its buffers are allocated when the
+ * first file is parsed
+ */
+
+void
+initparser(parser_t *parser) { /* O - Parser */
+  memset(parser, 0, sizeof(parser_t));
+}
+
+/*
+ * function to make a working buffer of a parser large enough for a
+ * string of the given length, the contents of the buffer are kept
+ */
+
+char  /* O - Buffer, it can have moved */
+*parserbuffer(parser_t *parser, /* I/O - Parser */
+	      int buffer,       /* I - Buffer, see "enum parser_buffer" */
+	      int length) {     /* I - Length of the string, without the
+				   terminating zero byte */
+  if (length < PARSER_BUFFER_MIN) length = PARSER_BUFFER_MIN;
+  growdata(&(parser->buffers[buffer]), &(parser->buffersizes[buffer]),
+	   length + 1);
+  return parser->buffers[buffer];
+}
+
+/*
+ * function to copy a part of the XML data into a working buffer of a
+ * parser, as a string
+ */
+
+char  /* O - Buffer, it can have moved */
+*parsercopy(parser_t *parser, /* I/O - Parser */
+	    int buffer,       /* I - Buffer, see "enum parser_buffer" */
+	    const char *str,  /* I - Data to copy */
+	    int length) {     /* I - Length of the data */
+  char *b = parserbuffer(parser, buffer, length);
+
+  memcpy(b, str, length);
+  b[length] = '\0';
+  return b;
+}
+
+/*
+ * function to append a string to the string in a working buffer of a
+ * parser
+ */
+
+char  /* O - Buffer, it can have moved */
+*parserappend(parser_t *parser, /* I/O - Parser */
+	      int buffer,       /* I - Buffer, see "enum parser_buffer" */
+	      const char *str) {/* I - String to append */
+  int l = strlen(parser->buffers[buffer]);
+  int n = strlen(str);
+  char *b = parserbuffer(parser, buffer, l + n);
+
+  memcpy(b + l, str, n + 1);
+  return b;
+}
+
+/*
+ * function to append a string to the printer make or model of a parser
+ */
+
+void
+appendprinter(char **value,    /* I/O - Make or model */
+	      int *size,       /* I/O - Allocated size of the value */
+	      const char *str) {/* I - String to append */
+  int l = strlen(*value);
+
+  growdata(value, size, l + strlen(str) + 1);
+  strcpy(*value + l, str);
+}
+
+/*
+ * function to copy the printer make and model of a parser to another
+ * one, for the threads parsing the option files
+ */
+
+void
+copyparserprinter(parser_t *parser,       /* I/O - Parser */
+		  const parser_t *from) { /* I - Parser with the printer */
+  growdata(&(parser->printermake), &(parser->sizemake),
+	   strlen(from->printermake) + 1);
+  growdata(&(parser->printermodel), &(parser->sizemodel),
+	   strlen(from->printermodel) + 1);
+  strcpy(parser->printermake, from->printermake);
+  strcpy(parser->printermodel, from->printermodel);
+}
+
+/*
+ * function to free the buffers of a parser
+ */
+
+void
+freeparser(parser_t *parser) { /* I/O - Parser */
+  int i;
+  free(parser->printermake);
+  free(parser->printermodel);
+  for (i = 0; i < PARSER_NUM_BUFFERS; i ++) free(parser->buffers[i]);
+  initparser(parser);
+}
+
+/*
+ * Tags which parse() looks at. Their names are turned into these IDs once,
+ * when the tag name is read, with a perfect hash: the length and the first
+ * and last characters of the known names lead to different slots of
+ * xmltags[], so that a single comparison tells whether a name is known.
+ * When adding a tag, check that its slot is still free.
+ */
+
+enum xml_tags
+{
+  XMLTAG_OTHER,          /* Any tag parse() does not look at */
+  XMLTAG_ARG_DEFVAL, XMLTAG_ARG_EXECUTION, XMLTAG_ARG_MAX, XMLTAG_ARG_MIN,
+  XMLTAG_ARG_PJL, XMLTAG_ARG_SHORTNAME, XMLTAG_AUTODETECT, XMLTAG_COMMENTS,
+  XMLTAG_CONSTRAINT, XMLTAG_CONSTRAINTS, XMLTAG_DRIVER, XMLTAG_DRIVERS,
+  XMLTAG_EN, XMLTAG_ENUM_VAL, XMLTAG_EV_SHORTNAME, XMLTAG_EXECUTION,
+  XMLTAG_FUNCTIONALITY, XMLTAG_ID, XMLTAG_LANG, XMLTAG_MAKE, XMLTAG_MODEL,
+  XMLTAG_NOPJL, XMLTAG_OPTION, XMLTAG_POSTSCRIPT, XMLTAG_PPD,
+  XMLTAG_PRINTER, XMLTAG_PRINTERS, XMLTAG_PROTOTYPE, XMLTAG_UNVERIFIED };
+
+#define XMLTAG_HASH_SIZE 64  /* Slots of xmltags[] */
+#define XMLTAG_MAX_LENGTH 13 /* Longest name in xmltags[] */
+#define XMLTAG_HASH(name, length) \
+  (((length) + (unsigned char)(name)[0] * 34 + \
+    (unsigned char)(name)[(length) - 1] * 12) % XMLTAG_HASH_SIZE)
+
+typedef struct { /* structure for a known tag (hash table) */
+  const char            *name;     /* Tag name, NULL: free slot */
+  int                   length;    /* Length of the name */
+  int                   id;        /* See "enum xml_tags" */
+} xmltag_t;
+
+static const xmltag_t xmltags[XMLTAG_HASH_SIZE] = {
+  { NULL, 0, XMLTAG_OTHER },                    /*  0 */
+  { NULL, 0, XMLTAG_OTHER },                    /*  1 */
+  { "enum_val", 8, XMLTAG_ENUM_VAL },           /*  2 */
+  { NULL, 0, XMLTAG_OTHER },                    /*  3 */
+  { "unverified", 10, XMLTAG_UNVERIFIED },      /*  4 */
+  { "functionality", 13, XMLTAG_FUNCTIONALITY }, /*  5 */
+  { NULL, 0, XMLTAG_OTHER },                    /*  6 */
+  { NULL, 0, XMLTAG_OTHER },                    /*  7 */
+  { NULL, 0, XMLTAG_OTHER },                    /*  8 */
+  { "arg_max", 7, XMLTAG_ARG_MAX },             /*  9 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 10 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 11 */
+  { "printers", 8, XMLTAG_PRINTERS },           /* 12 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 13 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 14 */
+  { "model", 5, XMLTAG_MODEL },                 /* 15 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 16 */
+  { "arg_min", 7, XMLTAG_ARG_MIN },             /* 17 */
+  { "comments", 8, XMLTAG_COMMENTS },           /* 18 */
+  { "ppd", 3, XMLTAG_PPD },                     /* 19 */
+  { "en", 2, XMLTAG_EN },                       /* 20 */
+  { "constraints", 11, XMLTAG_CONSTRAINTS },    /* 21 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 22 */
+  { "arg_execution", 13, XMLTAG_ARG_EXECUTION }, /* 23 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 24 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 25 */
+  { "postscript", 10, XMLTAG_POSTSCRIPT },      /* 26 */
+  { "execution", 9, XMLTAG_EXECUTION },         /* 27 */
+  { "autodetect", 10, XMLTAG_AUTODETECT },      /* 28 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 29 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 30 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 31 */
+  { "constraint", 10, XMLTAG_CONSTRAINT },      /* 32 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 33 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 34 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 35 */
+  { "id", 2, XMLTAG_ID },                       /* 36 */
+  { "prototype", 9, XMLTAG_PROTOTYPE },         /* 37 */
+  { "driver", 6, XMLTAG_DRIVER },               /* 38 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 39 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 40 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 41 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 42 */
+  { "arg_shortname", 13, XMLTAG_ARG_SHORTNAME }, /* 43 */
+  { "option", 6, XMLTAG_OPTION },               /* 44 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 45 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 46 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 47 */
+  { "lang", 4, XMLTAG_LANG },                   /* 48 */
+  { "nopjl", 5, XMLTAG_NOPJL },                 /* 49 */
+  { "ev_shortname", 12, XMLTAG_EV_SHORTNAME },  /* 50 */
+  { "drivers", 7, XMLTAG_DRIVERS },             /* 51 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 52 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 53 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 54 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 55 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 56 */
+  { "arg_pjl", 7, XMLTAG_ARG_PJL },             /* 57 */
+  { "make", 4, XMLTAG_MAKE },                   /* 58 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 59 */
+  { "arg_defval", 10, XMLTAG_ARG_DEFVAL },      /* 60 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 61 */
+  { NULL, 0, XMLTAG_OTHER },                    /* 62 */
+  { "printer", 7, XMLTAG_PRINTER }              /* 63 */
+};
+
+/*
+ * function to find the ID of a tag name
+ */
+
+int  /* O - Tag ID, XMLTAG_OTHER if parse() does not look at the tag */
+xmltagid(const char *name, /* I - Tag name */
+	 int length) {     /* I - Length of the tag name */
+  const xmltag_t *tag;
+
+  if ((length < 1) || (length > XMLTAG_MAX_LENGTH)) return XMLTAG_OTHER;
+  tag = xmltags + XMLTAG_HASH(name, length);
+  if ((tag->length == length) && (memcmp(tag->name, name, length) == 0))
+    return tag->id;
+  return XMLTAG_OTHER;
+}
+
+/*
+ * Most bytes of an XML file do not change the state of parse(): the text
+ * between the tags, the contents of comments and of quoted parameters,
+ * and the rest of a word in a tag. skipbytes() jumps over them, checking
+ * 32 (AVX2) or 16 (SSE2) bytes at once when the compiler targets these
+ * instruction sets, and counts the line breaks it jumps over. Stopping at
+ * a byte which does not matter is harmless, the word mode stops at all
+ * control characters for that reason.
+ */
+
+enum skip_modes
+{
+  SKIP_TEXT,    /* Outside of the tags: up to the next '<' */
+  SKIP_COMMENT, /* In a comment: up to the next '>' */
+  SKIP_QUOTES,  /* In a quoted parameter of a tag: up to the next quote */
+  SKIP_WORD };  /* In a word of a tag: up to the next white space, quote,
+		   '/', '<', or '>' */
+
+#if defined(__AVX2__)
+#define SKIP_VECTOR_SIZE 32
+typedef __m256i skipvector_t;
+#define SKIP_LOAD(p) _mm256_loadu_si256((const __m256i *)(p))
+#define SKIP_SET(c) _mm256_set1_epi8(c)
+#define SKIP_EQ(a, b) _mm256_cmpeq_epi8((a), (b))
+#define SKIP_OR(a, b) _mm256_or_si256((a), (b))
+#define SKIP_MIN(a, b) _mm256_min_epu8((a), (b))
+#define SKIP_MASK(a) ((unsigned int)_mm256_movemask_epi8(a))
+#elif defined(__SSE2__)
+#define SKIP_VECTOR_SIZE 16
+typedef __m128i skipvector_t;
+#define SKIP_LOAD(p) _mm_loadu_si128((const __m128i *)(p))
+#define SKIP_SET(c) _mm_set1_epi8(c)
+#define SKIP_EQ(a, b) _mm_cmpeq_epi8((a), (b))
+#define SKIP_OR(a, b) _mm_or_si128((a), (b))
+#define SKIP_MIN(a, b) _mm_min_epu8((a), (b))
+#define SKIP_MASK(a) ((unsigned int)_mm_movemask_epi8(a))
+#endif
+
+const char *  /* O - Next byte parse() has to look at, end if none */
+skipbytes(const char *scan, /* I - Current position */
+	  const char *end,  /* I - End of the data, a zero byte */
+	  int mode,         /* I - See "enum skip_modes" */
+	  int *linecount) { /* I/O - Line counter, for the skipped line
+			       breaks */
+  char          c1, c2;     /* Bytes to stop at (besides the zero byte) */
+#ifdef SKIP_VECTOR_SIZE
+  skipvector_t  v, stop, newline;
+  unsigned int  m;
+#endif
+
+  switch (mode) {
+  case SKIP_TEXT:
+    c1 = c2 = '<';
+    break;
+  case SKIP_COMMENT:
+    c1 = c2 = '>';
+    break;
+  case SKIP_QUOTES:
+    c1 = '\"';
+    c2 = '\'';
+    break;
+  default:
+    c1 = c2 = '\0';
+  }
+#ifdef SKIP_VECTOR_SIZE
+  while (end - scan >= SKIP_VECTOR_SIZE) {
+    v = SKIP_LOAD(scan);
+    if (mode == SKIP_WORD) {
+      /* White space, line breaks, and the zero byte are all <= ' ' */
+      stop = SKIP_OR(SKIP_OR(SKIP_EQ(SKIP_MIN(v, SKIP_SET(' ')), v),
+			     SKIP_EQ(v, SKIP_SET('\"'))),
+		     SKIP_OR(SKIP_OR(SKIP_EQ(v, SKIP_SET('\'')),
+				     SKIP_EQ(v, SKIP_SET('/'))),
+			     SKIP_OR(SKIP_EQ(v, SKIP_SET('<')),
+				     SKIP_EQ(v, SKIP_SET('>')))));
+      m = SKIP_MASK(stop);
+      if (m != 0) return scan + __builtin_ctz(m);
+    } else {
+      stop = SKIP_OR(SKIP_OR(SKIP_EQ(v, SKIP_SET(c1)),
+			     SKIP_EQ(v, SKIP_SET(c2))),
+		     SKIP_EQ(v, SKIP_SET('\0')));
+      newline = SKIP_EQ(v, SKIP_SET('\n'));
+      m = SKIP_MASK(stop);
+      if (m != 0) {
+	*linecount += __builtin_popcount(SKIP_MASK(newline) &
+					 ((1u << __builtin_ctz(m)) - 1));
+	return scan + __builtin_ctz(m);
+      }
+      *linecount += __builtin_popcount(SKIP_MASK(newline));
+    }
+    scan += SKIP_VECTOR_SIZE;
+  }
+#endif
+  /* The rest, or everything without vector instructions */
+  if (mode == SKIP_WORD) {
+    while ((scan < end) && ((unsigned char)*scan > ' ') && (*scan != '\"') &&
+	   (*scan != '\'') && (*scan != '/') && (*scan != '<') &&
+	   (*scan != '>'))
+      scan ++;
+  } else {
+    while ((scan < end) && (*scan != c1) && (*scan != c2) &&
+	   (*scan != '\0')) {
+      if (*scan == '\n') (*linecount) ++;
+      scan ++;
+    }
+  }
+  return scan;
+}
+
+/*
+ * function to free the list of ready-made PPD files of a printer
+ */
+
+void
+freeppdlist(ppdlist_t *ppdlist) { /* I - List of PPD files */
+  ppdlist_t     *next;
+
+  while (ppdlist != NULL) {
+    next = (ppdlist_t *)ppdlist->next;
+    free(ppdlist);
+    ppdlist = next;
+  }
+}
+
+/*
+ * function to parse an XML file and do a task on it
+ */
+
+enum parse_operation 
+{ 
+	PARSE_OP_PRINTER, PARSE_OP_DRIVER, PARSE_OP_OPTION, 
+	PARSE_OP_OV_DRIVER, PARSE_OP_OV_PRINTER };
+
+int /* O - Is the requested printer/driver combo already confirmed by the
+           <drivers> section in the printer XML file (operation = 
+	   PARSE_OP_PRINTER only). 1: yes, 0: no. For all other operations
+           there will be returned always 0, for drivers evaldriver()
+           tells it. -1: XML error in the file (error message issued),
+	   the caller frees what was recorded in "file" and the model */
+parse(parser_t *parser, /* I/O - Parser state and buffers */
+      xmlfile_t *file, /* I/O - XML file to process, the parts of it
+			    which go into the output are recorded in it */
+      const char *pid,   /* I - Foomatic printer ID */
+      const char *driver,/* I - driver name */
+      const char *filename, /* I - file name for error messages */
+      ovfile_t *ovfile,  /* I/O - Overview file, the changes of the
+			    printer/driver combos and the overview entry
+			    are recorded in it (PARSE_OP_OV_* only) */
+      int operation,     /* I - See "enum parse_operation" above */
+      const char **defaultsettings, /* I - Default option settings given on
+				       the command line */
+      int num_defaultsettings, /* I - Number of default option settings */
+      int *nopjl,        /* I/O - 0: driver allows PJL options, 1: driver
+			    does not allow PJL options (has "<nnpjl />"
+			    flag in "<execution>" section) */
+      idlist_t *idlist,  /* I - ID translation table */
+      optionmodel_t *optionmodel, /* O - Model of the option
+				     (PARSE_OP_OPTION only), the option
+				     is evaluated for a combo with
+				     evaloption() */
+      drivermodel_t *drivermodel, /* O - Model of the driver
+				     (PARSE_OP_DRIVER only), the driver
+				     is evaluated for a combo with
+				     evaldriver() */
+      int debug) {       /* I - Debug flag: If set, debugging output is
+			        produced */
+
+  const char    *data = file->data; /* Data to process */
+  int           datalength = file->length; /* Length of the data */
+  char          *entry = NULL;   /* Printer entry for the overview */
+  int           entrylength = 0; /* Length of the printer entry */
+  int           entrysize = 0;   /* Allocated size of the printer entry */
+  int           linecount = 1;   /* Count the lines for error messages */
+  int           nestinglevel = 0;/* How many XML environments are nested
+				    at the point where we are */
+  int           inxmlheader = 1;
+  int           intag = 0;
+  int           incomment = 0;
+  int           tagnamefound = 0;
+  int           intagword = 0;
+  int           inquotes = 0;
+  int           insinglequotes = 0;
+  int           indoublequotes = 0;
+  enum tag_type /* Arithmetic values, do not change! */ 
+  { TAG_OPEN = 01, TAG_CLOSE = -01, TAG_EMPTY = 0 };
+  int           tagtype = 0; /*1: opening, -1: closing, 0: opening & closing*/
+  int           inprinter = 0;
+  int           inmake = 0;
+  int           inmodel = 0;
+  int           inautodetect = 0;
+  int           indriver = 0;
+  int           indrivers = 0;
+  int           inexecution = 0;
+  int           inprototype = 0;
+  int           innopjl = 0;
+  int           inprinters = 0;
+  int           inid = 0;
+  int           inppd = 0;
+  int           inlang = 0;
+  int           inpostscript = 0;
+  int           inoption = 0;
+  int           inargshortname = 0;
+  int           inargexecution = 0;
+  int           inargpjl = 0;
+  int           inevshortname = 0;
+  int           inen = 0;
+  int           inargmax = 0;
+  int           inargmin = 0;
+  int           inenumval = 0;
+  int           inconstraints = 0;
+  int           inconstraint = 0;
+  int           inargdefault = 0;
+  int           infunctionality = 0;
+  int           inunverified = 0;
+  int           indfunctionality = 0;
+  int           incomments = 0;
+  /* Working buffers, in the parser, see parserbuffer(), they can move
+     whenever something gets copied into them */
+  char          *currtagname;
+  int           currtag = XMLTAG_OTHER; /* ID of currtagname, see
+					   xmltagid() */
+  char          *currtagparam;
+  char          *currtagbody;
+  char          *currevid;
+  int           csense = 0;
+  char          *cprinter;
+  char          *cmake;
+  char          *cmodel;
+  char          *cdriver;
+  char          *cid;
+  char          *cppd;
+  char          *cfunctionality;
+  int           cunverified = 0;
+  char          *cautodetectentry;
+  char          *cargdefault;
+  char          *dfunctionalityentry;
+  const char    *scan;               /* pointer for scanning through the file*/
+  const char    *end = data + datalength; /* zero byte after the data */
+  const char    *lasttag = NULL;     /* Start of last XML tag */
+  const char    *lasttagend = NULL;  /* End of last XML tag */
+  const char    *tagwordstart = NULL;/* Beginning of tagname */
+  char    *lastprinters = NULL;      /* Start of last <printers> tag */
+  char    *lastprinter = NULL;       /* Start of last <printer> tag */
+  char    *lastenumval = NULL;       /* Start of last <enum_val> tag */
+  char    *lastconstraints = NULL;   /* Start of last <constraints> tag */
+  char    *lastoption = NULL;        /* Start of last <option> tag */
+  char    *lastautodetect = NULL;    /* Start of last <autodetect> tag */
+  char    *lastdfunctionality = NULL;/* Start of last <functionality> tag */
+  char    *lastcomments = NULL;      /* Start of last <comments> tag */
+  char    *lastprototype = NULL;     /* Start of last <prototype> tag */
+  int           comboconfirmed = 0;
+  int           driverhasproto = 0;
+
+  char          *s;
+  int           j;
+  optevent_t    *event;          /* Event of the option model */
+  drvevent_t    *drvevent;       /* Event of the driver model */
+  xmlfile_t     nooutput;        /* To evaluate the option model while
+				    building it */
+  ppdlist_t     *ppdlistpointer;
+  ppdlist_t     *ppdlistpreventry;
+  ppdlist_t     *ppdlist = NULL;
+
+  /* The buffers grow with the values copied into them, so that a long
+     file does not make all of them as large as the file */
+  for (j = 0; j < PARSER_NUM_BUFFERS; j ++)
+    parserbuffer(parser, j, 0)[0] = '\0';
+  currtagname = parser->buffers[PB_TAGNAME];
+  currtagparam = parser->buffers[PB_TAGPARAM];
+  currtagbody = parser->buffers[PB_TAGBODY];
+  currevid = parser->buffers[PB_EVID];
+  cprinter = parser->buffers[PB_PRINTER];
+  cmake = parser->buffers[PB_MAKE];
+  cmodel = parser->buffers[PB_MODEL];
+  cdriver = parser->buffers[PB_DRIVER];
+  cid = parser->buffers[PB_ID];
+  cppd = parser->buffers[PB_PPD];
+  cfunctionality = parser->buffers[PB_FUNCTIONALITY];
+  cautodetectentry = parser->buffers[PB_AUTODETECTENTRY];
+  cargdefault = parser->buffers[PB_ARGDEFAULT];
+  dfunctionalityentry = parser->buffers[PB_DFUNCTIONALITYENTRY];
+
+  memset(&nooutput, 0, sizeof(nooutput));
+
+  j = 0;
+  if (operation == 0) { /* The make and model of a previous combo are not
+			   valid any more */
+    growdata(&(parser->printermake), &(parser->sizemake), PARSER_BUFFER_MIN);
+    growdata(&(parser->printermodel), &(parser->sizemodel),
+	     PARSER_BUFFER_MIN);
+    parser->printermake[0] = '\0';
+    parser->printermodel[0] = '\0';
+  }
+  for (scan = data; *scan != '\0'; scan++) {
+    /* Jump over the bytes which do not change the state, see
+       skipbytes() */
+    if (!intag)
+      scan = skipbytes(scan, end, SKIP_TEXT, &linecount);
+    else if (incomment)
+      scan = skipbytes(scan, end, SKIP_COMMENT, &linecount);
+    else if (inquotes)
+      scan = skipbytes(scan, end, SKIP_QUOTES, &linecount);
+    else if (intagword)
+      scan = skipbytes(scan, end, SKIP_WORD, &linecount);
+    if (*scan == '\0') break;
+    switch(*scan) {
+    case '<': /* open angle bracket */
+      if (!inquotes) {
+	if (intag) {
+	  if (!incomment && !inxmlheader) {
+	    /* Unless a tag is a comment, angle brackets cannot appear inside
+	       the tag. */
+	    fprintf(stderr, "XML error: Nested angle brackets in %s, line %d!\n",
+		    filename, linecount);
+	    freeppdlist(ppdlist);
+	    free(entry);
+	    return -1;
+	  }
+          /* In a comment angle brackets are treated as a part of a word */
+	  /*if (!intagword) {
+	    intagword = 1;
+	    tagwordstart = scan;
+	    }*/
+	} else {
+	  intag = 1;
+	  if (scan + 3 < data + datalength) {
+	    if ((*(scan + 1) == '!') && (*(scan + 2) == '-') &&
+		(*(scan + 3) == '-')) {
+	      incomment = 1;
+	      tagtype = TAG_EMPTY;
+	      if (debug) fprintf(stderr, "    Start of a comment\n");
+	    }
+	  }
+	  if (!incomment) {
+	    tagnamefound = 0;
+	    tagtype = TAG_OPEN;
+	    lasttag = scan;
+	  }
+	}
+      }
+      break;
+    case '\n': /* line break */
+      linecount ++;
+    case '/': /* tag closing */
+    case '>': /* close angle bracket */
+    case ' ': /* white space */
+    case '\t':
+    case '\r': /* Carriage return of dossy XML file */
+      /* word delimiters */
+      if (!inquotes) {
+	if (intag) {
+	  if (!incomment) {
+	    if (intagword) { /* a word in the XML tag finished */
+	      intagword = 0;
+	      if (!tagnamefound) { /* 1st word = tag name */
+		tagnamefound = 1;
+		currtagname = parsercopy(parser, PB_TAGNAME, tagwordstart,
+					 scan - tagwordstart);
+		currtag = xmltagid(currtagname, scan - tagwordstart);
+		if (debug)
+				fprintf(stderr, "    Tag Name: '%s'\n", currtagname);
 		switch (+operation) {
 		case (+PARSE_OP_PRINTER):  /* Printer XML file */
-		switch (+*currtagname) {
-		  case 'm': if (strcmp(currtagname, "make") == 0) {
+		switch (currtag) {
+		  case XMLTAG_MAKE:
 		    inmake = nestinglevel + 1;
-		  } else if (strcmp(currtagname, "model") == 0) {
+		    break;
+		  case XMLTAG_MODEL:
 		    inmodel = nestinglevel + 1;
-		  } break;
-		  case 'a': if (strcmp(currtagname, "autodetect") == 0) {
+		    break;
+		  case XMLTAG_AUTODETECT:
 		    inautodetect = nestinglevel + 1;
-		  } break;
-		  case 'd': if (strcmp(currtagname, "driver") == 0) {
+		    break;
+		  case XMLTAG_DRIVER:
 		    indriver = nestinglevel + 1;
 		    if (indrivers) {
 		      if (+tagtype == +TAG_OPEN) {
 			if (debug)
-			  fprintf(stderr, 
+			  fprintf(stderr,
 				  "    Resetting Driver.\n");
 			cid[0] = '\0';
 		      }
 		    }
-		  } else if (strcmp(currtagname, "drivers") == 0) {
+		    break;
+		  case XMLTAG_DRIVERS:
 		    indrivers = nestinglevel + 1;
-		  } break;
-		  case 'i': if (strcmp(currtagname, "id") == 0) {
+		    break;
+		  case XMLTAG_ID:
 		    inid = nestinglevel + 1;
-		  } break; 
-		  case 'p': if (strcmp(currtagname, "printer") == 0) {
+		    break;
+		  case XMLTAG_PRINTER:
 		    inprinter = nestinglevel + 1;
 		    if (+tagtype == +TAG_OPEN) {
 		      /* XML body of the file is starting here */
 		      inxmlheader = 0;
 		      nestinglevel = 1;
 		      /* Remove the whole header of the XML file */
-		      if (debug) 
+		      if (debug)
 			fprintf(stderr,
 				"    Removing XML file header\n");
-		      memmove(*data, lasttag, 
-			      *data + datalength + 1 - lasttag);
-		      datalength -= lasttag - *data;
-		      scan -= lasttag - *data;
-		      tagwordstart -= lasttag - *data;
-		      lasttag = *data;
+		      cutspans(file, 0, lasttag - data);
 		      lasttagend = NULL;
 		    }
-		  } else if (strcmp(currtagname, "postscript") == 0) {
+		    break;
+		  case XMLTAG_POSTSCRIPT:
 		    inpostscript = nestinglevel + 1;
 		    if (inlang) {
 		      if (+tagtype == +TAG_OPEN) {
 			if (debug)
-			  fprintf(stderr, 
+			  fprintf(stderr,
 				  "    Resetting Driver/PPD.\n");
 			cid[0] = '\0';
 			cppd[0] = '\0';
 		      }
 		    }
-		  } else if (strcmp(currtagname, "ppd") == 0) {
+		    break;
+		  case XMLTAG_PPD:
 		    inppd = nestinglevel + 1;
-		  } break;
-		  case 'l': if (strcmp(currtagname, "lang") == 0) {
+		    break;
+		  case XMLTAG_LANG:
 		    inlang = nestinglevel + 1;
-		  } break; 
-		} break; 
-		case (+PARSE_OP_DRIVER): { /* Driver XML file */
-		  if (strcmp(currtagname, "printer") == 0) {
+		    break;
+		} break;
+		case (+PARSE_OP_DRIVER): /* Driver XML file */
+		switch (currtag) {
+		  case XMLTAG_PRINTER:
 		    inprinter = nestinglevel + 1;
 		    if (+tagtype == +TAG_OPEN) lastprinter = (char*)lasttag;
-		  } else if (strcmp(currtagname, "execution") == 0) {
+		    break;
+		  case XMLTAG_EXECUTION:
 		    inexecution = nestinglevel + 1;
-		  } else if (strcmp(currtagname, "nopjl") == 0) {
+		    break;
+		  case XMLTAG_NOPJL:
 		    innopjl = nestinglevel + 1;
 		    if (inexecution) {
-		      *nopjl = 1;
+		      drivermodel->nopjl = 1;
 		      if (debug)
 			fprintf
 			  (stderr,
 			   "      <nopjl /> found, driver does not allow PJL options!\n");
 		    }
-		  } else if (strcmp(currtagname, "id") == 0) {
+		    break;
+		  case XMLTAG_ID:
 		    inid = nestinglevel + 1;
-		  } else if (strcmp(currtagname, "printers") == 0) {
+		    break;
+		  case XMLTAG_PRINTERS:
 		    inprinters = nestinglevel + 1;
 		    if (+tagtype == +TAG_OPEN) {
 		      /* Mark up to the end of the tag before, so that there do
 			 not remain empty lines or other whitespace after
 			 deleting this constraint */
 		      lastprinters = (char*)lasttagend + 1;
-		      printerentry[0] = '\0';
+		      adddrvevent(drivermodel, DRVEV_PRINTERS);
 		    }
-		  } else if (strcmp(currtagname, "driver") == 0) {
+		    break;
+		  case XMLTAG_DRIVER:
 		    indriver = nestinglevel + 1;
 		    if (+tagtype == +TAG_OPEN) {
 		      /* XML body of the file is starting here */
 		      inxmlheader = 0;
 		      nestinglevel = 1;
-		      /* Remove the whole header of the XML file */
-		      if (debug) 
-			fprintf(stderr,
-				"    Removing XML file header\n");
-		      memmove(*data, lasttag, 
-			      *data + datalength + 1 - lasttag);
-		      datalength -= lasttag - *data;
-		      scan -= lasttag - *data;
-		      tagwordstart -= lasttag - *data;
-		      lasttag = *data;
+		      /* The whole header of the XML file gets removed */
+		      adddrvevent(drivermodel, DRVEV_DRIVER)->to =
+			lasttag - data;
 		      lasttagend = NULL;
 		    }
-		  } 
-		} break; 
-		case (+PARSE_OP_OPTION): /* Option XML file */ 
-		switch (+*currtagname) {
-		case 'm':  if (strcmp (currtagname + 01, "make" + 01) == 0) {
+		    break;
+		} break;
+		case (+PARSE_OP_OPTION): /* Option XML file */
+		switch (currtag) {
+		  case XMLTAG_MAKE:
 		    inmake = nestinglevel + 1;
-		  } else if (strcmp (currtagname + 01, "model" + 01) == 0) {
+		    break;
+		  case XMLTAG_MODEL:
 		    inmodel = nestinglevel + 1;
-		  } break;
-		case 'd': if (strcmp (currtagname + 01, "driver" + 01) == 0) {
+		    break;
+		  case XMLTAG_DRIVER:
 		    indriver = nestinglevel + 1;
-		  } break;
-		case 'p': if (strcmp (currtagname + 01, "printer" + 01) == 0) {
+		    break;
+		  case XMLTAG_PRINTER:
 		    inprinter = nestinglevel + 1;
-		  } break;
-		case 'a': 
-		if (!strncmp (currtagname, "arg_", 04)) 
-		switch (+currtagname [04]) {
-			case 'd': if (strcmp(currtagname + 05, "defval" + 01) == 0) {
+		    break;
+		  case XMLTAG_ARG_DEFVAL:
 		    inargdefault = nestinglevel + 1;
-		  } break;
-		  case 's': if (strcmp(currtagname + 05, "shortname" + 01) == 0) {
+		    break;
+		  case XMLTAG_ARG_SHORTNAME:
 		    inargshortname = nestinglevel + 1;
-		  } break;
-		  case 'e': if (strcmp (currtagname + 05, "execution" + 01) == 0) {
+		    break;
+		  case XMLTAG_ARG_EXECUTION:
 		    inargexecution = nestinglevel + 1;
-		  } break;
-		  case 'p': 
-		  if (strcmp (currtagname + 05, "pjl" + 01) == 0) 
-		  /* ?ARG_PJL Y */ {
+		    break;
+		  case XMLTAG_ARG_PJL:
 		    inargpjl = nestinglevel + 1;
 		    if (inargexecution) /* ?IN_ARG_EXECUTION Y */ {
-		      /* We have a PJL option ... */
-		      if (*nopjl) /* ?NO_PJL Y */ {
-			/* ... and the driver does not allow it. 
-			   So skip this option. */
-			free((void *)(*data));
-			*data = NULL;
-			if (debug)
-			  fprintf
-			    (stderr,
-"      Driver does not allow PJL options and this is a PJL option -->\n"
-"    Option does not apply!\n");
+		      /* We have a PJL option, it does not apply if the
+			 driver does not allow PJL */
+		      addoptevent(optionmodel, OPTEV_ARG_PJL, inenumval,
+				  linecount);
+		      if ((pid) && (*nopjl)) {
+			/* No need to read on for the given combo */
+			optionmodel->partial = 1;
 			return +comboconfirmed;
-		      } /* ?NO_PJL */
+		      }
 		    } /* ?IN_ARG_EXECUTION */
-		  }  /* ?ARG_PJL */ break; 
-		  case 'm': if (strcmp(currtagname + 05, "max" + 01) == 0) {
+		    break;
+		  case XMLTAG_ARG_MAX:
 		    inargmax = nestinglevel + 1;
-		  } else if (strcmp(currtagname + 05, "min" + 01) == 0) {
+		    break;
+		  case XMLTAG_ARG_MIN:
 		    inargmin = nestinglevel + 1;
-		  } } break;
-		  case 'e': if (strcmp (currtagname + 01, "ev_shortname" + 01) == 0) {
+		    break;
+		  case XMLTAG_EV_SHORTNAME:
 		    inevshortname = nestinglevel + 1;
-		  } else if (strcmp(currtagname + 01, "en" + 01) == 0) {
+		    break;
+		  case XMLTAG_EN:
 		    inen = nestinglevel + 1;
-		  } else if (strcmp (currtagname + 01, "enum_val" + 01) == 0) {
+		    break;
+		  case XMLTAG_ENUM_VAL:
 		    inenumval = nestinglevel + 1;
 		    if (+tagtype == +TAG_OPEN) {
 		      /* New enum value, enum values are qualified by default
 			 and can be disqualified by constraints */
-		      enumvalqualified = 1;
-		      enumvaltoberemoved = 0;
+		      addoptevent(optionmodel, OPTEV_ENUM_VAL, inenumval,
+				  linecount);
 		      /* Mark up to the end of the tag before, so that there do
 			 not remain empty lines or other whitespace after
 			 deleting this constraint */
 		      lastenumval = (char*)lasttagend + 1;
 		    }
-		  } break; 
-		  case 'c': if (strcmp (currtagname + 01, "constraints" + 01) == 0) {
+		    break;
+		  case XMLTAG_CONSTRAINTS:
 		    inconstraints = nestinglevel + 1;
 		    if (+tagtype == +TAG_OPEN) {
 		      /* Reset high scores */
-		      printerhiscore = 0;
-		      driverhiscore = 0;
+		      addoptevent(optionmodel, OPTEV_CONSTRAINTS, inenumval,
+				  linecount);
 		      /* Mark up to the end of the tag before, so that there do
 			 not remain empty lines or other whitespace after
 			 deleting this constraint */
 		      lastconstraints = (char*)lasttagend + 1;
 		    }
-		  } else if (strcmp(currtagname, "constraint") == 0) {
+		    break;
+		  case XMLTAG_CONSTRAINT:
 		    inconstraint = nestinglevel + 1;
 		    if (+tagtype == +TAG_OPEN) {
 		      /* Delete the fields of the old constraint */
@@ -623,8 +3800,8 @@ parse(char **data, /* I/O - Data to process */
 		      cargdefault[0] = '\0';
 		      csense = 0;
 		    }
-		  } break;
-		  case 'o': if (strcmp(currtagname + 01, "option" + 01) == 0) {
+		    break;
+		  case XMLTAG_OPTION:
 		    inoption = nestinglevel + 1;
 		    /* Mark up to the end of the tag before, to insert the
 		       definition of the default option setting */
@@ -633,136 +3810,135 @@ parse(char **data, /* I/O - Data to process */
 		      /* XML body of the file is starting here */
 		      inxmlheader = 0;
 		      nestinglevel = 1;
-		      argdefault[0] = '\0';
-		      /* Remove the whole header of the XML file */
-		      if (debug) 
-			fprintf(stderr,
-				"    Removing XML file header\n");
-		      memmove(*data, lasttag, 
-			      *data + datalength + 1 - lasttag);
-		      datalength -= lasttag - *data;
-		      scan -= lasttag - *data;
-		      tagwordstart -= lasttag - *data;
-		      lasttag = *data;
+		      /* The whole header of the XML file gets removed */
+		      addoptevent(optionmodel, OPTEV_OPTION, inenumval,
+				  linecount)->to = lasttag - data;
 		      lasttagend = NULL;
 		    }
-		  } break;
-		} break; 
-		case (+PARSE_OP_OV_DRIVER): { /* Driver XML file (Overview) */
-		  if (strcmp(currtagname, "printer") == 0) {
+		    break;
+		} break;
+		case (+PARSE_OP_OV_DRIVER): /* Driver XML file (Overview) */
+		switch (currtag) {
+		  case XMLTAG_PRINTER:
 		    inprinter = nestinglevel + 1;
 		    if (+tagtype == +TAG_OPEN) {
 		      cprinter[0] = '\0';
 		      dfunctionalityentry[0] = '\0';
 		    }
-		  } else if (strcmp(currtagname, "id") == 0) {
+		    break;
+		  case XMLTAG_ID:
 		    inid = nestinglevel + 1;
-		  } else if (strcmp(currtagname, "functionality") == 0) {
+		    break;
+		  case XMLTAG_FUNCTIONALITY:
 		    indfunctionality = nestinglevel + 1;
 		    if (+tagtype == +TAG_OPEN) lastdfunctionality = (char*)lasttag;
-		  } else if (strcmp(currtagname, "execution") == 0) {
+		    break;
+		  case XMLTAG_EXECUTION:
 		    inexecution = nestinglevel + 1;
-		  } else if (strcmp(currtagname, "prototype") == 0) {
+		    break;
+		  case XMLTAG_PROTOTYPE:
 		    inprototype = nestinglevel + 1;
 		    if (+tagtype == +TAG_OPEN) lastprototype = (char*)lasttagend + 1;
-		  } else if (strcmp(currtagname, "printers") == 0) {
+		    break;
+		  case XMLTAG_PRINTERS:
 		    inprinters = nestinglevel + 1;
 		    if (+tagtype == +TAG_OPEN) lastprinters = (char*)lasttagend + 1;
-		  } else if (strcmp(currtagname, "comments") == 0) {
+		    break;
+		  case XMLTAG_COMMENTS:
 		    incomments = nestinglevel + 1;
 		    if (+tagtype == +TAG_OPEN) lastcomments = (char*)lasttagend + 1;
-		  } else if (strcmp(currtagname, "driver") == 0) {
+		    break;
+		  case XMLTAG_DRIVER:
 		    indriver = nestinglevel + 1;
 		    if (+tagtype == +TAG_OPEN) {
 		      /* XML body of the file is starting here */
 		      inxmlheader = 0;
 		      nestinglevel = 1;
 		      /* Remove the whole header of the XML file */
-		      if (debug) 
+		      if (debug)
 			fprintf(stderr,
 				"    Removing XML file header\n");
-		      memmove(*data, lasttag, 
-			      *data + datalength + 1 - lasttag);
-		      datalength -= lasttag - *data;
-		      scan -= lasttag - *data;
-		      tagwordstart -= lasttag - *data;
-		      lasttag = *data;
+		      cutspans(file, 0, lasttag - data);
 		      lasttagend = NULL;
 		    }
-		  } 
-		} break; 
-		case (+PARSE_OP_OV_PRINTER): { /* Printer XML file (Overview)*/
+		    break;
+		} break;
+		case (+PARSE_OP_OV_PRINTER): /* Printer XML file (Overview)*/
 		  if (debug)
 		    fprintf(stderr,
 			    "     Printer XML (Overview): Tag name: %s\n",
 			    currtagname);
-		  if (strcmp(currtagname, "make") == 0) {
+		switch (currtag) {
+		  case XMLTAG_MAKE:
 		    inmake = nestinglevel + 1;
-		  } else if (strcmp(currtagname, "model") == 0) {
+		    break;
+		  case XMLTAG_MODEL:
 		    inmodel = nestinglevel + 1;
-		  } else if (strcmp(currtagname, "functionality") == 0) {
+		    break;
+		  case XMLTAG_FUNCTIONALITY:
 		    infunctionality = nestinglevel + 1;
-		  } else if (strcmp(currtagname, "unverified") == 0) {
+		    break;
+		  case XMLTAG_UNVERIFIED:
 		    inunverified = nestinglevel + 1;
 		    cunverified = 1;
-		  } else if (strcmp(currtagname, "driver") == 0) {
+		    break;
+		  case XMLTAG_DRIVER:
 		    indriver = nestinglevel + 1;
 		    if (indrivers) {
 		      if (+tagtype == +TAG_OPEN) {
 			if (debug)
-			  fprintf(stderr, 
+			  fprintf(stderr,
 				  "    Resetting Driver/PPD.\n");
 			cid[0] = '\0';
 			cppd[0] = '\0';
 		      }
 		    }
-		  } else if (strcmp(currtagname, "drivers") == 0) {
+		    break;
+		  case XMLTAG_DRIVERS:
 		    indrivers = nestinglevel + 1;
-		  } else if (strcmp(currtagname, "id") == 0) {
+		    break;
+		  case XMLTAG_ID:
 		    inid = nestinglevel + 1;
-		  } else if (strcmp(currtagname, "ppd") == 0) {
+		    break;
+		  case XMLTAG_PPD:
 		    inppd = nestinglevel + 1;
-		  } else if (strcmp(currtagname, "lang") == 0) {
+		    break;
+		  case XMLTAG_LANG:
 		    inlang = nestinglevel + 1;
-		  } else if (strcmp(currtagname, "postscript") == 0) {
+		    break;
+		  case XMLTAG_POSTSCRIPT:
 		    inpostscript = nestinglevel + 1;
 		    if (inlang) {
 		      if (+tagtype == +TAG_OPEN) {
 			if (debug)
-			  fprintf(stderr, 
+			  fprintf(stderr,
 				  "    Resetting Driver/PPD.\n");
 			cid[0] = '\0';
 			cppd[0] = '\0';
 		      }
 		    }
-		  } else if (strcmp(currtagname, "autodetect") == 0) {
+		    break;
+		  case XMLTAG_AUTODETECT:
 		    inautodetect = nestinglevel + 1;
 		    if (+tagtype == +TAG_OPEN) lastautodetect = (char*)lasttag;
-		  } else if (strcmp(currtagname, "printer") == 0) {
+		    break;
+		  case XMLTAG_PRINTER:
 		    inprinter = nestinglevel + 1;
 		    if (+tagtype == +TAG_OPEN) {
 		      /* XML body of the file is starting here */
 		      inxmlheader = 0;
 		      nestinglevel = 1;
-		      /* Remove the whole header of the XML file */
-		      if (debug) 
-			fprintf(stderr,
-				"    Removing XML file header\n");
-		      memmove(*data, lasttag, 
-			      *data + datalength + 1 - lasttag);
-		      datalength -= lasttag - *data;
-		      scan -= lasttag - *data;
-		      tagwordstart -= lasttag - *data;
-		      lasttag = *data;
+		      /* The XML file header is not removed here, the output
+			 gets replaced by the overview entry at the end */
 		      lasttagend = NULL;
-		      if (debug) fprintf(stderr, 
+		      if (debug) fprintf(stderr,
 					 "    Initializing PPD list.\n");
 		      while(ppdlist != NULL) {
 			ppdlistpointer = ppdlist;
 			ppdlist = (ppdlist_t *)ppdlist->next;
 			free(ppdlistpointer);
 		      }
-		      if (debug) fprintf(stderr, 
+		      if (debug) fprintf(stderr,
 					 "    Initializing fields.\n");
 		      cprinter[0] = '\0';
 		      cmake[0] = '\0';
@@ -772,16 +3948,16 @@ parse(char **data, /* I/O - Data to process */
 		      cdriver[0] = '\0';
 		      cautodetectentry[0] = '\0';
 		    }
-		  }
+		    break;
 		} break; }
 	      } else { /* additional word = parameter */
-		memmove(currtagparam, tagwordstart, scan - tagwordstart);
-		currtagparam[scan - tagwordstart] = '\0';
+		currtagparam = parsercopy(parser, PB_TAGPARAM, tagwordstart,
+					  scan - tagwordstart);
 		if (debug) fprintf(stderr, 
 				   "    Tag parameter: '%s'\n",
 				   currtagparam); 
 		if (+operation == +PARSE_OP_OPTION) { /* Option XML file */
-		  if (strcmp(currtagname, "constraint") == 0) {
+		  if (currtag == XMLTAG_CONSTRAINT) {
 		    /* Set the sense of the constraint */
 		    if ((s = strstr(currtagparam, "sense")) != NULL) {
 		      if (strstr(s + 5, "true") != NULL) {
@@ -790,41 +3966,43 @@ parse(char **data, /* I/O - Data to process */
 			csense = 0;
 		      }
 		    }
-		  } else if (strcmp(currtagname, "option") == 0) {
+		  } else if (currtag == XMLTAG_OPTION) {
 		    if ((s = strstr(currtagparam, "type")) != NULL) {
 		      if (strstr(s + 4, "enum") != NULL) {
 			/* Set the number of qualified enum values to 0 */
 			/* If this value stays 0 we have no enum values */
 			/* and the option disqualifies */
-			numenumvals = 0;
-			optiontype = +OPTION_TYPE_ENUM;
+			optionmodel->numenumvals = 0;
+			optionmodel->optiontype = +OPTION_TYPE_ENUM;
 		      } else if (strstr(s + 4, "bool") != NULL) {
-			optiontype = +OPTION_TYPE_BOOL;
+			optionmodel->optiontype = +OPTION_TYPE_BOOL;
 		      } else if (strstr(s + 4, "int") != NULL) {
-			optiontype = +OPTION_TYPE_INT;
+			optionmodel->optiontype = +OPTION_TYPE_INT;
 		      } else if (strstr(s + 4, "float") != NULL) {
-			optiontype = +OPTION_TYPE_FLOAT;
+			optionmodel->optiontype = +OPTION_TYPE_FLOAT;
 		      }
 		    }
-		  } else if (strcmp(currtagname, "enum_val") == 0) {
+		  } else if (currtag == XMLTAG_ENUM_VAL) {
 		    if ((s = strstr(currtagparam, "id")) != NULL) {
 		      /* Extract the ID of this enum value */
-		      strcpy(currevid, s + 4);
-		      currevid[strlen(currevid) - 1] = '\0';
+		      currevid = parsercopy(parser, PB_EVID, s + 4,
+					    strlen(s + 4) - 1);
 		      if (debug)
 			fprintf(stderr, 
 				"    Enum value ID: '%s'\n",
 				currevid);
+		      addoptevent(optionmodel, OPTEV_ENUM_VAL_ID, inenumval,
+				  linecount)->text = eventstring(currevid);
 		    }
 		  }
 		} else if (+operation == +PARSE_OP_OV_DRIVER) { /* Driver XML file (Overview) */
-		  if (strcmp(currtagname, "driver") == 0) {
+		  if (currtag == XMLTAG_DRIVER) {
 		    if ((s = strstr(currtagparam, "id")) != NULL) {
 		      /* Get the short driver name (w/o "driver/") */
 		      s = strstr(s + 2, "driver/") + 7;
 		      /* Cut off trailing '"' */
 		      s[strlen(s)-1] = '\0';
-		      strcpy(cdriver, s);
+		      cdriver = parsercopy(parser, PB_DRIVER, s, strlen(s));
 		    }
 		  }
 		} else if (+operation == +PARSE_OP_OV_PRINTER) { /* Printer XML file (Overview) */
@@ -832,14 +4010,15 @@ parse(char **data, /* I/O - Data to process */
 		    fprintf(stderr, 
 			    "    Printer XML file (overview): Tag name: %s, Tag param:%s\n", 
 			    currtagname, currtagparam);
-		  if (strcmp(currtagname, "printer") == 0) {
+		  if (currtag == XMLTAG_PRINTER) {
 		    if ((s = strstr(currtagparam, "id")) != NULL) {
                       /* Get the short printer name (w/o "printer/") */
                       if ((s = strstr(s + 2, "printer/")) != NULL) {
                           s += 8;
                           /* Cut off trailing '"' */
                           s[strlen(s)-1] = '\0';
-                          strcpy(cprinter, s);
+                          cprinter = parsercopy(parser, PB_PRINTER, s,
+						strlen(s));
                       }
 		    }
 		  }
@@ -871,11 +4050,13 @@ parse(char **data, /* I/O - Data to process */
 	      if (!inxmlheader && (tagnamefound == 0)) {
 		fprintf(stderr, "XML error: Tag without name %s, line %d!\n",
 			filename, linecount);
-		exit(1);
+		freeppdlist(ppdlist);
+		free(entry);
+		return -1;
 	      }
 	      if (lasttagend != NULL) {
-		memmove(currtagbody, lasttagend + 1, lasttag - lasttagend - 1);
-		currtagbody[lasttag - lasttagend - 1] = '\0';
+		currtagbody = parsercopy(parser, PB_TAGBODY, lasttagend + 1,
+					 lasttag - lasttagend - 1);
 		if (debug)
 		  fprintf(stderr,
 			  "    Contents of tag body: '%s'\n", currtagbody);
@@ -889,12 +4070,16 @@ parse(char **data, /* I/O - Data to process */
 		if (nestinglevel < inmake) /* ?OVER_IN_MAKE Y */ { /* Found printer manufacturer */
 		  inmake = 0;
 		  /* Only the <make> outside the <autodetect> tag is valid. */
-		  if (!inautodetect) strcat(make, currtagbody);
+		  if (!inautodetect)
+		    appendprinter(&(parser->printermake), &(parser->sizemake),
+				  currtagbody);
 		} /* ?OVER_IN_MAKE */ 
 		if (nestinglevel < inmodel) /* ?OVER_IN_MODEL Y */ { /* Found printer model */
 		  inmodel = 0;
 		  /* Only the <model> outside the <autodetect> tag is valid. */
-		  if (!inautodetect) strcat(model, currtagbody);
+		  if (!inautodetect)
+		    appendprinter(&(parser->printermodel),
+				  &(parser->sizemodel), currtagbody);
 		} /* ?OVER_IN_MODEL */ 
 		if (nestinglevel < inautodetect) inautodetect = 0;
 		if (nestinglevel < indrivers) indrivers = 0;
@@ -920,10 +4105,12 @@ parse(char **data, /* I/O - Data to process */
 		    } /* ?HAVE_CID */ 
 		  } /* ?IN_DRIVERS */ 
 		} /* ?OVER_IN_DRIVER */
-		if (cppd[0]) strcpy(cid, "Postscript");
+		if (cppd[0])
+		  cid = parsercopy(parser, PB_ID, "Postscript", 10);
 		if (nestinglevel < inid) /* ?OVER_IN_ID Y */ {
 		  inid = 0;
-		  strcpy(cid, currtagbody);
+		  cid = parsercopy(parser, PB_ID, currtagbody,
+				   strlen(currtagbody));
 		  if (debug) fprintf(stderr, 
 				     "    Printer XML: Driver ID: %s\n", cid);
 		} /* ?OVER_IN_ID */
@@ -951,7 +4138,7 @@ parse(char **data, /* I/O - Data to process */
 		  for (s = currtagbody;
 		       (*s != '\0') && (strchr(" \n\r\t", *s) != NULL);
 		       s ++);
-		  strcpy(cppd, s);
+		  cppd = parsercopy(parser, PB_PPD, s, strlen(s));
 		  if (debug) fprintf(stderr, 
 				     "    PPD URL: %s\n", cppd);
 		} /* ?OVER_IN_PPD */ 
@@ -963,63 +4150,35 @@ parse(char **data, /* I/O - Data to process */
 		if (nestinglevel < indriver) indriver = 0;
 		if (nestinglevel < inprinters) /* ?OVER_IN_PRINTERS Y */ {
 		  inprinters = 0;
-		  /* Remove the whole <printers> block */
+		  /* The whole <printers> block gets replaced by the
+		     printer's entries */
+		  drvevent = adddrvevent(drivermodel, DRVEV_PRINTERS_END);
 		  if (lastprinters != NULL) /* ?LAST_PRINTERS Y */ {
-		    if (debug) 
-		      fprintf(stderr, "    Removing <printers> block\n");
-		    memmove(lastprinters, scan + 1, 
-			    *data + datalength - scan);
-		    datalength -= scan + 1 - lastprinters;
-		    scan = lastprinters - 1;
-		    if (debug) 
-		      fprintf(stderr, "    Inserting saved printer\n");
-		    l = strlen(printerentry);
-		    if (l != 0) /* ?PRINTER_ENTRY Y */ {
-		      memmove(lastprinters + l, lastprinters, 
-			      *data + datalength - lastprinters + 1);
-		      memmove(lastprinters, printerentry, l);
-		      datalength += l;
-		      scan += l;
-		    } /* ?PRINTER_ENTRY */ 
+		    drvevent->from = lastprinters - data;
+		    drvevent->to = scan + 1 - data;
 		  } /* ?LAST_PRINTERS */
 		} /* ?OVER_IN_PRINTERS */
 		if (nestinglevel < inprinter) /* ?OVER_IN_PRINTER Y */ {
 		  inprinter = 0;
-		  if (printertobesaved) /* ?PRINTER_TO_BE_SAVED Y */ {
-		    /* Save the printer entry in a buffer to reinsert it
-		       after deleting the <printers> block */
-		    printertobesaved = 0;
-		    if (lastprinter != NULL) /* ?LAST_PRINTER Y */ {
-		      if (debug) fprintf(stderr, "    Saving printer\n");
-		      strcat(printerentry,"\n <printers>\n  ");
-		      l = strlen(printerentry);
-		      memmove(printerentry + l, lastprinter,
-			      scan + 1 - lastprinter);
-		      printerentry[l + scan + 1 - lastprinter] = '\0';
-		      strcat(printerentry,"\n </printers>");
-		      if (debug) fprintf(stderr, "    Printer entry %s\n",
-					 printerentry);
-		    } /* ?LAST_PRINTER */
-		  } /* ?PRINTER_TO_BE_SAVED */
+		  /* The printer entry gets saved if it is the printer's */
+		  drvevent = adddrvevent(drivermodel, DRVEV_PRINTER_END);
+		  if (lastprinter != NULL) /* ?LAST_PRINTER Y */ {
+		    drvevent->from = lastprinter - data;
+		    drvevent->to = scan + 1 - data;
+		  } /* ?LAST_PRINTER */
 		} /* ?OVER_IN_PRINTER */
 		if (nestinglevel < inid) /* ?OVER_IN_ID Y */ {
 		  inid = 0;
 		  /* printer ID after the "printer/" in currtagbody is 
 		     used (to not compare the always equal "printer/" */
-		  if (strcmp(trpid, 
-			     translateid(currtagbody + 8, idlist)) == 0) /* ?FOUND_PRINTER_IN_DRIVER Y */ {
-		    /* Found printer entry in driver file */
-		    printerentryfound = 1;
-		    printertobesaved = 1;
-		    if (debug) fprintf(stderr, "    Found printer\n");
-		  } else /* ?FOUND_PRINTER_IN_DRIVER N */ {
-		    if (debug) fprintf(stderr, "    Other printer\n");
-		  }  /* ?FOUND_PRINTER_IN_DRIVER */
+		  adddrvevent(drivermodel, DRVEV_ID)->id =
+		    eventstring(strlen(currtagbody) >= 8 ?
+				translateid(currtagbody + 8, idlist) : "");
 		} /* ?OVER_IN_ID Y */
 	      } else  /* ?PARSE_OP_DRIVER N */ 
 	      if (+operation == +PARSE_OP_OPTION) /* ?PARSE_OP_OPTION Y */ 
 	      { /* Option XML file */
-		if ((debug) && (strcmp(currtagname, "constraint") == 0) &&
+		if ((debug) && (currtag == XMLTAG_CONSTRAINT) &&
 		    (tagtype == +TAG_CLOSE)) /* ?CLOSE_CONSTRAINT Y */ {
 		  j++;
 		  fprintf(stderr, "    Constraint %d: %s\n", j, filename);
@@ -1027,142 +4186,35 @@ parse(char **data, /* I/O - Data to process */
 		if (nestinglevel < inen) /* ?OVER_IN_EN Y */ {
 		  inen = 0;
 		  if (inargshortname) /* ?IN_ARG_SHORT_NAME Y */ {
-		    /* We have the short name of the option, check whether
-		       the user has defined a default value for it */
+		    /* We have the short name of the option, the user can
+		       have defined a default value for it */
 		    if (debug)
 		      fprintf
 			(stderr, "    Option short name: '%s'\n",
 			 currtagbody);
-		    for (k = 0; k < num_defaultsettings; k ++) /* @DEFAULT_SETTINGS */ 
-		    {
-		      if ((strstr(defaultsettings[k], currtagbody) == 
-			   defaultsettings[k]) && 
-			  (*(defaultsettings[k] + strlen(currtagbody))
-			   == '=')) /* ?FOUND_DEFAULT_SETTING Y */ {
-			s = (char *)(defaultsettings[k] +
-				     strlen(currtagbody) + 1);
-			userdefault = 1;
-			switch (+optiontype)  /* *OPTION_TYPE */ {
-			case (+OPTION_TYPE_BOOL): {
-			  /* Boolean options */
-			  if ((strcasecmp(s, "true") == 0) ||
-			      (strcasecmp(s, "yes") == 0) ||
-			      (strcasecmp(s, "on") == 0)) 
-			    /* "True" */
-			    s = "1";
-			  else if ((strcasecmp(s, "false") == 0) ||
-				     (strcasecmp(s, "no") == 0) ||
-				     (strcasecmp(s, "off") == 0)) 
-			    /* "False" */
-			    s = "0";
-			  else if ((strcasecmp(s, "0") != 0) &&
-				     (strcasecmp(s, "1") != 0)) 
-			    /* No valid value for a bool option */
-			    userdefault = 0;
-			} break;
-			case (+OPTION_TYPE_INT): {
-			  /* Integer options */
-			  if (strspn(s, "+-0123456789") < strlen(s)) 
-			    userdefault = 0;
-			} break;
-			case (+OPTION_TYPE_FLOAT): {
-			  /* Float options */
-			  if (strspn(s, "+-0123456789.eE") < strlen(s)) 
-			    userdefault = 0;
-			} break; } /* *OPTION_TYPE X */ 
-			strcpy(userdefaultvalue, s);
-			if ((debug) && (userdefault))
-			  fprintf
-			    (stderr,
-			     "      User default setting: '%s'\n",
-			     userdefaultvalue);
-		      } else /* ?FOUND_DEFAULT_SETTING N */
-		      if ((strcmp(defaultsettings[k], currtagbody) ==
-				  0) && (+optiontype == +OPTION_TYPE_BOOL)) 
-				  /* ?DEFAULT_TRUE Y */ {
-			/* "True" for boolean options */
-			strcpy(userdefaultvalue, "1");
-			userdefault = 1;
-			if (debug)
-			  fprintf
-			    (stderr,
-			     "      User default setting: '%s'\n",
-			     userdefaultvalue);
-		      } else /* ?DEFAULT_TRUE N */ 
-		      if ((strcmp(defaultsettings[k] + 2,currtagbody)
-				  == 0) &&
-				 (strncasecmp(defaultsettings[k], "no", 2)
-				  == 0) && (+optiontype == +OPTION_TYPE_BOOL)) 
-				  /* ?DEFAULT_FALSE Y */ {
-			/* "False" for boolean options */
-			strcpy(userdefaultvalue, "0");
-			userdefault = 1;
-			if (debug)
-			  fprintf
-			    (stderr,
-			     "      User default setting: '%s'\n",
-			     userdefaultvalue);
-		      } /* ?DEFAULT_FALSE ?DEFAULT_TRUE ?FOUND_DEFAULT_SETTING */
-		    } /* @DEFAULT_SETTINGS X */
+		    addoptevent(optionmodel, OPTEV_SHORTNAME, inenumval,
+				linecount)->text = eventstring(currtagbody);
 		  } else  /* ?IN_ARG_SHORT_NAME N */ 
 		  if (inevshortname) /* ?IN_EV_SHORT_NAME Y */ {
-		    /* We have the short name of the enum value, check
-		       whether the user chose this value as default,
-		       extract the enum value ID then and mark the user's
-		       default value as found */
+		    /* We have the short name of the enum value, the user
+		       can have chosen it as default */
 		    if (debug)
 		      fprintf
 			(stderr, "    Enum value short name: '%s'\n",
 			 currtagbody);
-		    if ((userdefault) &&
-			(strcmp(userdefaultvalue, currtagbody) == 0)) 
-			/* ?DEFAULT_IN_TAG_BODY Y */ {
-		      strcpy(userdefaultid, currevid);
-		      userdefaultfound = 1;
-		      if (debug)
-			fprintf
-			  (stderr,
-			   "      User default setting found!\n");
-		    } /* ?DEFAULT_IN_TAG_BODY Y */
+		    addoptevent(optionmodel, OPTEV_EV_SHORTNAME, inenumval,
+				linecount)->text = eventstring(currtagbody);
 		  } /* ?IN_EV_SHORT_NAME ?IN_ARG_SHORT_NAME */
 		} /* ?OVER_IN_EN */
 		if (nestinglevel < inargmax) /* ?OVER_IN_ARG_MAX Y */ {
 		  inargmax = 0;
-		  if 
-((optiontype == +OPTION_TYPE_INT) 
-|| (+optiontype == +OPTION_TYPE_FLOAT)) /* ?OPTION_NUMERIC Y */ {
-		    maxnumvalue = atof(currtagbody);
-		    if (userdefault &&
-		      /* Range-check user default and make it invalid if
-			 necessary */
-		      +atof(userdefaultvalue) > +maxnumvalue) 
-			userdefault = 0;
-		    if (debug)
-		      fprintf
-			(stderr,
-			 "    Maximum value: %s\n",
-			 currtagbody);
-		  } /* ?OPTION_NUMERIC */
+		  addoptevent(optionmodel, OPTEV_ARG_MAX, inenumval,
+			      linecount)->text = eventstring(currtagbody);
 		} /* ?OVER_IN_ARG_MAX */
 		if (nestinglevel < inargmin) /* ?OVER_IN_ARG_MIN Y */ {
 		  inargmin = 0;
-		  if 
-((+optiontype == +OPTION_TYPE_INT) 
-|| (+optiontype == +OPTION_TYPE_FLOAT)) /* ?OPTION_NUMERIC Y */ {
-		    minnumvalue = atof(currtagbody);
-		    if (userdefault) /* ?USER_DEFAULT Y */ {
-		      /* Range-check user default and make it invalid if
-			 necessary */
-		      if (atof(userdefaultvalue) < minnumvalue) {
-			userdefault = 0;
-		      }
-		    } /* ?USER_DEFAULT */
-		    if (debug)
-		      fprintf
-			(stderr,
-			 "    Minimum value: %s\n",
-			 currtagbody);
-		  } /* ?OPTION_NUMERIC */
+		  addoptevent(optionmodel, OPTEV_ARG_MIN, inenumval,
+			      linecount)->text = eventstring(currtagbody);
 		} /* ?OVER_IN_ARG_MIN */
 		if (nestinglevel < inargshortname) {
 		  inargshortname = 0;
@@ -1181,274 +4233,92 @@ parse(char **data, /* I/O - Data to process */
 		  if (inconstraint) /* ?IN_CONSTRAINT Y */ {
 		    /* Make always short printer IDs (w/o "printer/") */
 		    if (currtagbody[0] == 'p') {
-		      strcat(cprinter, currtagbody + 8);
+		      cprinter = parserappend(parser, PB_PRINTER,
+					      currtagbody + 8);
 		    } else {
-		      strcat(cprinter, currtagbody);
+		      cprinter = parserappend(parser, PB_PRINTER, currtagbody);
 		    }
 		  } /* ?IN_CONSTRAINT */
 		} /* ?OVER_IN_PRINTER */
 		if (nestinglevel < inmake) /* ?OVER_IN_MAKE Y */ {
 		  inmake = 0;
-		  if (inconstraint) strcat(cmake, currtagbody);
+		  if (inconstraint)
+		    cmake = parserappend(parser, PB_MAKE, currtagbody);
 		} /* ?OVER_IN_MAKE */
 		if (nestinglevel < inmodel) /* ?OVER_IN_MODEL Y */ {
 		  inmodel = 0;
-		  if (inconstraint) strcat(cmodel, currtagbody);
+		  if (inconstraint)
+		    cmodel = parserappend(parser, PB_MODEL, currtagbody);
 		} /* ?OVER_IN_MODEL */
 		if (nestinglevel < indriver) /* ?OVER_IN_DRIVER Y */ {
 		  indriver = 0;
-		  if (inconstraint) strcat(cdriver, currtagbody);
+		  if (inconstraint)
+		    cdriver = parserappend(parser, PB_DRIVER, currtagbody);
 		} /* ?OVER_IN_DRIVER */
 		if (nestinglevel < inargdefault) /* ?OVER_IN_ARG_DEFAULT Y */ {
 		  inargdefault = 0;
-		  if (inconstraint) strcat(cargdefault, currtagbody);
+		  if (inconstraint)
+		    cargdefault = parserappend(parser, PB_ARGDEFAULT,
+					       currtagbody);
 		} /* ?OVER_IN_ARG_DEFAULT */
 		if (nestinglevel < inconstraint) /* ?OVER_IN_CONSTRAINT Y */ {
 		  inconstraint = 0;
-		  /* Constraint completely read, here we evaluate it */
+		  /* Constraint completely read, it gets evaluated for the
+		     combo by evaloption() */
 		  if (debug) /* ?DEBUG Y */ {
-		    fprintf(stderr,"    Evaluation of constraint\n");
-		    fprintf(stderr,"      Values given in constraint:\n");
-		    fprintf(stderr,"        make: |%s|, model: |%s|, printer: |%s|\n",
+		    fprintf(stderr,"    Values given in constraint:\n");
+		    fprintf(stderr,"      make: |%s|, model: |%s|, printer: |%s|\n",
 			    cmake, cmodel, cprinter);
-		    fprintf(stderr,"        driver: |%s|, argdefault: |%s|, sense: |%d|\n",
+		    fprintf(stderr,"      driver: |%s|, argdefault: |%s|, sense: |%d|\n",
 			    cdriver, cargdefault, csense);
-		    fprintf(stderr,"      Values of current printer/driver combo:\n");
-		    fprintf(stderr,"        make: |%s|, model: |%s|\n",
-			    make, model);
-		    fprintf(stderr,"        PID: |%s|, driver: |%s|\n",
-			    pid, driver);
 		  } /* ?DEBUG */
-		  if (!((cmake[0]) || (cmodel[0]) || 
-			(cprinter[0]) || (cdriver[0]))) /* ?NULL_CONSTRAINT Y */ {
-		    fprintf(stderr, "WARNING: Illegal null constraint in %s, line %d!\n",
-			    filename, linecount);
-		  } else  /* ?NULL_CONSTRAINT N */ 
-		  if (((cmake[0]) || (cmodel[0])) && (cprinter[0])) 
-		  /* ?PRINTER_AND_MAKE Y */ {
-		    fprintf(stderr, "WARNING: Both printer id and make/model in constraint in %s, line %d!\n",
-			    filename, linecount);
-		  } else /* ?PRINTER_AND_MAKE N */ {
-		    if (debug) 
-		      fprintf(stderr,
-			      "      Highest scores for printer: |%d|, driver: |%d|\n",
-			      printerhiscore, driverhiscore);
-                    /* if make matches, printerscore match grade 1 */
-                    /* if model matches, printerscore match grade 2 */
-                    /* no information, printerscore = 0 */
-		    /* mismatch, printerscore = -1 */
-		    printerscore = 0;
-		    /* driverscore: -1 = mismatch, 1 = match, 0 = no info */
-		    driverscore = 0;
-		    /* The per-printer constraining can happen by poid or by
-		       a make[/model] pair */
-		    if (cprinter[0]) /* ?HAVE_PRINTER Y */ {
-		      if (debug) fprintf(stderr,"        Checking PID\n");
-		      if (strcmp(translateid(cprinter, idlist), trpid) == 0)
-			printerscore = 2;
-		      else
-			printerscore = -1;
-		    } else /* ?HAVE_PRINTER N */ if (cmake[0]) /* ?HAVE_MAKE Y */ {
-		      if (debug) fprintf(stderr,"        Checking make\n");
-		      /* We have a requested make, so it can't be zero.
-			 You can't request or constraint by model only! */
-		      if (strcmp(cmake, make) == 0) /* ?GOT_MAKE Y */ {
-			printerscore = 1; /* make matches */
-			if (cmodel[0]) /* ?HAVE_MODEL Y */ {
-			  if (debug)
-			    fprintf(stderr,"        Checking model\n");
-			  if (strcmp(cmodel, model) == 0)
-			    printerscore = 2; /* model matches, too */
-			  else
-			    printerscore = -1; /* model mismatch */
-			} /* ?HAVE_MODEL */
-		      } else /* ?GOT_MAKE N */ printerscore = -1; /* make mismatch */ 
-		      /* ?GOT_MAKE */
-		    }  /* ?HAVE_MAKE  ?HAVE_PRINTER */
-		    /* Is a driver requested? */
-		    if (cdriver[0]) /* ?HAVE_DRIVER Y */ {
-		      if (debug) 
-			fprintf(stderr,"        Checking driver\n");
-		      if ((strcmp(cdriver, driver) == 0) ||
-			  (strcmp(cdriver + 7, driver) == 0)) 
-			driverscore = 1; /* driver matches */
-		      else
-			driverscore = -1; /* driver mismatch */
-		    } /* ?HAVE_DRIVER */
-		    if (debug)
-		      fprintf(stderr,
-			      "      Scores for this constraint: printer: |%d|, driver: |%d|\n",
-			      printerscore, driverscore);
-		    /* Now compare the scores with the ones of the currently
-		       best-matching constraint */
-		    /* Any sort of match? */
-		    if (((printerscore > 0) || (driverscore > 0)) &&
-			((printerscore > -1) && (driverscore > -1))) /* ?GOT_MATCH Y */ {
-		      if (debug) fprintf(stderr,
-					 "      Something matches\n");
-		      /* Does this beat the best match to date? */
-		      if (((printerscore >= printerhiscore) &&
-			   (driverscore >= driverhiscore)) ||
-			  /* They're equal or better in both categories */
-			  (printerscore == 2)) /* ?BEST_PRINTER_DRIVER Y */ {
-			  /* A specific printer always wins */
-			if (debug)
-			  fprintf(stderr,"      This constraint wins\n");
-			/* Set the high scores */
-			if (printerscore > printerhiscore) {
-			  printerhiscore = printerscore;
-			}
-			if (driverscore > driverhiscore) {
-			  driverhiscore = driverscore;
-			}
-			/* Constraint applies */
-			if (inenumval) /* ?IN_ENUM_VAL Y */ {
-			  /* The winning constraint determines with its
-			     sense whether the option/the enum value
-			     qualifies for our printer/driver combo */
-			  enumvalqualified = csense;
-			  if (debug) 
-			    fprintf(stderr,
-				    "      Enumeration choice qualifies? %d (0: No, 1: Yes)\n",
-				    enumvalqualified);
-			} else /* ?IN_ENUM_VAL N */ {
-			  optionqualified = csense;
-			  if (debug) 
-			    fprintf(stderr,
-				    "      Option qualifies? %d (0: No, 1: Yes)\n",
-				    optionqualified);
-			  /* The winning constraint for the option
-			     determines the default setting for this
-			     option */
-			  strcpy(argdefault, cargdefault);
-			} /* ?IN_ENUM_VAL */
-		      } /* ?BEST_PRINTER_DRIVER */
-		    } /* ?GOT_MATCH */
-		  } /* ?PRINTER_AND_MAKE ?NULL_CONSTRAINT */
+		  event = addoptevent(optionmodel, OPTEV_CONSTRAINT, inenumval,
+				      linecount);
+		  event->sense = csense;
+		  event->printer = eventstring(cprinter);
+		  event->make = eventstring(cmake);
+		  event->model = eventstring(cmodel);
+		  event->driver = eventstring(cdriver);
+		  event->argdefault = eventstring(cargdefault);
 		}
 		if (nestinglevel < inconstraints) /* ?OVER_IN_CONSTRAINTS Y */ {
 		  inconstraints = 0;
-		  /* End of <constraints> block, did the option/the enum
-		     value qualify for our printer/driver combo? */
-		  if (inenumval) /* ?IN_ENUM_VAL Y */ {
-		    if (debug)
-		      fprintf(stderr,
-			      "    This enumeration value finally qualified? %d (0: No, 1: Yes)\n",
-			      enumvalqualified);
-		    if (!enumvalqualified) enumvaltoberemoved = 1;
-		  } else  /* ?IN_ENUM_VAL N */ {
-		    if (debug)
-		      fprintf(stderr,
-			      "    This option finally qualified?  %d (0: No, 1: Yes)\n",
-			      optionqualified);
-		    if (!optionqualified) /* ?OPTION_QUALIFIED Y */ {
-		      /* We have reached the end of the <constraints> block
-			 for this option, and the option's constraints 
-			 didn't qualify the option for our printer/driver
-			 combo =>
-			 remove this option file from memory and return. */
-		      free((void *)(*data));
-		      *data = NULL;
-		      if (debug)
-			fprintf(stderr, "    Option does not apply!\n");
-		      return +comboconfirmed;
-		    } /* ?OPTION_QUALIFIED */
-		  } /* ?IN_ENUM_VAL */
-		  if (debug)
-		    fprintf(stderr,
-			    "    Constr. for enum. value? %d, enum value disqualified? %d (0: No, 1: Yes)\n",
-			    inenumval, enumvaltoberemoved);
-		  if ((!inenumval) || (!enumvaltoberemoved)) /* ?REMOVE_CONSTRAINTS Y */ {
-		    /* Remove the read <constraints> block, it will not
-		       appear in the output, but don't remove it if the
-		       current enum value will be removed anyway */
-		    if (lastconstraints != NULL) /* ?LAST_CONSTRAINTS Y */ {
-		      if (debug)
-			fprintf(stderr, "    Removing constraints block\n");
-		      memmove(lastconstraints, scan + 1, 
-			      *data + datalength - scan);
-		      datalength -= scan + 1 - lastconstraints;
-		      scan = lastconstraints - 1;
-		    } else /* ?LAST_CONSTRAINTS N */ {
-		      if (debug)
-			fprintf(stderr, "    This enum value will be removed anyway, so constraints block does not  \n    need to be removed.\n");
-		    } /* ?LAST_CONSTRAINTS */
-		  } /* ?REMOVE_CONSTRAINTS */ 
+		  /* End of <constraints> block, the block is removed from
+		     the output */
+		  event = addoptevent(optionmodel, OPTEV_CONSTRAINTS_END,
+				      inenumval, linecount);
+		  if (lastconstraints != NULL)
+		    event->from = lastconstraints - data;
+		  event->to = scan + 1 - data;
+		  if ((pid) && (!inenumval) &&
+		      (!evaloption(optionmodel, &nooutput, pid, driver,
+				   parser->printermake, parser->printermodel,
+				   filename, defaultsettings,
+				   num_defaultsettings, *nopjl, idlist, 0))) {
+		    /* The option does not apply to the given combo, no
+		       need to read on */
+		    optionmodel->partial = 1;
+		    return +comboconfirmed;
+		  }
 		} /* ?OVER_IN_CONSTRAINTS */
 		if (nestinglevel < inenumval) /* ?OVER_IN_ENUM_VAL Y */ {
 		  inenumval = 0;
-		  if (debug) 
-		    fprintf(stderr,
-			    "    End of enumeration value block, to be removed? %d (0: No, 1: Yes)\n",
-			    enumvaltoberemoved);
-		  if (enumvaltoberemoved) /* ?ENUM_VAL_TO_BE_REMOVED Y */ {
-		    /* This enum value does not apply to our printer/driver
-		       combo, remove it */
-		    if (lastenumval != NULL) /* ?LAST_ENUM_VAL Y */ {
-		      if (debug) fprintf(stderr, "    Removing enumeration value\n");
-		      memmove(lastenumval, scan + 1, 
-			      *data + datalength - scan);
-		      datalength -= scan + 1 - lastenumval;
-		      scan = lastenumval - 1;
-		    } else  /* ?LAST_ENUM_VAL N */ {
-		      fprintf (stderr, "    Cannot remove this evaluation value.\n");
-		    }  /* ?LAST_ENUM_VAL */
-		  } else /* ?ENUM_VAL_TO_BE_REMOVED N */ 
-		    /* This enum value applies to our printer/driver combo */
-		    numenumvals++;
-		} /* ?ENUM_VAL_TO_BE_REMOVED */
+		  /* End of enumeration value block, it is removed if it
+		     does not apply to the combo */
+		  event = addoptevent(optionmodel, OPTEV_ENUM_VAL_END,
+				      inenumval, linecount);
+		  if (lastenumval != NULL)
+		    event->from = lastenumval - data;
+		  event->to = scan + 1 - data;
+		} /* ?OVER_IN_ENUM_VAL */
 		if (nestinglevel < inoption) /* ?OVER_IN_OPTION Y */ {
 		  inoption = 0;
-		  if (debug)
-		    fprintf(stderr,
-			    "End of option block:\n      No. of enum. values: %d, qualified by constraints? %d (0: No, 1: Yes)\n",
-			    numenumvals, optionqualified);
-		  if ((!numenumvals) || (!optionqualified)) /* ?NO_VALUES_APPLY Y */ {
-		    /* We have reached the end of the option file, but there
-                       are no enum values which qualified for our combo
-		       or there were no constraints at all =>
-		       remove this option file from memory and return. */
-		    free((void *)(*data));
-		    *data = NULL;
-		    if (debug) fprintf (stderr, "    No enum. values, no constraints => Removing option!\n");
-		    return +comboconfirmed;
-		  } /* ?NO_VALUES_APPLY */
-		  /* Insert the line determining the default setting */
-		  if ((argdefault[0]) || (userdefault)) {
-		    if (lastoption != NULL) {
-		      if (debug) 
-			fprintf(stderr, 
-				"    Inserting default value\n");
-		      if (userdefault) {
-			/* There is a user-defined default setting */
-			if ((+optiontype == +OPTION_TYPE_ENUM)) {
-			  /* enumerated option */
-			  if (userdefaultfound) {
-			    strcpy(argdefault, userdefaultid);
-			  }
-			} else {
-			  /* Boolean or numerical option */
-				assert 
-(+optiontype == +OPTION_TYPE_BOOL || +optiontype == +OPTION_TYPE_INT 
-			  || +optiontype == +OPTION_TYPE_FLOAT);
-			  strcpy(argdefault, userdefaultvalue);
-			}  
-		      }
-		      sprintf(defaultline,
-			      "\n  <arg_defval>%s</arg_defval>",
-			      argdefault);
-		      defaultlinelength = strlen(defaultline);
-		      memmove(lastoption + defaultlinelength, lastoption, 
-			      *data + datalength - lastoption + 1);
-		      memmove(lastoption, defaultline, defaultlinelength);
-		      datalength += defaultlinelength;
-		      scan += defaultlinelength;
-		      if (debug) 
-			fprintf(stderr,
-				"      Default value line: %s\n",
-				defaultline);
-		    }
-		  }
+		  /* End of the option, the default setting gets inserted
+		     here */
+		  event = addoptevent(optionmodel, OPTEV_OPTION_END,
+				      inenumval, linecount);
+		  if (lastoption != NULL)
+		    event->to = lastoption - data;
 		}
 	      } else if (+operation == +PARSE_OP_OV_DRIVER) 
 	      { /* Driver XML file (Overview) */
@@ -1459,10 +4329,7 @@ parse(char **data, /* I/O - Data to process */
 		  if (lastprinters != NULL) /* ?LAST_PRINTERS Y */ {
 		    if (debug) 
 		      fprintf(stderr, "    Removing <printers> block\n");
-		    memmove(lastprinters, scan + 1, 
-			    *data + datalength - scan);
-		    datalength -= scan + 1 - lastprinters;
-		    scan = lastprinters - 1;
+		    cutspans(file, lastprinters - data, scan + 1 - data);
 		  } /* ?LAST_PRINTERS */
 		} /* ?OVER_IN_PRINTERS */
 		if (nestinglevel < incomments) /* ?OVER_IN_COMMENTS Y */ {
@@ -1472,18 +4339,16 @@ parse(char **data, /* I/O - Data to process */
 		  /* ?COMMENTS_NOT_IN_PRINTER Y */ {
 		    if (debug) 
 		      fprintf(stderr, "    Removing <comments> block\n");
-		    memmove(lastcomments, scan + 1, 
-			    *data + datalength - scan);
-		    datalength -= scan + 1 - lastcomments;
-		    scan = lastcomments - 1;
+		    cutspans(file, lastcomments - data, scan + 1 - data);
 		  } /* ?COMMENTS_NOT_IN_PRINTER */
 		} /* ?OVER_IN_COMMENTS */
 		if (nestinglevel < inexecution) inexecution = 0;
 		if (nestinglevel < inid) /* ?OVER_IN_ID Y */ {
 		  inid = 0;
-		  /* Get the short printer ID (w/o "printer/") */
-		  strcpy(cprinter, currtagbody + 8);
-		  strcpy(cprinter, translateid(cprinter, idlist));
+		  /* Get the short printer ID (w/o "printer/"), it gets
+		     translated when the change is applied to the combos */
+		  cprinter = parsercopy(parser, PB_PRINTER, currtagbody + 8,
+					strlen(currtagbody + 8));
 		  if (debug)
 		    fprintf(stderr,
 			    "    Overview: Printer: %s Driver: %s\n",
@@ -1497,9 +4362,10 @@ parse(char **data, /* I/O - Data to process */
 		  if (lastdfunctionality != NULL) /* ?LAST_D_FUNCTIONALITY Y */ {
 		    if (debug) fprintf(stderr,
 				       "    Saving <functionality> entry\n");
-		    memmove(dfunctionalityentry, lastdfunctionality,
-			    scan + 1 - lastdfunctionality);
-		    dfunctionalityentry[scan + 1 - lastdfunctionality] = '\0';
+		    dfunctionalityentry =
+		      parsercopy(parser, PB_DFUNCTIONALITYENTRY,
+				 lastdfunctionality,
+				 scan + 1 - lastdfunctionality);
 		    if (debug) fprintf(stderr,
 				       "    <functionality> entry: %s\n",
 				       dfunctionalityentry);
@@ -1513,48 +4379,8 @@ parse(char **data, /* I/O - Data to process */
 			    cdriver, cprinter, dfunctionalityentry);
 		  /* Add this driver to the current printer's entry in the
 		     printer list, create the printer entry if necessary */
-		  plistpointer = *printerlist;
-		  plistpreventry = NULL;
-		  /* Search printer in list */
-		  while ((plistpointer != NULL) &&
-			 (strcmp(plistpointer->id, cprinter) != 0)) 
-			 /* @FIND_PRINTER */ {
-		    plistpreventry = plistpointer;
-		    plistpointer = (printerlist_t *)(plistpointer->next);
-		  } /* @FIND_PRINTER X */ 
-		  if (plistpointer == NULL) /* ?PRINTER_NOT_FOUND Y */ {
-		    /* printer not found, create new entry */
-		    plistpointer = 
-		      (printerlist_t *)malloc(sizeof(printerlist_t));
-		    strcpy(plistpointer->id, cprinter);
-		    plistpointer->drivers = NULL;
-		    plistpointer->next = NULL;
-		    if (plistpreventry != NULL)
-		      plistpreventry->next = 
-			(struct printerlist_t *)plistpointer;
-		    else 
-		      *printerlist = plistpointer;
-		  } /* ?PRINTER_NOT_FOUND */
-		  /* Add driver entry */
-		  dlistpointer = plistpointer->drivers;
-		  dlistpreventry = NULL;
-		  while (dlistpointer != 0) /* @D_LIST_POINTER */ {
-		    dlistpreventry = dlistpointer;
-		    dlistpointer = (driverlist_t *)(dlistpointer->next);
-		  } /* @D_LIST_POINTER X */
-		  dlistpointer = 
-		    (driverlist_t *)malloc(sizeof(driverlist_t));
-		  strcpy(dlistpointer->name, cdriver);
-		  if ((dfunctionalityentry != NULL) &&
-		      (dfunctionalityentry[0]))
-		    dlistpointer->functionality = strdup(dfunctionalityentry);
-		  else dlistpointer->functionality = NULL;
-		  dlistpointer->next = NULL;
-		  if (dlistpreventry != NULL)
-		    dlistpreventry->next =
-		      (struct driverlist_t *)dlistpointer;
-		  else 
-		    plistpointer->drivers = dlistpointer;
+		  addcombochange(ovfile, COMBO_ADD_PRINTER, cprinter, cdriver,
+				 dfunctionalityentry);
 		} /* ?OVER_IN_PRINTER */
 		if (nestinglevel < inprototype) /* ?OVER_IN_PROTOTYPE Y */ {
 		  inprototype = 0;
@@ -1577,35 +4403,15 @@ parse(char **data, /* I/O - Data to process */
 		      /* We have found a non-empty command line prototype, so
 			 this driver produces PPD files */
 		      driverhasproto = 1;
-		      /* Add the driver to the first entry in the printer
-			 list, the pseudo printer "proto" */
-		      plistpointer = *printerlist;
-		      plistpreventry = NULL;
-		      dlistpointer = plistpointer->drivers;
-		      dlistpreventry = NULL;
-		      while ((dlistpointer != 0) &&
-(strcasecmp(dlistpointer->name, cdriver))) /* @FIND_DRIVER */ {
-			dlistpreventry = dlistpointer;
-			dlistpointer = (driverlist_t *)(dlistpointer->next);
-		      } /* @FIND_DRIVER X */
-		      if (dlistpointer == 0) /* ?DRIVER_NOT_FOUND Y */ {
-			dlistpointer = 
-			  (driverlist_t *)malloc(sizeof(driverlist_t));
-			strcpy(dlistpointer->name, cdriver);
-			dlistpointer->functionality = NULL;
-			dlistpointer->next = NULL;
-			if (dlistpreventry != NULL)
-			  dlistpreventry->next =
-			    (struct driverlist_t *)dlistpointer;
-			else 
-			  plistpointer->drivers = dlistpointer;
-		      } /* ?DRIVER_NOT_FOUND */
+		      /* Add the driver to the set of drivers with command
+			 line prototype */
+		      addcombochange(ovfile, COMBO_PROTOTYPE, NULL, cdriver,
+				     NULL);
 		    } else /* ?FOUND_COMMAND_LINE_PROTOTYPE N */ {
 		      /* We have found an empty command line prototype, so
 			 this driver does not produce any PPD file, */
 		      /* Renove the driver XML data from memory */
-		      free((void *)(*data));
-		      *data = NULL;
+		      freespans(file);
 		      if (debug)
 			fprintf(stderr, "    Driver entry does not produce PPDs!\n");
 		      return +comboconfirmed;
@@ -1615,10 +4421,7 @@ parse(char **data, /* I/O - Data to process */
 		  if (lastprototype != NULL) {
 		    if (debug) 
 		      fprintf(stderr, "    Removing <prototype> block\n");
-		    memmove(lastprototype, scan + 1, 
-			    *data + datalength - scan);
-		    datalength -= scan + 1 - lastprototype;
-		    scan = lastprototype - 1;
+		    cutspans(file, lastprototype - data, scan + 1 - data);
 		  }
 		}
 	      } else if (operation == 4) { /* Printer XML file (Overview) */
@@ -1630,16 +4433,22 @@ parse(char **data, /* I/O - Data to process */
 		if (nestinglevel < inmake) {
 		  inmake = 0;
 		  /* Only the <make> outside the <autodetect> tag is valid. */
-		  if (!inautodetect) strcpy(cmake, currtagbody);
+		  if (!inautodetect)
+		    cmake = parsercopy(parser, PB_MAKE, currtagbody,
+				       strlen(currtagbody));
 		}
 		if (nestinglevel < inmodel) {
 		  inmodel = 0;
 		  /* Only the <model> outside the <autodetect> tag is valid. */
-		  if (!inautodetect) strcpy(cmodel, currtagbody);
+		  if (!inautodetect)
+		    cmodel = parsercopy(parser, PB_MODEL, currtagbody,
+					strlen(currtagbody));
 		}
 		if (nestinglevel < infunctionality) {
 		  infunctionality = 0;
-		  strcpy(cfunctionality, currtagbody);
+		  cfunctionality = parsercopy(parser, PB_FUNCTIONALITY,
+					      currtagbody,
+					      strlen(currtagbody));
 		}
 		if (nestinglevel < inunverified) inunverified = 0;
 		if (nestinglevel < indrivers) indrivers = 0;
@@ -1655,20 +4464,9 @@ parse(char **data, /* I/O - Data to process */
 		    driverhasproto = 0;
 		    if ((cid[0] != '\0') && (pid)) {
 		      /* Check if our driver has a command line prototype,
-			 it should be driver of the pseudo-printer
-			 "proto" (first item in the printer list) then */
-		      plistpointer = *printerlist;
-		      plistpreventry = NULL;
-		      dlistpointer = plistpointer->drivers;
-		      dlistpreventry = NULL;
-		      while ((dlistpointer != 0) &&
-			     (strcasecmp(dlistpointer->name, cid))) {
-			dlistpreventry = dlistpointer;
-			dlistpointer = (driverlist_t *)(dlistpointer->next);
-		      }
-		      if (dlistpointer != 0) {
+			 it is in the set of drivers with prototype then */
+		      if (findsetdriver(ovfile->protodrivers, cid) != NULL)
 			driverhasproto = 1;
-		      }
 		    }
 		    if (debug)
 		      fprintf(stderr,
@@ -1696,50 +4494,8 @@ parse(char **data, /* I/O - Data to process */
 			  fprintf(stderr,
 				  "    Overview: Printer: %s Driver: %s: Adding driver to list\n",
 				  cprinter, cid);
-			plistpointer = *printerlist;
-			plistpreventry = NULL;
-			/* Search printer in list */
-			while ((plistpointer != NULL) &&
-			       (strcmp(plistpointer->id, cprinter) != 0)) {
-			  plistpreventry = plistpointer;
-			  plistpointer = (printerlist_t *)(plistpointer->next);
-			}
-			if (plistpointer == NULL) {
-			  /* printer not found, create new entry */
-			  plistpointer = 
-			    (printerlist_t *)malloc(sizeof(printerlist_t));
-			  strcpy(plistpointer->id, cprinter);
-			  plistpointer->drivers = NULL;
-			  plistpointer->next = NULL;
-			  if (plistpreventry != NULL)
-			    plistpreventry->next = 
-			      (struct printerlist_t *)plistpointer;
-			  else 
-			    *printerlist = plistpointer;
-			}
-			/* Add driver entry */
-			dlistpointer = plistpointer->drivers;
-			dlistpreventry = NULL;
-			while ((dlistpointer != 0) &&
-			       (strcasecmp(dlistpointer->name, cid))) {
-			  dlistpreventry = dlistpointer;
-			  dlistpointer = (driverlist_t *)(dlistpointer->next);
-			}
-			if (dlistpointer == 0) {
-			  dlistpointer = 
-			    (driverlist_t *)malloc(sizeof(driverlist_t));
-			  strcpy(dlistpointer->name, cid);
-			  dlistpointer->functionality = NULL;
-			  dlistpointer->next = NULL;
-			  if (dlistpreventry != NULL)
-			    dlistpreventry->next =
-			      (struct driverlist_t *)dlistpointer;
-			  else 
-			    plistpointer->drivers = dlistpointer;
-			if (debug)
-			  fprintf(stderr,
-				  "    Overview: Driver successfully added to list.\n");
-			}
+			addcombochange(ovfile, COMBO_ADD_DRIVER, cprinter, cid,
+				       NULL);
 		      } else {
 			/* To suppress the printer/driver combo from the
 			   output list we need to delete the appropriate
@@ -1748,39 +4504,8 @@ parse(char **data, /* I/O - Data to process */
 			  fprintf(stderr,
 				  "    Overview: Printer: %s Driver: %s: Removing driver from list\n",
 				  cprinter, cid);
-			plistpointer = *printerlist;
-			plistpreventry = NULL;
-			/* Search printer in list */
-			while ((plistpointer != NULL) &&
-			       (strcmp(plistpointer->id, cprinter) != 0)) {
-			  plistpreventry = plistpointer;
-			  plistpointer =
-			    (printerlist_t *)(plistpointer->next);
-			}
-			/* If the printer is there, search for the driver */
-			if (plistpointer != NULL) {
-			  dlistpointer = plistpointer->drivers;
-			  dlistpreventry = NULL;
-			  while ((dlistpointer != NULL) &&
-				 (strcasecmp(dlistpointer->name, cid))) {
-			    dlistpreventry = dlistpointer;
-			    dlistpointer =
-			      (driverlist_t *)(dlistpointer->next);
-			  }
-			  if (dlistpointer != NULL) {
-			    dlistnextentry =
-			      (driverlist_t *)(dlistpointer->next);
-			    free(dlistpointer);
-			    if (dlistpreventry != NULL)
-			      dlistpreventry->next = 
-				(struct driverlist_t *)dlistnextentry;
-			    else
-			      plistpointer->drivers = dlistnextentry;
-			    if (debug)
-			      fprintf(stderr,
-				      "    Overview: Driver successfully removed from list.\n");
-			  }
-			}
+			addcombochange(ovfile, COMBO_REMOVE_DRIVER, cprinter,
+				       cid, NULL);
 		      }
 		      if (cppd[0] != '\0') {
 			if ((pid == NULL) || (pid[0] == 'C')) {
@@ -1819,11 +4544,14 @@ parse(char **data, /* I/O - Data to process */
 			}
 		      }
 		    }
-		  } else strcpy(cdriver, currtagbody);
+		  } else
+		    cdriver = parsercopy(parser, PB_DRIVER, currtagbody,
+					 strlen(currtagbody));
 		}
 		if (nestinglevel < inid) {
 		  inid = 0;
-		  strcpy(cid, currtagbody);
+		  cid = parsercopy(parser, PB_ID, currtagbody,
+				   strlen(currtagbody));
 		  if (debug) fprintf(stderr, 
 				     "    Driver ID for PPD: %s\n", cid);
 		}
@@ -1834,7 +4562,7 @@ parse(char **data, /* I/O - Data to process */
 		  for (s = currtagbody;
 		       (*s != '\0') && (strchr(" \n\r\t", *s) != NULL);
 		       s ++);
-		  strcpy(cppd, s);
+		  cppd = parsercopy(parser, PB_PPD, s, strlen(s));
 		  if (debug) fprintf(stderr, 
 				     "    PPD URL: %s\n", cppd);
 		}
@@ -1845,9 +4573,9 @@ parse(char **data, /* I/O - Data to process */
 		  if (lastautodetect != NULL) {
 		    if (debug) fprintf(stderr,
 				       "    Saving <autodetect> entry\n");
-		    memmove(cautodetectentry, lastautodetect,
-			    scan + 1 - lastautodetect);
-		    cautodetectentry[scan + 1 - lastautodetect] = '\0';
+		    cautodetectentry =
+		      parsercopy(parser, PB_AUTODETECTENTRY, lastautodetect,
+				 scan + 1 - lastautodetect);
 		    if (debug) fprintf(stderr,
 				       "    <autodetect> entry: %s\n",
 				       cautodetectentry);
@@ -1864,218 +4592,2544 @@ parse(char **data, /* I/O - Data to process */
 	  if ((*scan == '>') && 0) { /* tag end without beginning */
 	    fprintf(stderr, "XML error: '>' without '<' %s, line %d!\n",
 		    filename, linecount);
-	    exit(1);
+	    freeppdlist(ppdlist);
+	    free(entry);
+	    return -1;
+	  }
+	}
+      }
+      break;
+    default:
+      /* other characters */
+      if ((intag) && (!incomment)) {
+	if (*scan == '\'') insinglequotes = 1 - insinglequotes;
+	if (*scan == '\"') indoublequotes = 1 - indoublequotes;
+	if ((insinglequotes) || (indoublequotes)) inquotes = 1;
+	else inquotes = 0; 
+	if (!incomment) {
+	  if (!intagword) {
+	    intagword = 1;
+	    tagwordstart = scan;
+	  }
+	}
+      }
+    }
+  }
+  if (debug) fprintf(stderr, 
+		     "    XML tag nesting level: %d\n",nestinglevel);
+  if (debug) fprintf(stderr, "    Lines of input: %d\n", linecount);
+  switch (+operation) /* *OPERATION */
+  { 
+	  case /* *OPERATION */ (+PARSE_OP_PRINTER): { /* Printer XML file */
+    if ((parser->printermake[0] == 0) || (parser->printermodel[0] == 0)) /* ?NO_MODEL Y */ {
+      /* <make> or <model> tag not found */
+      fprintf(stderr, "Could not determine manufacturer or model name from the printer file %s!\n",
+	      filename);
+      return -1;
+    } /* ?NO_MODEL */
+    if (debug) fprintf(stderr, "    Driver in printer's driver list: %d\n", comboconfirmed); 
+  } break; 
+  case /* *OPERATION */ (+PARSE_OP_DRIVER): { /* Driver XML file */
+    if (debug) fprintf(stderr, "    Events in driver model: %d\n",
+		       drivermodel->numevents);
+  } break; 
+  case /* *OPERATION */ (+PARSE_OP_OPTION): { /* Option XML file */
+    if (debug) fprintf(stderr, "    Events in option model: %d\n",
+		       optionmodel->numevents);
+  } break;
+  case /* *OPERATION */ (+PARSE_OP_OV_DRIVER): 
+  { /* Driver XML file (Overview) */
+    if (pid && (driverhasproto == 0)) /* ?PID_NO_DRIVER Y */ {
+      /* We did not find a command line prototype, so
+	 this driver does not produce any PPD file, */
+      /* As we want to list only/printer/driver combos which produce
+	 a PPD file, renove the driver XML data from memory */
+      freespans(file);
+      /* Delete all occurences of the driver in the
+	 printer/driver combo list */
+      addcombochange(ovfile, COMBO_NO_PROTOTYPE, NULL, cdriver, NULL);
+      if (debug)
+	fprintf(stderr, "    Driver entry does not produce PPDs!\n");
+    } /* ?PID_NO_DRIVER */ 
+  } break; 
+  case /* *OPERATION */ (+PARSE_OP_OV_PRINTER):
+  { /* Printer XML file (Overview) */
+    /* Remove the printer input data from the output */
+    freespans(file);
+    /* Build the printer entry for the overview in a new buffer, it becomes
+       the output of this file */
+    if (debug) fprintf(stderr, "    Data for this printer entry in the overview:\n      Printer ID: |%s|\n      Make: |%s|\n      Model: |%s|\n      Functionality: |%s|\n      Rec. driver: |%s|\n      Auto detect entry: |%s|\n",
+	    cprinter, cmake, cmodel, cfunctionality, cdriver,cautodetectentry);
+    if ((cprinter[0]) && (cmake[0]) && (cmodel[0]) && (cfunctionality[0])) 
+    /* ?PRINTER_ENTRY Y */ {
+      /* The printer ID gets translated and the drivers get inserted
+	 when the changes of the combos are applied */
+      appenddata(&entry, &entrylength, &entrysize, "</id>\n    <make>");
+      appenddata(&entry, &entrylength, &entrysize, cmake);
+      appenddata(&entry, &entrylength, &entrysize, "</make>\n    <model>");
+      appenddata(&entry, &entrylength, &entrysize, cmodel);
+      appenddata(&entry, &entrylength, &entrysize, "</model>\n    <functionality>");
+      appenddata(&entry, &entrylength, &entrysize, cfunctionality);
+      appenddata(&entry, &entrylength, &entrysize, "</functionality>\n");
+      if (cunverified) /* ?UNVERIFIED Y */ {
+	appenddata(&entry, &entrylength, &entrysize, "    <unverified>");
+	appenddata(&entry, &entrylength, &entrysize, cfunctionality);
+	appenddata(&entry, &entrylength, &entrysize, "</unverified>\n");
+      } /* ?UNVERIFIED */
+      if (cdriver[0]) /* ?DRIVER Y */ {
+	appenddata(&entry, &entrylength, &entrysize, "    <driver>");
+	appenddata(&entry, &entrylength, &entrysize, cdriver);
+	appenddata(&entry, &entrylength, &entrysize, "</driver>\n");
+      } /* ?DRIVER */
+      if (cautodetectentry[0]) /* ?AUTO_DETECT_ENTRY Y */ {
+	appenddata(&entry, &entrylength, &entrysize, "    ");
+	appenddata(&entry, &entrylength, &entrysize, cautodetectentry);
+      } /* ?AUTO_DETECT_ENTRY */ 
+      ovfile->driverspos = entrylength;
+      if (ppdlist != NULL) /* ?PPD_LIST Y */ {
+	appenddata(&entry, &entrylength, &entrysize, "    <ppds>\n");
+	ppdlistpointer = ppdlist;
+	if (debug)
+	  fprintf(stderr,
+		  "    Going through list: ");
+	while (ppdlistpointer) /* @PPD_LIST_POINTER */ {
+	if (debug)
+	  fprintf(stderr,
+		  ".");
+	  appenddata(&entry, &entrylength, &entrysize, "      <ppd>\n");
+	  appenddata(&entry, &entrylength, &entrysize, "        <driver>");
+	  appenddata(&entry, &entrylength, &entrysize, ppdlistpointer->driver);
+	  appenddata(&entry, &entrylength, &entrysize, "</driver>\n        <ppdfile>");
+	  appenddata(&entry, &entrylength, &entrysize, ppdlistpointer->ppd);
+	  appenddata(&entry, &entrylength, &entrysize, "</ppdfile>\n");
+	  appenddata(&entry, &entrylength, &entrysize, "      </ppd>\n");
+	  ppdlistpointer = (ppdlist_t *)(ppdlistpointer->next);
+	} /* @PPD_LIST_POINTER X */
+	appenddata(&entry, &entrylength, &entrysize, "    </ppds>\n");
+      } /* ?PPD_LIST */
+      appenddata(&entry, &entrylength, &entrysize, "  </printer>\n");
+      ovfile->printer = strdup(cprinter);
+      ovfile->entry = entry;
+    } /* ?PRINTER_ENTRY */ 
+    freeppdlist(ppdlist);
+  } break; } /* *OPERATION X */
+  return(comboconfirmed);
+}
+
+/*
+ * function to map a compiled database snapshot ("-s") into the memory
+ */
+
+snapshot_t  /* O - Snapshot, NULL if it is not readable (error message
+	       issued) */
+*opensnapshot(const char *filename) { /* I - Snapshot file name */
+  snapshot_t    *snapshot;
+  const snapheader_t *header;
+  int           fd;
+  struct stat   st;
+  char          *data;
+
+  fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "Cannot read snapshot %s!\n", filename);
+    return NULL;
+  }
+  if ((fstat(fd, &st) != 0) || (st.st_size < (off_t)sizeof(snapheader_t))) {
+    close(fd);
+    fprintf(stderr, "File %s is not a database snapshot!\n", filename);
+    return NULL;
+  }
+  data = (char *)mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd,
+		      0);
+  close(fd);
+  if (data == (char *)MAP_FAILED) {
+    fprintf(stderr, "Cannot map snapshot %s!\n", filename);
+    return NULL;
+  }
+  countstat(STATS_FILES, 1);
+  countstat(STATS_BYTES, (long)st.st_size);
+
+  /* Only the header and the positions of the tables are checked, the
+     contents are trusted, the snapshot gets written by "-W" only */
+  header = (const snapheader_t *)data;
+#define SNAPSHOT_TABLE_OK(offset, num, type)				\
+  ((offset) % sizeof(unsigned int) == 0 && (offset) <= header->size &&	\
+   (num) <= (header->size - (offset)) / sizeof(type))
+  if ((memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) ||
+      (header->version != SNAPSHOT_VERSION) ||
+      (header->byteorder != SNAPSHOT_BYTEORDER) ||
+      (header->size != (unsigned int)st.st_size) ||
+      !SNAPSHOT_TABLE_OK(header->printers, header->numprinters, snapfile_t) ||
+      !SNAPSHOT_TABLE_OK(header->drivers, header->numdrivers, snapfile_t) ||
+      !SNAPSHOT_TABLE_OK(header->options, header->numoptions, snapoption_t) ||
+      !SNAPSHOT_TABLE_OK(header->events, header->numevents, snapevent_t) ||
+      !SNAPSHOT_TABLE_OK(header->idpairs, header->numidpairs,
+			 snapidpair_t) ||
+      !SNAPSHOT_TABLE_OK(header->strings, header->stringslength, char) ||
+      (header->stringslength == 0) ||
+      (header->libdir >= header->stringslength) ||
+      (data[header->strings + header->stringslength - 1] != '\0')) {
+    munmap(data, (size_t)st.st_size);
+    fprintf(stderr,
+	    "File %s is not a database snapshot of this version!\n",
+	    filename);
+    return NULL;
+  }
+#undef SNAPSHOT_TABLE_OK
+
+  snapshot = (snapshot_t *)calloc(1, sizeof(snapshot_t));
+  if (snapshot == NULL) {
+    fprintf(stderr, "Out of memory!\n");
+    exit(1);
+  }
+  snapshot->data = data;
+  snapshot->size = (size_t)st.st_size;
+  snapshot->header = header;
+  snapshot->strings = data + header->strings;
+  snapshot->printers = (const snapfile_t *)(data + header->printers);
+  snapshot->drivers = (const snapfile_t *)(data + header->drivers);
+  snapshot->options = (const snapoption_t *)(data + header->options);
+  snapshot->events = (const snapevent_t *)(data + header->events);
+  snapshot->idpairs = (const snapidpair_t *)(data + header->idpairs);
+  return snapshot;
+}
+
+/*
+ * function to unmap a snapshot
+ */
+
+void
+closesnapshot(snapshot_t *snapshot) { /* I - Snapshot */
+  if (snapshot == NULL) return;
+  munmap(snapshot->data, snapshot->size);
+  free(snapshot);
+}
+
+/*
+ * function to find a printer or driver file in a snapshot
+ */
+
+const snapfile_t  /* O - File, NULL if it is not in the snapshot */
+*findsnapfile(const snapshot_t *snapshot, /* I - Snapshot */
+	      const snapfile_t *files,    /* I - Table, sorted by name */
+	      int numfiles,               /* I - Number of files */
+	      const char *name) {         /* I - Printer ID or driver
+					     name */
+  int           low = 0, high = numfiles - 1, middle, result;
+
+  while (low <= high) {
+    middle = (low + high) / 2;
+    result = strcmp(name, snapshot->strings + files[middle].name);
+    if (result == 0) return files + middle;
+    if (result < 0) high = middle - 1;
+    else low = middle + 1;
+  }
+  return NULL;
+}
+
+/*
+ * function to set up an XML file with a file of a snapshot, the data is
+ * not copied
+ */
+
+void
+snapxmlfile(xmlfile_t *file,                 /* O - XML file */
+	    const snapshot_t *snapshot,      /* I - Snapshot */
+	    const snapfile_t *snapfile) {    /* I - File in the snapshot */
+  file->spans = NULL;
+  file->numspans = 0;
+  file->sizespans = 0;
+  file->data = (char *)(snapshot->strings + snapfile->data);
+  file->length = (int)snapfile->length;
+  file->mapped = 2;
+}
+
+/*
+ * function to load a printer or driver XML file, from the snapshot if
+ * there is one
+ */
+
+int  /* O - 1: file loaded, 0: file missing, empty, or not readable */
+loaddbfile(const database_t *db, /* I - Database */
+	   xmlfile_t *file,      /* O - XML file */
+	   int isdriver,         /* I - 1: driver file, 0: printer file */
+	   const char *name,     /* I - Printer ID or driver name */
+	   const char *filename) { /* I - file name */
+  const snapfile_t *snapfile;
+
+  if (db->snapshot == NULL) return loadxmlfile(file, filename);
+  if (isdriver)
+    snapfile = findsnapfile(db->snapshot, db->snapshot->drivers,
+			    db->snapshot->header->numdrivers, name);
+  else
+    snapfile = findsnapfile(db->snapshot, db->snapshot->printers,
+			    db->snapshot->header->numprinters, name);
+  if (snapfile == NULL) {
+    file->spans = NULL;
+    file->numspans = 0;
+    file->sizespans = 0;
+    file->data = NULL;
+    file->length = 0;
+    return 0;
+  }
+  snapxmlfile(file, db->snapshot, snapfile);
+  initspans(file);
+  return 1;
+}
+
+/*
+ * function to build the option index from a snapshot, the option files
+ * stay in the snapshot, the models are built when they are needed
+ */
+
+optindex_t  /* O - Option index, in the order of the snapshot */
+*snapshotoptindex(const snapshot_t *snapshot) { /* I - Snapshot */
+  optindex_t    *optindex = NULL, *last = NULL, *entry;
+  const snapoption_t *option;
+  unsigned int  i;
+
+  for (i = 0; i < snapshot->header->numoptions; i ++) {
+    option = snapshot->options + i;
+    entry = (optindex_t *)calloc(1, sizeof(optindex_t));
+    if (entry == NULL) {
+      fprintf(stderr, "Out of memory!\n");
+      exit(1);
+    }
+    strncpy(entry->name, snapshot->strings + option->file.name,
+	    sizeof(entry->name) - 1);
+    entry->keys = eventstring(snapshot->strings + option->keys);
+    snapxmlfile(&(entry->file), snapshot, &(option->file));
+    entry->snapshot = option;
+    if (last) last->next = (struct optindex_t *)entry;
+    else optindex = entry;
+    last = entry;
+  }
+  return optindex;
+}
+
+/*
+ * function to copy a string of a snapshot for an option event
+ */
+
+char  /* O - Copy of the string, NULL for offset 0 */
+*snapeventstring(const snapshot_t *snapshot, /* I - Snapshot */
+		 unsigned int offset) {      /* I - String */
+  return (offset ? eventstring(snapshot->strings + offset) : NULL);
+}
+
+/*
+ * function to build the model of an option from a snapshot
+ */
+
+optionmodel_t  /* O - Complete model of the option */
+*snapshotmodel(const snapshot_t *snapshot,  /* I - Snapshot */
+	       const snapoption_t *option) { /* I - Option */
+  optionmodel_t *model = newoptionmodel();
+  const snapevent_t *snapevent;
+  optevent_t    *event;
+  unsigned int  i;
+
+  model->optiontype = option->optiontype;
+  model->numenumvals = option->numenumvals;
+  for (i = 0; i < option->numevents; i ++) {
+    snapevent = snapshot->events + option->events + i;
+    event = addoptevent(model, snapevent->type, snapevent->inenumval,
+			snapevent->line);
+    event->from = snapevent->from;
+    event->to = snapevent->to;
+    event->sense = snapevent->sense;
+    event->text = snapeventstring(snapshot, snapevent->text);
+    event->printer = snapeventstring(snapshot, snapevent->printer);
+    event->make = snapeventstring(snapshot, snapevent->make);
+    event->model = snapeventstring(snapshot, snapevent->model);
+    event->driver = snapeventstring(snapshot, snapevent->driver);
+    event->argdefault = snapeventstring(snapshot, snapevent->argdefault);
+  }
+  return model;
+}
+
+/*
+ * function to build the printer ID translation table from a snapshot,
+ * the IDs stay in the snapshot
+ */
+
+idlist_t  /* O - ID translation table, NULL if there was none */
+*snapshotidlist(const snapshot_t *snapshot) { /* I - Snapshot */
+  idlist_t      *idlist;
+  unsigned int  i;
+
+  if (!snapshot->header->hasidlist) return NULL;
+  idlist = (idlist_t *)calloc(1, sizeof(idlist_t));
+  if (idlist == NULL) {
+    fprintf(stderr, "Out of memory!\n");
+    exit(1);
+  }
+  idlist->numpairs = idlist->sizepairs = (int)snapshot->header->numidpairs;
+  idlist->pairs =
+    (idpair_t *)malloc(sizeof(idpair_t) * (idlist->sizepairs + 1));
+  if (idlist->pairs == NULL) {
+    fprintf(stderr, "Out of memory!\n");
+    exit(1);
+  }
+  for (i = 0; i < snapshot->header->numidpairs; i ++) {
+    idlist->pairs[i].oldid =
+      (char *)(snapshot->strings + snapshot->idpairs[i].oldid);
+    idlist->pairs[i].newid =
+      (char *)(snapshot->strings + snapshot->idpairs[i].newid);
+  }
+  hashidlist(idlist);
+  return idlist;
+}
+
+/*
+ * function to get a driver file, it is loaded on the first request and
+ * kept in memory for later combos, with its model once it is parsed
+ */
+
+drivercache_t  /* O - Driver entry, the data of its file is NULL if the
+		  file is missing */
+*getdriverfile(database_t *db,           /* I/O - Database */
+	       const char *driver,       /* I - Driver name */
+	       const char *filename) {   /* I - Driver file name */
+  drivercache_t *entry;
+
+  for (entry = db->drivers; entry; entry = (drivercache_t *)(entry->next))
+    if (strcmp(entry->name, driver) == 0) {
+      freespans(&(entry->file));
+      if (entry->file.data != NULL) initspans(&(entry->file));
+      return entry;
+    }
+  entry = (drivercache_t *)calloc(1, sizeof(drivercache_t));
+  if (entry == NULL) {
+    fprintf(stderr, "Out of memory!\n");
+    exit(1);
+  }
+  strncpy(entry->name, driver, sizeof(entry->name) - 1);
+  if (!loaddbfile(db, &(entry->file), 1, driver, filename))
+    entry->file.data = NULL;
+  entry->next = (struct drivercache_t *)(db->drivers);
+  db->drivers = entry;
+  return entry;
+}
+
+/*
+ * function to drop a driver file which is not valid XML from the driver
+ * files kept in memory, the next combo with this driver reads it again
+ */
+
+void
+dropdriverfile(database_t *db,         /* I/O - Database */
+	       drivercache_t *entry) { /* I - Driver entry to drop */
+  drivercache_t **prev;
+
+  for (prev = &(db->drivers); *prev;
+       prev = (drivercache_t **)&((*prev)->next))
+    if (*prev == entry) {
+      *prev = (drivercache_t *)(entry->next);
+      break;
+    }
+  if (entry->file.data != NULL) freexmlfile(&(entry->file));
+  freedrivermodel(entry->model);
+  free(entry);
+}
+
+/*
+ * function to load, parse, and evaluate an option file for a combo,
+ * called by the threads and, without "-j", by combo() itself
+ */
+
+int  /* O - 1: option file evaluated, -1: file not readable or not
+	valid XML */
+evaloptionfile(optjobs_t *jobs,        /* I - Files and their common
+					  data */
+	       parser_t *parser,       /* I/O - Parser of the thread */
+	       optindex_t *optentry) { /* I/O - Option file */
+  char          optionfilename[1024]; /* Name of the option XML file */
+  int           nopjl = jobs->nopjl;
+
+  sprintf(optionfilename, "%s/db/source/opt/%s",
+	  jobs->db->libdir, optentry->name);
+  /* load the current option's XML file and build its model, or take
+     the ones of a previous combo */
+  if (optentry->file.data != NULL) {
+    initspans(&(optentry->file));
+  } else if (!loadxmlfile(&(optentry->file), optionfilename)) {
+    return -1;
+  }
+  if (jobs->debug) fprintf(stderr, "  Option file loaded!\n");
+  if ((optentry->model == NULL) && (optentry->snapshot != NULL)) {
+    /* The snapshot has the complete model */
+    optentry->model = snapshotmodel(jobs->db->snapshot, optentry->snapshot);
+  } else if (optentry->model == NULL) {
+    /* For a single combo parse() can stop reading the file as soon as
+       it is clear that the option does not apply, in batch mode the
+       complete model is built, to be reused */
+    optentry->model = newoptionmodel();
+    if (parse(parser, &(optentry->file), jobs->pid, jobs->driver,
+	      optionfilename, NULL, 2, jobs->db->defaultsettings,
+	      jobs->db->num_defaultsettings, &nopjl, jobs->db->idlist,
+	      optentry->model, NULL, jobs->debug2) < 0) {
+      /* The file gets read again by the next combo, it can be fixed by
+	 then */
+      freeoptionmodel(optentry->model);
+      optentry->model = NULL;
+      freexmlfile(&(optentry->file));
+      return -1;
+    }
+  }
+  /* process it */
+  evaloption(optentry->model, &(optentry->file), jobs->evalpid,
+	     jobs->driver, parser->printermake, parser->printermodel,
+	     optionfilename, jobs->db->defaultsettings,
+	     jobs->db->num_defaultsettings, jobs->nopjl, jobs->db->idlist,
+	     jobs->debug2);
+  if (optentry->model->partial) {
+    freeoptionmodel(optentry->model);
+    optentry->model = NULL;
+  }
+  /* If the parser discarded it (because it does not apply to our 
+     printer/driver combo) it is not put out */
+  if (optentry->file.spans == NULL) {
+    if (jobs->debug) fprintf(stderr, "  Option does not apply, removed!\n");
+    countstat(STATS_OPTREJECTED, 1);
+  } else {
+    if (jobs->debug) fprintf(stderr, "  Option applies!\n");
+    countstat(STATS_OPTQUALIFIED, 1);
+  }
+  return 1;
+}
+
+/*
+ * function run by the threads parsing the option files of a combo
+ */
+
+void  /* O - Always NULL */
+*optthread(void *arg) { /* I - Files and their common data (optjobs_t) */
+  optjobs_t     *jobs = (optjobs_t *)arg;
+  parser_t      parser;
+  int           i;
+
+  initparser(&parser);
+  copyparserprinter(&parser, jobs->printer);
+  for (;;) {
+    pthread_mutex_lock(&(jobs->lock));
+    i = jobs->next;
+    if (i < jobs->numentries) jobs->next ++;
+    pthread_mutex_unlock(&(jobs->lock));
+    if (i >= jobs->numentries) break;
+    if (evaloptionfile(jobs, &parser, jobs->entries[i]) < 0) {
+      pthread_mutex_lock(&(jobs->lock));
+      if ((jobs->failed < 0) || (i < jobs->failed)) jobs->failed = i;
+      pthread_mutex_unlock(&(jobs->lock));
+    }
+  }
+  freeparser(&parser);
+  return NULL;
+}
+
+/*
+ * function to release the output of the last combo which combo() did
+ * not put out
+ */
+
+void
+freecombo(database_t *db) { /* I/O - Database */
+  if (db->printerfile.data != NULL) freexmlfile(&(db->printerfile));
+  if (db->fallbackdriverfile.data != NULL)
+    freexmlfile(&(db->fallbackdriverfile));
+  db->driverfile = NULL;
+}
+
+/*
+ * function to compute the combo XML data for a printer/driver combo and
+ * to put it out. In batch mode the document is preceded by a line
+ * "COMBO <printer>,<driver> <length>" with the length in bytes. Without
+ * an output stream the output stays in the database until the next
+ * combo, in the printer file, the driver file, and the option files (see
+ * combopieces()).
+ */
+
+int  /* O - 0: combo put out, 1: combo not possible, -1: a database file
+	is not readable or not valid XML (error messages issued, nothing
+	put out) */
+combo(FILE *out,          /* I - Output stream, NULL: keep the output */
+      database_t *db,     /* I/O - Database */
+      parser_t *parser,   /* I/O - Parser */
+      const char *pid,    /* I - Foomatic printer ID */
+      const char *driver, /* I - Driver name */
+      int batch,          /* I - 1: frame the output for batch mode */
+      int debug) {        /* I - Debug level */
+  char          *t;
+  const char    *make, *model;  /* For constraints */
+  char          printerfilename[1024];/* Name of printer's XML file */
+  char          driverfilename[1024]; /* Name of driver's XML file */
+  char          optiondirname[1024];  /* Name of the directory with the XML
+					 files for the options */
+  xmlfile_t     *printerfile = &(db->printerfile); /* Printer XML file
+							and its output */
+  drivercache_t *drivercache; /* Driver XML file and its model */
+  xmlfile_t     *driverfile;  /* Driver XML file and its output */
+  optindex_t    *optentry;    /* Option index entry and file */
+  optjobs_t     jobs;         /* Option files to parse and evaluate */
+  pthread_t     *threads;
+  int           numthreads;
+  int           i;
+  const char    *trpid;       /* Translated printer ID */
+  int           nopjl = 0;
+  int           debug2 = (debug > 1);
+  int           comboconfirmed = 0;
+  int           comboconfirmed2 = 0;
+  int           length;
+  const char    *comboid = pid; /* Printer ID as requested */
+  statsclock_t  phasestart; /* Start of the current phase ("--stats") */
+
+  /* Set file/dir names, IDs which do not fit cannot be in the
+     database */
+
+  if ((snprintf(printerfilename, sizeof(printerfilename),
+		"%s/db/source/printer/%s.xml", db->libdir, pid)
+       >= (int)sizeof(printerfilename)) ||
+      (snprintf(driverfilename, sizeof(driverfilename),
+		"%s/db/source/driver/%s.xml", db->libdir, driver)
+       >= (int)sizeof(driverfilename))) {
+    fprintf(stderr, "Printer ID or driver name too long!\n");
+    return 1;
+  }
+  snprintf(optiondirname, sizeof(optiondirname), "%s/db/source/opt",
+	   db->libdir);
+
+  /* Output of the previous combo */
+
+  freecombo(db);
+  for (optentry = db->optindex; optentry;
+       optentry = (optindex_t *)(optentry->next))
+    freespans(&(optentry->file));
+
+  /* Read the printer file and extract the printer manufacturer and 
+     model */
+
+  startphase(&phasestart);
+  if (debug) fprintf(stderr, "Printer file: %s\n", printerfilename);
+  if (!loaddbfile(db, printerfile, 0, pid, printerfilename)) {
+    pid = translateid(pid, db->idlist);
+    snprintf(printerfilename, sizeof(printerfilename),
+	     "%s/db/source/printer/%s.xml", db->libdir, pid);
+    if (!loaddbfile(db, printerfile, 0, pid, printerfilename)) {
+      printerfile->data = malloc(3 * strlen(pid) + 256);
+      printerfile->mapped = 0;
+      make = strdup(pid);
+      model = strchr(make, '-');
+      if (model) {
+	t = (char *)model;
+	*t = '\0';
+	model ++;
+      } else { 
+	model = "Unknown model";
+      }
+      t = (char *)make;
+      while (*t) {
+	if (*t == '_') *t = ' ';
+	t ++;
+      }
+      t = (char *)model;
+      while (*t) {
+	if (*t == '_') *t = ' ';
+	t ++;
+      }
+      printerfile->length = sprintf(printerfile->data, "<printer id=\"printer/%s\">\n <make>%s</make>\n <model>%s</model>\n <mechanism>\n  <color />\n </mechanism>\n <noxmlentry />\n</printer>\n", pid, make, model);
+      free((void *)make);
+      initspans(printerfile);
+    } else {
+      fprintf(stderr, 
+	      "WARNING: Obsolete printer ID used, using %s instead!\n",
+	      pid);
+    }
+  }
+  if (debug) fprintf(stderr, "  Printer file loaded!\n");
+  comboconfirmed =
+    parse(parser, printerfile, pid, driver, printerfilename, NULL, 0, 
+	  db->defaultsettings, db->num_defaultsettings, &nopjl,
+	  db->idlist, NULL, NULL, debug2);
+  if (comboconfirmed < 0) {
+    fprintf(stderr, "Printer file %s corrupted!\n", printerfilename);
+    freecombo(db);
+    return -1;
+  }
+  endphase(STATS_PRINTER, &phasestart);
+
+  /* Read the driver file and check whether the printer is present */
+
+  if (debug) fprintf(stderr, "Driver file: %s\n", driverfilename);
+  drivercache = getdriverfile(db, driver, driverfilename);
+  driverfile = &(drivercache->file);
+  if (driverfile->data == NULL) {
+    if (!comboconfirmed) {
+      fprintf(stderr, 
+	      "Driver file %s corrupted, missing, or not readable!\n",
+	      driverfilename);
+      freecombo(db);
+      return 1;
+    } else {
+      driverfile = &(db->fallbackdriverfile);
+      driverfile->data = malloc(2 * strlen(driver) + strlen(pid) + 512);
+      driverfile->mapped = 0;
+      driverfile->length = sprintf(driverfile->data, "<driver id=\"driver/%s\">\n <name>%s</name>\n <url></url>\n <execution>\n  <filter />\n  <prototype></prototype>\n </execution>\n <printers>\n  <printer>\n   <id>printer/%s</id>\n  </printer>\n </printers>\n</driver>", driver, driver, pid);
+      initspans(driverfile);
+      endphase(STATS_DRIVER, &phasestart);
+    }
+  } else {
+    if (debug) fprintf(stderr, "  Driver file loaded!\n");
+    /* The driver file is parsed into its model only once, the model is
+       evaluated for every combo with this driver */
+    if (drivercache->model == NULL) {
+      drivercache->model = newdrivermodel();
+      if (parse(parser, driverfile, NULL, driver, driverfilename, NULL, 1,
+		db->defaultsettings, db->num_defaultsettings, &nopjl,
+		db->idlist, NULL, drivercache->model, debug2) < 0) {
+	fprintf(stderr, "Driver file %s corrupted!\n", driverfilename);
+	dropdriverfile(db, drivercache);
+	freecombo(db);
+	return -1;
+      }
+    }
+    comboconfirmed2 =
+      evaldriver(drivercache->model, driverfile, pid, db->idlist, &nopjl,
+		 debug2);
+    if ((!comboconfirmed) && (!comboconfirmed2)) {
+      fprintf(stderr, "The printer %s is not supported by the driver %s!\n",
+	      pid, driver);
+      freecombo(db);
+      return 1;
+    }
+    if (debug) {
+      if (nopjl) {
+	fprintf(stderr, "  Driver forbids PJL options!\n");
+      } else {
+	fprintf(stderr, "  Driver allows PJL options!\n");
+      }
+    }
+    endphase(STATS_DRIVER, &phasestart);
+
+    /* Search the Foomatic option directory and read all xml files found
+       there. Check whether and how they apply to the given printer/driver
+       combo */
+
+    /* Only the option files whose constraints can match our printer or
+       driver, according to the option index, need to be read */
+
+    if (!db->optindexloaded) {
+      if (db->snapshot != NULL)
+	db->optindex = snapshotoptindex(db->snapshot);
+      else
+	db->optindex = updateoptindex(optiondirname, db->optindexfilename,
+				      db->optindexsave, debug);
+      db->optindexloaded = 1;
+    }
+    trpid = translateid(pid, db->idlist);
+
+    memset(&jobs, 0, sizeof(optjobs_t));
+    jobs.db = db;
+    jobs.failed = -1;
+    jobs.pid = (batch ? NULL : pid);
+    jobs.evalpid = pid;
+    jobs.driver = driver;
+    jobs.printer = parser;
+    jobs.nopjl = nopjl;
+    jobs.debug = debug;
+    jobs.debug2 = debug2;
+    for (optentry = db->optindex; optentry;
+	 optentry = (optindex_t *)(optentry->next)) {
+      if (debug) fprintf(stderr, "Option file: %s/db/source/opt/%s\n", 
+			 db->libdir, optentry->name);
+      if (!optioncandidate(optentry->keys, driver, trpid, parser->printermake,
+			   db->idlist)) {
+	if (debug2) fprintf(stderr,
+			    "  Option does not apply according to index!\n");
+	countstat(STATS_OPTSKIPPED, 1);
+	continue;
+      }
+      if (jobs.numentries >= jobs.sizeentries) {
+	jobs.sizeentries = (jobs.sizeentries ? jobs.sizeentries * 2 : 64);
+	jobs.entries =
+	  (optindex_t **)realloc(jobs.entries,
+				 sizeof(optindex_t *) * jobs.sizeentries);
+	if (jobs.entries == NULL) {
+	  fprintf(stderr, "Out of memory!\n");
+	  exit(1);
+	}
+      }
+      jobs.entries[jobs.numentries ++] = optentry;
+    }
+
+    /* The candidate files are parsed and evaluated by the threads, or
+       here, one after the other. Their results stay in the option index,
+       so the output has the order of the option index in any case */
+    if ((db->numthreads > 1) && (jobs.numentries > 1)) {
+      numthreads = (db->numthreads < jobs.numentries ?
+		    db->numthreads : jobs.numentries);
+      pthread_mutex_init(&(jobs.lock), NULL);
+      threads = (pthread_t *)malloc(sizeof(pthread_t) * numthreads);
+      if (threads == NULL) {
+	fprintf(stderr, "Out of memory!\n");
+	exit(1);
+      }
+      for (i = 0; i < numthreads; i ++)
+	if (pthread_create(threads + i, NULL, optthread, &jobs) != 0) {
+	  fprintf(stderr, "Cannot start thread!\n");
+	  exit(1);
+	}
+      for (i = 0; i < numthreads; i ++)
+	pthread_join(threads[i], NULL);
+      free(threads);
+      pthread_mutex_destroy(&(jobs.lock));
+    } else {
+      for (i = 0; i < jobs.numentries; i ++)
+	if (evaloptionfile(&jobs, parser, jobs.entries[i]) < 0) {
+	  jobs.failed = i;
+	  break;
+	}
+    }
+    if (jobs.failed >= 0) {
+      fprintf(stderr,
+	      "Option file %s/db/source/opt/%s corrupted, missing, or not readable!\n",
+	      db->libdir, jobs.entries[jobs.failed]->name);
+      free(jobs.entries);
+      freecombo(db);
+      return -1;
+    }
+    free(jobs.entries);
+    endphase(STATS_OPTIONS, &phasestart);
+  }
+
+  /* Output the result */
+  db->driverfile = driverfile;
+  if (out == NULL) return 0;
+  if (debug) fprintf(stderr, "Putting out result!\n");
+  if (batch) {
+    length = strlen("<foomatic>\n") + spanslength(printerfile) +
+      spanslength(driverfile) + strlen("\n<options>\n") +
+      strlen("</options>\n</foomatic>\n");
+    for (optentry = db->optindex; optentry;
+	 optentry = (optindex_t *)(optentry->next))
+      length += spanslength(&(optentry->file));
+    fprintf(out, "COMBO %s,%s %d\n", comboid, driver, length);
+  }
+  fprintf(out, "<foomatic>\n");
+  writespans(out, printerfile);
+  writespans(out, driverfile);
+  fprintf(out, "\n<options>\n");
+  for (optentry = db->optindex; optentry;
+       optentry = (optindex_t *)(optentry->next))
+    writespans(out, &(optentry->file));
+  fprintf(out, "</options>\n</foomatic>\n");
+  endphase(STATS_OUTPUT, &phasestart);
+
+  freecombo(db);
+  return 0;
+}
+
+/*
+ * function to read a number of the overview cache file, it is followed by
+ * a space
+ */
+
+int  /* O - 1: number read, 0: format error */
+readcachenumber(char **scan,   /* I/O - Position in the cache data */
+		long *value) { /* O - Number */
+  char *end;
+
+  *value = strtol(*scan, &end, 10);
+  if ((end == *scan) || (*end != ' ')) return 0;
+  *scan = end + 1;
+  return 1;
+}
+
+/*
+ * function to read a string of the overview cache file, "<length>:<data> "
+ * or "-: " for NULL. The space after the data gets replaced by a zero
+ * byte, so that the string can be used in place.
+ */
+
+int  /* O - 1: string read, 0: format error */
+readcachestring(char **scan,     /* I/O - Position in the cache data */
+		const char *end, /* I - End of the cache data */
+		char **str,      /* O - String, NULL if NULL */
+		int *length) {   /* O - Length of the string or NULL */
+  char *t;
+  long l;
+
+  if (strncmp(*scan, "-: ", 3) == 0) {
+    *str = NULL;
+    if (length) *length = 0;
+    *scan += 3;
+    return 1;
+  }
+  l = strtol(*scan, &t, 10);
+  if ((t == *scan) || (*t != ':') || (l < 0) || (end - (t + 1) <= l) ||
+      (t[l + 1] != ' '))
+    return 0;
+  *str = t + 1;
+  (*str)[l] = '\0';
+  if (length) *length = (int)l;
+  *scan = t + l + 2;
+  return 1;
+}
+
+/*
+ * function to write a string to the overview cache file, see
+ * readcachestring()
+ */
+
+void
+writecachestring(FILE *out,       /* I - Cache file */
+		 const char *s) { /* I - String or NULL */
+  if (s == NULL)
+    fprintf(out, "-: ");
+  else
+    fprintf(out, "%d:%s ", (int)strlen(s), s);
+}
+
+/*
+ * function to compare two overview cache entries by their file names,
+ * for qsort() and bsearch()
+ */
+
+int  /* O - Result of strcmp() on the file names */
+compareovcacheentries(const void *a,   /* I - First entry */
+		      const void *b) { /* I - Second entry */
+  return strcmp(((const ovcacheentry_t *)a)->filename,
+		((const ovcacheentry_t *)b)->filename);
+}
+
+/*
+ * function to parse the overview cache file. It consists of lines
+ *
+ *   M <overview mode>
+ *   F <mtime> <size> <inode> <driverspos> <number of changes> <file name>
+ *     <printer ID> <entry> <output>
+ *   C <change type> <printer ID> <driver> <functionality>
+ *   P <driver with command line prototype>
+ *
+ * after the header, all fields are followed by a space, the strings are
+ * written by writecachestring(). The "C" lines of a file follow its "F"
+ * line.
+ */
+
+int  /* O - 1: cache parsed, 0: format error or other overview mode */
+parseovcache(ovcache_t *cache,   /* I/O - Overview cache */
+	     const char *pid,    /* I - Overview mode, see parse() */
+	     int length) {       /* I - Length of the cache data */
+  char           *scan = cache->data;
+  const char     *end = cache->data + length;
+  char           *mode, *printer, *driver, *functionality;
+  ovcacheentry_t *entry = NULL;
+  combochange_t  *change;
+  long           values[5] = { 0, 0, 0, 0, 0 };
+  long           type;
+  int            i;
+
+  if ((length < (int)strlen(OVCACHE_HEADER)) ||
+      (strncmp(scan, OVCACHE_HEADER, strlen(OVCACHE_HEADER)) != 0))
+    return 0;
+  scan += strlen(OVCACHE_HEADER);
+  if ((strncmp(scan, "M ", 2) != 0) ||
+      ((scan += 2), !readcachestring(&scan, end, &mode, NULL)) ||
+      (*(scan ++) != '\n') ||
+      (strcmp(mode, (pid ? pid : "-")) != 0))
+    return 0;
+  while (scan < end) /* @CACHE_LINES */ {
+    if ((end - scan < 2) || (scan[1] != ' ')) return 0;
+    switch (*scan) {
+    case 'F':
+      if ((entry != NULL) && (entry->numchanges < (int)values[4]))
+	return 0;
+      scan += 2;
+      for (i = 0; i < 5; i ++)
+	if (!readcachenumber(&scan, values + i)) return 0;
+      if ((values[3] < 0) || (values[4] < 0)) return 0;
+      if (cache->numentries >= cache->sizeentries) {
+	cache->sizeentries = (cache->sizeentries ?
+			      cache->sizeentries * 2 : 256);
+	cache->entries =
+	  (ovcacheentry_t *)realloc(cache->entries, sizeof(ovcacheentry_t) *
+				    cache->sizeentries);
+	if (cache->entries == NULL) {
+	  fprintf(stderr, "Out of memory!\n");
+	  exit(1);
+	}
+      }
+      entry = cache->entries + cache->numentries;
+      cache->numentries ++;
+      memset(entry, 0, sizeof(ovcacheentry_t));
+      entry->mtime = values[0];
+      entry->size = values[1];
+      entry->inode = (unsigned long)values[2];
+      entry->driverspos = (int)values[3];
+      entry->changes =
+	(combochange_t *)poolalloc(&(cache->pool), sizeof(combochange_t) *
+				   (values[4] ? values[4] : 1));
+      if (!readcachestring(&scan, end, &(entry->filename), NULL) ||
+	  (entry->filename == NULL) ||
+	  !readcachestring(&scan, end, &(entry->printer), NULL) ||
+	  !readcachestring(&scan, end, &(entry->entry), NULL) ||
+	  !readcachestring(&scan, end, &(entry->output),
+			   &(entry->outputlength)))
+	return 0;
+      if ((entry->printer != NULL) &&
+	  ((entry->entry == NULL) ||
+	   (entry->driverspos > (int)strlen(entry->entry))))
+	return 0;
+      break;
+    case 'C':
+      if ((entry == NULL) || (entry->numchanges >= (int)values[4]))
+	return 0;
+      scan += 2;
+      if (!readcachenumber(&scan, &type) ||
+	  !readcachestring(&scan, end, &printer, NULL) ||
+	  !readcachestring(&scan, end, &driver, NULL) ||
+	  (driver == NULL) ||
+	  !readcachestring(&scan, end, &functionality, NULL))
+	return 0;
+      change = entry->changes + entry->numchanges;
+      entry->numchanges ++;
+      change->type = (int)type;
+      change->printer = printer;
+      change->driver = driver;
+      change->functionality = functionality;
+      break;
+    case 'P':
+      scan += 2;
+      if (!readcachestring(&scan, end, &driver, NULL) || (driver == NULL))
+	return 0;
+      addsetdriver(&(cache->pool), &(cache->protodrivers), driver);
+      break;
+    default:
+      return 0;
+    }
+    if ((scan >= end) || (*(scan ++) != '\n')) return 0;
+  } /* @CACHE_LINES X */
+  if ((entry != NULL) && (entry->numchanges < (int)values[4]))
+    return 0;
+  if (cache->numentries > 1)
+    qsort(cache->entries, cache->numentries, sizeof(ovcacheentry_t),
+	  compareovcacheentries);
+  return 1;
+}
+
+/*
+ * function to load the overview cache and to start the new one, which
+ * gets the entries of all files of this run
+ */
+
+ovcache_t  /* O - Overview cache, without entries if the file is
+	          missing, invalid, or for another overview mode */
+*loadovcache(const char *filename, /* I - Cache file name */
+	     const char *pid,      /* I - Overview mode, see parse() */
+	     int debug) {          /* I - Debug mode flag */
+  ovcache_t     *cache;
+  int           length = 0;
+
+  cache = (ovcache_t *)calloc(1, sizeof(ovcache_t));
+  if (cache == NULL) {
+    fprintf(stderr, "Out of memory!\n");
+    exit(1);
+  }
+  cache->filename = filename;
+  cache->now = time(NULL);
+  cache->data = loadfile(filename, &length);
+  if ((cache->data != NULL) && !parseovcache(cache, pid, length)) {
+    if (debug)
+      fprintf(stderr, "Overview cache %s invalid or for another mode!\n",
+	      filename);
+    free(cache->entries);
+    cache->entries = NULL;
+    cache->numentries = 0;
+    cache->sizeentries = 0;
+    free(cache->protodrivers.buckets);
+    memset(&(cache->protodrivers), 0, sizeof(driverset_t));
+    freepool(&(cache->pool));
+  }
+  if (debug)
+    fprintf(stderr, "Overview cache %s: %d files\n", filename,
+	    cache->numentries);
+
+  /* The new cache is written to a temporary file which replaces the old
+     one when the overview is complete */
+  snprintf(cache->tmpfilename, sizeof(cache->tmpfilename), "%s.%d",
+	   filename, (int)getpid());
+  cache->out = fopen(cache->tmpfilename, "w");
+  if (cache->out == NULL) {
+    if (debug)
+      fprintf(stderr, "Cannot write overview cache %s!\n",
+	      cache->tmpfilename);
+  } else {
+    fprintf(cache->out, "%sM ", OVCACHE_HEADER);
+    writecachestring(cache->out, (pid ? pid : "-"));
+    fprintf(cache->out, "\n");
+  }
+  return cache;
+}
+
+/*
+ * function to find the cache entry of an overview file, the file must
+ * not have changed since the entry was written. For the printer files of
+ * the CUPS overview the drivers of the entry must have the same command
+ * line prototype status as then.
+ */
+
+const ovcacheentry_t  /* O - Cache entry, NULL: file must be parsed */
+*findovcache(const ovcache_t *cache,     /* I - Overview cache */
+	     const ovfile_t *ovfile,     /* I - Overview file */
+	     const driverset_t *protodrivers) { /* I - Drivers with command
+						   line prototype, NULL for
+						   the driver files */
+  ovcacheentry_t key;
+  const ovcacheentry_t *entry;
+  const combochange_t  *change;
+  int           i;
+
+  if ((cache->numentries == 0) || (ovfile->mtime < 0)) return NULL;
+  key.filename = (char *)ovfile->filename;
+  entry = (const ovcacheentry_t *)bsearch(&key, cache->entries,
+					  cache->numentries,
+					  sizeof(ovcacheentry_t),
+					  compareovcacheentries);
+  if ((entry == NULL) || (entry->mtime != ovfile->mtime) ||
+      (entry->size != ovfile->size) || (entry->inode != ovfile->inode))
+    return NULL;
+  if (protodrivers != NULL)
+    for (i = 0; i < entry->numchanges; i ++) {
+      change = entry->changes + i;
+      if (((change->type == COMBO_ADD_DRIVER) ||
+	   (change->type == COMBO_REMOVE_DRIVER)) &&
+	  ((findsetdriver(protodrivers, change->driver) == NULL) !=
+	   (findsetdriver(&(cache->protodrivers), change->driver) == NULL)))
+	return NULL;
+    }
+  return entry;
+}
+
+/*
+ * function to set up an overview file from its cache entry, as if it
+ * was parsed
+ */
+
+void
+cachedovfile(ovfile_t *ovfile) { /* I/O - Overview file */
+  const ovcacheentry_t *entry = (const ovcacheentry_t *)ovfile->cached;
+  const combochange_t  *change;
+  int           i;
+
+  for (i = 0; i < entry->numchanges; i ++) {
+    change = entry->changes + i;
+    addcombochange(ovfile, change->type, change->printer, change->driver,
+		   change->functionality);
+  }
+  if (entry->printer != NULL) {
+    ovfile->printer = strdup(entry->printer);
+    ovfile->entry = strdup(entry->entry);
+    ovfile->driverspos = entry->driverspos;
+  }
+  if (entry->output != NULL) {
+    ovfile->file.data = (char *)malloc(entry->outputlength + 1);
+    if (ovfile->file.data == NULL) {
+      fprintf(stderr, "Out of memory!\n");
+      exit(1);
+    }
+    memcpy(ovfile->file.data, entry->output, entry->outputlength);
+    ovfile->file.length = entry->outputlength;
+    ovfile->file.mapped = 0;
+    initspans(&(ovfile->file));
+  }
+  ovfile->status = 1;
+}
+
+/*
+ * function to write the cache entry of an overview file which is parsed
+ * or taken from the cache, before its changes get applied. Files modified
+ * since the start of the program are left out, they could be modified
+ * again without changing their modification time.
+ */
+
+void
+writeovcache(ovcache_t *cache,         /* I/O - Overview cache */
+	     const ovfile_t *ovfile) { /* I - Overview file */
+  const combochange_t *change;
+  int           i;
+
+  if ((cache->out == NULL) || (ovfile->mtime < 0) ||
+      (ovfile->mtime >= (long)cache->now))
+    return;
+  fprintf(cache->out, "F %ld %ld %lu %d %d ", ovfile->mtime, ovfile->size,
+	  ovfile->inode, (ovfile->printer ? ovfile->driverspos : 0),
+	  ovfile->numchanges);
+  writecachestring(cache->out, ovfile->filename);
+  writecachestring(cache->out, ovfile->printer);
+  writecachestring(cache->out, (ovfile->printer ? ovfile->entry : NULL));
+  if (ovfile->file.spans == NULL)
+    fprintf(cache->out, "-: ");
+  else {
+    fprintf(cache->out, "%d:", spanslength(&(ovfile->file)));
+    writespans(cache->out, &(ovfile->file));
+    fprintf(cache->out, " ");
+  }
+  fprintf(cache->out, "\n");
+  for (i = 0; i < ovfile->numchanges; i ++) {
+    change = ovfile->changes + i;
+    fprintf(cache->out, "C %d ", change->type);
+    writecachestring(cache->out, change->printer);
+    writecachestring(cache->out, change->driver);
+    writecachestring(cache->out, change->functionality);
+    fprintf(cache->out, "\n");
+  }
+}
+
+/*
+ * function to write the set of drivers with command line prototype to
+ * the overview cache, after the driver files
+ */
+
+void
+writeovcacheproto(ovcache_t *cache,               /* I/O - Overview
+						     cache */
+		  const driverset_t *protodrivers) { /* I - Drivers with
+							command line
+							prototype */
+  const driverlist_t *dlistpointer;
+  unsigned int  i;
+
+  if (cache->out == NULL) return;
+  for (i = 0; i < protodrivers->numbuckets; i ++)
+    for (dlistpointer = protodrivers->buckets[i]; dlistpointer;
+	 dlistpointer = (const driverlist_t *)(dlistpointer->next)) {
+      fprintf(cache->out, "P ");
+      writecachestring(cache->out, dlistpointer->name);
+      fprintf(cache->out, "\n");
+    }
+}
+
+/*
+ * function to complete the new overview cache, it replaces the old one,
+ * and to free the cache
+ */
+
+void
+closeovcache(ovcache_t *cache, /* I - Overview cache */
+	     int discard,      /* I - 1: the overview failed, do not replace
+				  the cache file */
+	     int debug) {      /* I - Debug mode flag */
+  int           ok;
+
+  if (cache->out != NULL) {
+    ok = !discard && !ferror(cache->out);
+    if (fclose(cache->out) != 0) ok = 0;
+    if (!ok || (rename(cache->tmpfilename, cache->filename) != 0)) {
+      if (debug)
+	fprintf(stderr, "Cannot write overview cache %s!\n",
+		cache->filename);
+      unlink(cache->tmpfilename);
+    }
+  }
+  free(cache->data);
+  free(cache->entries);
+  free(cache->protodrivers.buckets);
+  freepool(&(cache->pool));
+  free(cache);
+}
+
+/*
+ * function to compare two overview files by their names, for qsort()
+ */
+
+int  /* O - Result of strcmp() on the file names */
+compareovfiles(const void *a,   /* I - First file */
+	       const void *b) { /* I - Second file */
+  return strcmp(((const ovfile_t *)a)->filename,
+		((const ovfile_t *)b)->filename);
+}
+
+/*
+ * function to load and parse an overview file, called by the threads
+ * and, without "-j", by overviewfiles() itself
+ */
+
+int  /* O - 1: file parsed, -1: file not readable or not valid XML */
+parseovfile(ovjobs_t *jobs,     /* I - Files and their common data */
+	    parser_t *parser,   /* I/O - Parser of the thread */
+	    ovfile_t *ovfile) { /* I/O - File to parse */
+  int           nopjl = 0;
+
+  if (!loadxmlfile(&(ovfile->file), ovfile->filename))
+    return -1;
+  if (jobs->debug) fprintf(stderr, "  %s file loaded!\n",
+			   (jobs->operation == PARSE_OP_OV_DRIVER ?
+			    "Driver" : "Printer"));
+  /* process it, for a printer file the output becomes the overview
+     entry */
+  if (parse(parser, &(ovfile->file), jobs->pid, NULL, ovfile->filename,
+	    ovfile, jobs->operation, jobs->defaultsettings,
+	    jobs->num_defaultsettings, &nopjl, jobs->idlist, NULL, NULL,
+	    jobs->debug2) < 0)
+    return -1;
+  return 1;
+}
+
+/*
+ * function run by the threads parsing the overview files, they take the
+ * files in the order of their names, but stay at most "window" files
+ * ahead of the output
+ */
+
+void  /* O - Always NULL */
+*ovthread(void *arg) { /* I - Files and their common data (ovjobs_t) */
+  ovjobs_t      *jobs = (ovjobs_t *)arg;
+  parser_t      parser;
+  int           i, status;
+
+  initparser(&parser);
+  for (;;) {
+    pthread_mutex_lock(&(jobs->lock));
+    while ((jobs->next < jobs->numfiles) &&
+	   (jobs->next >= jobs->written + jobs->window))
+      pthread_cond_wait(&(jobs->cond), &(jobs->lock));
+    i = jobs->next;
+    if (i < jobs->numfiles) jobs->next ++;
+    pthread_mutex_unlock(&(jobs->lock));
+    if (i >= jobs->numfiles) break;
+    /* Files from the overview cache are set up by overviewfiles() */
+    if (jobs->files[i].cached != NULL) continue;
+    status = parseovfile(jobs, &parser, jobs->files + i);
+    pthread_mutex_lock(&(jobs->lock));
+    jobs->files[i].status = status;
+    pthread_cond_broadcast(&(jobs->cond));
+    pthread_mutex_unlock(&(jobs->lock));
+  }
+  freeparser(&parser);
+  return NULL;
+}
+
+/*
+ * function to process all driver or all printer XML files for the
+ * overview. The files are processed in the order of their names, so that
+ * the output does not depend on the order of the directory entries nor
+ * on the number of threads.
+ */
+
+int  /* O - 0: all files put out, -1: a file is not readable or not valid
+	XML (error message issued, the output is incomplete) */
+overviewfiles(FILE *out,                /* I - Output stream */
+	      overview_t *overview,     /* I/O - Printer/driver combos */
+	      const char *dirname,      /* I - Directory with the files */
+	      int operation,            /* I - PARSE_OP_OV_DRIVER or
+					   PARSE_OP_OV_PRINTER */
+	      const char *pid,          /* I - Overview mode, see parse() */
+	      const char **defaultsettings, /* I - Default option
+					       settings */
+	      int num_defaultsettings,  /* I - Number of default option
+					   settings */
+	      idlist_t *idlist,         /* I - ID translation table */
+	      int numthreads,           /* I - Number of threads, 1: do not
+					   start threads */
+	      ovcache_t *cache,         /* I/O - Overview cache, NULL: none */
+	      int debug,                /* I - Debug flag */
+	      int debug2) {             /* I - Debug flag for parse() */
+  ovjobs_t      jobs;
+  ovfile_t      *ovfile;
+  parser_t      parser;         /* Parser when there are no threads */
+  DIR           *dir;
+  struct dirent *direntry;
+  struct stat   st;
+  pthread_t     *threads = NULL;
+  int           sizefiles = 0;
+  int           numcached = 0;
+  int           status = 0;
+  int           i, l;
+
+  memset(&jobs, 0, sizeof(ovjobs_t));
+  jobs.operation = operation;
+  jobs.pid = pid;
+  jobs.defaultsettings = defaultsettings;
+  jobs.num_defaultsettings = num_defaultsettings;
+  jobs.idlist = idlist;
+  jobs.debug = debug;
+  jobs.debug2 = debug2;
+
+  /* Read the names of all XML files in the directory */
+  dir = opendir(dirname);
+  if (dir == NULL) {
+    fprintf(stderr, "Cannot read directory %s!\n", dirname);
+    exit(1);
+  }
+  while((direntry = readdir(dir)) != NULL) {
+    l = strlen(direntry->d_name);
+    if ((l < 4) || (strcmp(direntry->d_name + l - 4, ".xml") != 0))
+      continue;
+    if (jobs.numfiles >= sizefiles) {
+      sizefiles = (sizefiles ? sizefiles * 2 : 256);
+      jobs.files = (ovfile_t *)realloc(jobs.files,
+				       sizeof(ovfile_t) * sizefiles);
+      if (jobs.files == NULL) {
+	fprintf(stderr, "Out of memory!\n");
+	exit(1);
+      }
+    }
+    ovfile = jobs.files + jobs.numfiles;
+    memset(ovfile, 0, sizeof(ovfile_t));
+    snprintf(ovfile->filename, sizeof(ovfile->filename), "%s/%s",
+	     dirname, direntry->d_name);
+    ovfile->protodrivers = &(overview->protodrivers);
+    jobs.numfiles ++;
+  }
+  closedir(dir);
+  if (jobs.numfiles > 1)
+    qsort(jobs.files, jobs.numfiles, sizeof(ovfile_t), compareovfiles);
+
+  /* Files which did not change since they went into the overview cache
+     do not need to be parsed */
+  if (cache != NULL)
+    for (i = 0; i < jobs.numfiles; i ++) {
+      ovfile = jobs.files + i;
+      ovfile->mtime = -1;
+      if (stat(ovfile->filename, &st) != 0) continue;
+      ovfile->mtime = (long)st.st_mtime;
+      ovfile->size = (long)st.st_size;
+      ovfile->inode = (unsigned long)st.st_ino;
+      ovfile->cached =
+	(const struct ovcacheentry_t *)
+	findovcache(cache, ovfile, (operation == PARSE_OP_OV_PRINTER && pid ?
+				    &(overview->protodrivers) : NULL));
+      if (ovfile->cached != NULL) numcached ++;
+    }
+  if (debug && (cache != NULL))
+    fprintf(stderr, "%d of %d files taken from the overview cache\n",
+	    numcached, jobs.numfiles);
+
+  /* Start the threads, they parse the files while this thread applies
+     the changes of the combos and puts out the files in order */
+  if ((numthreads > 1) && (jobs.numfiles > 1)) {
+    jobs.window = OVERVIEW_WINDOW * numthreads;
+    pthread_mutex_init(&(jobs.lock), NULL);
+    pthread_cond_init(&(jobs.cond), NULL);
+    threads = (pthread_t *)malloc(sizeof(pthread_t) * numthreads);
+    if (threads == NULL) {
+      fprintf(stderr, "Out of memory!\n");
+      exit(1);
+    }
+    for (i = 0; i < numthreads; i ++)
+      if (pthread_create(threads + i, NULL, ovthread, &jobs) != 0) {
+	fprintf(stderr, "Cannot start thread!\n");
+	exit(1);
+      }
+  }
+  initparser(&parser);
+
+  for (i = 0; i < jobs.numfiles; i ++) {
+    ovfile = jobs.files + i;
+    if (debug) fprintf(stderr, "%s file: %s\n",
+		       (operation == PARSE_OP_OV_DRIVER ?
+			"Driver" : "Printer"), ovfile->filename);
+    if (ovfile->cached != NULL)
+      cachedovfile(ovfile);
+    else if (threads == NULL)
+      ovfile->status = parseovfile(&jobs, &parser, ovfile);
+    else {
+      pthread_mutex_lock(&(jobs.lock));
+      while (ovfile->status == 0)
+	pthread_cond_wait(&(jobs.cond), &(jobs.lock));
+      pthread_mutex_unlock(&(jobs.lock));
+    }
+    if (ovfile->status < 0) {
+      fprintf(stderr, "%s file %s corrupted, missing, or not readable!\n",
+	      (operation == PARSE_OP_OV_DRIVER ? "Driver" : "Printer"),
+	      ovfile->filename);
+      /* The threads stop taking files, the ones they parsed ahead get
+	 freed below */
+      if (threads != NULL) {
+	pthread_mutex_lock(&(jobs.lock));
+	jobs.next = jobs.numfiles;
+	pthread_cond_broadcast(&(jobs.cond));
+	pthread_mutex_unlock(&(jobs.lock));
+      }
+      status = -1;
+      break;
+    }
+    if (cache != NULL) writeovcache(cache, ovfile);
+    applycombochanges(overview, ovfile, operation == PARSE_OP_OV_DRIVER,
+		      idlist, debug2);
+    /* put it out */
+    if (ovfile->file.spans != NULL) {
+      writespans(out, &(ovfile->file));
+      if (operation == PARSE_OP_OV_DRIVER) fprintf(out, "\n");
+    }
+    /* Delete the file from memory */
+    freeovfile(ovfile);
+    if (threads != NULL) {
+      pthread_mutex_lock(&(jobs.lock));
+      jobs.written = i + 1;
+      pthread_cond_broadcast(&(jobs.cond));
+      pthread_mutex_unlock(&(jobs.lock));
+    }
+  }
+
+  if (threads != NULL) {
+    for (i = 0; i < numthreads; i ++)
+      pthread_join(threads[i], NULL);
+    free(threads);
+    pthread_mutex_destroy(&(jobs.lock));
+    pthread_cond_destroy(&(jobs.cond));
+  }
+  for (; i < jobs.numfiles; i ++)
+    freeovfile(jobs.files + i);
+  freeparser(&parser);
+  free(jobs.files);
+  return status;
+}
+
+/*
+ * function to compute the XML file for the printer overview list and to
+ * put it out
+ */
+
+int  /* O - 0: overview put out, -1: a database file is not readable or
+	not valid XML (error message issued, the output is incomplete) */
+overviewxml(FILE *out,           /* I - Output stream */
+	    database_t *db,      /* I - Database */
+	    int overview,        /* I - 1: overview ("-O"), 2: overview for
+				    the CUPS PPD list ("-C") */
+	    int noreadymadeppds, /* I - 1: suppress combos with ready-made
+				    PPD files ("-n") */
+	    const char *cachefilename, /* I - Overview cache file, NULL:
+					  none */
+	    int debug) {         /* I - Debug level */
+  int           i;
+  char          *t;
+  const char    *make, *model;  /* For the printers without XML file */
+  const char    *pid;           /* Overview mode, see parse() */
+  char          printerdirname[1024]; /* Name of the directory with the XML
+					 files for the printers */
+  char          driverdirname[1024];  /* Name of the directory with the XML
+					 files for the drivers */
+  int           debug2 = (debug > 1);
+  int           exceptionfound = 0;
+  overview_t    overviewcombos; /* Printer/driver combos for the overview */
+  printerlist_t *plistpointer;  /* pointers to navigate through the 
+				   printer */
+  driverlist_t  *dlistpointer;  /* list for the overview */
+  ovcache_t     *cache = NULL;  /* Overview cache */
+  statsclock_t  phasestart; /* Start of the current phase ("--stats") */
+
+  /* The snapshot has the overviews ready */
+  startphase(&phasestart);
+  if (db->snapshot != NULL) {
+    i = (overview == 2 ? (noreadymadeppds ? 2 : 1) : 0);
+    fwrite(db->snapshot->strings + db->snapshot->header->overviews[i], 1,
+	   db->snapshot->header->overviewlengths[i], out);
+    endphase(STATS_OUTPUT, &phasestart);
+    return 0;
+  }
+
+  /* Set file/dir names */
+
+  sprintf(driverdirname, "%s/db/source/driver",
+	  db->libdir);
+  sprintf(printerdirname, "%s/db/source/printer",
+	  db->libdir);
+
+  /* Mark overview mode */
+  if (overview == 2)
+    if (noreadymadeppds)
+      pid = "c";
+    else
+      pid = "C";
+  else
+    pid = NULL;
+
+  /* The printer/driver combos are collected while reading the driver
+     files, together with the set of drivers with a command line
+     prototype, so we can determine which printer/driver combos provide
+     PPD files. */
+  memset(&overviewcombos, 0, sizeof(overview_t));
+
+  /* With the overview cache only the files which changed get parsed */
+  if (cachefilename != NULL)
+    cache = loadovcache(cachefilename, pid, debug);
+
+  fprintf(out, "<overview>\n");
+
+  /* Search the Foomatic driver directory and read all xml files found
+     there. Read out the printers which the driver supports and add them
+     to the printer's driver list */
+  
+  if (overviewfiles(out, &overviewcombos, driverdirname, PARSE_OP_OV_DRIVER,
+		    pid, db->defaultsettings, db->num_defaultsettings,
+		    db->idlist, db->numthreads, cache, debug, debug2) < 0) {
+    if (cache != NULL) closeovcache(cache, 1, debug);
+    freeoverview(&overviewcombos);
+    return -1;
+  }
+  if (cache != NULL)
+    writeovcacheproto(cache, &(overviewcombos.protodrivers));
+  endphase(STATS_DRIVER, &phasestart);
+
+  if (debug) {
+    for (i = 0; i < overviewcombos.numprinters; i ++) {
+      plistpointer = overviewcombos.printers[i];
+      if (plistpointer->removed) continue;
+      fprintf(stderr, "Printer: %s\n", plistpointer->id);
+      dlistpointer = plistpointer->drivers;
+      while (dlistpointer) {
+	fprintf(stderr, "   Driver: %s\n", dlistpointer->name);
+	if (dlistpointer->functionality != NULL)
+	  fprintf(stderr, "    %s\n", dlistpointer->functionality);
+	dlistpointer = (driverlist_t *)(dlistpointer->next);
+      }
+    }
+  }
+
+  /* Search the Foomatic printer directory and read all xml files found
+     there. Read out the printer info and build the printer entries for the
+     overview with the printer/driver combo list obtained before */
+
+  if (overviewfiles(out, &overviewcombos, printerdirname,
+		    PARSE_OP_OV_PRINTER, pid,
+		    db->defaultsettings, db->num_defaultsettings,
+		    db->idlist, db->numthreads, cache, debug, debug2) < 0) {
+    if (cache != NULL) closeovcache(cache, 1, debug);
+    freeoverview(&overviewcombos);
+    return -1;
+  }
+  endphase(STATS_PRINTER, &phasestart);
+
+  if (debug) {
+    for (i = 0; i < overviewcombos.numprinters; i ++) {
+      plistpointer = overviewcombos.printers[i];
+      if (plistpointer->removed) continue;
+      fprintf(stderr, "Printer: %s\n", plistpointer->id);
+      dlistpointer = plistpointer->drivers;
+      while (dlistpointer) {
+	fprintf(stderr, "   Driver: %s\n", dlistpointer->name);
+	if (dlistpointer->functionality != NULL)
+	  fprintf(stderr, "    %s\n", dlistpointer->functionality);
+	dlistpointer = (driverlist_t *)(dlistpointer->next);
+      }
+    }
+  }
+
+  /* Now show all printers which are only mentioned in the lists of
+     supported prnters of the drivers and which not have a Foomatic
+     printer XML entry. */
+  for (i = 0; i < overviewcombos.numprinters; i ++) {
+    plistpointer = overviewcombos.printers[i];
+    if (!plistpointer->removed) {
+      if (debug) fprintf(stderr, "    Printer only mentioned in driver XML files:\n      Printer ID: |%s|\n",
+			 plistpointer->id);
+      /*strcpy(plistpointer->id, translateid(plistpointer->id, idlist));*/
+      fprintf(out, "  <printer>\n    <id>");
+      fprintf(out, "%s", plistpointer->id);
+      make = plistpointer->id;
+      model = strchr(make, '-');
+      if (model) {
+	t = (char *)model;
+	*t = '\0';
+	model ++;
+      } else { 
+	model = "Unknown model";
+      }
+      t = (char *)make;
+      while (*t) {
+	if (*t == '_') *t = ' ';
+	t ++;
+      }
+      t = (char *)model;
+      while (*t) {
+	if (*t == '_') *t = ' ';
+	t ++;
+      }
+      fprintf(out, "</id>\n    <make>");
+      fprintf(out, "%s", make);
+      fprintf(out, "</make>\n    <model>");
+      fprintf(out, "%s", model);
+      fprintf(out, "</model>\n    <noxmlentry />\n");
+      dlistpointer = plistpointer->drivers;
+      exceptionfound = 0;
+      if (dlistpointer) {
+	fprintf(out, "    <drivers>\n");
+	while (dlistpointer) {
+	  if (dlistpointer->name) {
+	    fprintf(out, "      <driver>");
+	    fprintf(out, "%s", dlistpointer->name);
+	    fprintf(out, "</driver>\n");
+	    if (dlistpointer->functionality != NULL) exceptionfound = 1;
 	  }
+	  dlistpointer = (driverlist_t *)(dlistpointer->next);
 	}
+	fprintf(out, "    </drivers>\n");
       }
-      break;
-    default:
-      /* other characters */
-      if ((intag) && (!incomment)) {
-	if (*scan == '\'') insinglequotes = 1 - insinglequotes;
-	if (*scan == '\"') indoublequotes = 1 - indoublequotes;
-	if ((insinglequotes) || (indoublequotes)) inquotes = 1;
-	else inquotes = 0; 
-	if (!incomment) {
-	  if (!intagword) {
-	    intagword = 1;
-	    tagwordstart = scan;
+      if (exceptionfound) {
+	fprintf(out, "    <driverfunctionalityexceptions>\n");
+	dlistpointer = plistpointer->drivers;
+	while (dlistpointer) {
+	  if ((dlistpointer->functionality != NULL) &&
+	      (dlistpointer->name != NULL)) {
+	    fprintf(out, "      <driverfunctionalityexception>\n");
+	    fprintf(out, "        <driver>");
+	    fprintf(out, "%s", dlistpointer->name);
+	    fprintf(out, "</driver>\n");
+	    fprintf(out, "%s", dlistpointer->functionality);
+	    fprintf(out, "\n      </driverfunctionalityexception>\n");
 	  }
+	  dlistpointer = (driverlist_t *)(dlistpointer->next);
 	}
+	fprintf(out, "    </driverfunctionalityexceptions>\n");
       }
+      fprintf(out, "  </printer>\n");
     }
   }
-  if (debug) fprintf(stderr, 
-		     "    XML tag nesting level: %d\n",nestinglevel);
-  if (debug) fprintf(stderr, "    Lines of input: %d\n", linecount);
-  switch (+operation) /* *OPERATION */
-  { 
-	  case /* *OPERATION */ (+PARSE_OP_PRINTER): { /* Printer XML file */
-    if ((make[0] == 0) || (model[0] == 0)) /* ?NO_MODEL Y */ {
-      /* <make> or <model> tag not found */
-      fprintf(stderr, "Could not determine manufacturer or model name from the printer file %s!\n",
-	      filename);
+
+  fprintf(out, "</overview>\n");
+
+  if (cache != NULL) closeovcache(cache, 0, debug);
+  freeoverview(&overviewcombos);
+  endphase(STATS_OUTPUT, &phasestart);
+  return 0;
+}
+
+/*
+ * function to store data in the string area of a snapshot being
+ * compiled, a zero byte is appended
+ */
+
+unsigned int  /* O - Offset of the data in the string area */
+snapstore(snapwriter_t *writer, /* I/O - Snapshot being compiled */
+	  const char *data,     /* I - Data */
+	  int length) {         /* I - Length of the data */
+  unsigned int  offset = (unsigned int)writer->stringslength;
+
+  if (length > 0x7ffffff0 - writer->stringslength) {
+    fprintf(stderr, "Database too large for a snapshot!\n");
+    exit(1);
+  }
+  growdata(&(writer->strings), &(writer->sizestrings),
+	   writer->stringslength + length + 1);
+  memcpy(writer->strings + writer->stringslength, data, length);
+  writer->strings[writer->stringslength + length] = '\0';
+  writer->stringslength += length + 1;
+  return offset;
+}
+
+/*
+ * function to store a string in a snapshot being compiled, a string
+ * which is already stored is not stored again
+ */
+
+unsigned int  /* O - Offset of the string in the string area, 0 for NULL */
+snapintern(snapwriter_t *writer, /* I/O - Snapshot being compiled */
+	   const char *str) {    /* I - String */
+  unsigned int  *old, oldsize, i, h;
+
+  if (str == NULL) return 0;
+  if (2 * (writer->numinterned + 1) > writer->sizeinterned) {
+    /* Grow the hash table */
+    old = writer->interned;
+    oldsize = writer->sizeinterned;
+    writer->sizeinterned = (oldsize ? oldsize * 2 : 1024);
+    writer->interned =
+      (unsigned int *)calloc(writer->sizeinterned, sizeof(unsigned int));
+    if (writer->interned == NULL) {
+      fprintf(stderr, "Out of memory!\n");
       exit(1);
-    } /* ?NO_MODEL */
-    if (debug) fprintf(stderr, "    Driver in printer's driver list: %d\n", comboconfirmed); 
-  } break; 
-  case /* *OPERATION */ (+PARSE_OP_DRIVER): { /* Driver XML file */
-    if (debug) 
+    }
+    for (i = 0; i < oldsize; i ++) {
+      if (old[i] == 0) continue;
+      for (h = hashid(writer->strings + old[i]) &
+	     (writer->sizeinterned - 1);
+	   writer->interned[h]; h = (h + 1) & (writer->sizeinterned - 1));
+      writer->interned[h] = old[i];
+    }
+    free(old);
+  }
+  for (h = hashid(str) & (writer->sizeinterned - 1); writer->interned[h];
+       h = (h + 1) & (writer->sizeinterned - 1))
+    if (strcmp(writer->strings + writer->interned[h], str) == 0)
+      return writer->interned[h];
+  writer->interned[h] = snapstore(writer, str, strlen(str));
+  writer->numinterned ++;
+  return writer->interned[h];
+}
+
+/*
+ * function to add an entry to a table of a snapshot being compiled
+ */
+
+void  /* O - The new entry, all fields zero */
+*snapentry(void **table,       /* I/O - Table */
+	   int *numentries,    /* I/O - Number of entries */
+	   int *sizeentries,   /* I/O - Allocated entries */
+	   size_t entrysize) { /* I - Size of an entry */
+  char          *entry;
+
+  if (*numentries >= *sizeentries) {
+    *sizeentries = (*sizeentries ? *sizeentries * 2 : 256);
+    *table = realloc(*table, entrysize * *sizeentries);
+    if (*table == NULL) {
+      fprintf(stderr, "Out of memory!\n");
+      exit(1);
+    }
+  }
+  entry = (char *)*table + entrysize * *numentries;
+  (*numentries) ++;
+  memset(entry, 0, entrysize);
+  return entry;
+}
+
+/*
+ * function to compare two file names for qsort()
+ */
+
+int  /* O - Result of strcmp() on the names */
+comparenames(const void *a,   /* I - First name */
+	     const void *b) { /* I - Second name */
+  return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/*
+ * function to add the printer or driver XML files of a directory to a
+ * snapshot being compiled, sorted by their names for findsnapfile()
+ */
+
+void
+snapshotdir(snapwriter_t *writer, /* I/O - Snapshot being compiled */
+	    const char *dirname,  /* I - Directory with the files */
+	    int isdriver) {       /* I - 1: driver files, 0: printer files */
+  DIR           *dir;
+  struct dirent *direntry;
+  char          **names = NULL;
+  int           numnames = 0, sizenames = 0;
+  char          filename[1024];
+  xmlfile_t     file;
+  snapfile_t    *entry;
+  int           i, l;
+
+  dir = opendir(dirname);
+  if (dir == NULL) {
+    fprintf(stderr, "Cannot read directory %s!\n", dirname);
+    exit(1);
+  }
+  while((direntry = readdir(dir)) != NULL) {
+    l = strlen(direntry->d_name);
+    if ((l < 4) || (strcmp(direntry->d_name + l - 4, ".xml") != 0))
+      continue;
+    if (numnames >= sizenames) {
+      sizenames = (sizenames ? sizenames * 2 : 256);
+      names = (char **)realloc(names, sizeof(char *) * sizenames);
+      if (names == NULL) {
+	fprintf(stderr, "Out of memory!\n");
+	exit(1);
+      }
+    }
+    names[numnames] = eventstring(direntry->d_name);
+    names[numnames][l - 4] = '\0';
+    numnames ++;
+  }
+  closedir(dir);
+  if (numnames > 0)
+    qsort(names, numnames, sizeof(char *), comparenames);
+
+  /* Files which cannot be read are left out, combo() takes them as
+     missing */
+  for (i = 0; i < numnames; i ++) {
+    snprintf(filename, sizeof(filename), "%s/%s.xml", dirname, names[i]);
+    if (loadxmlfile(&file, filename)) {
+      if (isdriver)
+	entry = (snapfile_t *)snapentry((void **)&(writer->drivers),
+					&(writer->numdrivers),
+					&(writer->sizedrivers),
+					sizeof(snapfile_t));
+      else
+	entry = (snapfile_t *)snapentry((void **)&(writer->printers),
+					&(writer->numprinters),
+					&(writer->sizeprinters),
+					sizeof(snapfile_t));
+      entry->name = snapintern(writer, names[i]);
+      entry->data = snapstore(writer, file.data, file.length);
+      entry->length = (unsigned int)file.length;
+      freexmlfile(&file);
+    }
+    free(names[i]);
+  }
+  free(names);
+}
+
+/*
+ * function to compile the database into a snapshot ("-W"). The snapshot
+ * gets written to a temporary file and renamed, so that a server which
+ * reloads it sees either the old or the new snapshot.
+ */
+
+void
+compilesnapshot(database_t *db,       /* I - Database */
+		parser_t *parser,     /* I/O - Parser */
+		const char *filename, /* I - Snapshot file name */
+		int debug) {          /* I - Debug level */
+  snapwriter_t  writer;
+  snapheader_t  header;
+  snapoption_t  *option;
+  snapevent_t   *snapevent;
+  const optevent_t *event;
+  optindex_t    *optindex, *optentry;
+  optionmodel_t *model;
+  xmlfile_t     file;
+  FILE          *tmp, *out;
+  char          dirname[1024];
+  char          optionfilename[1024];
+  char          tmpfilename[1024];
+  snapidpair_t  idpair;
+  unsigned long offset;
+  long          length;
+  int           nopjl = 0;
+  int           debug2 = (debug > 1);
+  int           i, ok;
+
+  memset(&writer, 0, sizeof(snapwriter_t));
+  memset(&header, 0, sizeof(snapheader_t));
+  /* Offset 0 of the string area is NULL */
+  snapstore(&writer, "", 0);
+
+  /* The printer and driver files */
+  sprintf(dirname, "%s/db/source/printer", db->libdir);
+  snapshotdir(&writer, dirname, 0);
+  sprintf(dirname, "%s/db/source/driver", db->libdir);
+  snapshotdir(&writer, dirname, 1);
+
+  /* The option files in the order of the option index, with their keys
+     and their complete models, as built in batch mode */
+  sprintf(dirname, "%s/db/source/opt", db->libdir);
+  optindex = updateoptindex(dirname, db->optindexfilename,
+			    db->optindexsave, debug);
+  for (optentry = optindex; optentry;
+       optentry = (optindex_t *)(optentry->next)) {
+    sprintf(optionfilename, "%s/db/source/opt/%s", db->libdir,
+	    optentry->name);
+    if (!loadxmlfile(&file, optionfilename)) {
       fprintf(stderr,
-	      "    nopjl: %d (1: driver does not allow PJL options)\n",
-	      *nopjl);
-    if (printerentryfound != 0) /* ?PRINTER_ENTRY_FOUND Y */ 
-    { /* the printer is in the listing of the 
-				     driver */
-      comboconfirmed = 1;
-    } /* ?PRINTER_ENTRY_FOUND */ 
-    if (debug) fprintf(stderr, "    Printer in driver's printer list: %d\n", comboconfirmed); 
-  } break; 
-  case /* *OPERATION */ (+PARSE_OP_OPTION): { /* Option XML file */
-    if (debug) fprintf(stderr, "    Resulting option XML:\n%s\n", *data); 
-  } break;
-  case /* *OPERATION */ (+PARSE_OP_OV_DRIVER): 
-  { /* Driver XML file (Overview) */
-    if (pid && (driverhasproto == 0)) /* ?PID_NO_DRIVER Y */ {
-      /* We did not find a command line prototype, so
-	 this driver does not produce any PPD file, */
-      /* As we want to list only/printer/driver combos which produce
-	 a PPD file, renove the driver XML data from memory */
-      free((void *)(*data));
-      *data = NULL;
-      /* Delete all occurences of the driver in the
-	 printer/driver combo list */
-      plistpointer = *printerlist;
-      plistpreventry = NULL;
-      /* Go through all printers in the list */
-      while (plistpointer != NULL) /* @P_LIST_POINTER */ {
-	/* Search for the driver */
-	dlistpointer = plistpointer->drivers;
-	dlistpreventry = NULL;
-	while 
-	((dlistpointer != NULL) && (strcasecmp(dlistpointer->name, cdriver))) 
-	/* @FIND_DRIVER */ {
-	  dlistpreventry = dlistpointer;
-	  dlistpointer =
-	    (driverlist_t *)(dlistpointer->next);
-	} /* @FIND_DRIVER X */
-	if (dlistpointer != NULL) /* ?D_LIST_POINTER Y */ {
-	  /* Delete it */
-	  dlistnextentry =
-	    (driverlist_t *)(dlistpointer->next);
-	  free(dlistpointer);
-	  if (dlistpreventry != NULL)
-	    dlistpreventry->next = 
-	      (struct driverlist_t *)dlistnextentry;
-	  else
-	    plistpointer->drivers = dlistnextentry;
-	} /* ?D_LIST_POINTER */
-	/* Next printer */
-	plistpreventry = plistpointer;
-	plistpointer =
-	  (printerlist_t *)(plistpointer->next);
-      } /* @P_LIST_POINTER X */
-      if (debug)
-	fprintf(stderr, "    Driver entry does not produce PPDs!\n");
-    } /* ?PID_NO_DRIVER */ 
-  } break; 
-  case /* *OPERATION */ (+PARSE_OP_OV_PRINTER):
-  { /* Printer XML file (Overview) */
-    /* Remove the printer input data */
-    **data = '\0';
-    /* Build the printer entry for the overview in the memory which was used
-       for the former input data, the overview entry is always shorter than
-       the original printer XML file. */
-    if (debug) fprintf(stderr, "    Data for this printer entry in the overview:\n      Printer ID: |%s|\n      Make: |%s|\n      Model: |%s|\n      Functionality: |%s|\n      Rec. driver: |%s|\n      Auto detect entry: |%s|\n",
-	    cprinter, cmake, cmodel, cfunctionality, cdriver,cautodetectentry);
-    if ((cprinter[0]) && (cmake[0]) && (cmodel[0]) && (cfunctionality[0])) 
-    /* ?PRINTER_ENTRY Y */ {
-      strcpy(cprinter, translateid(cprinter, idlist));
-      strcat((char *)(*data), "  <printer>\n    <id>");
-      strcat((char *)(*data), cprinter);
-      strcat((char *)(*data), "</id>\n    <make>");
-      strcat((char *)(*data), cmake);
-      strcat((char *)(*data), "</make>\n    <model>");
-      strcat((char *)(*data), cmodel);
-      strcat((char *)(*data), "</model>\n    <functionality>");
-      strcat((char *)(*data), cfunctionality);
-      strcat((char *)(*data), "</functionality>\n");
-      if (cunverified) /* ?UNVERIFIED Y */ {
-	strcat((char *)(*data), "    <unverified>");
-	strcat((char *)(*data), cfunctionality);
-	strcat((char *)(*data), "</unverified>\n");
-      } /* ?UNVERIFIED */
-      if (cdriver[0]) /* ?DRIVER Y */ {
-	strcat((char *)(*data), "    <driver>");
-	strcat((char *)(*data), cdriver);
-	strcat((char *)(*data), "</driver>\n");
-      } /* ?DRIVER */
-      if (cautodetectentry[0]) /* ?AUTO_DETECT_ENTRY Y */ {
-	strcat((char *)(*data), "    ");
-	strcat((char *)(*data), cautodetectentry);
-      } /* ?AUTO_DETECT_ENTRY */ 
-      plistpointer = *printerlist;
-      plistpreventry = NULL;
-      while ((plistpointer) &&
-             (strcmp(plistpointer->id, cprinter) != 0)) /* @LOCATE_CPRINTER */ {
-	plistpreventry = plistpointer;
-	plistpointer = (printerlist_t *)(plistpointer->next);
-      } /* @LOCATE_CPRINTER X */
-      if (plistpointer) /* ?P_LIST_POINTER Y */ {
-	strcat((char *)(*data), "\n    <drivers>\n");
-	dlistpointer = plistpointer->drivers;
-	exceptionfound = 0;
-	while (dlistpointer) /* @D_LIST_POINTER */ {
-	  strcat((char *)(*data), "      <driver>");
-	  strcat((char *)(*data), dlistpointer->name);
-	  strcat((char *)(*data), "</driver>\n");
-	  if (dlistpointer->functionality != NULL) exceptionfound = 1;
-	  dlistpointer = (driverlist_t *)(dlistpointer->next);
-	} /* @D_LIST_POINTER X */
-	strcat((char *)(*data), "    </drivers>\n");
-	if (exceptionfound) /* ?EXCEPTION_FOUND Y */ {
-	  strcat((char *)(*data), "    <driverfunctionalityexceptions>\n");
-	  dlistpointer = plistpointer->drivers;
-	  while (dlistpointer) /* @D_LIST_POINTER */ { 
-	    if ((dlistpointer->name != NULL) &&
-		(dlistpointer->functionality != NULL)) /* ?D_LIST_PTR_FUNCT Y */ {
-	      strcat((char *)(*data),
-		     "      <driverfunctionalityexception>\n");
-	      strcat((char *)(*data), "        <driver>");
-	      strcat((char *)(*data), dlistpointer->name);
-	      strcat((char *)(*data), "</driver>\n");
-	      strcat((char *)(*data), dlistpointer->functionality);
-	      strcat((char *)(*data),
-		     "\n      </driverfunctionalityexception>\n");
-	    } /* ?D_LIST_PTR_FUNCT */
-	    dlistpointer = (driverlist_t *)(dlistpointer->next);
-	  } /* @D_LIST_POINTER X */
-	  strcat((char *)(*data), "    </driverfunctionalityexceptions>\n");
-	} /* ?EXCEPTION_FOUND */
-	/* We remove every printer entry in the list for which we have found
-	   a printer XML file in the database, so all remaining entries are
-	   of printers which are only mentioned in a driver's printer list
-	   but do not have an XML file in the database. We will treat these
-	   printers later */
-	dlistpointer = plistpointer->drivers;
-	while (dlistpointer) /* @D_LIST_POINTER */ {
-	  dlistpreventry = dlistpointer;
-	  dlistpointer = (driverlist_t *)(dlistpointer->next);
-	  free(dlistpreventry);
-	} /* @D_LIST_POINTER X */
-	if (plistpreventry == NULL)
-	  *printerlist = (printerlist_t *)(plistpointer->next);
-	else
-	  plistpreventry->next = plistpointer->next;
-	free(plistpointer);
-      } /* ?P_LIST_POINTER */ 
-      if (ppdlist != NULL) /* ?PPD_LIST Y */ {
-	strcat((char *)(*data), "    <ppds>\n");
-	ppdlistpointer = ppdlist;
-	if (debug)
-	  fprintf(stderr,
-		  "    Going through list: ");
-	while (ppdlistpointer) /* @PPD_LIST_POINTER */ {
-	if (debug)
-	  fprintf(stderr,
-		  ".");
-	  strcat((char *)(*data), "      <ppd>\n");
-	  strcat((char *)(*data), "        <driver>");
-	  strcat((char *)(*data), ppdlistpointer->driver);
-	  strcat((char *)(*data), "</driver>\n        <ppdfile>");
-	  strcat((char *)(*data), ppdlistpointer->ppd);
-	  strcat((char *)(*data), "</ppdfile>\n");
-	  strcat((char *)(*data), "      </ppd>\n");
-	  ppdlistpointer = (ppdlist_t *)(ppdlistpointer->next);
-	} /* @PPD_LIST_POINTER X */
-	strcat((char *)(*data), "    </ppds>\n");
-      } /* ?PPD_LIST */
-      strcat((char *)(*data), "  </printer>\n");
-    } /* ?PRINTER_ENTRY */ 
-  } break; } /* *OPERATION X */
-  return(comboconfirmed);
+	      "Option file %s corrupted, missing, or not readable!\n",
+	      optionfilename);
+      exit(1);
+    }
+    model = newoptionmodel();
+    if (parse(parser, &file, NULL, NULL, optionfilename, NULL, 2, NULL, 0,
+	      &nopjl, db->idlist, model, NULL, debug2) < 0)
+      /* A snapshot of a broken database is not useful */
+      exit(1);
+    option = (snapoption_t *)snapentry((void **)&(writer.options),
+				       &(writer.numoptions),
+				       &(writer.sizeoptions),
+				       sizeof(snapoption_t));
+    option->file.name = snapintern(&writer, optentry->name);
+    option->file.data = snapstore(&writer, file.data, file.length);
+    option->file.length = (unsigned int)file.length;
+    option->keys = snapintern(&writer, optentry->keys);
+    option->optiontype = model->optiontype;
+    option->numenumvals = model->numenumvals;
+    option->events = (unsigned int)writer.numevents;
+    option->numevents = (unsigned int)model->numevents;
+    for (i = 0; i < model->numevents; i ++) {
+      event = model->events + i;
+      snapevent = (snapevent_t *)snapentry((void **)&(writer.events),
+					   &(writer.numevents),
+					   &(writer.sizeevents),
+					   sizeof(snapevent_t));
+      snapevent->type = event->type;
+      snapevent->from = event->from;
+      snapevent->to = event->to;
+      snapevent->inenumval = event->inenumval;
+      snapevent->line = event->line;
+      snapevent->sense = event->sense;
+      snapevent->text = snapintern(&writer, event->text);
+      snapevent->printer = snapintern(&writer, event->printer);
+      snapevent->make = snapintern(&writer, event->make);
+      snapevent->model = snapintern(&writer, event->model);
+      snapevent->driver = snapintern(&writer, event->driver);
+      snapevent->argdefault = snapintern(&writer, event->argdefault);
+    }
+    freeoptionmodel(model);
+    freexmlfile(&file);
+  }
+  freeoptindex(optindex);
+
+  /* The three overviews, as they are put out */
+  for (i = 0; i < 3; i ++) {
+    tmp = tmpfile();
+    if (tmp == NULL) {
+      fprintf(stderr, "Cannot create temporary file!\n");
+      exit(1);
+    }
+    if (overviewxml(tmp, db, (i == 0 ? 1 : 2), (i == 2), NULL, debug) < 0)
+      exit(1);
+    length = ftell(tmp);
+    if ((length < 0) || (length > 0x7ffffff0 - writer.stringslength)) {
+      fprintf(stderr, "Database too large for a snapshot!\n");
+      exit(1);
+    }
+    growdata(&(writer.strings), &(writer.sizestrings),
+	     writer.stringslength + (int)length + 1);
+    rewind(tmp);
+    if (fread(writer.strings + writer.stringslength, 1, length, tmp) !=
+	(size_t)length) {
+      fprintf(stderr, "Cannot read temporary file!\n");
+      exit(1);
+    }
+    fclose(tmp);
+    header.overviews[i] = (unsigned int)writer.stringslength;
+    header.overviewlengths[i] = (unsigned int)length;
+    writer.strings[writer.stringslength + length] = '\0';
+    writer.stringslength += (int)length + 1;
+  }
+
+  /* The printer ID translations, their table is written directly */
+  header.hasidlist = (db->idlist != NULL);
+  if (db->idlist != NULL) {
+    header.numidpairs = (unsigned int)db->idlist->numpairs;
+    for (i = 0; i < db->idlist->numpairs; i ++) {
+      snapintern(&writer, db->idlist->pairs[i].oldid);
+      snapintern(&writer, db->idlist->pairs[i].newid);
+    }
+  }
+
+  header.libdir = snapintern(&writer, db->libdir);
+
+  /* Lay out the file: header, tables, string area */
+  memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  header.version = SNAPSHOT_VERSION;
+  header.byteorder = SNAPSHOT_BYTEORDER;
+  offset = sizeof(snapheader_t);
+  header.printers = (unsigned int)offset;
+  header.numprinters = (unsigned int)writer.numprinters;
+  offset += sizeof(snapfile_t) * writer.numprinters;
+  header.drivers = (unsigned int)offset;
+  header.numdrivers = (unsigned int)writer.numdrivers;
+  offset += sizeof(snapfile_t) * writer.numdrivers;
+  header.options = (unsigned int)offset;
+  header.numoptions = (unsigned int)writer.numoptions;
+  offset += sizeof(snapoption_t) * writer.numoptions;
+  header.events = (unsigned int)offset;
+  header.numevents = (unsigned int)writer.numevents;
+  offset += sizeof(snapevent_t) * writer.numevents;
+  header.idpairs = (unsigned int)offset;
+  offset += sizeof(snapidpair_t) * header.numidpairs;
+  header.strings = (unsigned int)offset;
+  header.stringslength = (unsigned int)writer.stringslength;
+  offset += writer.stringslength;
+  if (offset > 0xfffffff0UL) {
+    fprintf(stderr, "Database too large for a snapshot!\n");
+    exit(1);
+  }
+  header.size = (unsigned int)offset;
+
+  snprintf(tmpfilename, sizeof(tmpfilename), "%s.%d", filename,
+	   (int)getpid());
+  out = fopen(tmpfilename, "w");
+  if (out == NULL) {
+    fprintf(stderr, "Cannot write snapshot %s!\n", tmpfilename);
+    exit(1);
+  }
+  ok = (fwrite(&header, sizeof(snapheader_t), 1, out) == 1);
+  if (writer.numprinters > 0)
+    ok &= (fwrite(writer.printers, sizeof(snapfile_t), writer.numprinters,
+		  out) == (size_t)writer.numprinters);
+  if (writer.numdrivers > 0)
+    ok &= (fwrite(writer.drivers, sizeof(snapfile_t), writer.numdrivers,
+		  out) == (size_t)writer.numdrivers);
+  if (writer.numoptions > 0)
+    ok &= (fwrite(writer.options, sizeof(snapoption_t), writer.numoptions,
+		  out) == (size_t)writer.numoptions);
+  if (writer.numevents > 0)
+    ok &= (fwrite(writer.events, sizeof(snapevent_t), writer.numevents,
+		  out) == (size_t)writer.numevents);
+  for (i = 0; i < (int)header.numidpairs; i ++) {
+    /* The IDs are stored already, this only looks them up */
+    idpair.oldid = snapintern(&writer, db->idlist->pairs[i].oldid);
+    idpair.newid = snapintern(&writer, db->idlist->pairs[i].newid);
+    ok &= (fwrite(&idpair, sizeof(snapidpair_t), 1, out) == 1);
+  }
+  ok &= (fwrite(writer.strings, 1, writer.stringslength, out) ==
+	 (size_t)writer.stringslength);
+  ok &= (fclose(out) == 0);
+  if (!ok || (rename(tmpfilename, filename) != 0)) {
+    fprintf(stderr, "Cannot write snapshot %s!\n", filename);
+    unlink(tmpfilename);
+    exit(1);
+  }
+  if (debug)
+    fprintf(stderr,
+	    "Snapshot %s: %d printers, %d drivers, %d options, %d events, %lu bytes\n",
+	    filename, writer.numprinters, writer.numdrivers,
+	    writer.numoptions, writer.numevents, offset);
+
+  free(writer.strings);
+  free(writer.interned);
+  free(writer.printers);
+  free(writer.drivers);
+  free(writer.options);
+  free(writer.events);
+}
+
+/*
+ * function to free the files, the option index, and the printer ID
+ * translation table kept in the database, the snapshot stays mapped
+ */
+
+void
+freedatabase(database_t *db) { /* I/O - Database */
+  drivercache_t *entry, *next;
+
+  freecombo(db);
+  freeoptindex(db->optindex);
+  db->optindex = NULL;
+  db->optindexloaded = 0;
+  for (entry = db->drivers; entry; entry = next) {
+    next = (drivercache_t *)(entry->next);
+    if (entry->file.data != NULL) freexmlfile(&(entry->file));
+    freedrivermodel(entry->model);
+    free(entry);
+  }
+  db->drivers = NULL;
+  freeidlist(db->idlist);
+  db->idlist = NULL;
+}
+
+/*
+ * function to drop the files and the option index kept in the database
+ * and to reload the printer ID translation table, so that the next
+ * requests see the current state of the database files. A snapshot gets
+ * mapped again, if the new one is not readable the old one stays.
+ */
+
+void
+reloaddatabase(database_t *db) { /* I/O - Database */
+  snapshot_t    *snapshot;
+  char          oldidfilename[1024]; /* Name of the file with the
+					translation table for old printer
+					IDs */
+  statsclock_t  phasestart;
+
+  freedatabase(db);
+  startphase(&phasestart);
+  if (db->snapshot != NULL) {
+    if ((snapshot = opensnapshot(db->snapshotfilename)) != NULL) {
+      closesnapshot(db->snapshot);
+      db->snapshot = snapshot;
+      db->libdir = snapshot->strings + snapshot->header->libdir;
+    }
+    db->idlist = snapshotidlist(db->snapshot);
+  } else {
+    sprintf(oldidfilename, "%s/db/oldprinterids", db->libdir);
+    db->idlist = loadidlist(oldidfilename);
+  }
+  endphase(STATS_IDLIST, &phasestart);
+}
+
+/*
+ * Set by SIGHUP, the server ("-S") reloads the database before the next
+ * request
+ */
+
+volatile sig_atomic_t reloadrequested = 0;
+
+void
+hanguphandler(int sig) { /* I - Signal number */
+  reloadrequested = 1;
+}
+
+/*
+ * function to answer one request to the server ("-S"). A request is a
+ * line of fields separated by tabs:
+ *
+ *   COMBO <printer> <driver> [<option setting> ...]
+ *   OVERVIEW [-C [-n]]
+ *   RELOAD
+ *
+ * The answer starts with a line "<request> <length>" followed by the
+ * given number of bytes. For COMBO the answer is the same as in batch
+ * mode ("-b"), "COMBO <printer>,<driver> <length>" and the combo XML
+ * data, a length of 0 means that the combo is not possible. OVERVIEW
+ * gives the overview XML data, RELOAD makes the server reload the
+ * database, requests which are not understood get an ERROR answer with
+ * the error message.
+ */
+
+void
+serverequest(FILE *out,         /* I - Output stream of the connection */
+	     database_t *db,    /* I/O - Database */
+	     parser_t *parser,  /* I/O - Parser */
+	     char *line,        /* I - Request line, it gets split up */
+	     int debug) {       /* I - Debug level */
+  char          *fields[SERVER_MAX_FIELDS]; /* Fields of the request */
+  int           numfields = 0;
+  char          *t;
+  char          *data;          /* Overview in memory */
+  size_t        length;
+  FILE          *memout;
+  int           overview = 1;
+  int           noreadymadeppds = 0;
+  int           i;
+  const char    *error = NULL;
+
+  fields[numfields ++] = line;
+  for (t = strchr(line, '\t'); t != NULL; t = strchr(t, '\t')) {
+    if (numfields >= SERVER_MAX_FIELDS) {
+      error = "Too many fields in the request!\n";
+      break;
+    }
+    *(t ++) = '\0';
+    fields[numfields ++] = t;
+  }
+  if (debug) fprintf(stderr, "Request: %s\n", fields[0]);
+  if (error != NULL) {
+    /* error message already set */
+  } else if (strcmp(fields[0], "COMBO") == 0) {
+    for (i = 1; i < numfields; i ++)
+      if (strlen(fields[i]) >= SERVER_FIELD_SIZE)
+	error = "Field of the request too long!\n";
+    if (error != NULL) {
+      /* error message already set */
+    } else if ((numfields < 3) || (fields[1][0] == '\0') ||
+	       (fields[2][0] == '\0'))
+      error = "A printer ID and a driver name must be supplied!\n";
+    else if ((strchr(fields[1], '/') != NULL) ||
+	     (strstr(fields[1], "..") != NULL) ||
+	     (strchr(fields[2], '/') != NULL) ||
+	     (strstr(fields[2], "..") != NULL))
+      /* The IDs are file names in db/source, the client must not get
+	 files from elsewhere */
+      error = "Invalid printer ID or driver name!\n";
+    else {
+      /* The option settings of the request are the default settings */
+      db->defaultsettings = (const char **)(fields + 3);
+      db->num_defaultsettings = numfields - 3;
+      /* A broken file in the database fails only this request, the
+	 server keeps running */
+      i = combo(out, db, parser, fields[1], fields[2], 1, debug);
+      if (i < 0)
+	error = "Database file corrupted, missing, or not readable!\n";
+      else if (i != 0)
+	fprintf(out, "COMBO %s,%s 0\n", fields[1], fields[2]);
+      db->defaultsettings = NULL;
+      db->num_defaultsettings = 0;
+    }
+  } else if (strcmp(fields[0], "OVERVIEW") == 0) {
+    for (i = 1; i < numfields; i ++)
+      if (strcmp(fields[i], "-O") == 0)
+	overview = 1;
+      else if (strcmp(fields[i], "-C") == 0)
+	overview = 2;
+      else if (strcmp(fields[i], "-n") == 0)
+	noreadymadeppds = 1;
+      else
+	error = "Unknown overview flag!\n";
+    if (error == NULL) {
+      /* The length is needed before the data, so the overview is built
+	 in memory */
+      memout = open_memstream(&data, &length);
+      if (memout == NULL) {
+	fprintf(stderr, "Out of memory!\n");
+	exit(1);
+      }
+      i = overviewxml(memout, db, overview, noreadymadeppds, NULL, debug);
+      fclose(memout);
+      if (i < 0)
+	error = "Database file corrupted, missing, or not readable!\n";
+      else {
+	fprintf(out, "OVERVIEW %lu\n", (unsigned long)length);
+	fwrite(data, 1, length, out);
+      }
+      free(data);
+    }
+  } else if (strcmp(fields[0], "RELOAD") == 0) {
+    reloaddatabase(db);
+    fprintf(out, "RELOAD 0\n");
+  } else
+    error = "Unknown request!\n";
+  if (error != NULL)
+    fprintf(out, "ERROR %lu\n%s", (unsigned long)strlen(error), error);
+}
+
+/*
+ * function to serve one connection to the server ("-S"), run as a thread
+ * for each connection: it reads the requests, answers them into the
+ * memory under the lock of the server, and sends the answers. A client
+ * which does not send a request line or does not take the answer within
+ * SERVER_TIMEOUT seconds gets disconnected.
+ */
+
+void  /* O - Always NULL */
+*connthread(void *arg) { /* I - Connection (serverconn_t) */
+  serverconn_t  *conn = (serverconn_t *)arg;
+  server_t      *srv = conn->server;
+  struct timeval timeout;
+  FILE          *in, *out, *memout;
+  char          line[SERVER_LINE_SIZE];
+  char          *data;          /* Answer in memory */
+  size_t        length;
+
+  timeout.tv_sec = SERVER_TIMEOUT;
+  timeout.tv_usec = 0;
+  setsockopt(conn->fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(conn->fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+  in = fdopen(conn->fd, "r");
+  out = fdopen(dup(conn->fd), "w");
+  if ((in == NULL) || (out == NULL)) {
+    fprintf(stderr, "Out of memory!\n");
+    exit(1);
+  }
+  while (fgets(line, sizeof(line), in) != NULL) /* @REQUESTS */ {
+    if (strchr(line, '\n') == NULL) {
+      /* Request line too long or incomplete, close the connection */
+      fprintf(out, "ERROR %lu\nRequest too long!\n",
+	      (unsigned long)strlen("Request too long!\n"));
+      break;
+    }
+    line[strcspn(line, "\r\n")] = '\0';
+    memout = open_memstream(&data, &length);
+    if (memout == NULL) {
+      fprintf(stderr, "Out of memory!\n");
+      exit(1);
+    }
+    pthread_mutex_lock(&(srv->lock));
+    if (reloadrequested) {
+      reloadrequested = 0;
+      if (srv->debug) fprintf(stderr, "Reloading the database\n");
+      reloaddatabase(srv->db);
+    }
+    serverequest(memout, srv->db, srv->parser, line, srv->debug);
+    pthread_mutex_unlock(&(srv->lock));
+    fclose(memout);
+    fwrite(data, 1, length, out);
+    free(data);
+    if ((fflush(out) != 0) || ferror(out)) break;
+  } /* @REQUESTS X */
+  fclose(in);
+  fclose(out);
+  free(conn);
+  return NULL;
+}
+
+/*
+ * function to run the server ("-S"): the database is loaded once and kept
+ * in memory, the connections of the clients on the Unix domain socket are
+ * served by a thread each, each connection can send any number of
+ * requests
+ */
+
+void
+server(database_t *db,        /* I/O - Database */
+       parser_t *parser,      /* I/O - Parser */
+       const char *socketname,/* I - File name of the socket */
+       int debug) {           /* I - Debug level */
+  struct sockaddr_un addr;
+  struct stat   st;
+  int           listenfd, fd;
+  server_t      srv;
+  serverconn_t  *conn;
+  pthread_t     thread;
+  pthread_attr_t attr;
+  sigset_t      hangup;
+
+  if (strlen(socketname) >= sizeof(addr.sun_path)) {
+    fprintf(stderr, "Socket name %s too long!\n", socketname);
+    exit(1);
+  }
+  /* A socket left over by a previous server gets replaced, any other
+     file not */
+  if (lstat(socketname, &st) == 0) {
+    if (!S_ISSOCK(st.st_mode)) {
+      fprintf(stderr, "%s exists and is not a socket!\n", socketname);
+      exit(1);
+    }
+    unlink(socketname);
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, socketname);
+  if (((listenfd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) ||
+      (bind(listenfd, (struct sockaddr *)&addr, sizeof(addr)) != 0) ||
+      (listen(listenfd, 16) != 0)) {
+    fprintf(stderr, "Cannot create socket %s: %s\n", socketname,
+	    strerror(errno));
+    exit(1);
+  }
+  /* Clients closing their connection early must not kill the server */
+  signal(SIGPIPE, SIG_IGN);
+  signal(SIGHUP, hanguphandler);
+  if (debug) fprintf(stderr, "Listening on %s\n", socketname);
+
+  srv.db = db;
+  srv.parser = parser;
+  srv.debug = debug;
+  pthread_mutex_init(&(srv.lock), NULL);
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  /* SIGHUP goes to the main thread, it must not interrupt the reading of
+     a connection */
+  sigemptyset(&hangup);
+  sigaddset(&hangup, SIGHUP);
+
+  for (;;) /* @CONNECTIONS */ {
+    if ((fd = accept(listenfd, NULL, NULL)) < 0) {
+      if (errno == EINTR) continue;
+      fprintf(stderr, "Cannot accept connection: %s\n", strerror(errno));
+      exit(1);
+    }
+    conn = (serverconn_t *)malloc(sizeof(serverconn_t));
+    if (conn == NULL) {
+      fprintf(stderr, "Out of memory!\n");
+      exit(1);
+    }
+    conn->server = &srv;
+    conn->fd = fd;
+    pthread_sigmask(SIG_BLOCK, &hangup, NULL);
+    if (pthread_create(&thread, &attr, connthread, conn) != 0) {
+      fprintf(stderr, "Cannot create thread, connection refused!\n");
+      close(fd);
+      free(conn);
+    }
+    pthread_sigmask(SIG_UNBLOCK, &hangup, NULL);
+  } /* @CONNECTIONS X */
+}
+
+/*
+ * Data structure for a database opened by a program which links the
+ * combo engine (foomatic-perl-data "-p", "-d"), see foomatic-combo-xml.h.
+ */
+
+struct combodb_s { /* structure for an opened database */
+  database_t            db;        /* The database */
+  parser_t              parser;    /* Parser for the combos */
+  int                   batch;     /* 1: many combos are computed */
+  char                  *libdir;   /* Database location */
+  char                  optindexfilename[1024]; /* Option index file */
+  combopiece_t          *pieces;   /* Output of the last combo */
+  int                   numpieces;
+  int                   sizepieces;
+};
+
+/*
+ * function to open the database for computing combos in the own process
+ */
+
+combodb_t  /* O - Database, to be closed with closecombodb() */
+*opencombodb(const char *libdir, /* I - Database location, NULL: default */
+	     int numthreads,     /* I - Threads for the option files */
+	     int batch) {        /* I - 1: many combos are computed */
+  combodb_t     *cdb;
+  char          oldidfilename[1024];
+  statsclock_t  phasestart;
+
+  if (libdir == NULL)
+    libdir = "/usr/share/foomatic";
+  cdb = (combodb_t *)calloc(1, sizeof(combodb_t));
+  if (cdb == NULL) {
+    fprintf(stderr, "Out of memory!\n");
+    exit(1);
+  }
+  cdb->libdir = strdup(libdir);
+  sprintf(oldidfilename, "%s/db/oldprinterids", libdir);
+  sprintf(cdb->optindexfilename, "%s/db/optionindex", libdir);
+  cdb->db.libdir = cdb->libdir;
+  cdb->db.optindexfilename = cdb->optindexfilename;
+  startphase(&phasestart);
+  cdb->db.idlist = loadidlist(oldidfilename);
+  endphase(STATS_IDLIST, &phasestart);
+  cdb->db.numthreads = (numthreads > 1 ? numthreads : 1);
+  cdb->batch = batch;
+  initparser(&(cdb->parser));
+  return cdb;
+}
+
+/*
+ * function to add the output of an XML file to the pieces of a combo
+ */
+
+void
+addpieces(combodb_t *cdb,           /* I/O - Database */
+	  const char *data,         /* I - Data, NULL: the output of file */
+	  int length,               /* I - Length of the data */
+	  const xmlfile_t *file) {  /* I - XML file */
+  int i, n;
+
+  n = (data != NULL ? 1 : (file->spans != NULL ? file->numspans : 0));
+  if (cdb->numpieces + n > cdb->sizepieces) {
+    cdb->sizepieces = (cdb->numpieces + n) * 2;
+    cdb->pieces =
+      (combopiece_t *)realloc(cdb->pieces,
+			      sizeof(combopiece_t) * cdb->sizepieces);
+    if (cdb->pieces == NULL) {
+      fprintf(stderr, "Out of memory!\n");
+      exit(1);
+    }
+  }
+  if (data != NULL) {
+    cdb->pieces[cdb->numpieces].data = data;
+    cdb->pieces[cdb->numpieces ++].length = length;
+    return;
+  }
+  for (i = 0; i < n; i ++) {
+    cdb->pieces[cdb->numpieces].data = file->spans[i].start;
+    cdb->pieces[cdb->numpieces ++].length = file->spans[i].length;
+  }
+}
+
+/*
+ * function to compute the combo XML data of a printer/driver combo, it
+ * is handed over in the pieces which combo() would put out one after
+ * the other, without copying them
+ */
+
+int  /* O - 0: combo computed, 1: combo not possible, -1: a database file
+	is not readable or not valid XML (error messages issued) */
+combopieces(combodb_t *cdb,         /* I/O - Database */
+	    const char *pid,        /* I - Foomatic printer ID */
+	    const char *driver,     /* I - Driver name */
+	    const combopiece_t **pieces, /* O - Pieces of the data, valid
+					    until the next combo */
+	    int *numpieces,         /* O - Number of pieces */
+	    int debug) {            /* I - Debug level */
+  optindex_t    *optentry;
+  int           result;
+
+  cdb->numpieces = 0;
+  result = combo(NULL, &(cdb->db), &(cdb->parser), pid, driver, cdb->batch,
+		 debug);
+  if (result != 0) return result;
+  addpieces(cdb, "<foomatic>\n", strlen("<foomatic>\n"), NULL);
+  addpieces(cdb, NULL, 0, &(cdb->db.printerfile));
+  addpieces(cdb, NULL, 0, cdb->db.driverfile);
+  addpieces(cdb, "\n<options>\n", strlen("\n<options>\n"), NULL);
+  for (optentry = cdb->db.optindex; optentry;
+       optentry = (optindex_t *)(optentry->next))
+    addpieces(cdb, NULL, 0, &(optentry->file));
+  addpieces(cdb, "</options>\n</foomatic>\n",
+	    strlen("</options>\n</foomatic>\n"), NULL);
+  *pieces = cdb->pieces;
+  *numpieces = cdb->numpieces;
+  return 0;
+}
+
+/*
+ * function to close a database opened with opencombodb()
+ */
+
+void
+closecombodb(combodb_t *cdb) { /* I - Database */
+  if (cdb == NULL) return;
+  freedatabase(&(cdb->db));
+  freeparser(&(cdb->parser));
+  free(cdb->pieces);
+  free(cdb->libdir);
+  free(cdb);
 }
 
+#ifndef FOOMATIC_COMBO_LIBRARY
 /*
  *  Main function
  */
@@ -2090,53 +7144,46 @@ main(int  argc,     /* I - Number of command-line arguments */
   const char    *pid = NULL,
                 *driver = NULL,
                 *setting = NULL;/* User-supplied data */
-  const char    *make, *model;  /* For constraints */
   const char    *libdir = NULL; /* Database location */
-  char          printerfilename[1024];/* Name of printer's XML file */
-  char          printerdirname[1024]; /* Name of the directory with the XML
-					 files for the printers */
-  char          driverfilename[1024]; /* Name of driver's XML file */
-  char          driverdirname[1024];  /* Name of the directory with the XML
-					 files for the drivers */
-  char          optionfilename[1024]; /* Name of current option XML file*/
-  char          optiondirname[1024];  /* Name of the directory with the XML
-					 files for the options */
   char          oldidfilename[1024];  /* Name of the file with the
 					 translation table for old printer
 					 IDs */
-  char          *printerbuffer = NULL;
-  char          *driverbuffer = NULL;
-  char          **optbuffers = NULL;
-  int           num_optbuffers = 0;
+  database_t    db;           /* Database for computing combos */
+  parser_t      parser;       /* Parser for computing combos */
+  const char    *batchfilename = NULL; /* List of combos to compute */
+  const char    *socketname = NULL; /* Socket for the server mode */
+  const char    *cachefilename = NULL; /* Overview cache file */
+  const char    *snapshotfilename = NULL; /* Snapshot to read */
+  const char    *compilefilename = NULL;  /* Snapshot to write */
+  FILE          *batchfile;
+  char          line[1024];
   char          **defaultsettings = NULL; /* User-supplied option settings*/
   int           num_defaultsettings = 0;
   int           overview = 0;
   int           noreadymadeppds = 0;
-  int           nopjl = 0;
+  int           numthreads = 1; /* Threads for the overview and for the
+				   option files */
   int           debug = 0;
-  int           debug2 = 0;
-  int           comboconfirmed = 0;
-  int           comboconfirmed2 = 0;
-  int           exceptionfound = 0;
-  DIR           *optiondir;
-  DIR           *driverdir;
-  DIR           *printerdir;
-  struct dirent *direntry;
-  printerlist_t *printerlist = NULL;
-  printerlist_t *plistpointer;  /* pointers to navigate through the 
-				   printer */
-  driverlist_t  *dlistpointer;  /* list for the overview */
-  printerlist_t *plistpreventry;
-  driverlist_t  *dlistpreventry;
+  const char    *optindexfilename = NULL; /* Option index file */
+  char          defaultindexfilename[1024];
   idlist_t      *idlist;        /* I - ID translation table */
+  snapshot_t    *snapshot;      /* Compiled database, NULL: none */
+  statsclock_t  phasestart; /* Start of a phase ("--stats") */
+  int           status = 0;     /* Exit status */
   
   /* Show the help message whem no command line arguments are given */
 
   if (argc < 2) {
-    fprintf(stderr, "Usage: foomatic-combo-xml [ -O ] [ -p printer -d driver ]\n                          [ -o option1=setting1 ] [ -o option2 ] [ -l dir ]\n                          [ -v | -vv ]\n");
+    fprintf(stderr, "Usage: foomatic-combo-xml [ -O ] [ -p printer -d driver ]\n                          [ -o option1=setting1 ] [ -o option2 ] [ -l dir ]\n                          [ -i indexfile ] [ -b file ] [ -j threads ]\n                          [ -c cachefile ] [ -S socket ] [ -s snapshot ]\n                          [ -W snapshot ] [ --stats[=json] ] [ -v | -vv ]\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "   -p printer   Foomatic ID of the printer\n");
     fprintf(stderr, "   -d driver    Name of the driver to use\n");
+    fprintf(stderr, "   -b file      Compute the combos listed in the file (\"-\":\n");
+    fprintf(stderr, "                standard input), one \"printer,driver\" per\n");
+    fprintf(stderr, "                line, each document preceded by a line\n");
+    fprintf(stderr, "                \"COMBO printer,driver length\"\n");
+    fprintf(stderr, "   -S socket    Run as a server, answering combo and overview\n");
+    fprintf(stderr, "                requests on the given Unix domain socket\n");
     fprintf(stderr, "   -o option1=setting1\n");
     fprintf(stderr, "   -o option2   Default option settings for the\n");
     fprintf(stderr, "                generated file\n");
@@ -2148,7 +7195,23 @@ main(int  argc,     /* I - Number of command-line arguments */
     fprintf(stderr, "                printer/driver combos which point to \n");
     fprintf(stderr, "                ready-made PPD file (CUPS usually \n");
     fprintf(stderr, "                lists ready-made PPD files directly).\n");
+    fprintf(stderr, "   -c cachefile (used only with \"-O\" and \"-C\") cache of the\n");
+    fprintf(stderr, "                parsed driver and printer XML files, only\n");
+    fprintf(stderr, "                the changed files get parsed again\n");
+    fprintf(stderr, "   -W snapshot  Compile the database into the given snapshot\n");
+    fprintf(stderr, "                file\n");
+    fprintf(stderr, "   -s snapshot  Read the database from the given snapshot\n");
+    fprintf(stderr, "                file instead of the XML files\n");
+    fprintf(stderr, "   -j threads   Number of threads to parse the XML files\n");
+    fprintf(stderr, "                (default: 1)\n");
     fprintf(stderr, "   -l dir       Directory where the Foomatic database is located\n");
+    fprintf(stderr, "   -i indexfile Option index file, to find the option files\n");
+    fprintf(stderr, "                which can apply to a printer/driver combo,\n");
+    fprintf(stderr, "                it is updated when the option files change\n");
+    fprintf(stderr, "                (default: <dir>/db/optionindex, only read)\n");
+    fprintf(stderr, "   --stats      Put out the time of the phases of the run and\n");
+    fprintf(stderr, "                counters on standard error at the end, as\n");
+    fprintf(stderr, "                key=value pairs (\"--stats=json\": as JSON)\n");
     fprintf(stderr, "   -v           Verbose (debug) mode\n");
     fprintf(stderr, "   -vv          Very Verbose (debug) mode\n");
     fprintf(stderr, "\n");
@@ -2205,10 +7268,80 @@ main(int  argc,     /* I - Number of command-line arguments */
 	      libdir = argv[i];
 	    }
 	    break;
+        case 'b' : /* batch mode, list of combos */
+	    if (argv[i][2] != '\0')
+	      batchfilename = argv[i] + 2;
+	    else {
+	      i ++;
+	      batchfilename = argv[i];
+	    }
+	    break;
+        case 'S' : /* server mode, socket */
+	    if (argv[i][2] != '\0')
+	      socketname = argv[i] + 2;
+	    else {
+	      i ++;
+	      socketname = argv[i];
+	    }
+	    break;
+        case 'c' : /* overview cache file */
+	    if (argv[i][2] != '\0')
+	      cachefilename = argv[i] + 2;
+	    else {
+	      i ++;
+	      cachefilename = argv[i];
+	    }
+	    break;
+        case 's' : /* snapshot to read */
+	    if (argv[i][2] != '\0')
+	      snapshotfilename = argv[i] + 2;
+	    else {
+	      i ++;
+	      snapshotfilename = argv[i];
+	    }
+	    break;
+        case 'W' : /* snapshot to write */
+	    if (argv[i][2] != '\0')
+	      compilefilename = argv[i] + 2;
+	    else {
+	      i ++;
+	      compilefilename = argv[i];
+	    }
+	    break;
+        case 'i' : /* option index file */
+	    if (argv[i][2] != '\0')
+	      optindexfilename = argv[i] + 2;
+	    else {
+	      i ++;
+	      optindexfilename = argv[i];
+	    }
+	    break;
+        case 'j' : /* threads */
+	    if (argv[i][2] != '\0')
+	      numthreads = atoi(argv[i] + 2);
+	    else {
+	      i ++;
+	      numthreads = (i < argc ? atoi(argv[i]) : 0);
+	    }
+	    if (numthreads < 1) {
+	      fprintf(stderr, "The number of threads must be at least 1!\n");
+	      exit(1);
+	    }
+	    break;
         case 'v' : /* verbose */
 	    debug++;
 	    if (argv[i][2] == 'v') debug++;
 	    break;
+        case '-' : /* long options */
+	    if (strcmp(argv[i], "--stats") == 0)
+	      enablestats(0);
+	    else if (strcmp(argv[i], "--stats=json") == 0)
+	      enablestats(1);
+	    else {
+	      fprintf(stderr, "Unknown option \'%s\'!", argv[i]);
+	      exit(1);
+	    }
+	    break;
 	default :
 	    fprintf(stderr, "Unknown option \'%c\'!", argv[i][1]);
             exit(1);
@@ -2218,19 +7351,32 @@ main(int  argc,     /* I - Number of command-line arguments */
     }
   }
 
-  /* Very verbose debug mode */
-
-  if (debug > 1) debug2 = 1;
-
   /* Set libdir to the default if empty */
 
   if (libdir == NULL)
     libdir = "/usr/share/foomatic";
 
-  /* Load translation table for old printer IDs */
-  sprintf(oldidfilename, "%s/db/oldprinterids",
-	  libdir);
-  idlist = loadidlist(oldidfilename);
+  /* The option index is read from next to the database by default, it
+     is only written to the file given with "-i" */
+
+  if (optindexfilename == NULL) {
+    sprintf(defaultindexfilename, "%s/db/optionindex", libdir);
+    optindexfilename = defaultindexfilename;
+  }
+
+  /* Map the snapshot, it replaces the XML files, or load translation
+     table for old printer IDs */
+  snapshot = NULL;
+  startphase(&phasestart);
+  if ((snapshotfilename != NULL) && (compilefilename == NULL)) {
+    if ((snapshot = opensnapshot(snapshotfilename)) == NULL) exit(1);
+    idlist = snapshotidlist(snapshot);
+  } else {
+    sprintf(oldidfilename, "%s/db/oldprinterids",
+	    libdir);
+    idlist = loadidlist(oldidfilename);
+  }
+  endphase(STATS_IDLIST, &phasestart);
   if (debug) {
     if (idlist) {
       fprintf(stderr, "Printer ID translation table loaded!\n");
@@ -2240,412 +7386,129 @@ main(int  argc,     /* I - Number of command-line arguments */
     }
   }
 
-  if (!overview) {
+  /* The database for computing combos, the option index and the files
+     get loaded when needed */
+  db.libdir = libdir;
+  db.optindexfilename = optindexfilename;
+  db.optindexsave = (optindexfilename != defaultindexfilename);
+  db.idlist = idlist;
+  db.optindex = NULL;
+  db.optindexloaded = 0;
+  db.drivers = NULL;
+  db.defaultsettings = (const char **)defaultsettings;
+  db.num_defaultsettings = num_defaultsettings;
+  db.numthreads = numthreads;
+  db.snapshot = snapshot;
+  db.snapshotfilename = snapshotfilename;
+  db.printerfile.data = NULL;
+  db.fallbackdriverfile.data = NULL;
+  db.driverfile = NULL;
+  /* The messages name the files where the snapshot was compiled from */
+  if (snapshot != NULL)
+    db.libdir = snapshot->strings + snapshot->header->libdir;
+  initparser(&parser);
+
+  if (compilefilename != NULL) {
 
     /*
-     * Compute combo XML file for a given printer/driver combo
+     * Compile the database into a snapshot
      */
 
-    /* Check user-supplied parameters */
-
-    if (pid == NULL) {
-      fprintf(stderr, "A printer ID must be supplied!\n");
-      exit(1);
-    }
-    if (driver == NULL) {
-      fprintf(stderr, "A driver name must be supplied!\n");
-      exit(1);
-    }
-    
-    /* Set file/dir names */
-    
-    sprintf(printerfilename, "%s/db/source/printer/%s.xml",
-	    libdir, pid);
-    sprintf(driverfilename, "%s/db/source/driver/%s.xml",
-	    libdir, driver);
-    sprintf(optiondirname, "%s/db/source/opt",
-	    libdir);
-    
-    /* Read the printer file and extract the printer manufacturer and 
-       model */
-
-    if (debug) fprintf(stderr, "Printer file: %s\n", printerfilename);
-    printerbuffer = loadfile(printerfilename);
-    if (printerbuffer == NULL) {
-      pid = translateid(pid, idlist);
-      sprintf(printerfilename, "%s/db/source/printer/%s.xml",
-	      libdir, pid);
-      printerbuffer = loadfile(printerfilename);
-      if (printerbuffer == NULL) {
-	printerbuffer = malloc(1024);
-	make = strdup(pid);
-	model = strchr(make, '-');
-	if (model) {
-	  t = (char *)model;
-	  *t = '\0';
-	  model ++;
-	} else { 
-	  model = "Unknown model";
-	}
-	t = (char *)make;
-	while (*t) {
-	  if (*t == '_') *t = ' ';
-	  t ++;
-	}
-	t = (char *)model;
-	while (*t) {
-	  if (*t == '_') *t = ' ';
-	  t ++;
-	}
-	sprintf((char *)printerbuffer, "<printer id=\"printer/%s\">\n <make>%s</make>\n <model>%s</model>\n <mechanism>\n  <color />\n </mechanism>\n <noxmlentry />\n</printer>\n", pid, make, model);
-      } else {
-	fprintf(stderr, 
-		"WARNING: Obsolete printer ID used, using %s instead!\n",
-		pid);
-      }
-    }
-    if (debug) fprintf(stderr, "  Printer file loaded!\n");
-    comboconfirmed =
-      parse(&printerbuffer, pid, driver, printerfilename, NULL, 0, 
-	    (const char **)defaultsettings, num_defaultsettings, &nopjl,
-	    idlist, debug2);
-    
-    /* Read the driver file and check whether the printer is present */
-    
-    if (debug) fprintf(stderr, "Driver file: %s\n", driverfilename);
-    driverbuffer = loadfile(driverfilename);
-    if (driverbuffer == NULL) {
-      if (!comboconfirmed) {
-	fprintf(stderr, 
-		"Driver file %s corrupted, missing, or not readable!\n",
-		driverfilename);
-	exit(1);
-      } else {
-	driverbuffer = malloc(4096);
-	sprintf((char *)driverbuffer, "<driver id=\"driver/%s\">\n <name>%s</name>\n <url></url>\n <execution>\n  <filter />\n  <prototype></prototype>\n </execution>\n <printers>\n  <printer>\n   <id>printer/%s</id>\n  </printer>\n </printers>\n</driver>", driver, driver, pid);
-      }
-    } else {
-      if (debug) fprintf(stderr, "  Driver file loaded!\n");
-      comboconfirmed2 =
-	parse(&driverbuffer, pid, driver, driverfilename, NULL, 1,
-	      (const char **)defaultsettings, num_defaultsettings, &nopjl,
-	      idlist, debug2);
-      if ((!comboconfirmed) && (!comboconfirmed2)) {
-	fprintf(stderr, "The printer %s is not supported by the driver %s!\n",
-		pid, driver);
-	exit(1);
-      }
-      if (debug) {
-	if (nopjl) {
-	  fprintf(stderr, "  Driver forbids PJL options!\n");
-	} else {
-	  fprintf(stderr, "  Driver allows PJL options!\n");
-	}
-      }
-    
-      /* Search the Foomatic option directory and read all xml files found
-	 there. Check whether and how they apply to the given printer/driver
-       combo */
-    
-      optiondir = opendir(optiondirname);
-      if (optiondir == NULL) {
-	fprintf(stderr, "Cannot read directory %s!\n", optiondirname);
-	exit(1);
-      }
-    
-      while((direntry = readdir(optiondir)) != NULL) {
-	sprintf(optionfilename, "%s/db/source/opt/%s",
-		libdir, direntry->d_name);
-	if (debug) fprintf(stderr, "Option file: %s\n", 
-			   optionfilename);
-	if (strcmp((optionfilename + strlen(optionfilename) - 4), ".xml") == 0) {
-	  /* Process only XML files */
-	  /* Make space for a pointer to the data */
-	  num_optbuffers ++;
-	  optbuffers = (char **)realloc((char **)optbuffers, 
-					sizeof(char *) * num_optbuffers);
-	  /* load the current option's XML file */
-	  optbuffers[num_optbuffers-1] = loadfile(optionfilename);
-	  if (optbuffers[num_optbuffers-1] == NULL) {
-	    fprintf(stderr,
-		    "Option file %s corrupted, missing, or not readable!\n",
-		    optionfilename);
-	    exit(1);
-	  }
-	  if (debug) fprintf(stderr, "  Option file loaded!\n");
-	  /* process it */
-	  parse((char **)&(optbuffers[num_optbuffers-1]), pid, driver,
-		optionfilename, NULL, 2,
-		(const char **)defaultsettings, num_defaultsettings, &nopjl, 
-		idlist, debug2);
-	  /* If the parser discarded it (because it does not apply to our 
-	     printer/driver combo) remove the space for the pointer to it */
-	  if (optbuffers[num_optbuffers-1] == NULL) {
-	    if (debug) fprintf(stderr, "  Option does not apply, removed!\n");
-	    num_optbuffers --;
-	  } else {
-	    if (debug) fprintf(stderr, "  Option applies!\n");
-	  }
-	}
-      }
-      closedir(optiondir);
-    }
-    
-    /* Output the result on STDOUT */
-    if (debug) fprintf(stderr, "Putting out result!\n");
-    printf("<foomatic>\n%s%s\n<options>\n", printerbuffer, driverbuffer);
-    for (i = 0; i < num_optbuffers; i++) {
-      printf("%s", optbuffers[i]);
-    }
-    printf("</options>\n</foomatic>\n");
+    compilesnapshot(&db, &parser, compilefilename, debug);
 
-  } else {
+  } else if (socketname != NULL) {
 
     /*
-     * Compute XML file for the printer overview list,
+     * Answer requests on a socket until the server is killed, the
+     * default option settings come with the requests
      */
 
-    /* Set file/dir names */
-    
-    sprintf(driverdirname, "%s/db/source/driver",
-	    libdir);
-    sprintf(printerdirname, "%s/db/source/printer",
-	    libdir);
-    
-    /* Mark overview mode */
-    if (overview == 2)
-      if (noreadymadeppds)
-	pid = "c";
-      else
-	pid = "C";
-    else
-      pid = NULL;
-
-    /* Add a pseudo-printer to the printer list to which we assign all
-       drivers with a command line prototype, so we can determine
-       which printer/driver combos provide PPD files. */
-    if (pid) {
-      plistpointer = 
-	(printerlist_t *)malloc(sizeof(printerlist_t));
-      strcpy(plistpointer->id, "proto");
-      plistpointer->drivers = NULL;
-      plistpointer->next = NULL;
-      printerlist = plistpointer;
-    }
+    db.defaultsettings = NULL;
+    db.num_defaultsettings = 0;
+    server(&db, &parser, socketname, debug);
 
-    printf("<overview>\n");
+  } else if (!overview) {
 
-    /* Search the Foomatic driver directory and read all xml files found
-       there. Read out the printers which the driver supports and add them
-       to the printer's driver list */
-    
-    driverdir = opendir(driverdirname);
-    if (driverdir == NULL) {
-      fprintf(stderr, "Cannot read directory %s!\n", driverdirname);
-      exit(1);
-    }
-    
-    while((direntry = readdir(driverdir)) != NULL) {
-      sprintf(driverfilename, "%s/db/source/driver/%s",
-	      libdir, direntry->d_name);
-      if (debug) fprintf(stderr, "Driver file: %s\n", driverfilename);
-      if (strcmp((driverfilename + strlen(driverfilename) - 4), ".xml") == 0) {
-	/* Process only XML files */
-	/* load the current driver's XML file */
-	driverbuffer = loadfile(driverfilename);
-	if (driverbuffer == NULL) {
-	  fprintf(stderr,
-		  "Driver file %s corrupted, missing, or not readable!\n",
-		  driverfilename);
-	  exit(1);
-	}
-	if (debug) fprintf(stderr, "  Driver file loaded!\n");
-	/* process it */
-	parse(&driverbuffer, pid, NULL, driverfilename, &printerlist, 3, 
-	      (const char **)defaultsettings, num_defaultsettings, &nopjl, 
-	      idlist, debug2);
-	if (driverbuffer != NULL) {
-	  /* put it out */
-	  printf("%s\n", driverbuffer);
-	  /* Delete the driver file from memory */
-	  free((void *)driverbuffer);
-	  driverbuffer = NULL;
-	}
-      }
-    }
-    closedir(driverdir);
+    /*
+     * Compute combo XML file for a given printer/driver combo
+     */
 
-    if (debug) {
-      plistpointer = printerlist;
-      while (plistpointer) {
-	fprintf(stderr, "Printer: %s\n", plistpointer->id);
-	dlistpointer = plistpointer->drivers;
-	while (dlistpointer) {
-	  fprintf(stderr, "   Driver: %s\n", dlistpointer->name);
-	  if (dlistpointer->functionality != NULL)
-	    fprintf(stderr, "    %s\n", dlistpointer->functionality);
-	  dlistpointer = (driverlist_t *)(dlistpointer->next);
-	}
-	plistpointer = (printerlist_t *)(plistpointer->next);
-      }
-    }
+    if (batchfilename != NULL) {
 
-    /* Search the Foomatic printer directory and read all xml files found
-       there. Read out the printer info and build the printer entries for the
-       overview with the printer/driver combo list obtained before */
+      /*
+       * Compute the combos listed in a file, one "printer,driver" per line
+       */
 
-    printerdir = opendir(printerdirname);
-    if (printerdir == NULL) {
-      fprintf(stderr, "Cannot read directory %s!\n", printerdirname);
-      exit(1);
-    }
-    
-    while((direntry = readdir(printerdir)) != NULL) {
-      sprintf(printerfilename, "%s/db/source/printer/%s",
-	      libdir, direntry->d_name);
-      if (debug) fprintf(stderr, "Printer file: %s\n", printerfilename);
-      if (strcmp((printerfilename + strlen(printerfilename) - 4), ".xml") ==
-	  0) {
-	/* Process only XML files */
-	/* load the current printer's XML file */
-	printerbuffer = loadfile(printerfilename);
-	if (printerbuffer == NULL) {
-	  fprintf(stderr,
-		  "Printer file %s corrupted, missing, or not readable!\n",
-		  printerfilename);
-	  exit(1);
+      if (strcmp(batchfilename, "-") == 0)
+	batchfile = stdin;
+      else
+	batchfile = fopen(batchfilename, "r");
+      if (batchfile == NULL) {
+	fprintf(stderr, "Cannot read combo list %s!\n", batchfilename);
+	exit(1);
+      }
+      while (fgets(line, sizeof(line), batchfile) != NULL) {
+	line[strcspn(line, "\r\n")] = '\0';
+	if (line[0] == '\0') continue;
+	t = strchr(line, ',');
+	if ((t == NULL) || (t == line) || (t[1] == '\0')) {
+	  fprintf(stderr, "Invalid combo \'%s\', must be \"printer,driver\"!\n",
+		  line);
+	  continue;
 	}
-	if (debug) fprintf(stderr, "  Printer file loaded!\n");
-	/* process it */
-	parse(&printerbuffer, pid, NULL, printerfilename, &printerlist, 4,
-	      (const char **)defaultsettings, num_defaultsettings, &nopjl, 
-	      idlist, debug2);
-	/* put it out */
-	printf("%s", printerbuffer);
-	/* Delete the printer file from memory */
-	free((void *)printerbuffer);
-	printerbuffer = NULL;
+	*t = '\0';
+	i = combo(stdout, &db, &parser, line, t + 1, 1, debug);
+	if (i != 0)
+	  /* The combo is not possible, put out an empty document */
+	  printf("COMBO %s,%s 0\n", line, t + 1);
+	if (i < 0)
+	  /* A broken database file fails its combos, the others are still
+	     computed */
+	  status = 1;
+	fflush(stdout);
       }
-    }
+      if (batchfile != stdin) fclose(batchfile);
 
-    closedir(printerdir);
+    } else {
 
-    if (debug) {
-      plistpointer = printerlist;
-      while (plistpointer) {
-	fprintf(stderr, "Printer: %s\n", plistpointer->id);
-	dlistpointer = plistpointer->drivers;
-	while (dlistpointer) {
-	  fprintf(stderr, "   Driver: %s\n", dlistpointer->name);
-	  if (dlistpointer->functionality != NULL)
-	    fprintf(stderr, "    %s\n", dlistpointer->functionality);
-	  dlistpointer = (driverlist_t *)(dlistpointer->next);
-	}
-	plistpointer = (printerlist_t *)(plistpointer->next);
-      }
-    }
+      /* Check user-supplied parameters */
 
-    /* Now show all printers which are only mentioned in the lists of
-       supported prnters of the drivers and which not have a Foomatic
-       printer XML entry. */
-    while (printerlist) {
-      if (printerlist->id && strcmp(printerlist->id, "proto")) {
-	if (debug) fprintf(stderr, "    Printer only mentioned in driver XML files:\n      Printer ID: |%s|\n",
-			   printerlist->id);
-	/*strcpy(printerlist->id, translateid(printerlist->id, idlist));*/
-	printf("  <printer>\n    <id>");
-	printf("%s", printerlist->id);
-	make = printerlist->id;
-	model = strchr(make, '-');
-	if (model) {
-	  t = (char *)model;
-	  *t = '\0';
-	  model ++;
-	} else { 
-	  model = "Unknown model";
-	}
-	t = (char *)make;
-	while (*t) {
-	  if (*t == '_') *t = ' ';
-	  t ++;
-	}
-	t = (char *)model;
-	while (*t) {
-	  if (*t == '_') *t = ' ';
-	  t ++;
-	}
-	printf("</id>\n    <make>");
-	printf("%s", make);
-	printf("</make>\n    <model>");
-	printf("%s", model);
-	printf("</model>\n    <noxmlentry />\n");
-	dlistpointer = printerlist->drivers;
-	exceptionfound = 0;
-	if (dlistpointer) {
-	  printf("    <drivers>\n");
-	  while (dlistpointer) {
-	    if (dlistpointer->name) {
-	      printf("      <driver>");
-	      printf("%s", dlistpointer->name);
-	      printf("</driver>\n");
-	      if (dlistpointer->functionality != NULL) exceptionfound = 1;
-	    }
-	    dlistpointer = (driverlist_t *)(dlistpointer->next);
-	  }
-	  printf("    </drivers>\n");
-	}
-	if (exceptionfound) {
-	  printf("    <driverfunctionalityexceptions>\n");
-	  dlistpointer = printerlist->drivers;
-	  while (dlistpointer) {
-	    if ((dlistpointer->functionality != NULL) &&
-		(dlistpointer->name != NULL)) {
-	      printf("      <driverfunctionalityexception>\n");
-	      printf("        <driver>");
-	      printf("%s", dlistpointer->name);
-	      printf("</driver>\n");
-	      printf("%s", dlistpointer->functionality);
-	      printf("\n      </driverfunctionalityexception>\n");
-	    }
-	    dlistpointer = (driverlist_t *)(dlistpointer->next);
-	  }
-	  printf("    </driverfunctionalityexceptions>\n");
-	}
-	printf("  </printer>\n");
+      if (pid == NULL) {
+	fprintf(stderr, "A printer ID must be supplied!\n");
+	exit(1);
       }
-      dlistpointer = printerlist->drivers;
-      while (dlistpointer) {
-	dlistpreventry = dlistpointer;
-	dlistpointer = (driverlist_t *)(dlistpointer->next);
-	free(dlistpreventry);
+      if (driver == NULL) {
+	fprintf(stderr, "A driver name must be supplied!\n");
+	exit(1);
       }
-      plistpreventry = printerlist;
-      printerlist = (printerlist_t *)(printerlist->next);
-      free(plistpreventry);
-    }
 
-    printf("</overview>\n");
-      
-    if (debug) {
-      plistpointer = printerlist;
-      while (plistpointer) {
-	fprintf(stderr, "Printer: %s\n", plistpointer->id);
-	dlistpointer = plistpointer->drivers;
-	while (dlistpointer) {
-	  fprintf(stderr, "   Driver: %s\n", dlistpointer->name);
-	  if (dlistpointer->functionality != NULL)
-	    fprintf(stderr, "    %s\n", dlistpointer->functionality);
-	  dlistpointer = (driverlist_t *)(dlistpointer->next);
-	}
-	plistpointer = (printerlist_t *)(plistpointer->next);
-      }
+      if (combo(stdout, &db, &parser, pid, driver, 0, debug) != 0)
+	status = 1;
     }
 
+  } else {
+
+    /*
+     * Compute XML file for the printer overview list,
+     */
+
+    if (overviewxml(stdout, &db, overview, noreadymadeppds, cachefilename,
+		    debug) < 0)
+      status = 1;
+
   }
+
+  if ((debug) && (idlist))
+    fprintf(stderr, "Printer ID translations: %d entries, %ld lookups\n",
+	    idlist->numpairs, idlist->lookups);
+
+  /* Statistics for "--stats" */
+  putstats(stderr);
     
   /* Done */
-  exit(0);
+  exit(status);
 }
+#endif /* !FOOMATIC_COMBO_LIBRARY */
 
 /*
  * End of "$Id$".
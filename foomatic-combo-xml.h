@@ -0,0 +1,109 @@
+/*
+ *   Foomatic Combo XML
+ *   ------------------
+ *
+ *   Interface of the combo engine of foomatic-combo-xml for programs
+ *   which compute printer/driver combos in their own process. The engine
+ *   is foomatic-combo-xml.c compiled with FOOMATIC_COMBO_LIBRARY defined,
+ *   which leaves out its main() function.
+ *
+ *   Copyright 2001-2011 by Till Kamppeter, Christopher Yeleighton
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of the
+ *   License, or (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *   02111-1307  USA
+ *
+ */
+
+#ifndef FOOMATIC_COMBO_XML_H
+#define FOOMATIC_COMBO_XML_H
+
+#include <stdio.h>
+
+/*
+ * A Foomatic database opened for computing printer/driver combos. The
+ * combo XML data is the same as "foomatic-combo-xml -p printer -d driver
+ * -l libdir" puts out, but it is not written anywhere: combopieces()
+ * hands over the parts of the database files and the text which make up
+ * the document, one after the other, they stay valid until the next
+ * combo or until the database is closed. With "batch" set the option
+ * and driver files are parsed completely, once, for all combos.
+ * combopieces() returns 1 if the combo is not possible and -1 if a
+ * database file is broken, the error message is issued on standard error
+ * then.
+ */
+
+typedef struct { /* structure for a piece of the combo XML data */
+  const char            *data;     /* the bytes, not terminated */
+  int                   length;    /* number of bytes */
+} combopiece_t;
+
+typedef struct combodb_s combodb_t;
+
+extern combodb_t *opencombodb(const char *libdir, int numthreads,
+			      int batch);
+extern int combopieces(combodb_t *cdb, const char *pid, const char *driver,
+		       const combopiece_t **pieces, int *numpieces,
+		       int debug);
+extern void closecombodb(combodb_t *cdb);
+
+/*
+ * Statistics for "--stats": wall clock and CPU time of the phases of a
+ * run and counters of what was done, put out on standard error at the
+ * end. The engine measures its own phases and counts the files it reads,
+ * programs which link it add their phases and counters with the same
+ * functions. Without enablestats() the phases are not timed.
+ */
+
+enum stats_phases {
+  STATS_IDLIST,         /* Loading the printer ID translation table */
+  STATS_PRINTER,        /* Loading and parsing the printer XML files */
+  STATS_DRIVER,         /* Loading and parsing the driver XML files */
+  STATS_OPTIONS,        /* Finding, parsing, and evaluating the option
+			   XML files */
+  STATS_OUTPUT,         /* Putting out the result */
+  STATS_XMLPARSE,       /* Parsing XML data into C data structures */
+  STATS_PERL,           /* Generating the Perl data */
+  STATS_NUM_PHASES
+};
+
+enum stats_counters {
+  STATS_FILES,          /* Files opened */
+  STATS_BYTES,          /* Bytes read from them */
+  STATS_OPTSKIPPED,     /* Option files skipped thanks to the index */
+  STATS_OPTQUALIFIED,   /* Options which apply to the combo */
+  STATS_OPTREJECTED,    /* Options which do not apply to the combo */
+  STATS_ENUMVALSPRUNED, /* Enum values removed from the options */
+  STATS_IDLOOKUPS,      /* Lookups in the printer ID translation table */
+  STATS_NUM_COUNTERS
+};
+
+typedef struct { /* structure for the start of a phase */
+  double                wall;      /* Wall clock time in seconds */
+  double                cpu;       /* CPU time of all threads */
+} statsclock_t;
+
+/* Turn on the statistics, json: 1 for JSON, 0 for key=value pairs */
+extern void enablestats(int json);
+/* Note the start of a phase */
+extern void startphase(statsclock_t *start);
+/* Add the time since the start to the phase, the start is set to the
+   current time, so that the next phase starts here */
+extern void endphase(int phase, statsclock_t *start);
+/* Add to a counter, safe to be called by several threads */
+extern void countstat(int counter, long n);
+/* Put out the statistics, if they are turned on */
+extern void putstats(FILE *out);
+
+#endif /* !FOOMATIC_COMBO_XML_H */
@@ -41,19 +41,20 @@
 
   Compilable with (depending on installed packages):
 
-  gcc `xml2-config --cflags` -lxml2 -o foomatic-perl-data \
-      foomatic-perl-data.c
+  gcc -DFOOMATIC_COMBO_LIBRARY -c -o foomatic-combo-engine.o \
+      foomatic-combo-xml.c
+  gcc `xml2-config --cflags` -o foomatic-perl-data \
+      foomatic-perl-data.c foomatic-combo-engine.o -lxml2 -lpthread
 
-  or
-
-  gcc `xml-config --cflags` -lxml -o foomatic-perl-data \
-      foomatic-perl-data.c
+  or, with libxml 1, with `xml-config --cflags` and -lxml instead
 
 */
 
 #include <stdio.h>
+#include <stdarg.h>
 #include <string.h>
 #include <stdlib.h>
+#include <sys/stat.h>
 
 /*
  * This program should compile and run indifferently with libxml-1.8.8 +
@@ -67,6 +68,9 @@
  */
 #include <libxml/xmlmemory.h>
 #include <libxml/parser.h>
+#include <libxml/xmlreader.h>
+
+#include "foomatic-combo-xml.h"
 
 #define DEBUG(x) printf(x)
 
@@ -74,6 +78,135 @@
  * an xmlChar * is really an UTF8 encoded char string (0 terminated)
  */
 
+/*
+ * Memory arena for the data parsed from one document. The records, their
+ * arrays, and their strings are cut one after the other out of big
+ * blocks, so that there is no malloc() for every single item and the
+ * whole data is released at once when it is not needed any more.
+ */
+
+#define ARENA_BLOCK_SIZE 65536 /* Size of the arena blocks, bigger requests
+				  get a block of their own */
+
+typedef struct arenaBlock {
+  struct arenaBlock *next; /* Block allocated before this one */
+  size_t            size;  /* Usable size, the memory follows the header */
+  double            align; /* Align the memory for every type */
+} arenaBlock, *arenaBlockPtr;
+
+typedef struct arena {
+  arenaBlockPtr blocks;    /* All blocks, the current one first */
+  char          *next;     /* Free memory in the current block */
+  size_t        left;      /* Bytes left in the current block */
+} arena, *arenaPtr;
+
+/*
+ * Buffer for the generated data and the sink it is written to
+ */
+
+#define OUTPUT_BUFFER_SIZE 65536 /* Initial size of the output buffer, the
+				    sink gets the data in chunks of this
+				    size */
+
+typedef int (*outputSink)(void *handle, const char *data, size_t length);
+
+typedef struct output {
+  char       *data;    /* Data not yet written out */
+  size_t     length;   /* Number of bytes in data */
+  size_t     size;     /* Allocated size of data */
+  outputSink sink;     /* Function to write the data, NULL: memory only */
+  void       *handle;  /* Argument for the sink, as a FILE * */
+  struct converter *build; /* Converter which gets the values of the
+			      generated data instead of their Perl text,
+			      NULL: Perl text */
+} output, *outputPtr;
+
+/*
+ * Tree of the combo XML data which the combo engine computes in this
+ * process ("-p", "-d"). The engine hands over the parts of the database
+ * files which make up the combo, they are read where they are, and the
+ * nodes are built in the arena of the parsed data, the same nodes as the
+ * XML parser builds, so that the same functions read them.
+ */
+
+typedef struct comboTree {
+  const combopiece_t *pieces; /* Parts of the combo XML data */
+  int           num_pieces;
+  int           next;      /* Next part to be read */
+  const char    *pos;      /* Current position in the current part */
+  const char    *end;      /* End of the current part */
+  arenaPtr      arena;     /* Arena for the nodes and their text */
+  xmlDocPtr     doc;       /* The document being built */
+  output        text;      /* Text of the current node */
+  int           *spaces;   /* White space handling of the open elements,
+			      as the XML parser's ctxt->space */
+  int           num_spaces;
+  int           size_spaces;
+} comboTree, *comboTreePtr;
+
+/*
+ * Perl values of the generated data, for the output in the network
+ * format of Perl's Storable module (as made by nfreeze()) or as JSON.
+ * The generators build them instead of writing the Perl text, the strings
+ * stay where they are in the parsed data. The values of one document are
+ * taken from an arena and released together, as hashes and arrays can be
+ * referenced from more than one place.
+ */
+
+#define STORABLE_MAJOR 2 /* Storable binary format version 2.7, understood */
+#define STORABLE_MINOR 7 /* by all Storable versions since Perl 5.8 */
+
+#define SX_OBJECT   0    /* Storable markers for the values we put out */
+#define SX_LSCALAR  1
+#define SX_ARRAY    2
+#define SX_HASH     3
+#define SX_REF      4
+#define SX_UNDEF    5
+#define SX_BYTE     8
+#define SX_NETINT   9
+#define SX_SCALAR  10
+
+typedef enum {
+  PERL_UNDEF,
+  PERL_SCALAR,  /* Quoted string */
+  PERL_NUMBER,  /* Bare number */
+  PERL_ARRAY,
+  PERL_HASH
+} perlValueType;
+
+typedef struct perlValue {
+  perlValueType type;
+  const char    *text;      /* Contents of a string or number */
+  int           length;     /* Length of the text */
+  int           num_items;  /* Array elements or hash entries */
+  struct perlValue **items; /* Array elements or hash values */
+  const char    **keys;     /* Hash keys */
+  int           *keylengths;
+  int           tag;        /* Storable object number, -1: not stored yet */
+} perlValue, *perlValuePtr;
+
+typedef enum {
+  CONVERT_STORABLE,
+  CONVERT_JSON
+} convertFormat;
+
+typedef struct converter {
+  convertFormat format;     /* Format to convert the Perl data into */
+  outputPtr     out;        /* Where the converted data goes */
+  arena         values;     /* All values of the current document */
+  int           tagnum;     /* Number of objects stored so far */
+  perlValuePtr  root;       /* Value of the current document */
+  perlValuePtr  *open;      /* Hashes and arrays being built, the
+			       innermost last */
+  int           num_open;
+  int           size_open;
+  int           failed;     /* Data which has no value, as Perl text it
+			       would be a syntax error */
+  int           num_items;  /* Elements of the overview array */
+  output        items;      /* Storable data of the overview elements,
+			       which has to wait for their number */
+} converter, *converterPtr;
+
 /*
  * Records for the unprintable margins data
  */
@@ -431,29 +564,987 @@ typedef struct overview {
 } overview, *overviewPtr;
 
 /*
- * Function to quote "'" and "\" in a string
+ * Functions for the memory arenas
+ */
+
+static arenaBlockPtr /* O - New block */
+arenaNewBlock(size_t size) { /* I - Usable size of the block */
+  arenaBlockPtr block;
+
+  block = (arenaBlockPtr) malloc(sizeof(arenaBlock) + size);
+  if (block == NULL) {
+    fprintf(stderr,"Out of memory!\n");
+    exit(1);
+  }
+  block->size = size;
+  return(block);
+}
+
+static void
+arenaInit(arenaPtr a) { /* O - Arena */
+  a->blocks = NULL;
+  a->next = NULL;
+  a->left = 0;
+}
+
+static void * /* O - Memory, not initialized */
+arenaAlloc(arenaPtr a,     /* I/O - Arena */
+	   size_t size) {  /* I - Number of bytes */
+  arenaBlockPtr block;
+  void          *p;
+
+  size = (size + sizeof(double) - 1) & ~(sizeof(double) - 1);
+  if (size > a->left) {
+    if (size > ARENA_BLOCK_SIZE / 4) {
+      /* Big request, give it a block of its own behind the current one,
+	 so that the rest of the current one is not lost */
+      block = arenaNewBlock(size);
+      if (a->blocks == NULL) {
+	block->next = NULL;
+	a->blocks = block;
+      } else {
+	block->next = a->blocks->next;
+	a->blocks->next = block;
+      }
+      return(block + 1);
+    }
+    block = arenaNewBlock(ARENA_BLOCK_SIZE);
+    block->next = a->blocks;
+    a->blocks = block;
+    a->next = (char *)(block + 1);
+    a->left = ARENA_BLOCK_SIZE;
+  }
+  p = a->next;
+  a->next += size;
+  a->left -= size;
+  return(p);
+}
+
+/*
+ * Function to make room for a new element of an array in an arena. The
+ * arrays have room for 4 elements at first and double their size
+ * whenever they are full, so the size follows from the number of
+ * elements and does not need to be stored. The old memory of a grown
+ * array stays in the arena until the arena is released.
+ */
+
+static void * /* O - The array, moved if it had to grow */
+arenaGrow(arenaPtr a,     /* I/O - Arena */
+	  void *array,    /* I - Array */
+	  int count,      /* I - Number of elements with the new one */
+	  size_t size) {  /* I - Size of an element */
+  void *p;
+
+  if ((count > 1) && (array != NULL) &&
+      ((count <= 4) || (((count - 1) & (count - 2)) != 0)))
+    return(array);
+  p = arenaAlloc(a, size * ((count <= 4) ? 4 : 2 * (count - 1)));
+  if ((count > 1) && (array != NULL))
+    memcpy(p, array, size * (count - 1));
+  return(p);
+}
+
+static void
+arenaFree(arenaPtr a) { /* I/O - Arena */
+  arenaBlockPtr block;
+
+  while ((block = a->blocks) != NULL) {
+    a->blocks = block->next;
+    free(block);
+  }
+  a->next = NULL;
+  a->left = 0;
+}
+
+/*
+ * Function to release all data of an arena but to keep its current
+ * block for the next data, for arenas which are used again and again
+ */
+
+static void
+arenaReset(arenaPtr a) { /* I/O - Arena */
+  arenaBlockPtr block;
+
+  block = a->blocks;
+  if ((block == NULL) || (block->size != ARENA_BLOCK_SIZE)) {
+    arenaFree(a);
+    return;
+  }
+  a->blocks = block->next;
+  arenaFree(a);
+  block->next = NULL;
+  a->blocks = block;
+  a->next = (char *)(block + 1);
+  a->left = ARENA_BLOCK_SIZE;
+}
+
+/*
+ * Buffered output of the generated data. The generators append to a
+ * large buffer with plain memory copies instead of going through printf()
+ * for every line. Whenever the buffer is full it is handed to the sink,
+ * a function which writes it to a file (standard output, for example).
+ * Without sink the buffer grows and collects all the data in the memory.
+ */
+
+static const char outputSpaces[] =
+  "                                                                ";
+
+static int    /* O - 0: success, -1: write error */
+fileSink(void *handle,      /* I - FILE * to write to */
+	 const char *data,  /* I - Data to write */
+	 size_t length) {   /* I - Length of the data */
+  return(fwrite(data, 1, length, (FILE *)handle) == length ? 0 : -1);
+}
+
+static void
+outputInit(outputPtr out,      /* O - Output buffer */
+	   outputSink sink,    /* I - Function to write the data out,
+				  NULL: keep it in out->data */
+	   void *handle) {     /* I - Argument for the sink */
+  out->size = OUTPUT_BUFFER_SIZE;
+  out->length = 0;
+  out->data = (char *) malloc(out->size);
+  if (out->data == NULL) {
+    fprintf(stderr,"Out of memory!\n");
+    exit(1);
+  }
+  out->sink = sink;
+  out->handle = handle;
+  out->build = NULL;
+}
+
+static void
+outputFree(outputPtr out) {    /* I/O - Output buffer */
+  free(out->data);
+  out->data = NULL;
+  out->size = out->length = 0;
+}
+
+static void
+outputFlush(outputPtr out) {   /* I/O - Output buffer */
+  if ((out->sink == NULL) || (out->length == 0)) return;
+  if ((*out->sink)(out->handle, out->data, out->length) != 0) {
+    fprintf(stderr,"Could not write the output!\n");
+    exit(1);
+  }
+  out->length = 0;
+}
+
+/*
+ * Function to make room for data at the end of the buffer, for the lines
+ * which get put together in place. The caller adds the length of what it
+ * has written to out->length.
+ */
+
+static char * /* O - Where the data goes */
+outputRoom(outputPtr out,      /* I/O - Output buffer */
+	   size_t length) {    /* I - Length of the data */
+  if (out->length + length > out->size) {
+    outputFlush(out);
+    while (out->length + length > out->size) {
+      out->size *= 2;
+      out->data = (char *) realloc(out->data, out->size);
+      if (out->data == NULL) {
+	fprintf(stderr,"Out of memory!\n");
+	exit(1);
+      }
+    }
+  }
+  return(out->data + out->length);
+}
+
+static void
+outputData(outputPtr out,      /* I/O - Output buffer */
+	   const char *data,   /* I - Data to append */
+	   size_t length) {    /* I - Length of the data */
+  memcpy(outputRoom(out, length), data, length);
+  out->length += length;
+}
+
+#define outputLiteral(out, s) outputData((out), (s), sizeof(s) - 1)
+
+static void
+outputText(outputPtr out,          /* I/O - Output buffer */
+	   const xmlChar *str) {   /* I - String to append as it is */
+  if (str == NULL) str = (const xmlChar *) "(null)";
+  outputData(out, (const char *) str, xmlStrlen(str));
+}
+
+static void
+outputIndent(outputPtr out,  /* I/O - Output buffer */
+	     int indent) {   /* I - Number of spaces */
+  while (indent > (int) sizeof(outputSpaces) - 1) {
+    outputData(out, outputSpaces, sizeof(outputSpaces) - 1);
+    indent -= sizeof(outputSpaces) - 1;
+  }
+  outputData(out, outputSpaces, indent);
+}
+
+static void
+outputInt(outputPtr out,  /* I/O - Output buffer */
+	  int n) {        /* I - Number to append in decimal */
+  char digits[16], *d = digits + sizeof(digits);
+  unsigned int u = (n < 0) ? - (unsigned int) n : (unsigned int) n;
+
+  do {
+    *(--d) = '0' + u % 10;
+    u /= 10;
+  } while (u > 0);
+  if (n < 0) *(--d) = '-';
+  outputData(out, d, digits + sizeof(digits) - d);
+}
+
+/*
+ * Function to append a string as the contents of a single-quoted Perl
+ * string, quoting "'" and "\" on the fly. The runs of characters between
+ * the quoted ones are copied in one piece, so that the string is scanned
+ * only once.
+ */
+
+static void
+outputPerlString(outputPtr out,          /* I/O - Output buffer */
+		 const xmlChar *str) {   /* I - Original string */
+  const xmlChar *s;
+
+  if (str == NULL) {
+    outputLiteral(out, "(null)");
+    return;
+  }
+  for (s = str; *s != '\0'; s ++)
+    if ((*s == '\'') || (*s == '\\')) {
+      outputData(out, (const char *) str, s - str);
+      outputLiteral(out, "\\");
+      str = s;
+    }
+  outputData(out, (const char *) str, s - str);
+}
+
+/*
+ * printf() for the "$VAR1->... = $VAR1->...;" lines of the Perl data. It
+ * knows only "%s", "%d", and "%%", the strings inserted by "%s" are the
+ * values of the data structures and they get quoted with
+ * outputPerlString(), as all of them appear between single quotes in the
+ * generated Perl code.
+ */
+
+static void
+outputFormat(outputPtr out,          /* I/O - Output buffer */
+	     const char *format,     /* I - Format with "%s" and "%d" only */
+	     ...) {                  /* I - Strings and integers to insert */
+  va_list ap;
+  const char *f;
+
+  va_start(ap, format);
+  for (f = format; *f != '\0'; f ++)
+    if ((*f == '%') && (f[1] != '\0')) {
+      outputData(out, format, f - format);
+      f ++;
+      if (*f == 's')
+	outputPerlString(out, va_arg(ap, const xmlChar *));
+      else if (*f == 'd')
+	outputInt(out, va_arg(ap, int));
+      else
+	outputData(out, f, 1);
+      format = f + 1;
+    }
+  outputData(out, format, f - format);
+  va_end(ap);
+}
+
+/*
+ * Functions to build the Perl values for the Storable or JSON output.
+ * When the output buffer has a converter the Perl data functions below
+ * add the values to the hashes and arrays being built, instead of
+ * writing their text.
+ */
+
+static perlValuePtr /* O - New value */
+newPerlValue(converterPtr st,        /* I/O - Converter state */
+	     perlValueType type) {  /* I - Type of the value */
+  perlValuePtr v;
+
+  v = (perlValuePtr) arenaAlloc(&st->values, sizeof(perlValue));
+  memset(v, 0, sizeof(perlValue));
+  v->type = type;
+  v->tag = -1;
+  return(v);
+}
+
+static void
+addPerlItem(converterPtr st,    /* I/O - Converter state */
+	    perlValuePtr v,     /* I/O - Array or hash */
+	    const char *key,    /* I - Hash key, NULL for arrays */
+	    int keylength,      /* I - Length of the key */
+	    perlValuePtr item) { /* I - Element or value */
+  v->items = (perlValuePtr *) arenaGrow(&st->values, v->items,
+					v->num_items + 1,
+					sizeof(perlValuePtr));
+  if (v->type == PERL_HASH) {
+    v->keys = (const char **) arenaGrow(&st->values, v->keys,
+					v->num_items + 1, sizeof(char *));
+    v->keylengths = (int *) arenaGrow(&st->values, v->keylengths,
+				      v->num_items + 1, sizeof(int));
+    v->keys[v->num_items] = key;
+    v->keylengths[v->num_items] = keylength;
+  }
+  v->items[v->num_items ++] = item;
+}
+
+static perlValuePtr /* O - New value, in the innermost open hash or array */
+buildValue(converterPtr st,       /* I/O - Converter state */
+	   const char *key,       /* I - Hash key, NULL: array element */
+	   perlValueType type) {  /* I - Type of the value */
+  perlValuePtr v;
+
+  v = newPerlValue(st, type);
+  if (st->num_open > 0)
+    addPerlItem(st, st->open[st->num_open - 1], key,
+		(key == NULL) ? 0 : strlen(key), v);
+  else
+    st->root = v;
+  return(v);
+}
+
+static void
+buildOpen(converterPtr st,       /* I/O - Converter state */
+	  const char *key,       /* I - Hash key, NULL: array element */
+	  perlValueType type) {  /* I - PERL_HASH or PERL_ARRAY */
+  perlValuePtr v;
+
+  v = buildValue(st, key, type);
+  if (st->num_open >= st->size_open) {
+    st->size_open *= 2;
+    st->open = (perlValuePtr *) realloc(st->open, sizeof(perlValuePtr) *
+					st->size_open);
+    if (st->open == NULL) {
+      fprintf(stderr,"Out of memory!\n");
+      exit(1);
+    }
+  }
+  st->open[st->num_open ++] = v;
+}
+
+/*
+ * Find the value of a hash key or the element of an array in the values
+ * built, as "->{'key'}" and "->[n]" do in Perl
+ */
+
+static perlValuePtr * /* O - Place of the value, NULL: not there */
+buildPlace(perlValuePtr *place, /* I - Hash or array, NULL: not there */
+	   const char *key,     /* I - Hash key, NULL: array element */
+	   int n) {             /* I - Index of the array element */
+  int i, keylength;
+
+  if ((place == NULL) || (*place == NULL)) return(NULL);
+  if (key != NULL) {
+    if ((*place)->type != PERL_HASH) return(NULL);
+    keylength = strlen(key);
+    /* The last entry of a key is the valid one, as in Perl */
+    for (i = (*place)->num_items - 1; i >= 0; i --)
+      if (((*place)->keylengths[i] == keylength) &&
+	  !memcmp((*place)->keys[i], key, keylength))
+	break;
+  } else {
+    if ((*place)->type != PERL_ARRAY) return(NULL);
+    i = n;
+  }
+  if ((i < 0) || (i >= (*place)->num_items)) return(NULL);
+  return(&((*place)->items[i]));
+}
+
+/*
+ * Functions for the lines of the Perl data. Each one appends the text of
+ * a hash entry or array element, with the given indentation and a NULL
+ * key for array elements, or builds its value for the converter. The
+ * keys of strings and bare values are fixed names, only the keys of
+ * hashes and arrays can come from the data and get quoted.
+ */
+
+static const char * /* O - Hash key */
+perlKey(const xmlChar *str) { /* I - String of the data used as key */
+  return((str == NULL) ? "(null)" : (const char *) str);
+}
+
+static void
+outputKey(outputPtr out,       /* I/O - Output buffer */
+	  int indent,          /* I - Indentation of the line */
+	  const char *key,     /* I - Hash key, NULL: array element */
+	  int quote) {         /* I - Key from the data, to be quoted? */
+  char   *d;
+  size_t length;
+
+  if ((key == NULL) || quote) {
+    outputIndent(out, indent);
+    if (key == NULL) return;
+    outputLiteral(out, "'");
+    outputPerlString(out, (const xmlChar *) key);
+    outputLiteral(out, "' => ");
+    return;
+  }
+  /* A fixed name, the beginning of the line is put together in one go */
+  length = strlen(key);
+  d = outputRoom(out, indent + length + 6);
+  memset(d, ' ', indent);
+  d[indent] = '\'';
+  memcpy(d + indent + 1, key, length);
+  memcpy(d + indent + 1 + length, "' => ", 5);
+  out->length += indent + length + 6;
+}
+
+static void
+outputString(outputPtr out,            /* I/O - Output buffer */
+	     int indent,               /* I - Indentation of the line */
+	     const char *key,          /* I - Hash key, NULL: array element */
+	     const xmlChar *value,     /* I - String value */
+	     int last) {               /* I - Last entry, without comma? */
+  perlValuePtr v;
+
+  if (out->build != NULL) {
+    if (value == NULL) value = (const xmlChar *) "(null)";
+    v = buildValue(out->build, key, PERL_SCALAR);
+    v->text = (const char *) value;
+    v->length = xmlStrlen(value);
+    return;
+  }
+  outputKey(out, indent, key, 0);
+  outputLiteral(out, "'");
+  outputPerlString(out, value);
+  if (last)
+    outputLiteral(out, "'\n");
+  else
+    outputLiteral(out, "',\n");
+}
+
+/*
+ * The most common line of the Perl data, a string field of a hash:
+ * <indent>'key' => 'value',
+ */
+
+static void
+outputField(outputPtr out,            /* I/O - Output buffer */
+	    int indent,               /* I - Indentation of the line */
+	    const char *key,          /* I - Hash key, NULL: array element */
+	    const xmlChar *value) {   /* I - String value */
+  outputString(out, indent, key, value, 0);
+}
+
+static void
+outputUndef(outputPtr out,       /* I/O - Output buffer */
+	    int indent,          /* I - Indentation of the line */
+	    const char *key) {   /* I - Hash key, NULL: array element */
+  if (out->build != NULL) {
+    buildValue(out->build, key, PERL_UNDEF);
+    return;
+  }
+  outputKey(out, indent, key, 0);
+  outputLiteral(out, "undef,\n");
+}
+
+/*
+ * Entry with a value of the data which is Perl code already: a number,
+ * "undef", or "''"
+ */
+
+static void
+outputBare(outputPtr out,           /* I/O - Output buffer */
+	   int indent,              /* I - Indentation of the line */
+	   const char *key,         /* I - Hash key, NULL: array element */
+	   const xmlChar *value) {  /* I - The Perl code */
+  perlValuePtr v;
+
+  if (out->build != NULL) {
+    if (value == NULL)
+      out->build->failed = 1;
+    else if (!xmlStrcmp(value, (const xmlChar *) "undef"))
+      buildValue(out->build, key, PERL_UNDEF);
+    else if (value[0] == '\'') {
+      v = buildValue(out->build, key, PERL_SCALAR);
+      v->text = (const char *) value + 1;
+      v->length = xmlStrlen(value) - 2;
+    } else {
+      v = buildValue(out->build, key, PERL_NUMBER);
+      v->text = (const char *) value;
+      v->length = xmlStrlen(value);
+    }
+    return;
+  }
+  outputKey(out, indent, key, 0);
+  outputText(out, value);
+  outputLiteral(out, ",\n");
+}
+
+/*
+ * A hash or an array, "{" or "[" starts it, its entries follow and
+ * outputClose() ends it
+ */
+
+static void
+outputOpen(outputPtr out,          /* I/O - Output buffer */
+	   int indent,             /* I - Indentation of the line */
+	   const char *key,        /* I - Hash key, NULL: array element */
+	   perlValueType type) {   /* I - PERL_HASH or PERL_ARRAY */
+  if (out->build != NULL) {
+    buildOpen(out->build, key, type);
+    return;
+  }
+  outputKey(out, indent, key, 1);
+  if (type == PERL_HASH)
+    outputLiteral(out, "{\n");
+  else
+    outputLiteral(out, "[\n");
+}
+
+static void
+outputClose(outputPtr out,          /* I/O - Output buffer */
+	    int indent,             /* I - Indentation of the line */
+	    perlValueType type,     /* I - PERL_HASH or PERL_ARRAY */
+	    int last) {             /* I - Last entry, without comma? */
+  if (out->build != NULL) {
+    if (out->build->num_open > 0) out->build->num_open --;
+    return;
+  }
+  outputIndent(out, indent);
+  outputData(out, (type == PERL_HASH) ? "}" : "]", 1);
+  if (last)
+    outputLiteral(out, "\n");
+  else
+    outputLiteral(out, ",\n");
+}
+
+static void
+outputEmpty(outputPtr out,          /* I/O - Output buffer */
+	    int indent,             /* I - Indentation of the line */
+	    const char *key,        /* I - Hash key, NULL: array element */
+	    perlValueType type,     /* I - PERL_HASH or PERL_ARRAY */
+	    int last) {             /* I - Last entry, without comma? */
+  if (out->build != NULL) {
+    buildValue(out->build, key, type);
+    return;
+  }
+  outputKey(out, indent, key, 1);
+  outputData(out, (type == PERL_HASH) ? "{}" : "[]", 2);
+  if (last)
+    outputLiteral(out, "\n");
+  else
+    outputLiteral(out, ",\n");
+}
+
+/*
+ * The hash of a printer, driver, or combo, "$VAR1 = {" ... "};"
+ */
+
+static void
+outputStart(outputPtr out) {     /* I/O - Output buffer */
+  if (out->build != NULL) {
+    buildOpen(out->build, NULL, PERL_HASH);
+    return;
+  }
+  outputLiteral(out, "$VAR1 = {\n");
+}
+
+static void
+outputEnd(outputPtr out) {       /* I/O - Output buffer */
+  if (out->build != NULL) {
+    if (out->build->num_open > 0) out->build->num_open --;
+    return;
+  }
+  outputLiteral(out, "};\n");
+}
+
+/*
+ * The lines behind the combo's hash which make its entries referenced
+ * from more than one place: a choice in "vals" is the one in
+ * "vals_byname", an option in "args_byname" is the one in "args"
+ */
+
+static void
+outputChoiceLink(outputPtr out,           /* I/O - Output buffer */
+		 int arg,                 /* I - Index of the option */
+		 int choice,              /* I - Index of the choice */
+		 const xmlChar *value) {  /* I - Value of the choice */
+  converterPtr st = out->build;
+  perlValuePtr *dest, *src;
+
+  if (st != NULL) {
+    src = buildPlace(buildPlace(&st->root, "args", 0), NULL, arg);
+    dest = buildPlace(buildPlace(src, "vals", 0), NULL, choice);
+    src = buildPlace(buildPlace(src, "vals_byname", 0), perlKey(value), 0);
+    if ((dest == NULL) || (src == NULL))
+      st->failed = 1;
+    else
+      *dest = *src;
+    return;
+  }
+  outputFormat(out, "$VAR1->{'args'}[%d]{'vals'}[%d] = $VAR1->{'args'}[%d]{'vals_byname'}{'%s'};\n",
+	       arg, choice, arg, value);
+}
+
+static void
+outputArgLink(outputPtr out,          /* I/O - Output buffer */
+	      int arg,                /* I - Index of the option */
+	      const xmlChar *name) {  /* I - Name of the option */
+  converterPtr st = out->build;
+  perlValuePtr *dest, *src;
+
+  if (st != NULL) {
+    dest = buildPlace(buildPlace(&st->root, "args_byname", 0),
+		      perlKey(name), 0);
+    src = buildPlace(buildPlace(&st->root, "args", 0), NULL, arg);
+    if ((dest == NULL) || (src == NULL))
+      st->failed = 1;
+    else
+      *dest = *src;
+    return;
+  }
+  outputFormat(out, "$VAR1->{'args_byname'}{'%s'} = $VAR1->{'args'}[%d];\n",
+	       name, arg);
+}
+
+static void
+outputNetInt(outputPtr out, /* I/O - Output buffer */
+	     int n) {       /* I - 32-bit integer, in network byte order */
+  char bytes[4];
+
+  bytes[0] = (n >> 24) & 0xff;
+  bytes[1] = (n >> 16) & 0xff;
+  bytes[2] = (n >> 8) & 0xff;
+  bytes[3] = n & 0xff;
+  outputData(out, bytes, 4);
+}
+
+static void
+outputMarker(outputPtr out, /* I/O - Output buffer */
+	     int marker) {  /* I - Storable marker or byte */
+  char byte = marker;
+
+  outputData(out, &byte, 1);
+}
+
+/*
+ * Put out a value in Storable's network format. Every value put out gets
+ * the next object number, hashes and arrays which were already put out
+ * are referenced by their number, as Storable does with shared data.
+ * Strings are never shared, as their assignment copies them in Perl.
+ */
+
+static void
+storePerlValue(converterPtr st,   /* I/O - Converter state */
+	       outputPtr out,    /* I/O - Output buffer */
+	       perlValuePtr v) { /* I - Value to put out */
+  long n;
+  char *end;
+  int  i;
+
+  if ((v->type == PERL_HASH) || (v->type == PERL_ARRAY)) {
+    if (v->tag >= 0) {
+      outputMarker(out, SX_OBJECT);
+      outputNetInt(out, v->tag);
+      return;
+    }
+    v->tag = st->tagnum ++;
+    outputMarker(out, (v->type == PERL_HASH) ? SX_HASH : SX_ARRAY);
+    outputNetInt(out, v->num_items);
+    for (i = 0; i < v->num_items; i ++) {
+      if ((v->items[i]->type == PERL_HASH) ||
+	  (v->items[i]->type == PERL_ARRAY)) {
+	/* A reference, which is an object on its own */
+	outputMarker(out, SX_REF);
+	st->tagnum ++;
+      }
+      storePerlValue(st, out, v->items[i]);
+      if (v->type == PERL_HASH) {
+	outputNetInt(out, v->keylengths[i]);
+	outputData(out, v->keys[i], v->keylengths[i]);
+      }
+    }
+    return;
+  }
+  st->tagnum ++;
+  if (v->type == PERL_UNDEF) {
+    outputMarker(out, SX_UNDEF);
+    return;
+  }
+  if (v->type == PERL_NUMBER) {
+    n = strtol(v->text, &end, 10);
+    if ((end == v->text + v->length) && (n >= -128) && (n <= 127)) {
+      outputMarker(out, SX_BYTE);
+      outputMarker(out, n + 128);
+      return;
+    } else if ((end == v->text + v->length) &&
+	       (n >= -2147483647L) && (n <= 2147483647L)) {
+      outputMarker(out, SX_NETINT);
+      outputNetInt(out, n);
+      return;
+    }
+  }
+  if (v->length <= 255) {
+    outputMarker(out, SX_SCALAR);
+    outputMarker(out, v->length);
+  } else {
+    outputMarker(out, SX_LSCALAR);
+    outputNetInt(out, v->length);
+  }
+  outputData(out, v->text, v->length);
+}
+
+static void
+outputStorableHeader(outputPtr out) { /* I/O - Output buffer */
+  outputMarker(out, (STORABLE_MAJOR << 1) | 1);
+  outputMarker(out, STORABLE_MINOR);
+}
+
+/*
+ * Put out a string as JSON string, escaping the quote, the backslash, and
+ * the control characters on the fly, the runs of characters in between
+ * are copied in one piece
+ */
+
+static void
+outputJSONString(outputPtr out,       /* I/O - Output buffer */
+		 const char *str,     /* I - String */
+		 int length) {        /* I - Length of the string */
+  static const char hex[] = "0123456789abcdef";
+  const char *s, *end = str + length;
+  char escape[6];
+
+  outputLiteral(out, "\"");
+  for (s = str; s < end; s ++)
+    if ((*s == '"') || (*s == '\\') || ((unsigned char)*s < 0x20)) {
+      outputData(out, str, s - str);
+      str = s + 1;
+      escape[0] = '\\';
+      switch (*s) {
+      case '"' :
+      case '\\' :
+	escape[1] = *s;
+	outputData(out, escape, 2);
+	break;
+      case '\n' :
+	outputLiteral(out, "\\n");
+	break;
+      case '\r' :
+	outputLiteral(out, "\\r");
+	break;
+      case '\t' :
+	outputLiteral(out, "\\t");
+	break;
+      default :
+	memcpy(escape + 1, "u00", 3);
+	escape[4] = hex[(*s >> 4) & 0xf];
+	escape[5] = hex[*s & 0xf];
+	outputData(out, escape, 6);
+      }
+    }
+  outputData(out, str, s - str);
+  outputLiteral(out, "\"");
+}
+
+/*
+ * Put out a value as JSON. Shared hashes and arrays are put out in full
+ * at every place, as JSON has no references. Bare numbers stay numbers
+ * if JSON allows them as they are.
+ */
+
+static void
+outputJSONValue(outputPtr out,    /* I/O - Output buffer */
+		perlValuePtr v) { /* I - Value to put out */
+  const char *s, *end;
+  int i;
+
+  switch (v->type) {
+  case PERL_UNDEF :
+    outputLiteral(out, "null");
+    break;
+  case PERL_NUMBER :
+    /* Only plain integers are JSON numbers as they are */
+    end = v->text + v->length;
+    s = (*v->text == '-') ? v->text + 1 : v->text;
+    for (i = 0; (s + i < end) && (s[i] >= '0') && (s[i] <= '9'); i ++);
+    if ((i > 0) && (s + i == end) && ((*s != '0') || (i == 1)))
+      outputData(out, v->text, v->length);
+    else
+      outputJSONString(out, v->text, v->length);
+    break;
+  case PERL_SCALAR :
+    outputJSONString(out, v->text, v->length);
+    break;
+  case PERL_ARRAY :
+  case PERL_HASH :
+    outputData(out, (v->type == PERL_HASH) ? "{" : "[", 1);
+    for (i = 0; i < v->num_items; i ++) {
+      if (i > 0) outputLiteral(out, ",");
+      if (v->type == PERL_HASH) {
+	outputJSONString(out, v->keys[i], v->keylengths[i]);
+	outputLiteral(out, ":");
+      }
+      outputJSONValue(out, v->items[i]);
+    }
+    outputData(out, (v->type == PERL_HASH) ? "}" : "]", 1);
+    break;
+  }
+}
+
+static void
+converterInit(converterPtr st,        /* O - Converter state */
+	      convertFormat format,   /* I - Format to convert into */
+	      outputPtr out) {        /* I - Where the data goes */
+  st->format = format;
+  st->out = out;
+  arenaInit(&st->values);
+  st->tagnum = 0;
+  st->root = NULL;
+  st->num_open = 0;
+  st->size_open = 16;
+  st->open = (perlValuePtr *) malloc(sizeof(perlValuePtr) * st->size_open);
+  if (st->open == NULL) {
+    fprintf(stderr,"Out of memory!\n");
+    exit(1);
+  }
+  st->failed = 0;
+  st->num_items = 0;
+  if (format == CONVERT_STORABLE) outputInit(&st->items, NULL, NULL);
+}
+
+static void
+converterFree(converterPtr st) {      /* I/O - Converter state */
+  arenaFree(&st->values);
+  free(st->open);
+  if (st->format == CONVERT_STORABLE) outputFree(&st->items);
+}
+
+/*
+ * Function to put out the values which a generator has built through an
+ * output buffer with the converter as Storable or JSON data, and to get
+ * the converter ready for the next document. For the overview the
+ * printers get converted one by one, as elements of the array started by
+ * convertOverviewStart() and finished by convertOverviewEnd().
+ */
+
+static int  /* O - 0: success, 1: data not convertible */
+convertPerlData(converterPtr st,  /* I/O - Converter state */
+		int element,      /* I - Overview element? */
+		int debug) {      /* I - Debug mode flag */
+  perlValuePtr value = st->root;
+
+  st->root = NULL;
+  if ((value == NULL) || st->failed || (st->num_open > 0)) {
+    fprintf(stderr, "Could not convert the generated Perl data!\n");
+    st->num_open = 0;
+    st->failed = 0;
+    arenaReset(&st->values);
+    return(1);
+  }
+  if (st->format == CONVERT_JSON) {
+    if (element && (st->num_items > 0)) outputLiteral(st->out, ",\n");
+    outputJSONValue(st->out, value);
+    if (!element) outputLiteral(st->out, "\n");
+  } else if (element) {
+    if ((value->type == PERL_HASH) || (value->type == PERL_ARRAY)) {
+      outputMarker(&st->items, SX_REF);
+      st->tagnum ++;
+    }
+    storePerlValue(st, &st->items, value);
+  } else {
+    outputStorableHeader(st->out);
+    storePerlValue(st, st->out, value);
+    if (debug) fprintf(stderr, "  Storable data of %d objects\n",
+		       st->tagnum);
+  }
+  if (element) st->num_items ++;
+  arenaReset(&st->values);
+  return(0);
+}
+
+static void
+convertOverviewStart(converterPtr st) { /* I/O - Converter state */
+  if (st->format == CONVERT_JSON)
+    outputLiteral(st->out, "[\n");
+  else
+    st->tagnum = 1; /* Object 0 is the array of the printers */
+}
+
+static void
+convertOverviewEnd(converterPtr st) { /* I/O - Converter state */
+  if (st->format == CONVERT_JSON) {
+    if (st->num_items > 0) outputLiteral(st->out, "\n");
+    outputLiteral(st->out, "]\n");
+  } else {
+    outputStorableHeader(st->out);
+    outputMarker(st->out, SX_ARRAY);
+    outputNetInt(st->out, st->num_items);
+    outputData(st->out, st->items.data, st->items.length);
+  }
+}
+
+/*
+ * Functions to take the parsed data into the arena of the document, the
+ * arena is attached to the document in its _private field. The text is
+ * copied, so that the XML tree can be freed as soon as it is parsed.
  */
 
-static xmlChar* /* O - String with quoted "'" */
-perlquote(xmlChar *str) { /* I - Original string */
-  xmlChar *dest, *s;
-  int offset = 0;
-
-  if (str == NULL) return NULL;
-  dest = xmlStrdup(str);
-  while ((s = (xmlChar *)xmlStrchr((const xmlChar *)(dest + offset),
-				   (xmlChar)'\'')) ||
-	 (s = (xmlChar *)xmlStrchr((const xmlChar *)(dest + offset),
-				   (xmlChar)'\\'))) {
-    offset = s - dest;
-    dest = (xmlChar *)realloc((xmlChar *)dest, 
-			      sizeof(xmlChar) * (xmlStrlen(dest) + 2));
-    s = dest + offset;
-    memmove(s + 1, s, xmlStrlen(dest) + 1 - offset);
-    *s = '\\';
-    offset += 2;
-  }
-  return(dest);
+static void * /* O - Memory, not initialized */
+parseAlloc(xmlDocPtr doc,   /* I - Document, with its arena */
+	   size_t size) {   /* I - Number of bytes */
+  return(arenaAlloc((arenaPtr)doc->_private, size));
+}
+
+static void * /* O - The array, moved if it had to grow */
+parseGrow(xmlDocPtr doc,   /* I - Document, with its arena */
+	  void *array,     /* I - Array */
+	  int count,       /* I - Number of elements with the new one */
+	  size_t size) {   /* I - Size of an element */
+  return(arenaGrow((arenaPtr)doc->_private, array, count, size));
+}
+
+static xmlChar * /* O - Copy of the string in the arena, NULL: none */
+parseString(xmlDocPtr doc,             /* I - Document, with its arena */
+	    const xmlChar *string) {   /* I - String to copy */
+  xmlChar *ret;
+  size_t  length;
+
+  if (string == NULL) return(NULL);
+  length = strlen((const char *)string) + 1;
+  ret = (xmlChar *) parseAlloc(doc, length);
+  memcpy(ret, string, length);
+  return(ret);
+}
+
+static xmlChar * /* O - Text of the nodes in the arena, NULL: none */
+parseText(xmlDocPtr doc,      /* I - Document, with its arena */
+	  xmlNodePtr list) {  /* I - Node list, as for
+				 xmlNodeListGetString() */
+  xmlChar *text, *ret;
+
+  if (list == NULL) return(NULL);
+
+  /* Usually the list is one text node, copy it directly */
+  if ((list->next == NULL) &&
+      ((list->type == XML_TEXT_NODE) ||
+       (list->type == XML_CDATA_SECTION_NODE)))
+    return(parseString(doc, list->content));
+
+  text = xmlNodeListGetString(doc, list, 1);
+  ret = parseString(doc, text);
+  xmlFree(text);
+  return(ret);
+}
+
+static xmlChar * /* O - Value of the attribute in the arena, NULL: none */
+parseProp(xmlDocPtr doc,          /* I - Document, with its arena */
+	  xmlNodePtr node,        /* I - Element */
+	  const xmlChar *name) {  /* I - Name of the attribute */
+  xmlAttrPtr attr;
+  xmlChar    *value, *ret;
+
+  attr = xmlHasProp(node, name);
+  if (attr == NULL) return(NULL);
+  if ((attr->type == XML_ATTRIBUTE_NODE) && (attr->children != NULL))
+    return(parseText(doc, attr->children));
+
+  value = xmlGetProp(node, name);
+  ret = parseString(doc, value);
+  xmlFree(value);
+  return(ret);
 }
 
 /*
@@ -484,8 +1575,7 @@ getLocalizedText(xmlDocPtr doc,   /* I - The whole data tree */
     while (cur1 != NULL) {
       /* Exact match of locale ID */
       if ((!xmlStrcasecmp(cur1->name, language))) {
-	*ret = xmlStrdup
-	  (perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1)));
+	*ret = parseText(doc, cur1->xmlChildrenNode);
 	if (debug)
 	  fprintf
 	    (stderr,
@@ -499,8 +1589,7 @@ getLocalizedText(xmlDocPtr doc,   /* I - The whole data tree */
     while (cur1 != NULL) {
       /* Fall back to match only the two-character language code */
       if ((!xmlStrncasecmp(cur1->name, language, 2))) {
-	*ret = xmlStrdup
-	  (perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1)));
+	*ret = parseText(doc, cur1->xmlChildrenNode);
 	if (debug)
 	  fprintf
 	    (stderr,
@@ -515,8 +1604,7 @@ getLocalizedText(xmlDocPtr doc,   /* I - The whole data tree */
   while (cur1 != NULL) {
     /* Fall back to English */
     if ((!xmlStrncasecmp(cur1->name, (const xmlChar *) "en", 2))) {
-      *ret = xmlStrdup
-	(perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1)));
+      *ret = parseText(doc, cur1->xmlChildrenNode);
       if (debug)
 	fprintf(stderr, "    English text:\n\n%s\n\n", *ret);
       return;
@@ -526,7 +1614,7 @@ getLocalizedText(xmlDocPtr doc,   /* I - The whole data tree */
   cur1 = node->xmlChildrenNode;
   /* Fall back to non-localized text (allows backward compatibility if
      deciding on localizing a database item later */
-  *ret = xmlStrdup(perlquote(xmlNodeListGetString(doc, cur1, 1)));
+  *ret = parseText(doc, cur1);
   if (debug)
     fprintf(stderr, "    Non-localized text:\n\n%s\n\n", *ret);
 }
@@ -550,10 +1638,9 @@ getLocalizedLicenseText(xmlDocPtr doc,   /* I - The whole data tree */
     while (cur1 != NULL) {
       /* Exact match of locale ID */
       if ((!xmlStrcasecmp(cur1->name, language))) {
-	*link = xmlGetProp(cur1, (const xmlChar *) "url");
+	*link = parseProp(doc, cur1, (const xmlChar *) "url");
 	if (*link == NULL) {
-	  *text = xmlStrdup
-	    (perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1)));
+	  *text = parseText(doc, cur1->xmlChildrenNode);
 	  if (debug)
 	    fprintf
 	      (stderr,
@@ -576,10 +1663,9 @@ getLocalizedLicenseText(xmlDocPtr doc,   /* I - The whole data tree */
       while (cur1 != NULL) {
 	/* Fall back to match only the two-character language code */
 	if ((!xmlStrncasecmp(cur1->name, language, 2))) {
-	  *link = xmlGetProp(cur1, (const xmlChar *) "url");
+	  *link = parseProp(doc, cur1, (const xmlChar *) "url");
 	  if (*link == NULL) {
-	    *text = xmlStrdup
-	      (perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1)));
+	    *text = parseText(doc, cur1->xmlChildrenNode);
 	    if (debug)
 	      fprintf
 		(stderr,
@@ -603,10 +1689,9 @@ getLocalizedLicenseText(xmlDocPtr doc,   /* I - The whole data tree */
   while (cur1 != NULL) {
     /* Fall back to English and/or extract original, English text/link */
     if ((!xmlStrncasecmp(cur1->name, (const xmlChar *) "en", 2))) {
-      *origlink = xmlGetProp(cur1, (const xmlChar *) "url");
+      *origlink = parseProp(doc, cur1, (const xmlChar *) "url");
       if (*origlink == NULL) {
-	*origtext = xmlStrdup
-	  (perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1)));
+	*origtext = parseText(doc, cur1->xmlChildrenNode);
 	if (debug)
 	  fprintf(stderr, "    Original English text:\n\n%s\n\n", *origtext);
 	if (localizedtextfound == 0) {
@@ -633,9 +1718,9 @@ getLocalizedLicenseText(xmlDocPtr doc,   /* I - The whole data tree */
   cur1 = node->xmlChildrenNode;
   /* Fall back to non-localized text (allows backward compatibility if
      deciding on localizing a database item later */
-  *link = xmlGetProp(cur1, (const xmlChar *) "url");
+  *link = parseProp(doc, cur1, (const xmlChar *) "url");
   if (*link == NULL) {
-    *text = xmlStrdup(perlquote(xmlNodeListGetString(doc, cur1, 1)));
+    *text = parseText(doc, cur1);
     *origtext = *text;
     if (debug)
       fprintf(stderr, "    Non-localized text:\n\n%s\n\n", *text);
@@ -667,15 +1752,10 @@ parseMarginEntry(xmlDocPtr doc,   /* I - The whole combo data tree */
   /* Allocate memory for the margin record */
   ret->num_marginRecords ++;
   ret->marginRecords =
-    (marginRecordPtr *)realloc
-    ((marginRecordPtr *)(ret->marginRecords), 
-     sizeof(marginRecordPtr) * ret->num_marginRecords);
-  marginRec = (marginRecordPtr) malloc(sizeof(marginRecord));
-  if (marginRec == NULL) {
-    fprintf(stderr,"Out of memory!\n");
-    xmlFreeDoc(doc);
-    exit(1);
-  }
+    (marginRecordPtr *)parseGrow(doc, ret->marginRecords,
+				 ret->num_marginRecords,
+				 sizeof(marginRecordPtr));
+  marginRec = (marginRecordPtr) parseAlloc(doc, sizeof(marginRecord));
   ret->marginRecords[ret->num_marginRecords-1] = marginRec;
   memset(marginRec, 0, sizeof(marginRecord));
 
@@ -690,9 +1770,9 @@ parseMarginEntry(xmlDocPtr doc,   /* I - The whole combo data tree */
 
   /* Get page size */
   if (entrytype > 0) {
-    pagesize = xmlGetProp(node, (const xmlChar *) "PageSize");
+    pagesize = parseProp(doc, node, (const xmlChar *) "PageSize");
     if (pagesize != NULL) {
-      marginRec->pagesize = perlquote(pagesize);
+      marginRec->pagesize = pagesize;
       if (debug) fprintf(stderr, "    Margins for page size %s\n", 
 			 marginRec->pagesize);
     } else {
@@ -709,34 +1789,32 @@ parseMarginEntry(xmlDocPtr doc,   /* I - The whole combo data tree */
   while (cur1 != NULL) {
     if ((!xmlStrcmp(cur1->name, (const xmlChar *) "unit"))) {
       marginRec->unit = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "      Unit: %s\n", marginRec->unit);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "absolute"))) {
       marginRec->absolute = (xmlChar *)"1";
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
       if (debug) fprintf(stderr, "      Absolute values\n");
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "relative"))) {
       marginRec->absolute = (xmlChar *)"0";
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
       if (debug) fprintf(stderr, "      Relative values\n");
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "left"))) {
       marginRec->left = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "      Left margin: %s\n",
 			 marginRec->left);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "right"))) {
       marginRec->right = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "      Right margin: %s\n",
 			 marginRec->right);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "top"))) {
       marginRec->top = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "      Top margin: %s\n",
 			 marginRec->top);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "bottom"))) {
       marginRec->bottom = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "      Bottom margin: %s\n",
 			 marginRec->bottom);
     }
@@ -754,12 +1832,7 @@ parseMargins(xmlDocPtr doc,   /* I - The whole combo data tree */
   xmlNodePtr     cur1;  /* XML node currently worked on */
 
   /* Allocate memory for the margins data structure */
-  *ret = (marginsPtr) malloc(sizeof(margins));
-  if (*ret == NULL) {
-    fprintf(stderr,"Out of memory!\n");
-    xmlFreeDoc(doc);
-    exit(1);
-  }
+  *ret = (marginsPtr) parseAlloc(doc, sizeof(margins));
   memset(*ret, 0, sizeof(margins));
 
   /* Initialization of entries */
@@ -809,15 +1882,10 @@ parseOverviewPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
   /* Allocate memory for the printer */
   ret->num_overviewPrinters ++;
   ret->overviewPrinters =
-    (overviewPrinterPtr *)realloc
-    ((overviewPrinterPtr *)(ret->overviewPrinters), 
-     sizeof(overviewPrinterPtr) * ret->num_overviewPrinters);
-  printer = (overviewPrinterPtr) malloc(sizeof(overviewPrinter));
-  if (printer == NULL) {
-    fprintf(stderr,"Out of memory!\n");
-    xmlFreeDoc(doc);
-    exit(1);
-  }
+    (overviewPrinterPtr *)parseGrow(doc, ret->overviewPrinters,
+				    ret->num_overviewPrinters,
+				    sizeof(overviewPrinterPtr));
+  printer = (overviewPrinterPtr) parseAlloc(doc, sizeof(overviewPrinter));
   ret->overviewPrinters[ret->num_overviewPrinters-1] = printer;
   memset(printer, 0, sizeof(overviewPrinter));
 
@@ -859,20 +1927,20 @@ parseOverviewPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
   while (cur1 != NULL) {
     if ((!xmlStrcmp(cur1->name, (const xmlChar *) "id"))) {
       printer->id = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Printer ID: %s\n", printer->id);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "make"))) {
       printer->make = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Printer Manufacturer: %s\n", 
 			 printer->make);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "model"))) {
       printer->model = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Printer Model: %s\n", printer->model);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "functionality"))) {
       printer->functionality = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Printer Functionality: %s\n",
 			 printer->functionality);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "unverified"))) {
@@ -883,7 +1951,7 @@ parseOverviewPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
       if (debug) fprintf(stderr, "  Printer XML entry does not exist in the database\n");
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "driver"))) {
       printer->driver = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Recommended driver: %s\n",
 			 printer->driver);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "drivers"))) {
@@ -891,7 +1959,7 @@ parseOverviewPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
       while (cur2 != NULL) {
 	if ((!xmlStrcmp(cur2->name, (const xmlChar *) "driver"))) {
 	  drivername =
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  driverfound = 0;
 	  for (i = 0; i < printer->num_drivers; i++) {
 	    dentry = printer->drivers[i];
@@ -904,16 +1972,11 @@ parseOverviewPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	  if (!driverfound) {
 	    printer->num_drivers ++;
 	    printer->drivers =
-	      (printerDrvEntryPtr *)
-	      realloc((printerDrvEntryPtr *)printer->drivers, 
-		      sizeof(printerDrvEntryPtr) * 
-		      printer->num_drivers);
-	    dentry = (printerDrvEntryPtr) malloc(sizeof(printerDrvEntry));
-	    if (dentry == NULL) {
-	      fprintf(stderr,"Out of memory!\n");
-	      xmlFreeDoc(doc);
-	      exit(1);
-	    }
+	      (printerDrvEntryPtr *)parseGrow(doc, printer->drivers,
+					      printer->num_drivers,
+					      sizeof(printerDrvEntryPtr));
+	    dentry =
+	      (printerDrvEntryPtr) parseAlloc(doc, sizeof(printerDrvEntry));
 	    printer->drivers[printer->num_drivers-1] = dentry;
 	    memset(dentry, 0, sizeof(printerDrvEntry));
 	    dentry->name = NULL;
@@ -945,7 +2008,7 @@ parseOverviewPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "driver"))) {
 	      drivername =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug)
 		fprintf(stderr, "  Functionality exceptions for driver: %s\n",
 			drivername);
@@ -959,11 +2022,6 @@ parseOverviewPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 		    for (j = i + 1; j < printer->num_drivers; j++)
 		      printer->drivers[j - 1] = printer->drivers[j];
 		    printer->num_drivers --;
-		    printer->drivers =
-		      (printerDrvEntryPtr *)
-		      realloc((printerDrvEntryPtr *)printer->drivers, 
-			      sizeof(printerDrvEntryPtr) * 
-			      printer->num_drivers);
 		    break;
 		  }
 		}
@@ -984,16 +2042,11 @@ parseOverviewPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	      if (!driverfound) {
 		printer->num_drivers ++;
 		printer->drivers =
-		  (printerDrvEntryPtr *)
-		  realloc((printerDrvEntryPtr *)printer->drivers, 
-			  sizeof(printerDrvEntryPtr) * 
-			  printer->num_drivers);
-		dentry = (printerDrvEntryPtr) malloc(sizeof(printerDrvEntry));
-		if (dentry == NULL) {
-		  fprintf(stderr,"Out of memory!\n");
-		  xmlFreeDoc(doc);
-		  exit(1);
-		}
+		  (printerDrvEntryPtr *)parseGrow(doc, printer->drivers,
+						  printer->num_drivers,
+						  sizeof(printerDrvEntryPtr));
+		dentry =
+		  (printerDrvEntryPtr) parseAlloc(doc, sizeof(printerDrvEntry));
 		printer->drivers[printer->num_drivers-1] = dentry;
 		memset(dentry, 0, sizeof(printerDrvEntry));
 		dentry->name = NULL;
@@ -1019,13 +2072,13 @@ parseOverviewPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	      while (cur4 != NULL) {
 		if ((!xmlStrcmp(cur4->name, (const xmlChar *) "maxresx"))) {
 		  dentry->excmaxresx =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "    Maximum X resolution: %s\n",
 			    dentry->excmaxresx);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "maxresy"))) {
 		  dentry->excmaxresy =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "    Maximum Y resolution: %s\n",
 			    dentry->excmaxresy);
@@ -1041,37 +2094,37 @@ parseOverviewPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 			    dentry->exccolor);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "text"))) {
 		  dentry->exctext =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "    Support level for text: %s\n",
 			    dentry->exctext);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "lineart"))) {
 		  dentry->exclineart =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "    Support level for line art: %s\n",
 			    dentry->exclineart);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "graphics"))) {
 		  dentry->excgraphics =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "    Support level for graphics: %s\n",
 			    dentry->excgraphics);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "photo"))) {
 		  dentry->excphoto =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "    Support level for photos: %s\n",
 			    dentry->excphoto);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "load"))) {
 		  dentry->excload =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "    Expected relative system load: %s\n",
 			    dentry->excload);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "speed"))) {
 		  dentry->excspeed =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "    Expected relative driver speed: %s\n",
 			    dentry->excspeed);
@@ -1090,16 +2143,9 @@ parseOverviewPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	if ((!xmlStrcmp(cur2->name, (const xmlChar *) "ppd"))) {
 	  printer->num_ppdfiles ++;
 	  printer->ppdfiles =
-	    (ppdFilePtr *)
-	    realloc((ppdFilePtr *)printer->ppdfiles, 
-		    sizeof(ppdFilePtr) *
-		    printer->num_ppdfiles);
-	  ppd = (ppdFilePtr) malloc(sizeof(ppdFile));
-	  if (ppd == NULL) {
-	    fprintf(stderr,"Out of memory!\n");
-	    xmlFreeDoc(doc);
-	    exit(1);
-	  }
+	    (ppdFilePtr *)parseGrow(doc, printer->ppdfiles,
+				    printer->num_ppdfiles, sizeof(ppdFilePtr));
+	  ppd = (ppdFilePtr) parseAlloc(doc, sizeof(ppdFile));
 	  printer->ppdfiles[printer->num_ppdfiles-1] = ppd;
 	  memset(ppd, 0, sizeof(ppdFile));
 	  ppd->driver = NULL;
@@ -1109,12 +2155,12 @@ parseOverviewPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "driver"))) {
 	      ppd->driver =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    For driver: %s\n",
 				 ppd->driver);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "ppdfile"))) {
 	      ppd->filename =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    File name: %s\n",
 				 ppd->filename);
 	    }
@@ -1132,31 +2178,26 @@ parseOverviewPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "ieee1284"))) {
 	      printer->general_ieee =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    IEEE1284: %s\n",
 				 printer->general_ieee);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "manufacturer"))) {
 	      printer->general_mfg =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MFG: %s\n", printer->general_mfg);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "model"))) {
 	      printer->general_mdl =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MDL: %s\n", printer->general_mdl);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "description"))) {
 	      printer->general_des =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    DES: %s\n", printer->general_des);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "commandset"))) {
 	      printer->general_cmd =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    CMD: %s\n", printer->general_cmd);
 	    }
 	    cur3 = cur3->next;
@@ -1167,31 +2208,26 @@ parseOverviewPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "ieee1284"))) {
 	      printer->par_ieee =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    IEEE1284: %s\n",
 				 printer->par_ieee);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "manufacturer"))) {
 	      printer->par_mfg =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MFG: %s\n", printer->par_mfg);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "model"))) {
 	      printer->par_mdl =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MDL: %s\n", printer->par_mdl);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "description"))) {
 	      printer->par_des =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    DES: %s\n", printer->par_des);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "commandset"))) {
 	      printer->par_cmd =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    CMD: %s\n", printer->par_cmd);
 	    }
 	    cur3 = cur3->next;
@@ -1202,31 +2238,26 @@ parseOverviewPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "ieee1284"))) {
 	      printer->usb_ieee =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    IEEE1284: %s\n",
 				 printer->usb_ieee);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "manufacturer"))) {
 	      printer->usb_mfg =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MFG: %s\n", printer->usb_mfg);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "model"))) {
 	      printer->usb_mdl =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MDL: %s\n", printer->usb_mdl);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "description"))) {
 	      printer->usb_des =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    DES: %s\n", printer->usb_des);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "commandset"))) {
 	      printer->usb_cmd =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    CMD: %s\n", printer->usb_cmd);
 	    }
 	    cur3 = cur3->next;
@@ -1237,31 +2268,26 @@ parseOverviewPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "ieee1284"))) {
 	      printer->snmp_ieee =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    IEEE1284: %s\n",
 				 printer->snmp_ieee);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "manufacturer"))) {
 	      printer->snmp_mfg =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MFG: %s\n", printer->snmp_mfg);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "model"))) {
 	      printer->snmp_mdl =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MDL: %s\n", printer->snmp_mdl);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "description"))) {
 	      printer->snmp_des =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    DES: %s\n", printer->snmp_des);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "commandset"))) {
 	      printer->snmp_cmd =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    CMD: %s\n", printer->snmp_cmd);
 	    }
 	    cur3 = cur3->next;
@@ -1333,12 +2359,12 @@ parseComboPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
   ret->drivers = NULL;
 
   /* Get printer ID */
-  id = xmlGetProp(node, (const xmlChar *) "id");
+  id = parseProp(doc, node, (const xmlChar *) "id");
   if (id == NULL) {
     fprintf(stderr, "No printer ID found\n");
     return;
   }
-  ret->id = perlquote(id + 8);
+  ret->id = id + 8;
   if (debug) fprintf(stderr, "  Printer ID: %s\n", ret->id);
 
   /* Go through subnodes */
@@ -1346,15 +2372,15 @@ parseComboPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
   while (cur1 != NULL) {
     if ((!xmlStrcmp(cur1->name, (const xmlChar *) "make"))) {
       ret->make = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Printer Manufacturer: %s\n", ret->make);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "model"))) {
       ret->model = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Printer Model: %s\n", ret->model);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "driver"))) {
       ret->recdriver = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Recommended driver: %s\n", 
 			 ret->recdriver);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "drivers"))) {
@@ -1363,16 +2389,11 @@ parseComboPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	if ((!xmlStrcmp(cur2->name, (const xmlChar *) "driver"))) {
 	  ret->num_drivers ++;
 	  ret->drivers =
-	    (printerDrvEntryPtr *)
-	    realloc((printerDrvEntryPtr *)ret->drivers, 
-		    sizeof(printerDrvEntryPtr) * 
-		    ret->num_drivers);
-	  dentry = (printerDrvEntryPtr) malloc(sizeof(printerDrvEntry));
-	  if (dentry == NULL) {
-	    fprintf(stderr,"Out of memory!\n");
-	    xmlFreeDoc(doc);
-	    exit(1);
-	  }
+	    (printerDrvEntryPtr *)parseGrow(doc, ret->drivers,
+					    ret->num_drivers,
+					    sizeof(printerDrvEntryPtr));
+	  dentry =
+	    (printerDrvEntryPtr) parseAlloc(doc, sizeof(printerDrvEntry));
 	  ret->drivers[ret->num_drivers-1] = dentry;
 	  memset(dentry, 0, sizeof(printerDrvEntry));
 	  dentry->name = NULL;
@@ -1392,14 +2413,14 @@ parseComboPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "id"))) {
 	      dname =
-		xmlNodeListGetString(doc, cur3->xmlChildrenNode, 1);
-	      dentry->name = perlquote(dname);
+		parseText(doc, cur3->xmlChildrenNode);
+	      dentry->name = dname;
 	      if (debug) fprintf(stderr, "    Name: %s\n",
 				 dentry->name);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "ppd"))) {
 	      dppd =
-		xmlNodeListGetString(doc, cur3->xmlChildrenNode, 1);
-	      dentry->ppd = perlquote(dppd);
+		parseText(doc, cur3->xmlChildrenNode);
+	      dentry->ppd = dppd;
 	      if (debug) fprintf(stderr, "    Ready-made PPD: %s\n",
 				 dentry->ppd);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "functionality"))) {
@@ -1407,13 +2428,13 @@ parseComboPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	      while (cur4 != NULL) {
 		if ((!xmlStrcmp(cur4->name, (const xmlChar *) "maxresx"))) {
 		  dentry->excmaxresx =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "    Maximum X resolution: %s\n",
 			    dentry->excmaxresx);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "maxresy"))) {
 		  dentry->excmaxresy =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "    Maximum Y resolution: %s\n",
 			    dentry->excmaxresy);
@@ -1429,37 +2450,37 @@ parseComboPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 			    dentry->exccolor);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "text"))) {
 		  dentry->exctext =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "    Support level for text: %s\n",
 			    dentry->exctext);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "lineart"))) {
 		  dentry->exclineart =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "    Support level for line art: %s\n",
 			    dentry->exclineart);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "graphics"))) {
 		  dentry->excgraphics =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "    Support level for graphics: %s\n",
 			    dentry->excgraphics);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "photo"))) {
 		  dentry->excphoto =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "    Support level for photos: %s\n",
 			    dentry->excphoto);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "load"))) {
 		  dentry->excload =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "    Expected relative system load: %s\n",
 			    dentry->excload);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "speed"))) {
 		  dentry->excspeed =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "    Expected relative driver speed: %s\n",
 			    dentry->excspeed);
@@ -1478,12 +2499,12 @@ parseComboPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
       }
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "ppdentry"))) {
       ret->printerppdentry = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Extra lines for PPD file:\n%s\n", 
 			 ret->printerppdentry);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "pcmodel"))) {
       ret->pcmodel = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr,
 			 "  Model part for PC filename in PPD: %s\n",
 			 ret->pcmodel);
@@ -1495,8 +2516,7 @@ parseComboPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "ppd"))) {
 	      ret->ppdurl =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr,
 				 "  URL for the PPD for this printer: %s\n",
 				 ret->ppdurl);
@@ -1528,7 +2548,7 @@ parseComboPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "charset"))) {
 	      charset =
-		xmlNodeListGetString(doc, cur3->xmlChildrenNode, 1);
+		parseText(doc, cur3->xmlChildrenNode);
 	      if ((!xmlStrcmp(charset, (const xmlChar *) "us-ascii")) ||
 		  (!xmlStrcmp(charset, (const xmlChar *) "iso-8859-1")) ||
 		  (!xmlStrcmp(charset, (const xmlChar *) "iso-8859-15"))) {
@@ -1550,31 +2570,26 @@ parseComboPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "ieee1284"))) {
 	      ret->general_ieee =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    IEEE1284: %s\n", 
 				 ret->general_ieee);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "manufacturer"))) {
 	      ret->general_mfg =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MFG: %s\n", ret->general_mfg);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "model"))) {
 	      ret->general_mdl =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MDL: %s\n", ret->general_mdl);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "description"))) {
 	      ret->general_des =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    DES: %s\n", ret->general_des);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "commandset"))) {
 	      ret->general_cmd =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    CMD: %s\n", ret->general_cmd);
 	    }
 	    cur3 = cur3->next;
@@ -1585,31 +2600,26 @@ parseComboPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "ieee1284"))) {
 	      ret->par_ieee =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    IEEE1284: %s\n", 
 				 ret->par_ieee);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "manufacturer"))) {
 	      ret->par_mfg =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MFG: %s\n", ret->par_mfg);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "model"))) {
 	      ret->par_mdl =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MDL: %s\n", ret->par_mdl);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "description"))) {
 	      ret->par_des =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    DES: %s\n", ret->par_des);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "commandset"))) {
 	      ret->par_cmd =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    CMD: %s\n", ret->par_cmd);
 	    }
 	    cur3 = cur3->next;
@@ -1620,31 +2630,26 @@ parseComboPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "ieee1284"))) {
 	      ret->usb_ieee =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    IEEE1284: %s\n", 
 				 ret->usb_ieee);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "manufacturer"))) {
 	      ret->usb_mfg =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MFG: %s\n", ret->usb_mfg);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "model"))) {
 	      ret->usb_mdl =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MDL: %s\n", ret->usb_mdl);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "description"))) {
 	      ret->usb_des =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    DES: %s\n", ret->usb_des);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "commandset"))) {
 	      ret->usb_cmd =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    CMD: %s\n", ret->usb_cmd);
 	    }
 	    cur3 = cur3->next;
@@ -1655,31 +2660,26 @@ parseComboPrinter(xmlDocPtr doc, /* I - The whole combo data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "ieee1284"))) {
 	      ret->snmp_ieee =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    IEEE1284: %s\n", 
 				 ret->snmp_ieee);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "manufacturer"))) {
 	      ret->snmp_mfg =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MFG: %s\n", ret->snmp_mfg);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "model"))) {
 	      ret->snmp_mdl =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MDL: %s\n", ret->snmp_mdl);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "description"))) {
 	      ret->snmp_des =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    DES: %s\n", ret->snmp_des);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "commandset"))) {
 	      ret->snmp_cmd =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    CMD: %s\n", ret->snmp_cmd);
 	    }
 	    cur3 = cur3->next;
@@ -1764,12 +2764,12 @@ parseComboDriver(xmlDocPtr doc, /* I - The whole combo data tree */
   ret->combomargins = NULL;
 
   /* Get driver ID */
-  id = xmlGetProp(node, (const xmlChar *) "id");
+  id = parseProp(doc, node, (const xmlChar *) "id");
   if (id == NULL) {
     fprintf(stderr, "No driver ID found\n");
     return;
   }
-  ret->driver = perlquote(id + 7);
+  ret->driver = id + 7;
   if (debug) fprintf(stderr, "  Driver ID: %s\n", ret->driver);
 
   /* Go through subnodes */
@@ -1777,24 +2777,24 @@ parseComboDriver(xmlDocPtr doc, /* I - The whole combo data tree */
   while (cur1 != NULL) {
     if ((!xmlStrcmp(cur1->name, (const xmlChar *) "driver"))) {
       ret->driver = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Driver name: %s\n", ret->driver);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "group"))) {
       ret->driver_group = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Driver group (for localization): %s\n", 
 			 ret->driver_group);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "pcdriver"))) {
       ret->pcdriver = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Driver part of PC file name in PPD: %s\n",
 			 ret->pcdriver);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "url"))) {
       ret->url = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Driver URL: %s\n", ret->url);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "obsolete"))) {
-      ret->driver_obsolete = xmlGetProp(cur1, (const xmlChar *) "replace");
+      ret->driver_obsolete = parseProp(doc, cur1, (const xmlChar *) "replace");
       if (ret->driver_obsolete == NULL) {
 	if (debug) fprintf(stderr, "    No replacement driver found!\n");
 	ret->driver_obsolete = (xmlChar *)"1";
@@ -1807,7 +2807,7 @@ parseComboDriver(xmlDocPtr doc, /* I - The whole combo data tree */
       getLocalizedText(doc, cur1, &(ret->supplier), language, debug);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "manufacturersupplied"))) {
       ret->manufacturersupplied =
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if ((ret->manufacturersupplied == NULL) ||
 	  (ret->manufacturersupplied[0] == '\0'))
 	ret->manufacturersupplied = (xmlChar *)"1";
@@ -1846,25 +2846,20 @@ parseComboDriver(xmlDocPtr doc, /* I - The whole combo data tree */
 	if ((!xmlStrcmp(cur2->name, (const xmlChar *) "supportcontact"))) {
 	  ret->num_supportcontacts ++;
 	  ret->supportcontacts =
-	    (xmlChar const **)
-	    realloc((xmlChar **)ret->supportcontacts, 
-		    sizeof(xmlChar *) * 
-		    ret->num_supportcontacts);
+	    (xmlChar const **)parseGrow(doc, ret->supportcontacts,
+					ret->num_supportcontacts,
+					sizeof(xmlChar *));
 	  ret->supportcontacturls =
-	    (xmlChar **)
-	    realloc((xmlChar **)ret->supportcontacturls, 
-		    sizeof(xmlChar *) * 
-		    ret->num_supportcontacts);
+	    (xmlChar **)parseGrow(doc, ret->supportcontacturls,
+				  ret->num_supportcontacts, sizeof(xmlChar *));
 	  ret->supportcontactlevels =
-	    (xmlChar **)
-	    realloc((xmlChar **)ret->supportcontactlevels, 
-		    sizeof(xmlChar *) * 
-		    ret->num_supportcontacts);
-	  level = xmlGetProp(cur2, (const xmlChar *) "level");
+	    (xmlChar **)parseGrow(doc, ret->supportcontactlevels,
+				  ret->num_supportcontacts, sizeof(xmlChar *));
+	  level = parseProp(doc, cur2, (const xmlChar *) "level");
 	  if (level == NULL) {
 	    level = (xmlChar *)"Unknown";
 	  }
-	  url = xmlGetProp(cur2, (const xmlChar *) "url");
+	  url = parseProp(doc, cur2, (const xmlChar *) "url");
 	  ret->supportcontactlevels[ret->num_supportcontacts - 1] = level;
 	  ret->supportcontacturls[ret->num_supportcontacts - 1] = url;
 	  getLocalizedText
@@ -1885,7 +2880,7 @@ parseComboDriver(xmlDocPtr doc, /* I - The whole combo data tree */
       getLocalizedText(doc, cur1, &(ret->shortdescription), language, debug);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "locales"))) {
       ret->locales = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Driver list of locales: %s\n", ret->locales);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "packages"))) {
       cur2 = cur1->xmlChildrenNode;
@@ -1894,26 +2889,20 @@ parseComboDriver(xmlDocPtr doc, /* I - The whole combo data tree */
 	if ((!xmlStrcmp(cur2->name, (const xmlChar *) "package"))) {
 	  ret->num_packages ++;
 	  ret->packageurls =
-	    (xmlChar **)
-	    realloc((xmlChar **)ret->packageurls, 
-		    sizeof(xmlChar *) * 
-		    ret->num_packages);
+	    (xmlChar **)parseGrow(doc, ret->packageurls, ret->num_packages,
+				  sizeof(xmlChar *));
 	  ret->packagescopes =
-	    (xmlChar **)
-	    realloc((xmlChar **)ret->packagescopes, 
-		    sizeof(xmlChar *) * 
-		    ret->num_packages);
-	  scope = xmlGetProp(cur2, (const xmlChar *) "scope");
+	    (xmlChar **)parseGrow(doc, ret->packagescopes, ret->num_packages,
+				  sizeof(xmlChar *));
+	  scope = parseProp(doc, cur2, (const xmlChar *) "scope");
 	  ret->packagefingerprints =
-	    (xmlChar **)
-	    realloc((xmlChar **)ret->packagefingerprints, 
-		    sizeof(xmlChar *) * 
-		    ret->num_packages);
-	  fingerprint = xmlGetProp(cur2, (const xmlChar *) "fingerprint");
+	    (xmlChar **)parseGrow(doc, ret->packagefingerprints,
+				  ret->num_packages, sizeof(xmlChar *));
+	  fingerprint = parseProp(doc, cur2, (const xmlChar *) "fingerprint");
 	  ret->packageurls[ret->num_packages - 1] =
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
-	  ret->packagescopes[ret->num_packages - 1] = perlquote(scope);
-	  ret->packagefingerprints[ret->num_packages - 1] = perlquote(fingerprint);
+	    parseText(doc, cur2->xmlChildrenNode);
+	  ret->packagescopes[ret->num_packages - 1] = scope;
+	  ret->packagefingerprints[ret->num_packages - 1] = fingerprint;
 	  if (debug)
 	    fprintf(stderr, "    %s (%s), key fingerprint on %s\n", 
 		    ret->packageurls[ret->num_packages - 1],
@@ -1927,13 +2916,13 @@ parseComboDriver(xmlDocPtr doc, /* I - The whole combo data tree */
       while (cur2 != NULL) {
 	if ((!xmlStrcmp(cur2->name, (const xmlChar *) "maxresx"))) {
 	  ret->drvmaxresx = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug)
 	    fprintf(stderr, "  Driver functionality: Max X resolution: %s\n",
 		    ret->drvmaxresx);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "maxresy"))) {
 	  ret->drvmaxresy = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug)
 	    fprintf(stderr, "  Driver functionality: Max Y resolution: %s\n",
 		    ret->drvmaxresy);
@@ -1945,37 +2934,37 @@ parseComboDriver(xmlDocPtr doc, /* I - The whole combo data tree */
 	  if (debug) fprintf(stderr, "  Driver functionality: Monochrome\n");
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "text"))) {
 	  ret->text = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug)
 	    fprintf(stderr, "  Driver functionality: Text support rating: %s\n",
 		    ret->text);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "lineart"))) {
 	  ret->lineart = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug)
 	    fprintf(stderr, "  Driver functionality: Line art support rating: %s\n",
 		    ret->lineart);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "graphics"))) {
 	  ret->graphics = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug)
 	    fprintf(stderr, "  Driver functionality: Graphics support rating: %s\n",
 		    ret->graphics);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "photo"))) {
 	  ret->photo = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug)
 	    fprintf(stderr, "  Driver functionality: Photo support rating: %s\n",
 		    ret->photo);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "load"))) {
 	  ret->load = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug)
 	    fprintf(stderr, "  Driver functionality: System load rating: %s\n",
 		    ret->load);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "speed"))) {
 	  ret->speed = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug)
 	    fprintf(stderr, "  Driver functionality: Speed rating: %s\n",
 		    ret->speed);
@@ -1988,19 +2977,15 @@ parseComboDriver(xmlDocPtr doc, /* I - The whole combo data tree */
 	if ((!xmlStrcmp(cur2->name, (const xmlChar *) "requires"))) {
 	  ret->num_requires ++;
 	  ret->requires =
-	    (xmlChar **)
-	    realloc((xmlChar **)ret->requires, 
-		    sizeof(xmlChar *) * 
-		    ret->num_requires);
+	    (xmlChar **)parseGrow(doc, ret->requires, ret->num_requires,
+				  sizeof(xmlChar *));
 	  ret->requiresversion =
-	    (xmlChar **)
-	    realloc((xmlChar **)ret->requiresversion, 
-		    sizeof(xmlChar *) * 
-		    ret->num_requires);
-	  version = xmlGetProp(cur2, (const xmlChar *) "version");
+	    (xmlChar **)parseGrow(doc, ret->requiresversion, ret->num_requires,
+				  sizeof(xmlChar *));
+	  version = parseProp(doc, cur2, (const xmlChar *) "version");
 	  ret->requires[ret->num_requires - 1] =
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
-	  ret->requiresversion[ret->num_requires - 1] = perlquote(version);
+	    parseText(doc, cur2->xmlChildrenNode);
+	  ret->requiresversion[ret->num_requires - 1] = version;
 	  if (debug) /* an explicit brace for GCC thought police */ {
 	    if (!version)
 	      fprintf(stderr, "  Driver requires driver: %s\n", 
@@ -2038,17 +3023,17 @@ parseComboDriver(xmlDocPtr doc, /* I - The whole combo data tree */
 	  if (debug) fprintf(stderr, "  Driver suppresses CUPS page accounting\n");
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "prototype"))) {
 	  ret->cmd =
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug) fprintf(stderr, "  Driver command line:\n\n    %s\n\n",
 			     ret->cmd);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "prototype_pdf"))) {
 	  ret->cmd_pdf =
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug) fprintf(stderr, "  Driver PDF command line:\n\n    %s\n\n",
 			     ret->cmd_pdf);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "ppdentry"))) {
 	  ret->driverppdentry = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug) fprintf(stderr, "  Extra lines for PPD file:\n%s\n", 
 			     ret->driverppdentry);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "margins"))) {
@@ -2068,8 +3053,8 @@ parseComboDriver(xmlDocPtr doc, /* I - The whole combo data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "ppdentry"))) {
 	      ret->comboppdentry = 
-		perlquote(xmlNodeListGetString(doc,
-					       cur3->xmlChildrenNode, 1));
+		parseText(doc,
+					       cur3->xmlChildrenNode);
 	      if (debug) 
 		fprintf(stderr, "  Extra lines for PPD file:\n%s\n", 
 			ret->comboppdentry);
@@ -2081,13 +3066,13 @@ parseComboDriver(xmlDocPtr doc, /* I - The whole combo data tree */
 	      while (cur4 != NULL) {
 		if ((!xmlStrcmp(cur4->name, (const xmlChar *) "maxresx"))) {
 		  ret->excmaxresx =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "  Combo exception: Maximum X resolution: %s\n",
 			    ret->excmaxresx);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "maxresy"))) {
 		  ret->excmaxresy =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "  Combo exception: Maximum Y resolution: %s\n",
 			    ret->excmaxresy);
@@ -2103,37 +3088,37 @@ parseComboDriver(xmlDocPtr doc, /* I - The whole combo data tree */
 			    ret->exccolor);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "text"))) {
 		  ret->exctext =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "  Combo exception: Support level for text: %s\n",
 			    ret->exctext);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "lineart"))) {
 		  ret->exclineart =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "  Combo exception: Support level for line art: %s\n",
 			    ret->exclineart);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "graphics"))) {
 		  ret->excgraphics =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "  Combo exception: Support level for graphics: %s\n",
 			    ret->excgraphics);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "photo"))) {
 		  ret->excphoto =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "  Combo exception: Support level for photos: %s\n",
 			    ret->excphoto);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "load"))) {
 		  ret->excload =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "  Combo exception: Expected relative system load: %s\n",
 			    ret->excload);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "speed"))) {
 		  ret->excspeed =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "  Combo exception: Expected relative driver speed: %s\n",
 			    ret->excspeed);
@@ -2176,14 +3161,9 @@ parseChoices(xmlDocPtr doc, /* I - The whole combo data tree */
       /* Allocate memory for the option */
       option->num_choices ++;
       option->choices =
-	(choicePtr *)realloc((choicePtr *)(option->choices), 
-			     sizeof(choicePtr) * option->num_choices);
-      enum_val = (choicePtr) malloc(sizeof(arg));
-      if (enum_val == NULL) {
-	fprintf(stderr,"Out of memory!\n");
-	xmlFreeDoc(doc);
-	exit(1);
-      }
+	(choicePtr *)parseGrow(doc, option->choices, option->num_choices,
+			       sizeof(choicePtr));
+      enum_val = (choicePtr) parseAlloc(doc, sizeof(choice));
       option->choices[option->num_choices-1] = enum_val;
       memset(enum_val, 0, sizeof(choice));
 
@@ -2194,12 +3174,12 @@ parseChoices(xmlDocPtr doc, /* I - The whole combo data tree */
       enum_val->driverval = NULL;
 
       /* Get option ID */
-      id = xmlGetProp(cur1, (const xmlChar *) "id");
+      id = parseProp(doc, cur1, (const xmlChar *) "id");
       if (id == NULL) {
 	fprintf(stderr, "No choice ID found\n");
 	return;
       }
-      enum_val->idx = perlquote(id);
+      enum_val->idx = id;
       if (debug) fprintf(stderr, "    Choice ID: %s\n", enum_val->idx);
 
       /* Go through subnodes */
@@ -2215,7 +3195,7 @@ parseChoices(xmlDocPtr doc, /* I - The whole combo data tree */
 	  getLocalizedText(doc, cur2, &(enum_val->comment), language, debug);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "ev_driverval"))) {
 	  enum_val->driverval = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug) fprintf(stderr, "      String to insert at %%s: %s\n",
 			     enum_val->driverval);
 	}
@@ -2252,14 +3232,8 @@ parseOptions(xmlDocPtr doc, /* I - The whole combo data tree */
       /* Allocate memory for the option */
       ret->num_args ++;
       ret->args =
-	(argPtr *)realloc((argPtr *)(ret->args), 
-			  sizeof(argPtr) * ret->num_args);
-      option = (argPtr) malloc(sizeof(arg));
-      if (option == NULL) {
-	fprintf(stderr,"Out of memory!\n");
-	xmlFreeDoc(doc);
-	exit(1);
-      }
+	(argPtr *)parseGrow(doc, ret->args, ret->num_args, sizeof(argPtr));
+      option = (argPtr) parseAlloc(doc, sizeof(arg));
       ret->args[ret->num_args-1] = option;
       memset(option, 0, sizeof(arg));
 
@@ -2287,21 +3261,21 @@ parseOptions(xmlDocPtr doc, /* I - The whole combo data tree */
       option->choices = NULL;
 
       /* Get option ID */
-      id = xmlGetProp(cur1, (const xmlChar *) "id");
+      id = parseProp(doc, cur1, (const xmlChar *) "id");
       if (id == NULL) {
 	fprintf(stderr, "No option ID found\n");
 	return;
       }
-      option->idx = perlquote(id);
+      option->idx = id;
       if (debug) fprintf(stderr, "  Option ID: %s\n", option->idx);
 
       /* Get option type */
-      option_type = xmlGetProp(cur1, (const xmlChar *) "type");
+      option_type = parseProp(doc, cur1, (const xmlChar *) "type");
       if (option_type == NULL) {
 	fprintf(stderr, "No option type found\n");
 	return;
       }
-      option->option_type = perlquote(option_type);
+      option->option_type = option_type;
       if (debug) fprintf(stderr, "    Option type: %s\n",
 			 option->option_type);
 
@@ -2356,8 +3330,7 @@ parseOptions(xmlDocPtr doc, /* I - The whole combo data tree */
 			"    Option style: Forced composite option\n");
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "arg_spot"))) {
 	      option->spot =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr,
 				 "    Command line insertion spot: %%%s\n",
 				 option->spot);
@@ -2366,29 +3339,25 @@ parseOptions(xmlDocPtr doc, /* I - The whole combo data tree */
 	      }
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "arg_order"))) {
 	      option->order =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr,
 				 "    Command line insertion order: %s\n",
 				 option->order);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "arg_section"))) {
 	      option->section =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr,
 				 "    Section in PostScript file: %s\n",
 				 option->section);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "arg_group"))) {
 	      option->grouppath =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr,
 				 "    Option Group: %s\n",
 				 option->grouppath);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "arg_proto"))) {
 	      option->proto =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr,
 				 "    Code to insert: %s\n",
 				 option->proto);
@@ -2401,40 +3370,40 @@ parseOptions(xmlDocPtr doc, /* I - The whole combo data tree */
 	  }
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "arg_min"))) {
 	  option->min_value = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug) fprintf(stderr,
 			     "    Minimum value: %s\n",
 			     option->min_value);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "arg_max"))) {
 	  option->max_value = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug) fprintf(stderr,
 			     "    Maximum value: %s\n",
 			     option->max_value);
 	} else if ((!xmlStrcmp(cur2->name,
 			       (const xmlChar *) "arg_maxlength"))) {
 	  option->max_length = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug) fprintf(stderr,
 			     "    Maximum string length: %s\n",
 			     option->max_length);
 	} else if ((!xmlStrcmp(cur2->name,
 			       (const xmlChar *) "arg_allowedchars"))) {
 	  option->allowed_chars = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug) fprintf(stderr,
 			     "    Allowed characters in string: %s\n",
 			     option->allowed_chars);
 	} else if ((!xmlStrcmp(cur2->name,
 			       (const xmlChar *) "arg_allowedregexp"))) {
 	  option->allowed_regexp = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug) fprintf(stderr,
 			     "    String must match Perl regexp: %s\n",
 			     option->allowed_regexp);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "arg_defval"))) {
 	  option->default_value = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug) fprintf(stderr,
 			     "    Default: %s\n",
 			     option->default_value);
@@ -2523,12 +3492,12 @@ parsePrinterEntry(xmlDocPtr doc, /* I - The whole printer data tree */
   ret->drivers = NULL;
 
   /* Get printer ID */
-  id = xmlGetProp(node, (const xmlChar *) "id");
+  id = parseProp(doc, node, (const xmlChar *) "id");
   if (id == NULL) {
     fprintf(stderr, "No printer ID found\n");
     return;
   }
-  ret->id = perlquote(id + 8);
+  ret->id = id + 8;
   if (debug) fprintf(stderr, "  Printer ID: %s\n", ret->id);
 
   /* Go through subnodes */
@@ -2536,11 +3505,11 @@ parsePrinterEntry(xmlDocPtr doc, /* I - The whole printer data tree */
   while (cur1 != NULL) {
     if ((!xmlStrcmp(cur1->name, (const xmlChar *) "make"))) {
       ret->make = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Printer Manufacturer: %s\n", ret->make);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "model"))) {
       ret->model = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Printer Model: %s\n", ret->model);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "mechanism"))) {
       cur2 = cur1->xmlChildrenNode;
@@ -2580,18 +3549,16 @@ parsePrinterEntry(xmlDocPtr doc, /* I - The whole printer data tree */
 	      while (cur4 != NULL) {
 		if ((!xmlStrcmp(cur4->name, (const xmlChar *) "x"))) {
 		  ret->maxxres = 
-		    perlquote(xmlNodeListGetString(doc,
-						   cur4->xmlChildrenNode,
-						   1));
+		    parseText(doc,
+						   cur4->xmlChildrenNode);
 		  if (debug) fprintf(stderr,
 				     "  Maximum X resolution: %s\n",
 				     ret->maxxres);
 		  
 		} else if ((!xmlStrcmp(cur4->name,(const xmlChar *) "y"))) {
 		  ret->maxyres = 
-		    perlquote(xmlNodeListGetString(doc,
-						   cur4->xmlChildrenNode,
-						   1));
+		    parseText(doc,
+						   cur4->xmlChildrenNode);
 		  if (debug) fprintf(stderr,
 				     "  Maximum Y resolution: %s\n",
 				     ret->maxyres);
@@ -2628,8 +3595,7 @@ parsePrinterEntry(xmlDocPtr doc, /* I - The whole printer data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "charset"))) {
 	      ret->ascii =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr,
 				 "  Printer prints plain text: %s\n",
 				 ret->ascii);
@@ -2641,8 +3607,7 @@ parsePrinterEntry(xmlDocPtr doc, /* I - The whole printer data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "ppd"))) {
 	      ret->ppdurl =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr,
 				 "  URL for the PPD for this printer: %s\n",
 				 ret->ppdurl);
@@ -2655,21 +3620,16 @@ parsePrinterEntry(xmlDocPtr doc, /* I - The whole printer data tree */
 	    (xmlStrcmp(cur2->name, (const xmlChar *) "comment"))) {
 	  ret->num_languages ++;
 	  ret->languages =
-	    (printerLanguagePtr *)
-	    realloc((printerLanguagePtr *)ret->languages, 
-		    sizeof(printerLanguagePtr) * 
-		    ret->num_languages);
-	  lentry = (printerLanguagePtr) malloc(sizeof(printerLanguage));
-	  if (lentry == NULL) {
-	    fprintf(stderr,"Out of memory!\n");
-	    xmlFreeDoc(doc);
-	    exit(1);
-	  }
+	    (printerLanguagePtr *)parseGrow(doc, ret->languages,
+					    ret->num_languages,
+					    sizeof(printerLanguagePtr));
+	  lentry =
+	    (printerLanguagePtr) parseAlloc(doc, sizeof(printerLanguage));
 	  ret->languages[ret->num_languages-1] = lentry;
 	  memset(lentry, 0, sizeof(printerLanguage));
-	  lentry->name = perlquote((xmlChar *)(cur2->name));
+	  lentry->name = parseString(doc, cur2->name);
 	  lentry->level =
-	    perlquote(xmlGetProp(cur2, (const xmlChar *) "level"));
+	    parseProp(doc, cur2, (const xmlChar *) "level");
 	  if (lentry->level == NULL) lentry->level = (xmlChar *) "";
 	  if (debug)
 	    fprintf(stderr, "  Printer understands PDL: %s Level %s\n",
@@ -2686,31 +3646,26 @@ parsePrinterEntry(xmlDocPtr doc, /* I - The whole printer data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "ieee1284"))) {
 	      ret->general_ieee =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    IEEE1284: %s\n", 
 				 ret->general_ieee);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "manufacturer"))) {
 	      ret->general_mfg =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MFG: %s\n", ret->general_mfg);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "model"))) {
 	      ret->general_mdl =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MDL: %s\n", ret->general_mdl);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "description"))) {
 	      ret->general_des =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    DES: %s\n", ret->general_des);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "commandset"))) {
 	      ret->general_cmd =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    CMD: %s\n", ret->general_cmd);
 	    }
 	    cur3 = cur3->next;
@@ -2721,31 +3676,26 @@ parsePrinterEntry(xmlDocPtr doc, /* I - The whole printer data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "ieee1284"))) {
 	      ret->par_ieee =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    IEEE1284: %s\n", 
 				 ret->par_ieee);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "manufacturer"))) {
 	      ret->par_mfg =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MFG: %s\n", ret->par_mfg);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "model"))) {
 	      ret->par_mdl =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MDL: %s\n", ret->par_mdl);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "description"))) {
 	      ret->par_des =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    DES: %s\n", ret->par_des);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "commandset"))) {
 	      ret->par_cmd =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    CMD: %s\n", ret->par_cmd);
 	    }
 	    cur3 = cur3->next;
@@ -2756,31 +3706,26 @@ parsePrinterEntry(xmlDocPtr doc, /* I - The whole printer data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "ieee1284"))) {
 	      ret->usb_ieee =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    IEEE1284: %s\n", 
 				 ret->usb_ieee);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "manufacturer"))) {
 	      ret->usb_mfg =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MFG: %s\n", ret->usb_mfg);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "model"))) {
 	      ret->usb_mdl =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MDL: %s\n", ret->usb_mdl);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "description"))) {
 	      ret->usb_des =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    DES: %s\n", ret->usb_des);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "commandset"))) {
 	      ret->usb_cmd =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    CMD: %s\n", ret->usb_cmd);
 	    }
 	    cur3 = cur3->next;
@@ -2791,31 +3736,26 @@ parsePrinterEntry(xmlDocPtr doc, /* I - The whole printer data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "ieee1284"))) {
 	      ret->snmp_ieee =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    IEEE1284: %s\n", 
 				 ret->snmp_ieee);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "manufacturer"))) {
 	      ret->snmp_mfg =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode, 
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MFG: %s\n", ret->snmp_mfg);
 
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "model"))) {
 	      ret->snmp_mdl =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    MDL: %s\n", ret->snmp_mdl);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "description"))) {
 	      ret->snmp_des =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    DES: %s\n", ret->snmp_des);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "commandset"))) {
 	      ret->snmp_cmd =
-		perlquote(xmlNodeListGetString(doc, cur3->xmlChildrenNode,
-					       1));
+		parseText(doc, cur3->xmlChildrenNode);
 	      if (debug) fprintf(stderr, "    CMD: %s\n", ret->snmp_cmd);
 	    }
 	    cur3 = cur3->next;
@@ -2825,16 +3765,16 @@ parsePrinterEntry(xmlDocPtr doc, /* I - The whole printer data tree */
       }
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "functionality"))) {
       ret->functionality = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Printer Functionality: %s\n",
 			 ret->functionality);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "driver"))) {
       ret->driver = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Recommended driver: %s\n", ret->driver);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "ppdentry"))) {
       ret->printerppdentry = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Extra lines for PPD file:\n%s\n", 
 			 ret->printerppdentry);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "unverified"))) {
@@ -2845,11 +3785,11 @@ parsePrinterEntry(xmlDocPtr doc, /* I - The whole printer data tree */
       if (debug) fprintf(stderr, "  Printer XML entry does not exist in the database\n");
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "url"))) {
       ret->url = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Printer URL: %s\n", ret->url);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "contrib_url"))) {
       ret->contriburl = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Contributed URL: %s\n",
 			 ret->contriburl);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "comments"))) {
@@ -2862,16 +3802,11 @@ parsePrinterEntry(xmlDocPtr doc, /* I - The whole printer data tree */
 	if ((!xmlStrcmp(cur2->name, (const xmlChar *) "driver"))) {
 	  ret->num_drivers ++;
 	  ret->drivers =
-	    (printerDrvEntryPtr *)
-	    realloc((printerDrvEntryPtr *)ret->drivers, 
-		    sizeof(printerDrvEntryPtr) * 
-		    ret->num_drivers);
-	  dentry = (printerDrvEntryPtr) malloc(sizeof(printerDrvEntry));
-	  if (dentry == NULL) {
-	    fprintf(stderr,"Out of memory!\n");
-	    xmlFreeDoc(doc);
-	    exit(1);
-	  }
+	    (printerDrvEntryPtr *)parseGrow(doc, ret->drivers,
+					    ret->num_drivers,
+					    sizeof(printerDrvEntryPtr));
+	  dentry =
+	    (printerDrvEntryPtr) parseAlloc(doc, sizeof(printerDrvEntry));
 	  ret->drivers[ret->num_drivers-1] = dentry;
 	  memset(dentry, 0, sizeof(printerDrvEntry));
 	  dentry->name = NULL;
@@ -2891,14 +3826,14 @@ parsePrinterEntry(xmlDocPtr doc, /* I - The whole printer data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "id"))) {
 	      dname =
-		xmlNodeListGetString(doc, cur3->xmlChildrenNode, 1);
-	      dentry->name = perlquote(dname);
+		parseText(doc, cur3->xmlChildrenNode);
+	      dentry->name = dname;
 	      if (debug) fprintf(stderr, "    Name: %s\n",
 				 dentry->name);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "ppd"))) {
 	      dppd =
-		xmlNodeListGetString(doc, cur3->xmlChildrenNode, 1);
-	      dentry->ppd = perlquote(dppd);
+		parseText(doc, cur3->xmlChildrenNode);
+	      dentry->ppd = dppd;
 	      if (debug) fprintf(stderr, "    Ready-made PPD: %s\n",
 				 dentry->ppd);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "comments"))) {
@@ -2978,12 +3913,12 @@ parseDriverEntry(xmlDocPtr doc, /* I - The whole driver data tree */
   ret->printers = NULL;
 
   /* Get driver ID */
-  id = xmlGetProp(node, (const xmlChar *) "id");
+  id = parseProp(doc, node, (const xmlChar *) "id");
   if (id == NULL) {
     fprintf(stderr, "No driver ID found\n");
     return;
   }
-  ret->id = perlquote(id + 7);
+  ret->id = id + 7;
   if (debug) fprintf(stderr, "  Driver ID: %s\n", ret->id);
 
   /* Go through subnodes */
@@ -2991,19 +3926,19 @@ parseDriverEntry(xmlDocPtr doc, /* I - The whole driver data tree */
   while (cur1 != NULL) {
     if ((!xmlStrcmp(cur1->name, (const xmlChar *) "name"))) {
       ret->name = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Driver name: %s\n", ret->name);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "group"))) {
       ret->group = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Driver group (for localization): %s\n",
 			 ret->group);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "url"))) {
       ret->url = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Driver URL: %s\n", ret->url);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "obsolete"))) {
-      ret->driver_obsolete = xmlGetProp(cur1, (const xmlChar *) "replace");
+      ret->driver_obsolete = parseProp(doc, cur1, (const xmlChar *) "replace");
       if (ret->driver_obsolete == NULL) {
 	if (debug) fprintf(stderr, "    No replacement driver found!\n");
 	ret->driver_obsolete = (xmlChar *)"1";
@@ -3016,7 +3951,7 @@ parseDriverEntry(xmlDocPtr doc, /* I - The whole driver data tree */
       getLocalizedText(doc, cur1, &(ret->supplier), language, debug);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "manufacturersupplied"))) {
       ret->manufacturersupplied =
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if ((ret->manufacturersupplied == NULL) ||
 	  (ret->manufacturersupplied[0] == '\0'))
 	ret->manufacturersupplied = (xmlChar *)"1";
@@ -3055,25 +3990,20 @@ parseDriverEntry(xmlDocPtr doc, /* I - The whole driver data tree */
 	if ((!xmlStrcmp(cur2->name, (const xmlChar *) "supportcontact"))) {
 	  ret->num_supportcontacts ++;
 	  ret->supportcontacts =
-	    (xmlChar const **)
-	    realloc((xmlChar **)ret->supportcontacts, 
-		    sizeof(xmlChar *) * 
-		    ret->num_supportcontacts);
+	    (xmlChar const **)parseGrow(doc, ret->supportcontacts,
+					ret->num_supportcontacts,
+					sizeof(xmlChar *));
 	  ret->supportcontacturls =
-	    (xmlChar **)
-	    realloc((xmlChar **)ret->supportcontacturls, 
-		    sizeof(xmlChar *) * 
-		    ret->num_supportcontacts);
+	    (xmlChar **)parseGrow(doc, ret->supportcontacturls,
+				  ret->num_supportcontacts, sizeof(xmlChar *));
 	  ret->supportcontactlevels =
-	    (xmlChar **)
-	    realloc((xmlChar **)ret->supportcontactlevels, 
-		    sizeof(xmlChar *) * 
-		    ret->num_supportcontacts);
-	  level = xmlGetProp(cur2, (const xmlChar *) "level");
+	    (xmlChar **)parseGrow(doc, ret->supportcontactlevels,
+				  ret->num_supportcontacts, sizeof(xmlChar *));
+	  level = parseProp(doc, cur2, (const xmlChar *) "level");
 	  if (level == NULL) {
 	    level = (xmlChar *)"Unknown";
 	  }
-	  url = xmlGetProp(cur2, (const xmlChar *) "url");
+	  url = parseProp(doc, cur2, (const xmlChar *) "url");
 	  ret->supportcontactlevels[ret->num_supportcontacts - 1] = level;
 	  ret->supportcontacturls[ret->num_supportcontacts - 1] = url;
 	  getLocalizedText
@@ -3094,7 +4024,7 @@ parseDriverEntry(xmlDocPtr doc, /* I - The whole driver data tree */
       getLocalizedText(doc, cur1, &(ret->shortdescription), language, debug);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "locales"))) {
       ret->locales = 
-	perlquote(xmlNodeListGetString(doc, cur1->xmlChildrenNode, 1));
+	parseText(doc, cur1->xmlChildrenNode);
       if (debug) fprintf(stderr, "  Driver list of locales: %s\n", ret->locales);
     } else if ((!xmlStrcmp(cur1->name, (const xmlChar *) "packages"))) {
       cur2 = cur1->xmlChildrenNode;
@@ -3103,26 +4033,20 @@ parseDriverEntry(xmlDocPtr doc, /* I - The whole driver data tree */
 	if ((!xmlStrcmp(cur2->name, (const xmlChar *) "package"))) {
 	  ret->num_packages ++;
 	  ret->packageurls =
-	    (xmlChar **)
-	    realloc((xmlChar **)ret->packageurls, 
-		    sizeof(xmlChar *) * 
-		    ret->num_packages);
+	    (xmlChar **)parseGrow(doc, ret->packageurls, ret->num_packages,
+				  sizeof(xmlChar *));
 	  ret->packagescopes =
-	    (xmlChar **)
-	    realloc((xmlChar **)ret->packagescopes, 
-		    sizeof(xmlChar *) * 
-		    ret->num_packages);
-	  scope = xmlGetProp(cur2, (const xmlChar *) "scope");
+	    (xmlChar **)parseGrow(doc, ret->packagescopes, ret->num_packages,
+				  sizeof(xmlChar *));
+	  scope = parseProp(doc, cur2, (const xmlChar *) "scope");
 	  ret->packagefingerprints =
-	    (xmlChar **)
-	    realloc((xmlChar **)ret->packagefingerprints, 
-		    sizeof(xmlChar *) * 
-		    ret->num_packages);
-	  fingerprint = xmlGetProp(cur2, (const xmlChar *) "fingerprint");
+	    (xmlChar **)parseGrow(doc, ret->packagefingerprints,
+				  ret->num_packages, sizeof(xmlChar *));
+	  fingerprint = parseProp(doc, cur2, (const xmlChar *) "fingerprint");
 	  ret->packageurls[ret->num_packages - 1] =
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
-	  ret->packagescopes[ret->num_packages - 1] = perlquote(scope);
-	  ret->packagefingerprints[ret->num_packages - 1] = perlquote(fingerprint);
+	    parseText(doc, cur2->xmlChildrenNode);
+	  ret->packagescopes[ret->num_packages - 1] = scope;
+	  ret->packagefingerprints[ret->num_packages - 1] = fingerprint;
 	  if (debug)
 	    fprintf(stderr, "    %s (%s), key fingerprint on %s\n", 
 		    ret->packageurls[ret->num_packages - 1],
@@ -3136,13 +4060,13 @@ parseDriverEntry(xmlDocPtr doc, /* I - The whole driver data tree */
       while (cur2 != NULL) {
 	if ((!xmlStrcmp(cur2->name, (const xmlChar *) "maxresx"))) {
 	  ret->maxresx = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug)
 	    fprintf(stderr, "  Driver functionality: Max X resolution: %s\n",
 		    ret->maxresx);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "maxresy"))) {
 	  ret->maxresy = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug)
 	    fprintf(stderr, "  Driver functionality: Max Y resolution: %s\n",
 		    ret->maxresy);
@@ -3154,37 +4078,37 @@ parseDriverEntry(xmlDocPtr doc, /* I - The whole driver data tree */
 	  if (debug) fprintf(stderr, "  Driver functionality: Monochrome\n");
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "text"))) {
 	  ret->text = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug)
 	    fprintf(stderr, "  Driver functionality: Text support rating: %s\n",
 		    ret->text);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "lineart"))) {
 	  ret->lineart = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug)
 	    fprintf(stderr, "  Driver functionality: Line art support rating: %s\n",
 		    ret->lineart);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "graphics"))) {
 	  ret->graphics = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug)
 	    fprintf(stderr, "  Driver functionality: Graphics support rating: %s\n",
 		    ret->graphics);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "photo"))) {
 	  ret->photo = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug)
 	    fprintf(stderr, "  Driver functionality: Photo support rating: %s\n",
 		    ret->photo);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "load"))) {
 	  ret->load = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug)
 	    fprintf(stderr, "  Driver functionality: System load rating: %s\n",
 		    ret->load);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "speed"))) {
 	  ret->speed = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug)
 	    fprintf(stderr, "  Driver functionality: Speed rating: %s\n",
 		    ret->speed);
@@ -3197,19 +4121,15 @@ parseDriverEntry(xmlDocPtr doc, /* I - The whole driver data tree */
 	if ((!xmlStrcmp(cur2->name, (const xmlChar *) "requires"))) {
 	  ret->num_requires ++;
 	  ret->requires =
-	    (xmlChar **)
-	    realloc((xmlChar **)ret->requires, 
-		    sizeof(xmlChar *) * 
-		    ret->num_requires);
+	    (xmlChar **)parseGrow(doc, ret->requires, ret->num_requires,
+				  sizeof(xmlChar *));
 	  ret->requiresversion =
-	    (xmlChar **)
-	    realloc((xmlChar **)ret->requiresversion, 
-		    sizeof(xmlChar *) * 
-		    ret->num_requires);
-	  version = xmlGetProp(cur2, (const xmlChar *) "version");
+	    (xmlChar **)parseGrow(doc, ret->requiresversion, ret->num_requires,
+				  sizeof(xmlChar *));
+	  version = parseProp(doc, cur2, (const xmlChar *) "version");
 	  ret->requires[ret->num_requires - 1] =
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
-	  ret->requiresversion[ret->num_requires - 1] = perlquote(version);
+	    parseText(doc, cur2->xmlChildrenNode);
+	  ret->requiresversion[ret->num_requires - 1] = version;
 	  if (debug) {
 	    if (!version)
 	      fprintf(stderr, "  Driver requires driver: %s\n", 
@@ -3241,17 +4161,17 @@ parseDriverEntry(xmlDocPtr doc, /* I - The whole driver data tree */
 	  if (debug) fprintf(stderr, "  Driver type: PostScript\n");
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "prototype"))) {
 	  ret->cmd =
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug) fprintf(stderr, "  Driver command line:\n\n    %s\n\n",
 			     ret->cmd);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "prototype_pdf"))) {
 	  ret->cmd_pdf =
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug) fprintf(stderr, "  Driver PDF command line:\n\n    %s\n\n",
 			     ret->cmd_pdf);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "ppdentry"))) {
 	  ret->driverppdentry = 
-	    perlquote(xmlNodeListGetString(doc, cur2->xmlChildrenNode, 1));
+	    parseText(doc, cur2->xmlChildrenNode);
 	  if (debug) fprintf(stderr, "  Extra lines for PPD file:\n%s\n", 
 			     ret->driverppdentry);
 	} else if ((!xmlStrcmp(cur2->name, (const xmlChar *) "margins"))) {
@@ -3269,15 +4189,9 @@ parseDriverEntry(xmlDocPtr doc, /* I - The whole driver data tree */
 	if ((!xmlStrcmp(cur2->name, (const xmlChar *) "printer"))) {
 	  ret->num_printers ++;
 	  ret->printers =
-	    (drvPrnEntryPtr *)realloc((drvPrnEntryPtr *)ret->printers, 
-				      sizeof(drvPrnEntryPtr) * 
-				      ret->num_printers);
-	  entry = (drvPrnEntryPtr) malloc(sizeof(drvPrnEntry));
-	  if (entry == NULL) {
-	    fprintf(stderr,"Out of memory!\n");
-	    xmlFreeDoc(doc);
-	    exit(1);
-	  }
+	    (drvPrnEntryPtr *)parseGrow(doc, ret->printers, ret->num_printers,
+					sizeof(drvPrnEntryPtr));
+	  entry = (drvPrnEntryPtr) parseAlloc(doc, sizeof(drvPrnEntry));
 	  ret->printers[ret->num_printers-1] = entry;
 	  memset(entry, 0, sizeof(drvPrnEntry));
 	  entry->id = NULL;
@@ -3296,8 +4210,8 @@ parseDriverEntry(xmlDocPtr doc, /* I - The whole driver data tree */
 	  while (cur3 != NULL) {
 	    if ((!xmlStrcmp(cur3->name, (const xmlChar *) "id"))) {
 	      id =
-		xmlNodeListGetString(doc, cur3->xmlChildrenNode, 1);
-	      entry->id = perlquote(id + 8);
+		parseText(doc, cur3->xmlChildrenNode);
+	      entry->id = id + 8;
 	      if (debug) fprintf(stderr, "    ID: %s\n",
 				 entry->id);
 	    } else if ((!xmlStrcmp(cur3->name, (const xmlChar *) "comments"))) {
@@ -3309,13 +4223,13 @@ parseDriverEntry(xmlDocPtr doc, /* I - The whole driver data tree */
 	      while (cur4 != NULL) {
 		if ((!xmlStrcmp(cur4->name, (const xmlChar *) "maxresx"))) {
 		  entry->excmaxresx =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "  Printer exception: Maximum X resolution: %s\n",
 			    entry->excmaxresx);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "maxresy"))) {
 		  entry->excmaxresy =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "  Printer exception: Maximum Y resolution: %s\n",
 			    entry->excmaxresy);
@@ -3331,37 +4245,37 @@ parseDriverEntry(xmlDocPtr doc, /* I - The whole driver data tree */
 			    entry->exccolor);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "text"))) {
 		  entry->exctext =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "  Printer exception: Support level for text: %s\n",
 			    entry->exctext);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "lineart"))) {
 		  entry->exclineart =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "  Printer exception: Support level for line art: %s\n",
 			    entry->exclineart);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "graphics"))) {
 		  entry->excgraphics =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "  Printer exception: Support level for graphics: %s\n",
 			    entry->excgraphics);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "photo"))) {
 		  entry->excphoto =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "  Printer exception: Support level for photos: %s\n",
 			    entry->excphoto);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "load"))) {
 		  entry->excload =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "  Printer exception: Expected relative system load: %s\n",
 			    entry->excload);
 		} else if ((!xmlStrcmp(cur4->name, (const xmlChar *) "speed"))) {
 		  entry->excspeed =
-		    perlquote(xmlNodeListGetString(doc, cur4->xmlChildrenNode, 1));
+		    parseText(doc, cur4->xmlChildrenNode);
 		  if (debug)
 		    fprintf(stderr, "  Printer exception: Expected relative driver speed: %s\n",
 			    entry->excspeed);
@@ -3379,6 +4293,19 @@ parseDriverEntry(xmlDocPtr doc, /* I - The whole driver data tree */
   }
 }
 
+/*
+ * Count an input file for "--stats"
+ */
+
+static void
+countInputFile(const char *filename) { /* I - Input file name */
+  struct stat st;
+
+  if (stat(filename, &st) != 0) return;
+  countstat(STATS_FILES, 1);
+  countstat(STATS_BYTES, (long)st.st_size);
+}
+
 static xmlDocPtr /* O - Tree with data parsed from stdin */
 parseXMLFromStdin() {
 
@@ -3392,9 +4319,11 @@ parseXMLFromStdin() {
     
     res = fread(chars, 1, 4, stdin);
     if (res > 0) {
+      countstat(STATS_BYTES, res);
       ctxt = xmlCreatePushParserCtxt(NULL, NULL,
 				     chars, res, NULL);
       while ((res = fread(chars, 1, size, stdin)) > 0) {
+	countstat(STATS_BYTES, res);
 	xmlParseChunk(ctxt, chars, res, 0);
       }
       xmlParseChunk(ctxt, chars, 0, 1);
@@ -3405,115 +4334,571 @@ parseXMLFromStdin() {
   return doc;
 }
 
-static overviewPtr     /* O - C data structure of overview */
-parseOverviewFile(char *filename, /* I - Input file name, NULL: stdin */
-		  xmlChar const language [], /* I - User language */
-		  int debug) { /* I - Debug mode flag */
-  xmlDocPtr      doc;  /* Output of XML parser */
-  overviewPtr    ret;  /* C data structure of overview */
-  xmlNodePtr     cur;  /* XML node currently worked on */
-  driverEntryPtr driver;
-  
-  /*
-   * build an XML tree from a file or stdin;
-   */
-  
-  if (filename == NULL) {
-    doc = parseXMLFromStdin();
-  } else {
-    doc = xmlParseFile(filename);
+/*
+ * Functions to build the tree of the combo XML data which the combo
+ * engine computes in this process. They read the data as the XML parser
+ * does with xmlKeepBlanksDefault(0): entities and character references
+ * are replaced, line ends become "\n" and white space in attributes
+ * becomes spaces, and text of only white space between tags is dropped
+ * where the parser drops it. The combo engine leaves out the XML
+ * declarations of the database files.
+ */
+
+/* Names of the text and comment nodes, as the XML parser names them */
+static const xmlChar treeNameText[] = "text";
+static const xmlChar treeNameComment[] = "comment";
+
+static int  /* O - Byte, -1: end of the data */
+treePeek(comboTreePtr t, /* I - Tree being built */
+	 int k) {        /* I - Offset from the current position */
+  int i;
+
+  while (t->pos == t->end) {
+    if (t->next >= t->num_pieces) return(-1);
+    t->pos = t->pieces[t->next].data;
+    t->end = t->pos + t->pieces[t->next ++].length;
   }
-  if (doc == NULL) return(NULL);
-  
-  /*
-   * Check the document is of the right kind
-   */
-  
-  cur = xmlDocGetRootElement(doc);
-  if (cur == NULL) {
-    fprintf(stderr,"Empty input document!\n");
-    xmlFreeDoc(doc);
-    return(NULL);
+  if (k < t->end - t->pos) return((unsigned char)t->pos[k]);
+  k -= t->end - t->pos;
+  for (i = t->next; i < t->num_pieces; i ++) {
+    if (k < t->pieces[i].length) return((unsigned char)t->pieces[i].data[k]);
+    k -= t->pieces[i].length;
   }
-  
-  if (xmlStrcmp(cur->name, (const xmlChar *) "overview")) {
-    fprintf(stderr,"Input document is not a Foomatic overview XML file (no \"<overview>\" tag)!\n");
-    xmlFreeDoc(doc);
-    return(NULL);
+  return(-1);
+}
+
+/* The current byte, as treePeek(t, 0), without a call in a part */
+#define treeByte(t) (((t)->pos < (t)->end) ? (unsigned char)*(t)->pos : \
+		     treePeek((t), 0))
+
+static void
+treeSkip(comboTreePtr t, /* I/O - Tree being built */
+	 int n) {        /* I - Number of bytes */
+  int m;
+
+  while ((n > 0) && (treePeek(t, 0) != -1)) {
+    m = (n < t->end - t->pos ? n : t->end - t->pos);
+    t->pos += m;
+    n -= m;
   }
-  
-  /*
-   * Allocate the structure to be returned.
-   */
-  ret = (overviewPtr) malloc(sizeof(overview));
-  if (ret == NULL) {
-    fprintf(stderr,"Out of memory!\n");
-    xmlFreeDoc(doc);
-    return(NULL);
+}
+
+static int  /* O - Byte, line ends as "\n", -1: end of the data */
+treeGet(comboTreePtr t) { /* I/O - Tree being built */
+  int c;
+
+  if ((c = treeByte(t)) == -1) return(-1);
+  t->pos ++;
+  if (c == '\r') {
+    if (treeByte(t) == '\n') t->pos ++;
+    c = '\n';
   }
-  memset(ret, 0, sizeof(overview));
-  ret->num_overviewPrinters = 0;
-  ret->overviewPrinters = NULL;
+  return(c);
+}
 
-  /*
-   * Now, walk through the tree.
-   */
+static int  /* O - 1: the data continues with the string, 0: not */
+treeLooking(comboTreePtr t,   /* I - Tree being built */
+	    const char *s) {  /* I - String */
+  int k;
 
-  /* On the first level we have the printer entries */
+  for (k = 0; s[k] != '\0'; k ++)
+    if (treePeek(t, k) != (unsigned char)s[k]) return(0);
+  return(1);
+}
 
-  cur = cur->xmlChildrenNode;
-  while (cur) {
-    if (xmlIsBlankNode(cur)) {
-      cur = cur->next;
+static int  /* O - Always -1 */
+treeError(const char *message) { /* I - What is wrong */
+  fprintf(stderr, "Combo XML data is not valid: %s!\n", message);
+  return(-1);
+}
+
+static void
+treeSkipSpace(comboTreePtr t) { /* I/O - Tree being built */
+  int c;
+
+  while (((c = treeByte(t)) == ' ') || (c == '\t') || (c == '\n') ||
+	 (c == '\r'))
+    t->pos ++;
+}
+
+static xmlChar * /* O - Text of the current node, in the arena */
+treeString(comboTreePtr t) { /* I/O - Tree being built */
+  xmlChar *ret;
+
+  ret = (xmlChar *) arenaAlloc(t->arena, t->text.length + 1);
+  memcpy(ret, t->text.data, t->text.length);
+  ret[t->text.length] = '\0';
+  t->text.length = 0;
+  return(ret);
+}
+
+static xmlNodePtr /* O - New node, the last child of the parent */
+treeNode(comboTreePtr t,         /* I/O - Tree being built */
+	 xmlElementType type,    /* I - Type of the node */
+	 const xmlChar *name,    /* I - Name of the node */
+	 xmlNodePtr parent) {    /* I/O - Parent node */
+  xmlNodePtr node;
+
+  node = (xmlNodePtr) arenaAlloc(t->arena, sizeof(xmlNode));
+  memset(node, 0, sizeof(xmlNode));
+  node->type = type;
+  node->name = name;
+  node->doc = t->doc;
+  node->parent = parent;
+  node->prev = parent->last;
+  if (parent->last != NULL)
+    parent->last->next = node;
+  else
+    parent->children = node;
+  parent->last = node;
+  return(node);
+}
+
+static int  /* O - 0: replaced, -1: invalid reference */
+treeReference(comboTreePtr t) { /* I/O - Tree being built, after '&' */
+  char          name[16];
+  int           i, c;
+  unsigned long code = 0;
+  char          utf8[4];
+
+  for (i = 0; (c = treeByte(t)) != ';'; i ++) {
+    if ((c == -1) || (i >= (int)sizeof(name) - 1))
+      return(treeError("invalid entity reference"));
+    name[i] = c;
+    t->pos ++;
+  }
+  name[i] = '\0';
+  t->pos ++;
+  if (strcmp(name, "lt") == 0) outputLiteral(&t->text, "<");
+  else if (strcmp(name, "gt") == 0) outputLiteral(&t->text, ">");
+  else if (strcmp(name, "amp") == 0) outputLiteral(&t->text, "&");
+  else if (strcmp(name, "quot") == 0) outputLiteral(&t->text, "\"");
+  else if (strcmp(name, "apos") == 0) outputLiteral(&t->text, "'");
+  else if (name[0] == '#') {
+    /* Character reference, put in as UTF-8 */
+    if ((name[1] == 'x') && (name[2] != '\0'))
+      for (i = 2; (name[i] != '\0') && (code <= 0x10ffff); i ++) {
+	if ((name[i] >= '0') && (name[i] <= '9'))
+	  code = code * 16 + name[i] - '0';
+	else if ((name[i] >= 'a') && (name[i] <= 'f'))
+	  code = code * 16 + name[i] - 'a' + 10;
+	else if ((name[i] >= 'A') && (name[i] <= 'F'))
+	  code = code * 16 + name[i] - 'A' + 10;
+	else
+	  return(treeError("invalid character reference"));
+      }
+    else if (name[1] != '\0')
+      for (i = 1; (name[i] != '\0') && (code <= 0x10ffff); i ++) {
+	if ((name[i] >= '0') && (name[i] <= '9'))
+	  code = code * 10 + name[i] - '0';
+	else
+	  return(treeError("invalid character reference"));
+      }
+    if ((code == 0) || (code > 0x10ffff))
+      return(treeError("invalid character reference"));
+    if (code < 0x80) {
+      utf8[0] = code;
+      i = 1;
+    } else if (code < 0x800) {
+      utf8[0] = 0xc0 | (code >> 6);
+      utf8[1] = 0x80 | (code & 0x3f);
+      i = 2;
+    } else if (code < 0x10000) {
+      utf8[0] = 0xe0 | (code >> 12);
+      utf8[1] = 0x80 | ((code >> 6) & 0x3f);
+      utf8[2] = 0x80 | (code & 0x3f);
+      i = 3;
+    } else {
+      utf8[0] = 0xf0 | (code >> 18);
+      utf8[1] = 0x80 | ((code >> 12) & 0x3f);
+      utf8[2] = 0x80 | ((code >> 6) & 0x3f);
+      utf8[3] = 0x80 | (code & 0x3f);
+      i = 4;
+    }
+    outputData(&t->text, utf8, i);
+  } else
+    return(treeError("undefined entity"));
+  return(0);
+}
+
+#define treeIsName(c) (((c) != -1) && ((c) != ' ') && ((c) != '\t') && \
+		       ((c) != '\n') && ((c) != '\r') && ((c) != '/') && \
+		       ((c) != '>') && ((c) != '=') && ((c) != '<') && \
+		       ((c) != '?'))
+
+static int  /* O - Length of the name, in t->text, 0: no name */
+treeName(comboTreePtr t) { /* I/O - Tree being built */
+  const char *run;
+  int        c;
+
+  t->text.length = 0;
+  while (treeIsName(c = treeByte(t))) {
+    run = t->pos;
+    while ((t->pos < t->end) && treeIsName((unsigned char)*t->pos))
+      t->pos ++;
+    outputData(&t->text, run, t->pos - run);
+  }
+  return(t->text.length);
+}
+
+static int  /* O - 0: found, -1: end of the data */
+treeUntil(comboTreePtr t,        /* I/O - Tree being built */
+	  const char *end) {     /* I - String which ends the content */
+  char c;
+
+  t->text.length = 0;
+  while (!treeLooking(t, end)) {
+    if (treePeek(t, 0) == -1) return(treeError("premature end of data"));
+    c = treeGet(t);
+    outputData(&t->text, &c, 1);
+  }
+  treeSkip(t, strlen(end));
+  return(0);
+}
+
+/*
+ * The XML parser hands over the text between two tags in chunks, it
+ * drops a chunk of only white space when it looks like indentation,
+ * and it keeps all white space of an element once a chunk starting with
+ * white space is kept (xmlParseCharData(), areBlanks()). Here the same
+ * chunks are cut, so that the same text is kept.
+ */
+
+#define TREE_CHUNK_SIZE 300 /* Chunks of text with other than ASCII
+			       characters, XML_PARSER_BIG_BUFFER_SIZE */
+
+#define treeIsBlank(c) (((c) == ' ') || ((c) == '\t') || ((c) == '\n') || \
+			((c) == '\r'))
+#define treeIsPlain(c) ((((c) >= 0x20) && ((c) <= 0x7f) && ((c) != '<') && \
+			 ((c) != '&')) || ((c) == '\t') || ((c) == '\n'))
+
+static void
+treeChunk(comboTreePtr t,     /* I/O - Tree being built */
+	  xmlNodePtr parent,  /* I - Element of the text */
+	  size_t start,       /* I - Start of the chunk in t->text */
+	  int spaces,         /* I - 1: the chunk sets the element to keep
+				 all white space, if it is kept */
+	  int raw) {          /* I - Byte the parser is at, -1: the byte
+				 after the chunk */
+  int    c, *space = t->spaces + t->num_spaces - 1;
+  size_t i;
+
+  if (start == t->text.length) return;
+  if ((*space != 1) && (*space != -2) && (start == 0)) {
+    for (i = start; i < t->text.length; i ++)
+      if (!treeIsBlank(t->text.data[i])) break;
+    c = (raw == -1 ? treePeek(t, 0) : raw);
+    if ((i == t->text.length) && ((c == '<') || (c == '\r')) &&
+	((parent->children != NULL) || (c != '<') ||
+	 (treePeek(t, 1) != '/')) &&
+	((parent->last == NULL) ||
+	 (parent->last->type != XML_TEXT_NODE)) &&
+	((parent->children == NULL) ||
+	 (parent->children->type != XML_TEXT_NODE))) {
+      /* Indentation, dropped */
+      t->text.length = start;
+      return;
+    }
+  }
+  if (spaces && (*space == -1)) *space = -2;
+}
+
+static int  /* O - 0: text in t->text, -1: invalid reference */
+treeText(comboTreePtr t,       /* I/O - Tree being built */
+	 xmlNodePtr parent) {  /* I - Element of the text */
+  const char *run;
+  size_t     start;
+  int        c, blank;
+  char       ch;
+
+  t->text.length = 0;
+  while (((c = treeByte(t)) != '<') && (c != -1)) {
+    if (c == '&') {
+      t->pos ++;
+      if (treeReference(t) < 0) return(-1);
       continue;
     }
-    if (!xmlStrcmp(cur->name, (const xmlChar *) "driver")) {
-      ret->num_overviewDrivers ++;
-      ret->overviewDrivers =
-	(driverEntryPtr *)realloc
-	((driverEntryPtr *)(ret->overviewDrivers), 
-	 sizeof(driverEntryPtr) * ret->num_overviewDrivers);
-      driver = (driverEntryPtr) malloc(sizeof(driverEntry));
-      if (driver == NULL) {
-	fprintf(stderr,"Out of memory!\n");
-	xmlFreeDoc(doc);
-	exit(1);
+    if (treeIsPlain(c)) {
+      /* ASCII text, up to a line end or another character */
+      start = t->text.length;
+      blank = treeIsBlank(c);
+      while (treeIsPlain(c = treeByte(t))) {
+	run = t->pos;
+	while ((t->pos < t->end) && treeIsPlain((unsigned char)*t->pos))
+	  t->pos ++;
+	outputData(&t->text, run, t->pos - run);
       }
-      ret->overviewDrivers[ret->num_overviewDrivers-1] = driver;
-      memset(driver, 0, sizeof(driverEntry));
-      if (debug) fprintf(stderr, "--> Parsing driver data\n");
-      parseDriverEntry(doc, cur, driver, language, debug);
-    } else if (!xmlStrcmp(cur->name, (const xmlChar *) "printer")) {
-      if (debug) fprintf(stderr, "--> Parsing printer data\n");
-      parseOverviewPrinter(doc, cur, ret, language, debug);
-    } 
-    cur = cur->next;
+      treeChunk(t, parent, start, blank, -1);
+    }
+    if ((c == '\r') && (treePeek(t, 1) == '\n')) {
+      /* The next chunk starts with the "\n" */
+      treeSkip(t, 1);
+      if (treeIsPlain(treePeek(t, 1))) continue;
+    } else if ((c == '<') || (c == '&') || (c == -1))
+      continue;
+    /* Other text, up to the next tag or reference */
+    start = t->text.length;
+    while (((c = treeByte(t)) != '<') && (c != '&') && (c != -1)) {
+      ch = treeGet(t);
+      outputData(&t->text, &ch, 1);
+      if (t->text.length - start >= TREE_CHUNK_SIZE) {
+	/* The parser is at the next character then, at the "\n" if it
+	   is a "\r\n" */
+	treeChunk(t, parent, start, 1,
+		  (((treePeek(t, 0) == '\r') && (treePeek(t, 1) == '\n')) ?
+		   '\n' : -1));
+	start = t->text.length;
+      }
+    }
+    treeChunk(t, parent, start, 1, -1);
   }
-  
-  /* We succeeded, return the result */
+  return(0);
+}
 
-  return(ret);
+static void
+treePushSpace(comboTreePtr t) { /* I/O - Tree being built */
+  int space = t->spaces[t->num_spaces - 1];
+
+  if (t->num_spaces >= t->size_spaces) {
+    t->size_spaces *= 2;
+    t->spaces = (int *) realloc(t->spaces, sizeof(int) * t->size_spaces);
+    if (t->spaces == NULL) {
+      fprintf(stderr,"Out of memory!\n");
+      exit(1);
+    }
+  }
+  t->spaces[t->num_spaces ++] = (space == -2 ? -1 : space);
+}
+
+/* Bytes which an attribute value keeps as they are */
+#define treeIsValue(c, quote) (((c) != (quote)) && ((c) != '<') && \
+			       ((c) != '&') && ((c) != '\t') && \
+			       ((c) != '\n') && ((c) != '\r'))
+
+static int  /* O - 1: empty element, 0: content follows, -1: error */
+treeAttributes(comboTreePtr t,     /* I/O - Tree being built */
+	       xmlNodePtr node) {  /* I/O - Element */
+  xmlAttrPtr attr, last = NULL;
+  xmlNodePtr value;
+  const char *run;
+  int        c, quote;
+  char       ch;
+
+  for (;;) {
+    treeSkipSpace(t);
+    c = treeByte(t);
+    if (c == '>') {
+      t->pos ++;
+      return(0);
+    }
+    if ((c == '/') && (treePeek(t, 1) == '>')) {
+      treeSkip(t, 2);
+      return(1);
+    }
+    if (treeName(t) == 0) return(treeError("invalid attribute"));
+    attr = (xmlAttrPtr) arenaAlloc(t->arena, sizeof(xmlAttr));
+    memset(attr, 0, sizeof(xmlAttr));
+    attr->type = XML_ATTRIBUTE_NODE;
+    attr->name = treeString(t);
+    attr->parent = node;
+    attr->doc = t->doc;
+    attr->prev = last;
+    if (last != NULL)
+      last->next = attr;
+    else
+      node->properties = attr;
+    last = attr;
+    treeSkipSpace(t);
+    if (treeByte(t) != '=') return(treeError("attribute without value"));
+    t->pos ++;
+    treeSkipSpace(t);
+    quote = treeByte(t);
+    if ((quote != '"') && (quote != '\''))
+      return(treeError("attribute value not quoted"));
+    t->pos ++;
+    while ((c = treeByte(t)) != quote) {
+      if ((c == -1) || (c == '<'))
+	return(treeError("invalid attribute value"));
+      if (c == '&') {
+	t->pos ++;
+	if (treeReference(t) < 0) return(-1);
+      } else if (treeIsValue(c, quote)) {
+	run = t->pos;
+	while ((t->pos < t->end) && treeIsValue((unsigned char)*t->pos, quote))
+	  t->pos ++;
+	outputData(&t->text, run, t->pos - run);
+      } else {
+	ch = treeGet(t);
+	if ((ch == '\n') || (ch == '\t')) ch = ' ';
+	outputData(&t->text, &ch, 1);
+      }
+    }
+    t->pos ++;
+    value = treeNode(t, XML_TEXT_NODE, treeNameText, (xmlNodePtr)attr);
+    value->content = treeString(t);
+    if (!xmlStrcmp(attr->name, (const xmlChar *) "xml:space")) {
+      if (!xmlStrcmp(value->content, (const xmlChar *) "default"))
+	t->spaces[t->num_spaces - 1] = 0;
+      else if (!xmlStrcmp(value->content, (const xmlChar *) "preserve"))
+	t->spaces[t->num_spaces - 1] = 1;
+    }
+  }
+}
+
+static xmlDocPtr /* O - Tree of the combo XML data, in the arena, NULL: not
+		    valid XML (error message issued) */
+buildComboTree(const combopiece_t *pieces, /* I - Combo XML data */
+	       int num_pieces,
+	       arenaPtr arena) { /* I/O - Arena for the tree */
+  comboTree      t;
+  xmlNodePtr     parent, node;
+  const xmlChar  *content;
+  xmlChar        *concat;
+  int            c, ret = -1;
+
+  t.pieces = pieces;
+  t.num_pieces = num_pieces;
+  t.next = 0;
+  t.pos = t.end = NULL;
+  t.arena = arena;
+  t.doc = (xmlDocPtr) arenaAlloc(arena, sizeof(xmlDoc));
+  memset(t.doc, 0, sizeof(xmlDoc));
+  t.doc->type = XML_DOCUMENT_NODE;
+  outputInit(&t.text, NULL, NULL);
+  t.size_spaces = 16;
+  t.spaces = (int *) malloc(sizeof(int) * t.size_spaces);
+  if (t.spaces == NULL) {
+    fprintf(stderr,"Out of memory!\n");
+    exit(1);
+  }
+  t.spaces[0] = -1;
+  t.num_spaces = 1;
+  parent = (xmlNodePtr) t.doc;
+
+  for (;;) {
+
+    /* Text up to the next tag */
+    if (parent == (xmlNodePtr) t.doc) {
+      treeSkipSpace(&t);
+      if (((c = treeByte(&t)) != '<') && (c != -1)) {
+	treeError("text outside of the root element");
+	goto done;
+      }
+    } else {
+      if (treeText(&t, parent) < 0) goto done;
+      c = treeByte(&t);
+      if (t.text.length > 0) {
+	node = treeNode(&t, XML_TEXT_NODE, treeNameText, parent);
+	node->content = treeString(&t);
+      }
+    }
+    if (c == -1) break;
+
+    /* The tag */
+    c = treePeek(&t, 1);
+    if ((c == '!') && treeLooking(&t, "<!--")) {
+      treeSkip(&t, 4);
+      if (treeUntil(&t, "-->") < 0) goto done;
+      node = treeNode(&t, XML_COMMENT_NODE, treeNameComment, parent);
+      node->content = treeString(&t);
+    } else if ((c == '!') && treeLooking(&t, "<![CDATA[")) {
+      treeSkip(&t, 9);
+      if (treeUntil(&t, "]]>") < 0) goto done;
+      if (parent == (xmlNodePtr) t.doc) {
+	treeError("CDATA outside of the root element");
+	goto done;
+      }
+      if ((parent->last != NULL) &&
+	  (parent->last->type == XML_CDATA_SECTION_NODE)) {
+	/* Adjacent CDATA sections make one node */
+	content = parent->last->content;
+	concat = (xmlChar *) arenaAlloc(arena, xmlStrlen(content) +
+					t.text.length + 1);
+	memcpy(concat, content, xmlStrlen(content));
+	memcpy(concat + xmlStrlen(content), t.text.data, t.text.length);
+	concat[xmlStrlen(content) + t.text.length] = '\0';
+	parent->last->content = concat;
+	t.text.length = 0;
+      } else {
+	node = treeNode(&t, XML_CDATA_SECTION_NODE, NULL, parent);
+	node->content = treeString(&t);
+      }
+    } else if (c == '?') {
+      treeSkip(&t, 2);
+      if (treeName(&t) == 0) {
+	treeError("processing instruction without name");
+	goto done;
+      }
+      if ((t.text.length == 3) && (memcmp(t.text.data, "xml", 3) == 0)) {
+	if (treeUntil(&t, "?>") < 0) goto done;
+	t.text.length = 0;
+      } else {
+	node = treeNode(&t, XML_PI_NODE, treeString(&t), parent);
+	treeSkipSpace(&t);
+	if (treeUntil(&t, "?>") < 0) goto done;
+	node->content = treeString(&t);
+      }
+    } else if (c == '!') {
+      /* Document type declaration, without internal subset */
+      while ((c = treeGet(&t)) != '>') {
+	if ((c == -1) || (c == '[')) {
+	  treeError("unsupported document type declaration");
+	  goto done;
+	}
+      }
+    } else if (c == '/') {
+      treeSkip(&t, 2);
+      treeName(&t);
+      treeSkipSpace(&t);
+      if ((treeGet(&t) != '>') || (parent == (xmlNodePtr) t.doc) ||
+	  (xmlStrlen(parent->name) != (int)t.text.length) ||
+	  (memcmp(parent->name, t.text.data, t.text.length) != 0)) {
+	treeError("end tag does not match start tag");
+	goto done;
+      }
+      t.text.length = 0;
+      parent = parent->parent;
+      t.num_spaces --;
+    } else {
+      t.pos ++;
+      if ((parent == (xmlNodePtr) t.doc) &&
+	  (xmlDocGetRootElement(t.doc) != NULL)) {
+	treeError("extra content at the end of the data");
+	goto done;
+      }
+      if (treeName(&t) == 0) {
+	treeError("tag without name");
+	goto done;
+      }
+      node = treeNode(&t, XML_ELEMENT_NODE, treeString(&t), parent);
+      treePushSpace(&t);
+      if ((c = treeAttributes(&t, node)) < 0) goto done;
+      if (c == 0)
+	parent = node;
+      else
+	t.num_spaces --;
+    }
+  }
+  if (parent != (xmlNodePtr) t.doc) {
+    treeError("premature end of data");
+    goto done;
+  }
+  ret = 0;
+
+ done:
+  outputFree(&t.text);
+  free(t.spaces);
+  return(ret == 0 ? t.doc : NULL);
 }
 
 static comboDataPtr   /* O - C data structure of printer/driver combo */
-parseComboFile(char *filename, /* I - Input file name, NULL: stdin */
+parseComboTree(xmlDocPtr doc, /* I - Combo XML data tree */
+	       arenaPtr arena, /* I/O - Arena for the parsed data */
 	       xmlChar const language [], /* I - User language */
 	       int debug) { /* I - Debug mode flag */
-  xmlDocPtr      doc;  /* Output of XML parser */
   comboDataPtr   ret;  /* C data structure of printer/driver combo */
   xmlNodePtr     cur;  /* XML node currently worked on */
   
-  /*
-   * build an XML tree from a file or stdin;
-   */
-  
-  if (filename == NULL) {
-    doc = parseXMLFromStdin();
-  } else {
-    doc = xmlParseFile(filename);
-  }
-  if (doc == NULL) return(NULL);
-  
   /*
    * Check the document is of the right kind
    */
@@ -3521,25 +4906,19 @@ parseComboFile(char *filename, /* I - Input file name, NULL: stdin */
   cur = xmlDocGetRootElement(doc);
   if (cur == NULL) {
     fprintf(stderr,"Empty input document!\n");
-    xmlFreeDoc(doc);
     return(NULL);
   }
   
   if (xmlStrcmp(cur->name, (const xmlChar *) "foomatic")) {
     fprintf(stderr,"Input document is not a Foomatic combo XML file (no \"<foomatic>\" tag)!\n");
-    xmlFreeDoc(doc);
     return(NULL);
   }
   
   /*
    * Allocate the structure to be returned.
    */
-  ret = (comboDataPtr) malloc(sizeof(comboData));
-  if (ret == NULL) {
-    fprintf(stderr,"Out of memory!\n");
-    xmlFreeDoc(doc);
-    return(NULL);
-  }
+  doc->_private = arena;
+  ret = (comboDataPtr) parseAlloc(doc, sizeof(comboData));
   memset(ret, 0, sizeof(comboData));
   ret->make = NULL;
   ret->driver = NULL;
@@ -3579,18 +4958,81 @@ parseComboFile(char *filename, /* I - Input file name, NULL: stdin */
     exit(1);
   }
 
-  if (ret->driver == NULL) {
-    fprintf(stderr,"\"<driver>\" tag not found!\n");
-    exit(1);
-  }
+  if (ret->driver == NULL) {
+    fprintf(stderr,"\"<driver>\" tag not found!\n");
+    exit(1);
+  }
+
+  /* We succeeded, return the result, all data is copied into the
+     arena */
+
+  return(ret);
+}
+
+static comboDataPtr   /* O - C data structure of printer/driver combo */
+parseComboDoc(xmlDocPtr doc, /* I - Combo XML data tree, freed */
+	      arenaPtr arena, /* I/O - Arena for the parsed data */
+	      xmlChar const language [], /* I - User language */
+	      int debug) { /* I - Debug mode flag */
+  comboDataPtr   ret;  /* C data structure of printer/driver combo */
+
+  /* The tree is not needed any more when it is parsed */
+  ret = parseComboTree(doc, arena, language, debug);
+  xmlFreeDoc(doc);
+  return(ret);
+}
+
+static comboDataPtr   /* O - C data structure of printer/driver combo */
+parseComboFile(char *filename, /* I - Input file name, NULL: stdin */
+	       arenaPtr arena, /* I/O - Arena for the parsed data */
+	       xmlChar const language [], /* I - User language */
+	       int debug) { /* I - Debug mode flag */
+  xmlDocPtr      doc;  /* Output of XML parser */
+  
+  /*
+   * build an XML tree from a file or stdin;
+   */
+  
+  if (filename == NULL) {
+    doc = parseXMLFromStdin();
+  } else {
+    doc = xmlParseFile(filename);
+  }
+  if (doc == NULL) return(NULL);
+  return(parseComboDoc(doc, arena, language, debug));
+}
+
+static comboDataPtr   /* O - C data structure of printer/driver combo */
+parseComboPieces(const combopiece_t *pieces, /* I - Combo XML data, as
+						parts of the database
+						files */
+		 int num_pieces, /* I - Number of parts */
+		 arenaPtr arena, /* I/O - Arena for the parsed data */
+		 xmlChar const language [], /* I - User language */
+		 int debug) { /* I - Debug mode flag */
+  xmlDocPtr      doc;  /* Tree of the combo XML data */
+  comboDataPtr   ret;  /* C data structure of printer/driver combo */
+  statsclock_t   phasestart; /* Start of the XML parsing ("--stats") */
 
-  /* We succeeded, return the result */
+  /*
+   * The combo is computed with the engine of foomatic-combo-xml in this
+   * process, without a pipe between both programs, and the tree is
+   * built directly from the parts of the database files which make up
+   * the combo, without writing them out as XML text and parsing that
+   */
 
+  startphase(&phasestart);
+  doc = buildComboTree(pieces, num_pieces, arena);
+  if (doc == NULL) return(NULL);
+  doc->_private = arena;
+  ret = parseComboTree(doc, arena, language, debug);
+  endphase(STATS_XMLPARSE, &phasestart);
   return(ret);
 }
 
 static printerEntryPtr     /* O - C data structure of printer entry */
 parsePrinterFile(char *filename, /* I - Input file name, NULL: stdin */
+		 arenaPtr arena, /* I/O - Arena for the parsed data */
 		 xmlChar const language [], /* I - User language */
 		 int debug) { /* I - Debug mode flag */
   xmlDocPtr       doc;  /* Output of XML parser */
@@ -3628,12 +5070,8 @@ parsePrinterFile(char *filename, /* I - Input file name, NULL: stdin */
   /*
    * Allocate the structure to be returned.
    */
-  ret = (printerEntryPtr) malloc(sizeof(printerEntry));
-  if (ret == NULL) {
-    fprintf(stderr,"Out of memory!\n");
-    xmlFreeDoc(doc);
-    return(NULL);
-  }
+  doc->_private = arena;
+  ret = (printerEntryPtr) parseAlloc(doc, sizeof(printerEntry));
   memset(ret, 0, sizeof(printerEntry));
 
   /*
@@ -3643,13 +5081,16 @@ parsePrinterFile(char *filename, /* I - Input file name, NULL: stdin */
   if (debug) fprintf(stderr, "--> Parsing printer data\n");
   parsePrinterEntry(doc, cur, ret, language, debug);
 
-  /* We succeeded, return the result */
+  /* We succeeded, return the result, the tree is not needed any more,
+     all data is copied into the arena */
 
+  xmlFreeDoc(doc);
   return(ret);
 }
 
 static driverEntryPtr     /* O - C data structure of driver entry */
 parseDriverFile(char *filename, /* I - Input file name, NULL: stdin */
+		arenaPtr arena, /* I/O - Arena for the parsed data */
 		xmlChar const language [], /* I - User language */
 		int debug) { /* I - Debug mode flag */
   xmlDocPtr       doc;  /* Output of XML parser */
@@ -3687,12 +5128,8 @@ parseDriverFile(char *filename, /* I - Input file name, NULL: stdin */
   /*
    * Allocate the structure to be returned.
    */
-  ret = (driverEntryPtr) malloc(sizeof(driverEntry));
-  if (ret == NULL) {
-    fprintf(stderr,"Out of memory!\n");
-    xmlFreeDoc(doc);
-    return(NULL);
-  }
+  doc->_private = arena;
+  ret = (driverEntryPtr) parseAlloc(doc, sizeof(driverEntry));
   memset(ret, 0, sizeof(driverEntry));
 
   /*
@@ -3702,8 +5139,10 @@ parseDriverFile(char *filename, /* I - Input file name, NULL: stdin */
   if (debug) fprintf(stderr, "--> Parsing driver data\n");
   parseDriverEntry(doc, cur, ret, language, debug);
 
-  /* We succeeded, return the result */
+  /* We succeeded, return the result, the tree is not needed any more,
+     all data is copied into the arena */
 
+  xmlFreeDoc(doc);
   return(ret);
 }
 
@@ -3760,358 +5199,492 @@ prepareComboData(comboDataPtr combo, /* I/O - Foomatic combo data parsed
 }
 
 void
-generateOverviewPerlData(overviewPtr overview, /* I/O - Foomatic overview 
-						  data parsed from XML 
-						  input */
-			 int debug) { /* Debug flag */
-
-  int i, j, k, l; /* loop variables */
-  overviewPrinterPtr printer;
+generateOverviewPrinterPerlData(overviewPtr overview, /* I - Foomatic
+							 overview data, for
+							 the drivers */
+				overviewPrinterPtr printer, /* I - Printer
+							       entry */
+				outputPtr out, /* I/O - Buffer for the Perl data */
+				int debug) { /* Debug flag */
+
+  int j, k, l; /* loop variables */
   
-  printf("$VAR1 = [\n");
-  for (i = 0; i < overview->num_overviewPrinters; i ++) {
-    printer = overview->overviewPrinters[i];
-    printf("          {\n");
-    printf("            'id' => '%s',\n", printer->id);
-    printf("            'make' => '%s',\n", printer->make);
-    printf("            'model' => '%s',\n", printer->model);
-    if (printer->general_ieee) {
-      printf("            'general_ieee' => '%s',\n",
-	     printer->general_ieee);
-    }
-    if (printer->general_mfg) {
-      printf("            'general_mfg' => '%s',\n", printer->general_mfg);
-    }
-    if (printer->general_mdl) {
-      printf("            'general_mdl' => '%s',\n", printer->general_mdl);
-    }
-    if (printer->general_des) {
-      printf("            'general_des' => '%s',\n", printer->general_des);
-    }
-    if (printer->general_cmd) {
-      printf("            'general_cmd' => '%s',\n", printer->general_cmd);
-    }
-    if (printer->par_ieee) {
-      printf("            'par_ieee' => '%s',\n", printer->par_ieee);
-    }
-    if (printer->par_mfg) {
-      printf("            'par_mfg' => '%s',\n", printer->par_mfg);
-    }
-    if (printer->par_mdl) {
-      printf("            'par_mdl' => '%s',\n", printer->par_mdl);
-    }
-    if (printer->par_des) {
-      printf("            'par_des' => '%s',\n", printer->par_des);
-    }
-    if (printer->par_cmd) {
-      printf("            'par_cmd' => '%s',\n", printer->par_cmd);
-    }
-    if (printer->usb_ieee) {
-      printf("            'usb_ieee' => '%s',\n", printer->usb_ieee);
-    }
-    if (printer->usb_mfg) {
-      printf("            'usb_mfg' => '%s',\n", printer->usb_mfg);
-    }
-    if (printer->usb_mdl) {
-      printf("            'usb_mdl' => '%s',\n", printer->usb_mdl);
-    }
-    if (printer->usb_des) {
-      printf("            'usb_des' => '%s',\n", printer->usb_des);
-    }
-    if (printer->usb_cmd) {
-      printf("            'usb_cmd' => '%s',\n", printer->usb_cmd);
-    }
-    if (printer->snmp_ieee) {
-      printf("            'snmp_ieee' => '%s',\n", printer->snmp_ieee);
-    }
-    if (printer->snmp_mfg) {
-      printf("            'snmp_mfg' => '%s',\n", printer->snmp_mfg);
-    }
-    if (printer->snmp_mdl) {
-      printf("            'snmp_mdl' => '%s',\n", printer->snmp_mdl);
-    }
-    if (printer->snmp_des) {
-      printf("            'snmp_des' => '%s',\n", printer->snmp_des);
-    }
-    if (printer->snmp_cmd) {
-      printf("            'snmp_cmd' => '%s',\n", printer->snmp_cmd);
-    }
-    printf("            'functionality' => '%s',\n", 
-	   printer->functionality);
-    if (printer->unverified) {
-      printf("            'unverified' => 1,\n");
-    } else {
-      printf("            'unverified' => 0,\n");
-    }
-    if (printer->noxmlentry) {
-      printf("            'noxmlentry' => 1,\n");
-    } else {
-      printf("            'noxmlentry' => 0,\n");
-    }
-    if (printer->driver) {
-      printf("            'driver' => '%s',\n", printer->driver);
-    }
-    if (printer->num_drivers > 0) {
-      printf("            'drivers' => [\n");
-      for (j = 0; j < printer->num_drivers; j ++)
-	if (printer->drivers[j]->name != NULL)
-	  printf("                           '%s',\n",
-		 printer->drivers[j]->name);
-      printf("                         ],\n");
-      printf("            'driverproperties' => {\n");
-      for (j = 0; j < printer->num_drivers; j ++) {
-	for (k = 0; k < overview->num_overviewDrivers; k ++) {
-	  if (!xmlStrcmp(overview->overviewDrivers[k]->name,
-			 printer->drivers[j]->name)) break;
+  outputOpen(out, 10, NULL, PERL_HASH);
+  outputField(out, 12, "id", printer->id);
+  outputField(out, 12, "make", printer->make);
+  outputField(out, 12, "model", printer->model);
+  if (printer->general_ieee) {
+    outputField(out, 12, "general_ieee",
+		printer->general_ieee);
+  }
+  if (printer->general_mfg) {
+    outputField(out, 12, "general_mfg", printer->general_mfg);
+  }
+  if (printer->general_mdl) {
+    outputField(out, 12, "general_mdl", printer->general_mdl);
+  }
+  if (printer->general_des) {
+    outputField(out, 12, "general_des", printer->general_des);
+  }
+  if (printer->general_cmd) {
+    outputField(out, 12, "general_cmd", printer->general_cmd);
+  }
+  if (printer->par_ieee) {
+    outputField(out, 12, "par_ieee", printer->par_ieee);
+  }
+  if (printer->par_mfg) {
+    outputField(out, 12, "par_mfg", printer->par_mfg);
+  }
+  if (printer->par_mdl) {
+    outputField(out, 12, "par_mdl", printer->par_mdl);
+  }
+  if (printer->par_des) {
+    outputField(out, 12, "par_des", printer->par_des);
+  }
+  if (printer->par_cmd) {
+    outputField(out, 12, "par_cmd", printer->par_cmd);
+  }
+  if (printer->usb_ieee) {
+    outputField(out, 12, "usb_ieee", printer->usb_ieee);
+  }
+  if (printer->usb_mfg) {
+    outputField(out, 12, "usb_mfg", printer->usb_mfg);
+  }
+  if (printer->usb_mdl) {
+    outputField(out, 12, "usb_mdl", printer->usb_mdl);
+  }
+  if (printer->usb_des) {
+    outputField(out, 12, "usb_des", printer->usb_des);
+  }
+  if (printer->usb_cmd) {
+    outputField(out, 12, "usb_cmd", printer->usb_cmd);
+  }
+  if (printer->snmp_ieee) {
+    outputField(out, 12, "snmp_ieee", printer->snmp_ieee);
+  }
+  if (printer->snmp_mfg) {
+    outputField(out, 12, "snmp_mfg", printer->snmp_mfg);
+  }
+  if (printer->snmp_mdl) {
+    outputField(out, 12, "snmp_mdl", printer->snmp_mdl);
+  }
+  if (printer->snmp_des) {
+    outputField(out, 12, "snmp_des", printer->snmp_des);
+  }
+  if (printer->snmp_cmd) {
+    outputField(out, 12, "snmp_cmd", printer->snmp_cmd);
+  }
+  outputField(out, 12, "functionality", 
+	      printer->functionality);
+  if (printer->unverified) {
+    outputBare(out, 12, "unverified", (const xmlChar *) "1");
+  } else {
+    outputBare(out, 12, "unverified", (const xmlChar *) "0");
+  }
+  if (printer->noxmlentry) {
+    outputBare(out, 12, "noxmlentry", (const xmlChar *) "1");
+  } else {
+    outputBare(out, 12, "noxmlentry", (const xmlChar *) "0");
+  }
+  if (printer->driver) {
+    outputField(out, 12, "driver", printer->driver);
+  }
+  if (printer->num_drivers > 0) {
+    outputOpen(out, 12, "drivers", PERL_ARRAY);
+    for (j = 0; j < printer->num_drivers; j ++)
+      if (printer->drivers[j]->name != NULL)
+	outputField(out, 27, NULL, printer->drivers[j]->name);
+    outputClose(out, 25, PERL_ARRAY, 0);
+    outputOpen(out, 12, "driverproperties", PERL_HASH);
+    for (j = 0; j < printer->num_drivers; j ++) {
+      for (k = 0; k < overview->num_overviewDrivers; k ++) {
+	if (!xmlStrcmp(overview->overviewDrivers[k]->name,
+		       printer->drivers[j]->name)) break;
+      }
+      if ((k < overview->num_overviewDrivers) &&
+	  (!xmlStrcmp(overview->overviewDrivers[k]->name,
+		      printer->drivers[j]->name))) {
+	outputOpen(out, 14, perlKey(printer->drivers[j]->name), PERL_HASH);
+	if (overview->overviewDrivers[k]->group != NULL) {
+	  outputField(out, 16, "group",
+		      overview->overviewDrivers[k]->group);
 	}
-	if ((k < overview->num_overviewDrivers) &&
-	    (!xmlStrcmp(overview->overviewDrivers[k]->name,
-			printer->drivers[j]->name))) {
-	  printf("              '%s' => {\n",
-		 printer->drivers[j]->name);
-	  if (overview->overviewDrivers[k]->group != NULL) {
-	    printf("                'group' => '%s',\n",
-		   overview->overviewDrivers[k]->group);
-	  }
-	  if (overview->overviewDrivers[k]->url != NULL) {
-	    printf("                'url' => '%s',\n",
-		   overview->overviewDrivers[k]->url);
-	  }
-	  if (overview->overviewDrivers[k]->driver_obsolete != NULL) {
-	    printf("                'obsolete' => '%s',\n",
-		   overview->overviewDrivers[k]->driver_obsolete);
-	  }
-	  if (overview->overviewDrivers[k]->supplier != NULL) {
-	    printf("                'supplier' => '%s',\n",
-		   overview->overviewDrivers[k]->supplier);
-	  }
-	  if (overview->overviewDrivers[k]->manufacturersupplied != NULL) {
-	    printf("                'manufacturersupplied' => '%s',\n",
-		   overview->overviewDrivers[k]->manufacturersupplied);
-	  }
-	  if (overview->overviewDrivers[k]->license != NULL) {
-	    printf("                'license' => '%s',\n",
-		   overview->overviewDrivers[k]->license);
-	  }
-	  if (overview->overviewDrivers[k]->licensetext != NULL) {
-	    printf("                'licensetext' => '%s',\n",
-		   overview->overviewDrivers[k]->licensetext);
-	  }
-	  if (overview->overviewDrivers[k]->origlicensetext != NULL) {
-	    printf("                'origlicensetext' => '%s',\n",
-		   overview->overviewDrivers[k]->origlicensetext);
-	  }
-	  if (overview->overviewDrivers[k]->licenselink != NULL) {
-	    printf("                'licenselink' => '%s',\n",
-		   overview->overviewDrivers[k]->licenselink);
-	  }
-	  if (overview->overviewDrivers[k]->origlicenselink != NULL) {
-	    printf("                'origlicenselink' => '%s',\n",
-		   overview->overviewDrivers[k]->origlicenselink);
-	  }
-	  if (overview->overviewDrivers[k]->free != NULL) {
-	    printf("                'free' => '%s',\n",
-		   overview->overviewDrivers[k]->free);
-	  }
-	  if (overview->overviewDrivers[k]->patents != NULL) {
-	    printf("                'patents' => '%s',\n",
-		   overview->overviewDrivers[k]->patents);
-	  }
-	  if (overview->overviewDrivers[k]->num_supportcontacts != 0) {
-	    printf("                'supportcontacts' => [\n");
-	    for (l = 0;
-		 l < overview->overviewDrivers[k]->num_supportcontacts; l ++) {
-	      if (overview->overviewDrivers[k]->supportcontacturls[l] != 
-		  NULL) {
-		printf("                  {\n");
-		printf("                    'description' => '%s',\n",
-		       overview->overviewDrivers[k]->supportcontacts[l]);
-		if (overview->overviewDrivers[k]->supportcontacturls[l]
-		    != NULL)
-		  printf("                    'url' => '%s',\n",
-			 overview->overviewDrivers[k]->supportcontacturls[l]);
-		printf("                    'level' => '%s',\n",
-		       overview->overviewDrivers[k]->supportcontactlevels[l]);
-		printf("                  },\n");
-	      }
+	if (overview->overviewDrivers[k]->url != NULL) {
+	  outputField(out, 16, "url",
+		      overview->overviewDrivers[k]->url);
+	}
+	if (overview->overviewDrivers[k]->driver_obsolete != NULL) {
+	  outputField(out, 16, "obsolete",
+		      overview->overviewDrivers[k]->driver_obsolete);
+	}
+	if (overview->overviewDrivers[k]->supplier != NULL) {
+	  outputField(out, 16, "supplier",
+		      overview->overviewDrivers[k]->supplier);
+	}
+	if (overview->overviewDrivers[k]->manufacturersupplied != NULL) {
+	  outputField(out, 16, "manufacturersupplied",
+		      overview->overviewDrivers[k]->manufacturersupplied);
+	}
+	if (overview->overviewDrivers[k]->license != NULL) {
+	  outputField(out, 16, "license",
+		      overview->overviewDrivers[k]->license);
+	}
+	if (overview->overviewDrivers[k]->licensetext != NULL) {
+	  outputField(out, 16, "licensetext",
+		      overview->overviewDrivers[k]->licensetext);
+	}
+	if (overview->overviewDrivers[k]->origlicensetext != NULL) {
+	  outputField(out, 16, "origlicensetext",
+		      overview->overviewDrivers[k]->origlicensetext);
+	}
+	if (overview->overviewDrivers[k]->licenselink != NULL) {
+	  outputField(out, 16, "licenselink",
+		      overview->overviewDrivers[k]->licenselink);
+	}
+	if (overview->overviewDrivers[k]->origlicenselink != NULL) {
+	  outputField(out, 16, "origlicenselink",
+		      overview->overviewDrivers[k]->origlicenselink);
+	}
+	if (overview->overviewDrivers[k]->free != NULL) {
+	  outputField(out, 16, "free",
+		      overview->overviewDrivers[k]->free);
+	}
+	if (overview->overviewDrivers[k]->patents != NULL) {
+	  outputField(out, 16, "patents",
+		      overview->overviewDrivers[k]->patents);
+	}
+	if (overview->overviewDrivers[k]->num_supportcontacts != 0) {
+	  outputOpen(out, 16, "supportcontacts", PERL_ARRAY);
+	  for (l = 0;
+	       l < overview->overviewDrivers[k]->num_supportcontacts; l ++) {
+	    if (overview->overviewDrivers[k]->supportcontacturls[l] != 
+		NULL) {
+	      outputOpen(out, 18, NULL, PERL_HASH);
+	      outputField(out, 20, "description",
+			  overview->overviewDrivers[k]->supportcontacts[l]);
+	      if (overview->overviewDrivers[k]->supportcontacturls[l]
+		  != NULL)
+		outputField(out, 20, "url",
+			    overview->overviewDrivers[k]->supportcontacturls[l]);
+	      outputField(out, 20, "level",
+			  overview->overviewDrivers[k]->supportcontactlevels[l]);
+	      outputClose(out, 18, PERL_HASH, 0);
 	    }
-	    printf("                ],\n");
 	  }
-	  if (overview->overviewDrivers[k]->shortdescription != NULL) {
-	    printf("                'shortdescription' => '%s',\n",
-		   overview->overviewDrivers[k]->shortdescription);
-	  }
-	  if (overview->overviewDrivers[k]->locales != NULL) {
-	    printf("                'locales' => '%s',\n",
-		   overview->overviewDrivers[k]->locales);
-	  }
-	  if (overview->overviewDrivers[k]->num_packages != 0) {
-	    printf("                'packages' => [\n");
-	    for (l = 0;
-		 l < overview->overviewDrivers[k]->num_packages; l ++) {
-	      if (overview->overviewDrivers[k]->packageurls[l] != 
-		  NULL) {
-		printf("                  {\n");
-		printf("                    'url' => '%s',\n",
-		       overview->overviewDrivers[k]->packageurls[l]);
-		if (overview->overviewDrivers[k]->packagescopes[l]
-		    != NULL)
-		  printf("                    'scope' => '%s',\n",
-			 overview->overviewDrivers[k]->packagescopes[l]);
-		if (overview->overviewDrivers[k]->packagefingerprints[l]
-		    != NULL)
-		  printf("                    'fingerprint' => '%s',\n",
-			 overview->overviewDrivers[k]->packagefingerprints[l]);
-		printf("                  },\n");
-	      }
+	  outputClose(out, 16, PERL_ARRAY, 0);
+	}
+	if (overview->overviewDrivers[k]->shortdescription != NULL) {
+	  outputField(out, 16, "shortdescription",
+		      overview->overviewDrivers[k]->shortdescription);
+	}
+	if (overview->overviewDrivers[k]->locales != NULL) {
+	  outputField(out, 16, "locales",
+		      overview->overviewDrivers[k]->locales);
+	}
+	if (overview->overviewDrivers[k]->num_packages != 0) {
+	  outputOpen(out, 16, "packages", PERL_ARRAY);
+	  for (l = 0;
+	       l < overview->overviewDrivers[k]->num_packages; l ++) {
+	    if (overview->overviewDrivers[k]->packageurls[l] != 
+		NULL) {
+	      outputOpen(out, 18, NULL, PERL_HASH);
+	      outputField(out, 20, "url",
+			  overview->overviewDrivers[k]->packageurls[l]);
+	      if (overview->overviewDrivers[k]->packagescopes[l]
+		  != NULL)
+		outputField(out, 20, "scope",
+			    overview->overviewDrivers[k]->packagescopes[l]);
+	      if (overview->overviewDrivers[k]->packagefingerprints[l]
+		  != NULL)
+		outputField(out, 20, "fingerprint",
+			    overview->overviewDrivers[k]->packagefingerprints[l]);
+	      outputClose(out, 18, PERL_HASH, 0);
 	    }
-	    printf("                ],\n");
 	  }
-	  if (overview->overviewDrivers[k]->num_requires != 0) {
-	    printf("                'requires' => [\n");
-	    for (l = 0;
-		 l < overview->overviewDrivers[k]->num_requires; l ++) {
-	      if (overview->overviewDrivers[k]->requires[l] != 
-		  NULL) {
-		printf("                  {\n");
-		printf("                    'driver' => '%s',\n",
-		       overview->overviewDrivers[k]->requires[l]);
-		if (overview->overviewDrivers[k]->requiresversion[l]
-		    != NULL)
-		  printf("                    'version' => '%s',\n",
-			 overview->overviewDrivers[k]->requiresversion[l]);
-		printf("                  },\n");
-	      }
+	  outputClose(out, 16, PERL_ARRAY, 0);
+	}
+	if (overview->overviewDrivers[k]->num_requires != 0) {
+	  outputOpen(out, 16, "requires", PERL_ARRAY);
+	  for (l = 0;
+	       l < overview->overviewDrivers[k]->num_requires; l ++) {
+	    if (overview->overviewDrivers[k]->requires[l] != 
+		NULL) {
+	      outputOpen(out, 18, NULL, PERL_HASH);
+	      outputField(out, 20, "driver",
+			  overview->overviewDrivers[k]->requires[l]);
+	      if (overview->overviewDrivers[k]->requiresversion[l]
+		  != NULL)
+		outputField(out, 20, "version",
+			    overview->overviewDrivers[k]->requiresversion[l]);
+	      outputClose(out, 18, PERL_HASH, 0);
 	    }
-	    printf("                ],\n");
-	  }
-	  if (overview->overviewDrivers[k]->driver_type != NULL) {
-	    printf("                'type' => '%s',\n",
-		   overview->overviewDrivers[k]->driver_type);
-	  }
-	  if (printer->drivers[j]->excmaxresx != NULL) {
-	    printf("                'drvmaxresx' => '%s',\n",
-		   printer->drivers[j]->excmaxresx);
-	  } else if (overview->overviewDrivers[k]->maxresx != NULL) {
-	    printf("                'drvmaxresx' => '%s',\n",
-		   overview->overviewDrivers[k]->maxresx);
-	  }
-	  if (printer->drivers[j]->excmaxresy != NULL) {
-	    printf("                'drvmaxresy' => '%s',\n",
-		   printer->drivers[j]->excmaxresy);
-	  } else if (overview->overviewDrivers[k]->maxresy != NULL) {
-	    printf("                'drvmaxresy' => '%s',\n",
-		   overview->overviewDrivers[k]->maxresy);
-	  }
-	  if (printer->drivers[j]->exccolor != NULL) {
-	    printf("                'drvcolor' => '%s',\n",
-		   printer->drivers[j]->exccolor);
-	  } else if (overview->overviewDrivers[k]->color != NULL) {
-	    printf("                'drvcolor' => '%s',\n",
-		   overview->overviewDrivers[k]->color);
-	  }
-	  if (printer->drivers[j]->exctext != NULL) {
-	    printf("                'text' => '%s',\n",
-		   printer->drivers[j]->exctext);
-	  } else if (overview->overviewDrivers[k]->text != NULL) {
-	    printf("                'text' => '%s',\n",
-		   overview->overviewDrivers[k]->text);
-	  }
-	  if (printer->drivers[j]->exclineart != NULL) {
-	    printf("                'lineart' => '%s',\n",
-		   printer->drivers[j]->exclineart);
-	  } else if (overview->overviewDrivers[k]->lineart != NULL) {
-	    printf("                'lineart' => '%s',\n",
-		   overview->overviewDrivers[k]->lineart);
-	  }
-	  if (printer->drivers[j]->excgraphics != NULL) {
-	    printf("                'graphics' => '%s',\n",
-		   printer->drivers[j]->excgraphics);
-	  } else if (overview->overviewDrivers[k]->graphics != NULL) {
-	    printf("                'graphics' => '%s',\n",
-		   overview->overviewDrivers[k]->graphics);
-	  }
-	  if (printer->drivers[j]->excphoto != NULL) {
-	    printf("                'photo' => '%s',\n",
-		   printer->drivers[j]->excphoto);
-	  } else if (overview->overviewDrivers[k]->photo != NULL) {
-	    printf("                'photo' => '%s',\n",
-		   overview->overviewDrivers[k]->photo);
 	  }
-	  if (printer->drivers[j]->excload != NULL) {
-	    printf("                'load' => '%s',\n",
-		   printer->drivers[j]->excload);
-	  } else if (overview->overviewDrivers[k]->load != NULL) {
-	    printf("                'load' => '%s',\n",
-		   overview->overviewDrivers[k]->load);
-	  }
-	  if (printer->drivers[j]->excspeed != NULL) {
-	    printf("                'speed' => '%s',\n",
-		   printer->drivers[j]->excspeed);
-	  } else if (overview->overviewDrivers[k]->speed != NULL) {
-	    printf("                'speed' => '%s',\n",
-		   overview->overviewDrivers[k]->speed);
-	  }
-	  printf("              },\n");
+	  outputClose(out, 16, PERL_ARRAY, 0);
 	}
-      }
-      printf("            },\n");
-    } else {
-      printf("            'drivers' => [],\n");
-    }
-    if (printer->num_ppdfiles > 0) {
-      printf("            'ppds' => [\n");
-      for (j = 0; j < printer->num_ppdfiles; j ++)
-	if ((printer->ppdfiles[j]->driver != NULL) &&
-	    (printer->ppdfiles[j]->filename != NULL)) {
-	  printf("                        {\n");
-	  printf("                          'driver' => '%s',\n",
-		 printer->ppdfiles[j]->driver);
-	  printf("                          'ppdfile' => '%s',\n",
-		 printer->ppdfiles[j]->filename);
-	  printf("                        },\n");
+	if (overview->overviewDrivers[k]->driver_type != NULL) {
+	  outputField(out, 16, "type",
+		      overview->overviewDrivers[k]->driver_type);
+	}
+	if (printer->drivers[j]->excmaxresx != NULL) {
+	  outputField(out, 16, "drvmaxresx",
+		      printer->drivers[j]->excmaxresx);
+	} else if (overview->overviewDrivers[k]->maxresx != NULL) {
+	  outputField(out, 16, "drvmaxresx",
+		      overview->overviewDrivers[k]->maxresx);
+	}
+	if (printer->drivers[j]->excmaxresy != NULL) {
+	  outputField(out, 16, "drvmaxresy",
+		      printer->drivers[j]->excmaxresy);
+	} else if (overview->overviewDrivers[k]->maxresy != NULL) {
+	  outputField(out, 16, "drvmaxresy",
+		      overview->overviewDrivers[k]->maxresy);
+	}
+	if (printer->drivers[j]->exccolor != NULL) {
+	  outputField(out, 16, "drvcolor",
+		      printer->drivers[j]->exccolor);
+	} else if (overview->overviewDrivers[k]->color != NULL) {
+	  outputField(out, 16, "drvcolor",
+		      overview->overviewDrivers[k]->color);
 	}
-      printf("                      ],\n");
+	if (printer->drivers[j]->exctext != NULL) {
+	  outputField(out, 16, "text",
+		      printer->drivers[j]->exctext);
+	} else if (overview->overviewDrivers[k]->text != NULL) {
+	  outputField(out, 16, "text",
+		      overview->overviewDrivers[k]->text);
+	}
+	if (printer->drivers[j]->exclineart != NULL) {
+	  outputField(out, 16, "lineart",
+		      printer->drivers[j]->exclineart);
+	} else if (overview->overviewDrivers[k]->lineart != NULL) {
+	  outputField(out, 16, "lineart",
+		      overview->overviewDrivers[k]->lineart);
+	}
+	if (printer->drivers[j]->excgraphics != NULL) {
+	  outputField(out, 16, "graphics",
+		      printer->drivers[j]->excgraphics);
+	} else if (overview->overviewDrivers[k]->graphics != NULL) {
+	  outputField(out, 16, "graphics",
+		      overview->overviewDrivers[k]->graphics);
+	}
+	if (printer->drivers[j]->excphoto != NULL) {
+	  outputField(out, 16, "photo",
+		      printer->drivers[j]->excphoto);
+	} else if (overview->overviewDrivers[k]->photo != NULL) {
+	  outputField(out, 16, "photo",
+		      overview->overviewDrivers[k]->photo);
+	}
+	if (printer->drivers[j]->excload != NULL) {
+	  outputField(out, 16, "load",
+		      printer->drivers[j]->excload);
+	} else if (overview->overviewDrivers[k]->load != NULL) {
+	  outputField(out, 16, "load",
+		      overview->overviewDrivers[k]->load);
+	}
+	if (printer->drivers[j]->excspeed != NULL) {
+	  outputField(out, 16, "speed",
+		      printer->drivers[j]->excspeed);
+	} else if (overview->overviewDrivers[k]->speed != NULL) {
+	  outputField(out, 16, "speed",
+		      overview->overviewDrivers[k]->speed);
+	}
+	outputClose(out, 14, PERL_HASH, 0);
+      }
     }
-    printf("          },\n");
+    outputClose(out, 12, PERL_HASH, 0);
+  } else {
+    outputEmpty(out, 12, "drivers", PERL_ARRAY, 0);
+  }
+  if (printer->num_ppdfiles > 0) {
+    outputOpen(out, 12, "ppds", PERL_ARRAY);
+    for (j = 0; j < printer->num_ppdfiles; j ++)
+      if ((printer->ppdfiles[j]->driver != NULL) &&
+	  (printer->ppdfiles[j]->filename != NULL)) {
+	outputOpen(out, 24, NULL, PERL_HASH);
+	outputField(out, 26, "driver",
+		    printer->ppdfiles[j]->driver);
+	outputField(out, 26, "ppdfile",
+		    printer->ppdfiles[j]->filename);
+	outputClose(out, 24, PERL_HASH, 0);
+      }
+    outputClose(out, 22, PERL_ARRAY, 0);
+  }
+  outputClose(out, 10, PERL_HASH, 0);
+
+}
+
+/*
+ * Function to parse the overview XML data and to put out its Perl data
+ * entry by entry, with a streaming parser. Only one <printer> or <driver>
+ * element is in memory as an XML tree at a time, the printers are put
+ * out and freed as soon as they are parsed. The drivers are kept in an
+ * arena of their own, the printers need their properties,
+ * foomatic-combo-xml puts them out before the printers.
+ */
+
+static int   /* O - 0: success, 1: input not readable or not an overview
+		(error message issued) */
+streamOverviewFile(char *filename, /* I - Input file name, NULL: stdin */
+		   xmlChar const language [], /* I - User language */
+		   outputPtr out, /* I/O - Buffer for the Perl data */
+		   converterPtr st, /* I/O - Converter into Storable data or
+				      JSON,
+				      NULL: Perl data only */
+		   int debug) { /* I - Debug mode flag */
+  xmlTextReaderPtr reader;  /* Streaming XML parser */
+  xmlNodePtr     cur;  /* XML node currently worked on */
+  overview       ret;  /* The drivers and the current printer */
+  driverEntryPtr driver;
+  xmlDocPtr      doc;  /* Document of the reader */
+  arena          drivers; /* Data of the drivers */
+  arena          printer; /* Data of the current printer */
+  int            result; /* Result of the last reader step */
+  int            started = 0; /* Beginning of the Perl data put out? */
+  statsclock_t   phasestart; /* Start of the current phase ("--stats") */
+  
+  /*
+   * read the XML data from a file or stdin, without the formatting
+   * spaces, as the tree parser does
+   */
+
+  if (filename == NULL) {
+    reader = xmlReaderForFd(0, NULL, NULL, XML_PARSE_NOBLANKS);
+  } else {
+    reader = xmlReaderForFile(filename, NULL, XML_PARSE_NOBLANKS);
   }
-  printf("        ];\n");
+  if (reader == NULL) return(1);
+  startphase(&phasestart);
+  memset(&ret, 0, sizeof(overview));
+  arenaInit(&drivers);
+  arenaInit(&printer);
 
+  /*
+   * Check the document is of the right kind
+   */
+
+  while (((result = xmlTextReaderRead(reader)) == 1) &&
+	 (xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT));
+  if (result != 1) {
+    if (result == 0) fprintf(stderr,"Empty input document!\n");
+    xmlFreeTextReader(reader);
+    return(1);
+  }
+  if (xmlStrcmp(xmlTextReaderConstName(reader),
+		(const xmlChar *) "overview")) {
+    fprintf(stderr,"Input document is not a Foomatic overview XML file (no \"<overview>\" tag)!\n");
+    xmlFreeTextReader(reader);
+    return(1);
+  }
+
+  /*
+   * Now, walk through the entries on the first level, each one is
+   * expanded into a tree, parsed, and freed when the reader goes on
+   */
+
+  if (st == NULL)
+    outputLiteral(out, "$VAR1 = [\n");
+  else
+    convertOverviewStart(st);
+  started = 1;
+  result = xmlTextReaderRead(reader);
+  while (result == 1) {
+    if ((xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT) ||
+	(xmlTextReaderDepth(reader) != 1)) {
+      result = xmlTextReaderRead(reader);
+      continue;
+    }
+    cur = xmlTextReaderExpand(reader);
+    if (cur == NULL) {
+      result = -1;
+      break;
+    }
+    /* Not xmlTextReaderCurrentDoc(), the reader would not free the
+       document then */
+    doc = cur->doc;
+    if (!xmlStrcmp(cur->name, (const xmlChar *) "driver")) {
+      ret.num_overviewDrivers ++;
+      ret.overviewDrivers =
+	(driverEntryPtr *)arenaGrow(&drivers, ret.overviewDrivers,
+				    ret.num_overviewDrivers,
+				    sizeof(driverEntryPtr));
+      driver = (driverEntryPtr) arenaAlloc(&drivers, sizeof(driverEntry));
+      ret.overviewDrivers[ret.num_overviewDrivers-1] = driver;
+      memset(driver, 0, sizeof(driverEntry));
+      if (debug) fprintf(stderr, "--> Parsing driver data\n");
+      doc->_private = &drivers;
+      parseDriverEntry(doc, cur, driver, language, debug);
+      endphase(STATS_XMLPARSE, &phasestart);
+    } else if (!xmlStrcmp(cur->name, (const xmlChar *) "printer")) {
+      if (debug) fprintf(stderr, "--> Parsing printer data\n");
+      doc->_private = &printer;
+      parseOverviewPrinter(doc, cur, &ret, language, debug);
+      endphase(STATS_XMLPARSE, &phasestart);
+      generateOverviewPrinterPerlData(&ret, ret.overviewPrinters[0], out,
+				      debug);
+      endphase(STATS_PERL, &phasestart);
+      /* The converted values are the printer's strings, it is freed
+	 afterwards */
+      if ((st != NULL) && (convertPerlData(st, 1, debug) != 0)) {
+	result = -1;
+	break;
+      }
+      endphase(STATS_OUTPUT, &phasestart);
+      ret.num_overviewPrinters = 0;
+      ret.overviewPrinters = NULL;
+      arenaReset(&printer);
+    }
+    result = xmlTextReaderNext(reader);
+  }
+  endphase(STATS_XMLPARSE, &phasestart);
+  if (started && (result == 0)) {
+    if (st == NULL)
+      outputLiteral(out, "        ];\n");
+    else
+      convertOverviewEnd(st);
+  }
+  if (filename == NULL)
+    countstat(STATS_BYTES, xmlTextReaderByteConsumed(reader));
+  arenaFree(&printer);
+  arenaFree(&drivers);
+  xmlFreeTextReader(reader);
+  return(result != 0);
 }
 
 void
 generateMarginsPerlData(marginsPtr margins, /* I/O - Foomatic margins data
 					       parsed from XML input */
+			outputPtr out, /* I/O - Buffer for the Perl data */
 			int debug) { /* Debug flag */
 
   int i; /* loop variable */
   
   for (i = 0; i < margins->num_marginRecords; i ++) {
     if (margins->marginRecords[i]->pagesize) {
-      printf("    '%s' => {\n", margins->marginRecords[i]->pagesize);
+      outputOpen(out, 4, perlKey(margins->marginRecords[i]->pagesize),
+		 PERL_HASH);
     } else {
-      printf("    '_general' => {\n");
+      outputOpen(out, 4, "_general", PERL_HASH);
     }
     if (margins->marginRecords[i]->unit) {
-      printf("      'unit' => '%s',\n", margins->marginRecords[i]->unit);
+      outputField(out, 6, "unit", margins->marginRecords[i]->unit);
     }
     if (margins->marginRecords[i]->absolute) {
-      printf("      'absolute' => '%s',\n", 
-	     margins->marginRecords[i]->absolute);
+      outputField(out, 6, "absolute", 
+		  margins->marginRecords[i]->absolute);
     }
     if (margins->marginRecords[i]->left) {
-      printf("      'left' => '%s',\n", margins->marginRecords[i]->left);
+      outputField(out, 6, "left", margins->marginRecords[i]->left);
     }
     if (margins->marginRecords[i]->right) {
-      printf("      'right' => '%s',\n", margins->marginRecords[i]->right);
+      outputField(out, 6, "right", margins->marginRecords[i]->right);
     }
     if (margins->marginRecords[i]->top) {
-      printf("      'top' => '%s',\n", margins->marginRecords[i]->top);
+      outputField(out, 6, "top", margins->marginRecords[i]->top);
     }
     if (margins->marginRecords[i]->bottom) {
-      printf("      'bottom' => '%s',\n", margins->marginRecords[i]->bottom);
+      outputField(out, 6, "bottom", margins->marginRecords[i]->bottom);
     }
-    printf("    },\n");
+    outputClose(out, 4, PERL_HASH, 0);
   }
 }
 
@@ -4120,519 +5693,519 @@ xmlChar const sc_Postscript [] = "Postscript";
 void
 generateComboPerlData(comboDataPtr combo, /* I/O - Foomatic combo data
 					     parsed from XML input */
+		      outputPtr out, /* I/O - Buffer for the Perl data */
 		      int debug) { /* Debug flag */
 
   int i, j; /* loop variables */
   int haspsdriver = 0; /* Is the "Postscript" driver in the printer's
 			  driver list? */
   
-  printf("$VAR1 = {\n");
-  printf("  'id' => '%s',\n", combo->id);
-  printf("  'make' => '%s',\n", combo->make);
-  printf("  'model' => '%s',\n", combo->model);
+  outputStart(out);
+  outputField(out, 2, "id", combo->id);
+  outputField(out, 2, "make", combo->make);
+  outputField(out, 2, "model", combo->model);
   if (combo->recdriver) {
-    printf("  'recdriver' => '%s',\n", combo->recdriver);
+    outputField(out, 2, "recdriver", combo->recdriver);
   } else {
-    printf("  'recdriver' => undef,\n");
+    outputUndef(out, 2, "recdriver");
   }
   if ((combo->num_drivers > 0) || (combo->ppdurl)) {
-    printf("  'drivers' => [\n");
+    outputOpen(out, 2, "drivers", PERL_ARRAY);
     for (i = 0; i < combo->num_drivers; i ++) {
-      printf("                 {\n");
+      outputOpen(out, 17, NULL, PERL_HASH);
       if (combo->drivers[i]->name) {
 	if (xmlStrncmp(combo->drivers[i]->name, sc_Postscript, 10))
 	  haspsdriver = 1;
-	printf("                   'name' => '%s',\n",
-	       combo->drivers[i]->name);
-	printf("                   'id' => '%s',\n",
-	       combo->drivers[i]->name);
+	outputField(out, 19, "name",
+		    combo->drivers[i]->name);
+	outputField(out, 19, "id",
+		    combo->drivers[i]->name);
       }
       if (combo->drivers[i]->ppd) {
-	printf("                   'ppd' => '%s',\n",
-	       combo->drivers[i]->ppd);
+	outputField(out, 19, "ppd",
+		    combo->drivers[i]->ppd);
       }
       if (combo->drivers[i]->comment) {
-	printf("                   'comment' => '%s',\n",
-	       combo->drivers[i]->comment);
+	outputField(out, 19, "comment",
+		    combo->drivers[i]->comment);
       }
-      printf("                 },\n");
+      outputClose(out, 17, PERL_HASH, 0);
     }
     if ((combo->ppdurl) && !haspsdriver) {
-      printf("                 {\n");
-      printf("                   'name' => '%s',\n",
-	     "Postscript");
-      printf("                   'id' => '%s',\n",
-	     "Postscript");
-      printf("                   'ppd' => '%s',\n",
-	     combo->ppdurl);
-      printf("                 },\n");
+      outputOpen(out, 17, NULL, PERL_HASH);
+      outputField(out, 19, "name",
+		  (const xmlChar *) "Postscript");
+      outputField(out, 19, "id",
+		  (const xmlChar *) "Postscript");
+      outputField(out, 19, "ppd",
+		  combo->ppdurl);
+      outputClose(out, 17, PERL_HASH, 0);
     }
-    printf("               ],\n");
+    outputClose(out, 15, PERL_ARRAY, 0);
   }
   if (combo->pcmodel) {
-    printf("  'pcmodel' => '%s',\n", combo->pcmodel);
+    outputField(out, 2, "pcmodel", combo->pcmodel);
   } else {
-    printf("  'pcmodel' => undef,\n");
+    outputUndef(out, 2, "pcmodel");
   }
   if (combo->ppdurl) {
-    printf("  'ppdurl' => '%s',\n", combo->ppdurl);
+    outputField(out, 2, "ppdurl", combo->ppdurl);
   }
-  printf("  'color' => %s,\n", combo->color);
-  printf("  'ascii' => %s,\n", combo->ascii);
-  printf("  'pjl' => %s,\n", combo->pjl);
+  outputBare(out, 2, "color", combo->color);
+  outputBare(out, 2, "ascii", combo->ascii);
+  outputBare(out, 2, "pjl", combo->pjl);
   if (combo->printerppdentry) {
-    printf("  'printerppdentry' => '%s',\n", combo->printerppdentry);
+    outputField(out, 2, "printerppdentry", combo->printerppdentry);
   } else {
-    printf("  'printerppdentry' => undef,\n");
+    outputUndef(out, 2, "printerppdentry");
   }
   if (combo->printermargins) {
-    printf("  'printermargins' => {\n");
-    generateMarginsPerlData(combo->printermargins, debug);
-    printf("  },\n");
+    outputOpen(out, 2, "printermargins", PERL_HASH);
+    generateMarginsPerlData(combo->printermargins, out, debug);
+    outputClose(out, 2, PERL_HASH, 0);
   }
   if (combo->general_ieee) {
-    printf("  'pnp_ieee' => '%s',\n", combo->general_ieee);
-    printf("  'general_ieee' => '%s',\n", combo->general_ieee);
+    outputField(out, 2, "pnp_ieee", combo->general_ieee);
+    outputField(out, 2, "general_ieee", combo->general_ieee);
   } else {
-    printf("  'pnp_ieee' => undef,\n");
-    printf("  'general_ieee' => undef,\n");
+    outputUndef(out, 2, "pnp_ieee");
+    outputUndef(out, 2, "general_ieee");
   }
   if (combo->general_mfg) {
-    printf("  'pnp_mfg' => '%s',\n", combo->general_mfg);
-    printf("  'general_mfg' => '%s',\n", combo->general_mfg);
+    outputField(out, 2, "pnp_mfg", combo->general_mfg);
+    outputField(out, 2, "general_mfg", combo->general_mfg);
   } else {
-    printf("  'pnp_mfg' => undef,\n");
-    printf("  'general_mfg' => undef,\n");
+    outputUndef(out, 2, "pnp_mfg");
+    outputUndef(out, 2, "general_mfg");
   }
   if (combo->general_mdl) {
-    printf("  'pnp_mdl' => '%s',\n", combo->general_mdl);
-    printf("  'general_mdl' => '%s',\n", combo->general_mdl);
+    outputField(out, 2, "pnp_mdl", combo->general_mdl);
+    outputField(out, 2, "general_mdl", combo->general_mdl);
   } else {
-    printf("  'pnp_mdl' => undef,\n");
-    printf("  'general_mdl' => undef,\n");
+    outputUndef(out, 2, "pnp_mdl");
+    outputUndef(out, 2, "general_mdl");
   }
   if (combo->general_des) {
-    printf("  'pnp_des' => '%s',\n", combo->general_des);
-    printf("  'general_des' => '%s',\n", combo->general_des);
+    outputField(out, 2, "pnp_des", combo->general_des);
+    outputField(out, 2, "general_des", combo->general_des);
   } else {
-    printf("  'pnp_des' => undef,\n");
-    printf("  'general_des' => undef,\n");
+    outputUndef(out, 2, "pnp_des");
+    outputUndef(out, 2, "general_des");
   }
   if (combo->general_cmd) {
-    printf("  'pnp_cmd' => '%s',\n", combo->general_cmd);
-    printf("  'general_cmd' => '%s',\n", combo->general_cmd);
+    outputField(out, 2, "pnp_cmd", combo->general_cmd);
+    outputField(out, 2, "general_cmd", combo->general_cmd);
   } else {
-    printf("  'pnp_cmd' => undef,\n");
-    printf("  'general_cmd' => undef,\n");
+    outputUndef(out, 2, "pnp_cmd");
+    outputUndef(out, 2, "general_cmd");
   }
   if (combo->par_ieee) {
-    printf("  'par_ieee' => '%s',\n", combo->par_ieee);
+    outputField(out, 2, "par_ieee", combo->par_ieee);
   } else {
-    printf("  'par_ieee' => undef,\n");
+    outputUndef(out, 2, "par_ieee");
   }
   if (combo->par_mfg) {
-    printf("  'par_mfg' => '%s',\n", combo->par_mfg);
+    outputField(out, 2, "par_mfg", combo->par_mfg);
   } else {
-    printf("  'par_mfg' => undef,\n");
+    outputUndef(out, 2, "par_mfg");
   }
   if (combo->par_mdl) {
-    printf("  'par_mdl' => '%s',\n", combo->par_mdl);
+    outputField(out, 2, "par_mdl", combo->par_mdl);
   } else {
-    printf("  'par_mdl' => undef,\n");
+    outputUndef(out, 2, "par_mdl");
   }
   if (combo->par_des) {
-    printf("  'par_des' => '%s',\n", combo->par_des);
+    outputField(out, 2, "par_des", combo->par_des);
   } else {
-    printf("  'par_des' => undef,\n");
+    outputUndef(out, 2, "par_des");
   }
   if (combo->par_cmd) {
-    printf("  'par_cmd' => '%s',\n", combo->par_cmd);
+    outputField(out, 2, "par_cmd", combo->par_cmd);
   } else {
-    printf("  'par_cmd' => undef,\n");
+    outputUndef(out, 2, "par_cmd");
   }
   if (combo->usb_ieee) {
-    printf("  'usb_ieee' => '%s',\n", combo->usb_ieee);
+    outputField(out, 2, "usb_ieee", combo->usb_ieee);
   } else {
-    printf("  'usb_ieee' => undef,\n");
+    outputUndef(out, 2, "usb_ieee");
   }
   if (combo->usb_mfg) {
-    printf("  'usb_mfg' => '%s',\n", combo->usb_mfg);
+    outputField(out, 2, "usb_mfg", combo->usb_mfg);
   } else {
-    printf("  'usb_mfg' => undef,\n");
+    outputUndef(out, 2, "usb_mfg");
   }
   if (combo->usb_mdl) {
-    printf("  'usb_mdl' => '%s',\n", combo->usb_mdl);
+    outputField(out, 2, "usb_mdl", combo->usb_mdl);
   } else {
-    printf("  'usb_mdl' => undef,\n");
+    outputUndef(out, 2, "usb_mdl");
   }
   if (combo->usb_des) {
-    printf("  'usb_des' => '%s',\n", combo->usb_des);
+    outputField(out, 2, "usb_des", combo->usb_des);
   } else {
-    printf("  'usb_des' => undef,\n");
+    outputUndef(out, 2, "usb_des");
   }
   if (combo->usb_cmd) {
-    printf("  'usb_cmd' => '%s',\n", combo->usb_cmd);
+    outputField(out, 2, "usb_cmd", combo->usb_cmd);
   } else {
-    printf("  'usb_cmd' => undef,\n");
+    outputUndef(out, 2, "usb_cmd");
   }
   if (combo->snmp_ieee) {
-    printf("  'snmp_ieee' => '%s',\n", combo->snmp_ieee);
+    outputField(out, 2, "snmp_ieee", combo->snmp_ieee);
   } else {
-    printf("  'snmp_ieee' => undef,\n");
+    outputUndef(out, 2, "snmp_ieee");
   }
   if (combo->snmp_mfg) {
-    printf("  'snmp_mfg' => '%s',\n", combo->snmp_mfg);
+    outputField(out, 2, "snmp_mfg", combo->snmp_mfg);
   } else {
-    printf("  'snmp_mfg' => undef,\n");
+    outputUndef(out, 2, "snmp_mfg");
   }
   if (combo->snmp_mdl) {
-    printf("  'snmp_mdl' => '%s',\n", combo->snmp_mdl);
+    outputField(out, 2, "snmp_mdl", combo->snmp_mdl);
   } else {
-    printf("  'snmp_mdl' => undef,\n");
+    outputUndef(out, 2, "snmp_mdl");
   }
   if (combo->snmp_des) {
-    printf("  'snmp_des' => '%s',\n", combo->snmp_des);
+    outputField(out, 2, "snmp_des", combo->snmp_des);
   } else {
-    printf("  'snmp_des' => undef,\n");
+    outputUndef(out, 2, "snmp_des");
   }
   if (combo->snmp_cmd) {
-    printf("  'snmp_cmd' => '%s',\n", combo->snmp_cmd);
+    outputField(out, 2, "snmp_cmd", combo->snmp_cmd);
   } else {
-    printf("  'snmp_cmd' => undef,\n");
+    outputUndef(out, 2, "snmp_cmd");
   }
-  printf("  'driver' => '%s',\n", combo->driver);
+  outputField(out, 2, "driver", combo->driver);
   if (combo->driver_group) {
-    printf("  'group' => '%s',\n", combo->driver_group);
+    outputField(out, 2, "group", combo->driver_group);
   }
   if (combo->pcdriver) {
-    printf("  'pcdriver' => '%s',\n", combo->pcdriver);
+    outputField(out, 2, "pcdriver", combo->pcdriver);
   } else {
-    printf("  'pcdriver' => undef,\n");
+    outputUndef(out, 2, "pcdriver");
   }
-  printf("  'type' => '%s',\n", combo->driver_type);
+  outputField(out, 2, "type", combo->driver_type);
   if (combo->driver_comment) {
-    printf("  'comment' => '%s',\n", combo->driver_comment);
+    outputField(out, 2, "comment", combo->driver_comment);
   } else {
-    printf("  'comment' => undef,\n");
+    outputUndef(out, 2, "comment");
   }
   if (combo->url) {
-    printf("  'url' => '%s',\n", combo->url);
+    outputField(out, 2, "url", combo->url);
   } else {
-    printf("  'url' => undef,\n");
+    outputUndef(out, 2, "url");
   }
   if (combo->driver_obsolete) {
-    printf("  'obsolete' => '%s',\n", combo->driver_obsolete);
+    outputField(out, 2, "obsolete", combo->driver_obsolete);
   }
   if (combo->supplier != NULL) {
-    printf("  'supplier' => '%s',\n",
-	   combo->supplier);
+    outputField(out, 2, "supplier",
+		combo->supplier);
   }
   if (combo->manufacturersupplied != NULL) {
-    printf("  'manufacturersupplied' => '%s',\n",
-	   combo->manufacturersupplied);
+    outputField(out, 2, "manufacturersupplied",
+		combo->manufacturersupplied);
   }
   if (combo->license != NULL) {
-    printf("  'license' => '%s',\n",
-	   combo->license);
+    outputField(out, 2, "license",
+		combo->license);
   }
   if (combo->licensetext != NULL) {
-    printf("  'licensetext' => '%s',\n",
-	   combo->licensetext);
+    outputField(out, 2, "licensetext",
+		combo->licensetext);
   }
   if (combo->origlicensetext != NULL) {
-    printf("  'origlicensetext' => '%s',\n",
-	   combo->origlicensetext);
+    outputField(out, 2, "origlicensetext",
+		combo->origlicensetext);
   }
   if (combo->licenselink != NULL) {
-    printf("  'licenselink' => '%s',\n",
-	   combo->licenselink);
+    outputField(out, 2, "licenselink",
+		combo->licenselink);
   }
   if (combo->origlicenselink != NULL) {
-    printf("  'origlicenselink' => '%s',\n",
-	   combo->origlicenselink);
+    outputField(out, 2, "origlicenselink",
+		combo->origlicenselink);
   }
   if (combo->free != NULL) {
-    printf("  'free' => '%s',\n",
-	   combo->free);
+    outputField(out, 2, "free",
+		combo->free);
   }
   if (combo->patents != NULL) {
-    printf("  'patents' => '%s',\n",
-	   combo->patents);
+    outputField(out, 2, "patents",
+		combo->patents);
   }
   if (combo->num_supportcontacts != 0) {
-    printf("  'supportcontacts' => [\n");
+    outputOpen(out, 2, "supportcontacts", PERL_ARRAY);
     for (i = 0;
 	 i < combo->num_supportcontacts; i ++) {
       if (combo->supportcontacturls[i] != 
 	  NULL) {
-	printf("    {\n");
-	printf("      'description' => '%s',\n",
-	       combo->supportcontacts[i]);
+	outputOpen(out, 4, NULL, PERL_HASH);
+	outputField(out, 6, "description",
+		    combo->supportcontacts[i]);
 	if (combo->supportcontacturls[i]
 	    != NULL)
-	  printf("      'url' => '%s',\n",
-		 combo->supportcontacturls[i]);
-	printf("      'level' => '%s',\n",
-	       combo->supportcontactlevels[i]);
-	printf("    },\n");
+	  outputField(out, 6, "url",
+		      combo->supportcontacturls[i]);
+	outputField(out, 6, "level",
+		    combo->supportcontactlevels[i]);
+	outputClose(out, 4, PERL_HASH, 0);
       }
     }
-    printf("  ],\n");
+    outputClose(out, 2, PERL_ARRAY, 0);
   }
   if (combo->shortdescription != NULL) {
-    printf("  'shortdescription' => '%s',\n",
-	   combo->shortdescription);
+    outputField(out, 2, "shortdescription",
+		combo->shortdescription);
   }
   if (combo->locales != NULL) {
-    printf("  'locales' => '%s',\n",
-	   combo->locales);
+    outputField(out, 2, "locales",
+		combo->locales);
   }
   if (combo->num_packages != 0) {
-    printf("  'packages' => [\n");
+    outputOpen(out, 2, "packages", PERL_ARRAY);
     for (i = 0;
 	 i < combo->num_packages; i ++) {
       if (combo->packageurls[i] != 
 	  NULL) {
-	printf("    {\n");
-	printf("      'url' => '%s',\n",
-	       combo->packageurls[i]);
+	outputOpen(out, 4, NULL, PERL_HASH);
+	outputField(out, 6, "url",
+		    combo->packageurls[i]);
 	if (combo->packagescopes[i]
 	    != NULL)
-	  printf("      'scope' => '%s',\n",
-		 combo->packagescopes[i]);
+	  outputField(out, 6, "scope",
+		      combo->packagescopes[i]);
 	if (combo->packagefingerprints[i]
 	    != NULL)
-	  printf("      'fingerprint' => '%s',\n",
-		 combo->packagefingerprints[i]);
-	printf("    },\n");
+	  outputField(out, 6, "fingerprint",
+		      combo->packagefingerprints[i]);
+	outputClose(out, 4, PERL_HASH, 0);
       }
     }
-    printf("  ],\n");
+    outputClose(out, 2, PERL_ARRAY, 0);
   }
   if (combo->excmaxresx != NULL) {
-    printf("  'drvmaxresx' => '%s',\n",
-	   combo->excmaxresx);
+    outputField(out, 2, "drvmaxresx",
+		combo->excmaxresx);
   } else if (combo->drvmaxresx != NULL) {
-    printf("  'drvmaxresx' => '%s',\n",
-	   combo->drvmaxresx);
+    outputField(out, 2, "drvmaxresx",
+		combo->drvmaxresx);
   }
   if (combo->excmaxresy != NULL) {
-    printf("  'drvmaxresy' => '%s',\n",
-	   combo->excmaxresy);
+    outputField(out, 2, "drvmaxresy",
+		combo->excmaxresy);
   } else if (combo->drvmaxresy != NULL) {
-    printf("  'drvmaxresy' => '%s',\n",
-	   combo->drvmaxresy);
+    outputField(out, 2, "drvmaxresy",
+		combo->drvmaxresy);
   }
   if (combo->exccolor != NULL) {
-    printf("  'drvcolor' => '%s',\n",
-	   combo->exccolor);
+    outputField(out, 2, "drvcolor",
+		combo->exccolor);
   } else if (combo->drvcolor != NULL) {
-    printf("  'drvcolor' => '%s',\n",
-	   combo->drvcolor);
+    outputField(out, 2, "drvcolor",
+		combo->drvcolor);
   }
   if (combo->exctext != NULL) {
-    printf("  'text' => '%s',\n",
-	   combo->exctext);
+    outputField(out, 2, "text",
+		combo->exctext);
   } else if (combo->text != NULL) {
-    printf("  'text' => '%s',\n",
-	   combo->text);
+    outputField(out, 2, "text",
+		combo->text);
   }
   if (combo->exclineart != NULL) {
-    printf("  'lineart' => '%s',\n",
-	   combo->exclineart);
+    outputField(out, 2, "lineart",
+		combo->exclineart);
   } else if (combo->lineart != NULL) {
-    printf("  'lineart' => '%s',\n",
-	   combo->lineart);
+    outputField(out, 2, "lineart",
+		combo->lineart);
   }
   if (combo->excgraphics != NULL) {
-    printf("  'graphics' => '%s',\n",
-	   combo->excgraphics);
+    outputField(out, 2, "graphics",
+		combo->excgraphics);
   } else if (combo->graphics != NULL) {
-    printf("  'graphics' => '%s',\n",
-	   combo->graphics);
+    outputField(out, 2, "graphics",
+		combo->graphics);
   }
   if (combo->excphoto != NULL) {
-    printf("  'photo' => '%s',\n",
-	   combo->excphoto);
+    outputField(out, 2, "photo",
+		combo->excphoto);
   } else if (combo->photo != NULL) {
-    printf("  'photo' => '%s',\n",
-	   combo->photo);
+    outputField(out, 2, "photo",
+		combo->photo);
   }
   if (combo->excload != NULL) {
-    printf("  'load' => '%s',\n",
-	   combo->excload);
+    outputField(out, 2, "load",
+		combo->excload);
   } else if (combo->load != NULL) {
-    printf("  'load' => '%s',\n",
-	   combo->load);
+    outputField(out, 2, "load",
+		combo->load);
   }
   if (combo->excspeed != NULL) {
-    printf("  'speed' => '%s',\n",
-	   combo->excspeed);
+    outputField(out, 2, "speed",
+		combo->excspeed);
   } else if (combo->speed != NULL) {
-    printf("  'speed' => '%s',\n",
-	   combo->speed);
+    outputField(out, 2, "speed",
+		combo->speed);
   }
   if (combo->num_requires != 0) {
-    printf("  'requires' => [\n");
+    outputOpen(out, 2, "requires", PERL_ARRAY);
     for (i = 0;
 	 i < combo->num_requires; i ++) {
       if (combo->requires[i] != 
 	  NULL) {
-	printf("    {\n");
-	printf("      'driver' => '%s',\n",
-	       combo->requires[i]);
+	outputOpen(out, 4, NULL, PERL_HASH);
+	outputField(out, 6, "driver",
+		    combo->requires[i]);
 	if (combo->requiresversion[i]
 	    != NULL)
-	  printf("      'version' => '%s',\n",
-		 combo->requiresversion[i]);
-	printf("    },\n");
+	  outputField(out, 6, "version",
+		      combo->requiresversion[i]);
+	outputClose(out, 4, PERL_HASH, 0);
       }
     }
-    printf("  ],\n");
+    outputClose(out, 2, PERL_ARRAY, 0);
   }
   if (combo->cmd) {
-    printf("  'cmd' => '%s',\n", combo->cmd);
+    outputField(out, 2, "cmd", combo->cmd);
   } else {
-    printf("  'cmd' => undef,\n");
+    outputUndef(out, 2, "cmd");
   }
   if (combo->cmd_pdf) {
-    printf("  'cmd_pdf' => '%s',\n", combo->cmd_pdf);
+    outputField(out, 2, "cmd_pdf", combo->cmd_pdf);
   } else {
-    printf("  'cmd_pdf' => undef,\n");
+    outputUndef(out, 2, "cmd_pdf");
   }
   if (combo->nopjl) {
-    printf("  'drivernopjl' => %s,\n", combo->nopjl);
+    outputBare(out, 2, "drivernopjl", combo->nopjl);
   } else {
-    printf("  'drivernopjl' => 0,\n");
+    outputBare(out, 2, "drivernopjl", (const xmlChar *) "0");
   }
   if (combo->nopageaccounting) {
-    printf("  'drivernopageaccounting' => %s,\n", combo->nopageaccounting);
+    outputBare(out, 2, "drivernopageaccounting", combo->nopageaccounting);
   } else {
-    printf("  'drivernopageaccounting' => 0,\n");
+    outputBare(out, 2, "drivernopageaccounting", (const xmlChar *) "0");
   }
   if (combo->driverppdentry) {
-    printf("  'driverppdentry' => '%s',\n", combo->driverppdentry);
+    outputField(out, 2, "driverppdentry", combo->driverppdentry);
   } else {
-    printf("  'driverppdentry' => undef,\n");
+    outputUndef(out, 2, "driverppdentry");
   }
   if (combo->comboppdentry) {
-    printf("  'comboppdentry' => '%s',\n", combo->comboppdentry);
+    outputField(out, 2, "comboppdentry", combo->comboppdentry);
   } else {
-    printf("  'comboppdentry' => undef,\n");
+    outputUndef(out, 2, "comboppdentry");
   }
   if (combo->drivermargins) {
-    printf("  'drivermargins' => {\n");
-    generateMarginsPerlData(combo->drivermargins, debug);
-    printf("  },\n");
+    outputOpen(out, 2, "drivermargins", PERL_HASH);
+    generateMarginsPerlData(combo->drivermargins, out, debug);
+    outputClose(out, 2, PERL_HASH, 0);
   }
   if (combo->combomargins) {
-    printf("  'combomargins' => {\n");
-    generateMarginsPerlData(combo->combomargins, debug);
-    printf("  },\n");
+    outputOpen(out, 2, "combomargins", PERL_HASH);
+    generateMarginsPerlData(combo->combomargins, out, debug);
+    outputClose(out, 2, PERL_HASH, 0);
   }
   if (combo->maxspot > 0) {
-    printf("  'maxspot' => '%s',\n", combo->maxspot);
+    outputField(out, 2, "maxspot", combo->maxspot);
   } else {
-    printf("  'maxspot' => 'A',\n");
+    outputField(out, 2, "maxspot", (const xmlChar *) "A");
   }
-  printf("  'args_byname' => {\n");
+  outputOpen(out, 2, "args_byname", PERL_HASH);
   for (i = 0; i < combo->num_args; i ++) {
-    printf("    '%s' => {},\n", combo->args[i]->name);
+    outputEmpty(out, 4, perlKey(combo->args[i]->name), PERL_HASH, 0);
   }
-  printf("  },\n");
-  printf("  'args' => [\n");
+  outputClose(out, 2, PERL_HASH, 0);
+  outputOpen(out, 2, "args", PERL_ARRAY);
   for (i = 0; i < combo->num_args; i ++) {
-    printf("    {\n");
-    printf("      'name' => '%s',\n", combo->args[i]->name);
+    outputOpen(out, 4, NULL, PERL_HASH);
+    outputField(out, 6, "name", combo->args[i]->name);
     if (combo->args[i]->name_false) {
-      printf("      'name_false' => '%s',\n", combo->args[i]->name_false);
+      outputField(out, 6, "name_false", combo->args[i]->name_false);
     }
-    printf("      'comment' => '%s',\n", combo->args[i]->comment);
-    printf("      'idx' => '%s',\n", combo->args[i]->idx);
-    printf("      'type' => '%s',\n", combo->args[i]->option_type);
-    printf("      'style' => '%s',\n", combo->args[i]->style);
+    outputField(out, 6, "comment", combo->args[i]->comment);
+    outputField(out, 6, "idx", combo->args[i]->idx);
+    outputField(out, 6, "type", combo->args[i]->option_type);
+    outputField(out, 6, "style", combo->args[i]->style);
     if (combo->args[i]->substyle) {
-      printf("      'substyle' => '%s',\n", combo->args[i]->substyle);
+      outputField(out, 6, "substyle", combo->args[i]->substyle);
     }
-    printf("      'spot' => '%s',\n", combo->args[i]->spot);
-    printf("      'order' => '%s',\n", combo->args[i]->order);
+    outputField(out, 6, "spot", combo->args[i]->spot);
+    outputField(out, 6, "order", combo->args[i]->order);
     if (combo->args[i]->section) {
-      printf("      'section' => '%s',\n", combo->args[i]->section);
+      outputField(out, 6, "section", combo->args[i]->section);
     }
     if (combo->args[i]->grouppath) {
-      printf("      'group' => '%s',\n", combo->args[i]->grouppath);
+      outputField(out, 6, "group", combo->args[i]->grouppath);
     }
     if (combo->args[i]->proto) {
-      printf("      'proto' => '%s',\n", combo->args[i]->proto);
+      outputField(out, 6, "proto", combo->args[i]->proto);
     }
     if (combo->args[i]->required) {
-      printf("      'required' => 1,\n");
+      outputBare(out, 6, "required", (const xmlChar *) "1");
     }
     if (combo->args[i]->min_value) {
-      printf("      'min' => '%s',\n", combo->args[i]->min_value);
+      outputField(out, 6, "min", combo->args[i]->min_value);
     }
     if (combo->args[i]->max_value) {
-      printf("      'max' => '%s',\n", combo->args[i]->max_value);
+      outputField(out, 6, "max", combo->args[i]->max_value);
     }
     if (combo->args[i]->max_length) {
-      printf("      'maxlength' => '%s',\n", combo->args[i]->max_length);
+      outputField(out, 6, "maxlength", combo->args[i]->max_length);
     }
     if (combo->args[i]->allowed_chars) {
-      printf("      'allowedchars' => '%s',\n", combo->args[i]->allowed_chars);
+      outputField(out, 6, "allowedchars", combo->args[i]->allowed_chars);
     }
     if (combo->args[i]->allowed_regexp) {
-      printf("      'allowedregexp' => '%s',\n",
-	     combo->args[i]->allowed_regexp);
+      outputField(out, 6, "allowedregexp",
+		  combo->args[i]->allowed_regexp);
     }
     if (combo->args[i]->default_value) {
-      printf("      'default' => '%s',\n", combo->args[i]->default_value);
+      outputField(out, 6, "default", combo->args[i]->default_value);
     } else {
-      printf("      'default' => 'None',\n");
+      outputField(out, 6, "default", (const xmlChar *) "None");
     }
     if (combo->args[i]->num_choices > 0) {
-      printf("      'vals_byname' => {\n");
+      outputOpen(out, 6, "vals_byname", PERL_HASH);
       for (j = 0; j < combo->args[i]->num_choices; j ++) {
 	if (combo->args[i]->choices[j]->value == NULL) {
 		static xmlChar sc_None [] = "None";
 	  combo->args[i]->choices[j]->value = sc_None;
 	}
-	printf("        '%s' => {\n", combo->args[i]->choices[j]->value);
-	printf("          'value' => '%s',\n", 
-	       combo->args[i]->choices[j]->value);
+	outputOpen(out, 8, perlKey(combo->args[i]->choices[j]->value),
+		   PERL_HASH);
+	outputField(out, 10, "value", 
+		    combo->args[i]->choices[j]->value);
 	if (combo->args[i]->choices[j]->comment) {
-	  printf("          'comment' => '%s',\n",
-		 combo->args[i]->choices[j]->comment);
+	  outputField(out, 10, "comment",
+		      combo->args[i]->choices[j]->comment);
 	}
-	printf("          'idx' => '%s',\n",
-	       combo->args[i]->choices[j]->idx);
+	outputField(out, 10, "idx",
+		    combo->args[i]->choices[j]->idx);
 	if (combo->args[i]->choices[j]->driverval) {
-	  printf("          'driverval' => '%s'\n",
-		 combo->args[i]->choices[j]->driverval);
+	  outputString(out, 10, "driverval",
+		       combo->args[i]->choices[j]->driverval, 1);
 	} else {
-	  printf("          'driverval' => ''\n");
+	  outputString(out, 10, "driverval", (const xmlChar *) "", 1);
 	}
-	printf("        },\n");
+	outputClose(out, 8, PERL_HASH, 0);
       }
-      printf("      },\n");
-      printf("      'vals' => [\n");
+      outputClose(out, 6, PERL_HASH, 0);
+      outputOpen(out, 6, "vals", PERL_ARRAY);
       for (j = 0; j < combo->args[i]->num_choices; j ++) {
-	printf("        {},\n");
+	outputEmpty(out, 8, NULL, PERL_HASH, 0);
       }
-      printf("      ]\n");
+      outputClose(out, 6, PERL_ARRAY, 1);
     }
-    printf("    },\n");
+    outputClose(out, 4, PERL_HASH, 0);
   }
-  printf("  ]\n");
-  printf("};\n");
+  outputClose(out, 2, PERL_ARRAY, 1);
+  outputEnd(out);
   for (i = 0; i < combo->num_args; i ++) {
     for (j = 0; j < combo->args[i]->num_choices; j ++) {
-      printf("$VAR1->{'args'}[%d]{'vals'}[%d] = $VAR1->{'args'}[%d]{'vals_byname'}{'%s'};\n",
-	     i, j, i, combo->args[i]->choices[j]->value);
+      outputChoiceLink(out, i, j, combo->args[i]->choices[j]->value);
     }
   }
   for (i = 0; i < combo->num_args; i ++) {
-    printf("$VAR1->{'args_byname'}{'%s'} = $VAR1->{'args'}[%d];\n",
-	   combo->args[i]->name, i);
+    outputArgLink(out, i, combo->args[i]->name);
   }
 
 }
@@ -4641,178 +6214,179 @@ void
 generatePrinterPerlData(printerEntryPtr printer, /* I/O - Foomatic printer 
 						    data parsed from XML 
 						    input */
+			outputPtr out, /* I/O - Buffer for the Perl data */
 			int debug) { /* Debug flag */
 
   int i; /* loop variable */
   int haspsdriver = 0; /* Is the "Postscript" driver in the printer's
 			  driver list? */
 
-  printf("$VAR1 = {\n");
-  printf("  'id' => '%s',\n", printer->id);
-  printf("  'make' => '%s',\n", printer->make);
-  printf("  'model' => '%s',\n", printer->model);
+  outputStart(out);
+  outputField(out, 2, "id", printer->id);
+  outputField(out, 2, "make", printer->make);
+  outputField(out, 2, "model", printer->model);
   if (printer->printer_type) {
-    printf("  'type' => '%s',\n", printer->printer_type);
+    outputField(out, 2, "type", printer->printer_type);
   }
   if (printer->color) {
-    printf("  'color' => '%s',\n", printer->color);
+    outputField(out, 2, "color", printer->color);
   }
   if (printer->maxxres) {
-    printf("  'maxxres' => '%s',\n", printer->maxxres);
+    outputField(out, 2, "maxxres", printer->maxxres);
   }
   if (printer->maxyres) {
-    printf("  'maxyres' => '%s',\n", printer->maxyres);
+    outputField(out, 2, "maxyres", printer->maxyres);
   }
   if (printer->printerppdentry) {
-    printf("  'ppdentry' => '%s',\n", printer->printerppdentry);
+    outputField(out, 2, "ppdentry", printer->printerppdentry);
   } else {
-    printf("  'ppdentry' => undef,\n");
+    outputUndef(out, 2, "ppdentry");
   }
   if (printer->printermargins) {
-    printf("  'margins' => {\n");
-    generateMarginsPerlData(printer->printermargins, debug);
-    printf("  },\n");
+    outputOpen(out, 2, "margins", PERL_HASH);
+    generateMarginsPerlData(printer->printermargins, out, debug);
+    outputClose(out, 2, PERL_HASH, 0);
   }
   if (printer->refill) {
-    printf("  'refill' => '%s',\n", printer->refill);
+    outputField(out, 2, "refill", printer->refill);
   }
   if (printer->ascii) {
-    printf("  'ascii' => '%s',\n", printer->ascii);
+    outputField(out, 2, "ascii", printer->ascii);
   }
   if (printer->pjl) {
-    printf("  'pjl' => '%s',\n", printer->pjl);
+    outputField(out, 2, "pjl", printer->pjl);
   }
   if (printer->num_languages > 0) {
-    printf("  'languages' => [\n");
+    outputOpen(out, 2, "languages", PERL_ARRAY);
     for (i = 0; i < printer->num_languages; i ++) {
-      printf("                   {\n");
-      printf("                     'name' => '%s',\n",
-	     printer->languages[i]->name);
-      printf("                     'level' => '%s',\n",
-	     printer->languages[i]->level);
-      printf("                   },\n");
+      outputOpen(out, 19, NULL, PERL_HASH);
+      outputField(out, 21, "name",
+		  printer->languages[i]->name);
+      outputField(out, 21, "level",
+		  printer->languages[i]->level);
+      outputClose(out, 19, PERL_HASH, 0);
     }
-    printf("                 ],\n");
+    outputClose(out, 17, PERL_ARRAY, 0);
   }
   if (printer->ppdurl) {
-    printf("  'ppdurl' => '%s',\n", printer->ppdurl);
+    outputField(out, 2, "ppdurl", printer->ppdurl);
   }
   if (printer->general_ieee) {
-    printf("  'general_ieee' => '%s',\n", printer->general_ieee);
+    outputField(out, 2, "general_ieee", printer->general_ieee);
   }
   if (printer->general_mfg) {
-    printf("  'general_mfg' => '%s',\n", printer->general_mfg);
+    outputField(out, 2, "general_mfg", printer->general_mfg);
   }
   if (printer->general_mdl) {
-    printf("  'general_mdl' => '%s',\n", printer->general_mdl);
+    outputField(out, 2, "general_mdl", printer->general_mdl);
   }
   if (printer->general_des) {
-    printf("  'general_des' => '%s',\n", printer->general_des);
+    outputField(out, 2, "general_des", printer->general_des);
   }
   if (printer->general_cmd) {
-    printf("  'general_cmd' => '%s',\n", printer->general_cmd);
+    outputField(out, 2, "general_cmd", printer->general_cmd);
   }
   if (printer->par_ieee) {
-    printf("  'par_ieee' => '%s',\n", printer->par_ieee);
+    outputField(out, 2, "par_ieee", printer->par_ieee);
   }
   if (printer->par_mfg) {
-    printf("  'par_mfg' => '%s',\n", printer->par_mfg);
+    outputField(out, 2, "par_mfg", printer->par_mfg);
   }
   if (printer->par_mdl) {
-    printf("  'par_mdl' => '%s',\n", printer->par_mdl);
+    outputField(out, 2, "par_mdl", printer->par_mdl);
   }
   if (printer->par_des) {
-    printf("  'par_des' => '%s',\n", printer->par_des);
+    outputField(out, 2, "par_des", printer->par_des);
   }
   if (printer->par_cmd) {
-    printf("  'par_cmd' => '%s',\n", printer->par_cmd);
+    outputField(out, 2, "par_cmd", printer->par_cmd);
   }
   if (printer->usb_ieee) {
-    printf("  'usb_ieee' => '%s',\n", printer->usb_ieee);
+    outputField(out, 2, "usb_ieee", printer->usb_ieee);
   }
   if (printer->usb_mfg) {
-    printf("  'usb_mfg' => '%s',\n", printer->usb_mfg);
+    outputField(out, 2, "usb_mfg", printer->usb_mfg);
   }
   if (printer->usb_mdl) {
-    printf("  'usb_mdl' => '%s',\n", printer->usb_mdl);
+    outputField(out, 2, "usb_mdl", printer->usb_mdl);
   }
   if (printer->usb_des) {
-    printf("  'usb_des' => '%s',\n", printer->usb_des);
+    outputField(out, 2, "usb_des", printer->usb_des);
   }
   if (printer->usb_cmd) {
-    printf("  'usb_cmd' => '%s',\n", printer->usb_cmd);
+    outputField(out, 2, "usb_cmd", printer->usb_cmd);
   }
   if (printer->snmp_ieee) {
-    printf("  'snmp_ieee' => '%s',\n", printer->snmp_ieee);
+    outputField(out, 2, "snmp_ieee", printer->snmp_ieee);
   }
   if (printer->snmp_mfg) {
-    printf("  'snmp_mfg' => '%s',\n", printer->snmp_mfg);
+    outputField(out, 2, "snmp_mfg", printer->snmp_mfg);
   }
   if (printer->snmp_mdl) {
-    printf("  'snmp_mdl' => '%s',\n", printer->snmp_mdl);
+    outputField(out, 2, "snmp_mdl", printer->snmp_mdl);
   }
   if (printer->snmp_des) {
-    printf("  'snmp_des' => '%s',\n", printer->snmp_des);
+    outputField(out, 2, "snmp_des", printer->snmp_des);
   }
   if (printer->snmp_cmd) {
-    printf("  'snmp_cmd' => '%s',\n", printer->snmp_cmd);
+    outputField(out, 2, "snmp_cmd", printer->snmp_cmd);
   }
   if (printer->functionality) {
-    printf("  'functionality' => '%s',\n", printer->functionality);
+    outputField(out, 2, "functionality", printer->functionality);
   }
   if (printer->driver) {
-    printf("  'driver' => '%s',\n", printer->driver);
+    outputField(out, 2, "driver", printer->driver);
   }
   if ((printer->num_drivers > 0) || (printer->ppdurl)) {
-    printf("  'drivers' => [\n");
+    outputOpen(out, 2, "drivers", PERL_ARRAY);
     for (i = 0; i < printer->num_drivers; i ++) {
-      printf("                 {\n");
+      outputOpen(out, 17, NULL, PERL_HASH);
       if (printer->drivers[i]->name) { 
 	if (xmlStrncmp(printer->drivers[i]->name, sc_Postscript, 10))
 	  haspsdriver = 1;
-	printf("                   'name' => '%s',\n",
-	       printer->drivers[i]->name);
-	printf("                   'id' => '%s',\n",
-	       printer->drivers[i]->name);
+	outputField(out, 19, "name",
+		    printer->drivers[i]->name);
+	outputField(out, 19, "id",
+		    printer->drivers[i]->name);
       }
       if (printer->drivers[i]->ppd) {
-	printf("                   'ppd' => '%s',\n",
-	       printer->drivers[i]->ppd);
+	outputField(out, 19, "ppd",
+		    printer->drivers[i]->ppd);
       }
       if (printer->drivers[i]->comment) {
-	printf("                   'comment' => '%s',\n",
-	       printer->drivers[i]->comment);
+	outputField(out, 19, "comment",
+		    printer->drivers[i]->comment);
       }
-      printf("                 },\n");
+      outputClose(out, 17, PERL_HASH, 0);
     }
     if ((printer->ppdurl) && !haspsdriver) {
-      printf("                 {\n");
-      printf("                   'name' => '%s',\n",
-	     "Postscript");
-      printf("                   'id' => '%s',\n",
-	     "Postscript");
-      printf("                   'ppd' => '%s',\n",
-	     printer->ppdurl);
-      printf("                 },\n");
+      outputOpen(out, 17, NULL, PERL_HASH);
+      outputField(out, 19, "name",
+		  (const xmlChar *) "Postscript");
+      outputField(out, 19, "id",
+		  (const xmlChar *) "Postscript");
+      outputField(out, 19, "ppd",
+		  printer->ppdurl);
+      outputClose(out, 17, PERL_HASH, 0);
     }
-    printf("               ],\n");
+    outputClose(out, 15, PERL_ARRAY, 0);
   }
   if (printer->unverified) {
-    printf("  'unverified' => '%s',\n", printer->unverified);
+    outputField(out, 2, "unverified", printer->unverified);
   }
   if (printer->noxmlentry) {
-    printf("  'noxmlentry' => '%s',\n", printer->noxmlentry);
+    outputField(out, 2, "noxmlentry", printer->noxmlentry);
   }
   if (printer->url) {
-    printf("  'url' => '%s',\n", printer->url);
+    outputField(out, 2, "url", printer->url);
   }
   if (printer->contriburl) {
-    printf("  'contriburl' => '%s',\n", printer->contriburl);
+    outputField(out, 2, "contriburl", printer->contriburl);
   }
   if (printer->comment) {
-    printf("  'comment' => '%s',\n", printer->comment);
+    outputField(out, 2, "comment", printer->comment);
   }
-  printf("};\n");
+  outputEnd(out);
 
 }
 
@@ -4820,6 +6394,7 @@ void
 generateDriverPerlData(driverEntryPtr driver, /* I/O - Foomatic driver
 						 data parsed from XML 
 						 input */
+		       outputPtr out, /* I/O - Buffer for the Perl data */
 		       int debug) { /* Debug flag */
 
   int i; /* loop variable */
@@ -4832,232 +6407,232 @@ generateDriverPerlData(driverEntryPtr driver, /* I/O - Foomatic driver
   xmlChar *comment;
   int     num_printers;
   xmlChar **printers;
-  printf("$VAR1 = {\n");
-  printf("  'name' => '%s',\n", driver->name);
+  outputStart(out);
+  outputField(out, 2, "name", driver->name);
   if (driver->group) {
-    printf("  'group' => '%s',\n", driver->group);
+    outputField(out, 2, "group", driver->group);
   }
   if (driver->url) {
-    printf("  'url' => '%s',\n", driver->url);
+    outputField(out, 2, "url", driver->url);
   }
   if (driver->driver_obsolete) {
-    printf("  'obsolete' => '%s',\n", driver->driver_obsolete);
+    outputField(out, 2, "obsolete", driver->driver_obsolete);
   }
   if (driver->supplier != NULL) {
-    printf("  'supplier' => '%s',\n",
-	   driver->supplier);
+    outputField(out, 2, "supplier",
+		driver->supplier);
   }
   if (driver->manufacturersupplied != NULL) {
-    printf("  'manufacturersupplied' => '%s',\n",
-	   driver->manufacturersupplied);
+    outputField(out, 2, "manufacturersupplied",
+		driver->manufacturersupplied);
   }
   if (driver->license != NULL) {
-    printf("  'license' => '%s',\n",
-	   driver->license);
+    outputField(out, 2, "license",
+		driver->license);
   }
   if (driver->licensetext != NULL) {
-    printf("  'licensetext' => '%s',\n",
-	   driver->licensetext);
+    outputField(out, 2, "licensetext",
+		driver->licensetext);
   }
   if (driver->origlicensetext != NULL) {
-    printf("  'origlicensetext' => '%s',\n",
-	   driver->origlicensetext);
+    outputField(out, 2, "origlicensetext",
+		driver->origlicensetext);
   }
   if (driver->licenselink != NULL) {
-    printf("  'licenselink' => '%s',\n",
-	   driver->licenselink);
+    outputField(out, 2, "licenselink",
+		driver->licenselink);
   }
   if (driver->origlicenselink != NULL) {
-    printf("  'origlicenselink' => '%s',\n",
-	   driver->origlicenselink);
+    outputField(out, 2, "origlicenselink",
+		driver->origlicenselink);
   }
   if (driver->free != NULL) {
-    printf("  'free' => '%s',\n",
-	   driver->free);
+    outputField(out, 2, "free",
+		driver->free);
   }
   if (driver->patents != NULL) {
-    printf("  'patents' => '%s',\n",
-	   driver->patents);
+    outputField(out, 2, "patents",
+		driver->patents);
   }
   if (driver->num_supportcontacts != 0) {
-    printf("  'supportcontacts' => [\n");
+    outputOpen(out, 2, "supportcontacts", PERL_ARRAY);
     for (i = 0;
 	 i < driver->num_supportcontacts; i ++) {
       if (driver->supportcontacturls[i] != 
 	  NULL) {
-	printf("    {\n");
-	printf("      'description' => '%s',\n",
-	       driver->supportcontacts[i]);
+	outputOpen(out, 4, NULL, PERL_HASH);
+	outputField(out, 6, "description",
+		    driver->supportcontacts[i]);
 	if (driver->supportcontacturls[i]
 	    != NULL)
-	  printf("      'url' => '%s',\n",
-		 driver->supportcontacturls[i]);
-	printf("      'level' => '%s',\n",
-	       driver->supportcontactlevels[i]);
-	printf("    },\n");
+	  outputField(out, 6, "url",
+		      driver->supportcontacturls[i]);
+	outputField(out, 6, "level",
+		    driver->supportcontactlevels[i]);
+	outputClose(out, 4, PERL_HASH, 0);
       }
     }
-    printf("  ],\n");
+    outputClose(out, 2, PERL_ARRAY, 0);
   }
   if (driver->shortdescription != NULL) {
-    printf("  'shortdescription' => '%s',\n",
-	   driver->shortdescription);
+    outputField(out, 2, "shortdescription",
+		driver->shortdescription);
   }
   if (driver->locales != NULL) {
-    printf("  'locales' => '%s',\n",
-	   driver->locales);
+    outputField(out, 2, "locales",
+		driver->locales);
   }
   if (driver->num_packages != 0) {
-    printf("  'packages' => [\n");
+    outputOpen(out, 2, "packages", PERL_ARRAY);
     for (i = 0;
 	 i < driver->num_packages; i ++) {
       if (driver->packageurls[i] != 
 	  NULL) {
-	printf("    {\n");
-	printf("      'url' => '%s',\n",
-	       driver->packageurls[i]);
+	outputOpen(out, 4, NULL, PERL_HASH);
+	outputField(out, 6, "url",
+		    driver->packageurls[i]);
 	if (driver->packagescopes[i]
 	    != NULL)
-	  printf("      'scope' => '%s',\n",
-		 driver->packagescopes[i]);
+	  outputField(out, 6, "scope",
+		      driver->packagescopes[i]);
 	if (driver->packagefingerprints[i]
 	    != NULL)
-	  printf("      'fingerprint' => '%s',\n",
-		 driver->packagefingerprints[i]);
-	printf("    },\n");
+	  outputField(out, 6, "fingerprint",
+		      driver->packagefingerprints[i]);
+	outputClose(out, 4, PERL_HASH, 0);
       }
     }
-    printf("  ],\n");
+    outputClose(out, 2, PERL_ARRAY, 0);
   }
   if (driver->maxresx != NULL) {
-    printf("  'drvmaxresx' => '%s',\n",
-	   driver->maxresx);
+    outputField(out, 2, "drvmaxresx",
+		driver->maxresx);
   }
   if (driver->maxresy != NULL) {
-    printf("  'drvmaxresy' => '%s',\n",
-	   driver->maxresy);
+    outputField(out, 2, "drvmaxresy",
+		driver->maxresy);
   }
   if (driver->color != NULL) {
-    printf("  'drvcolor' => '%s',\n",
-	   driver->color);
+    outputField(out, 2, "drvcolor",
+		driver->color);
   }
   if (driver->text != NULL) {
-    printf("  'text' => '%s',\n",
-	   driver->text);
+    outputField(out, 2, "text",
+		driver->text);
   }
   if (driver->lineart != NULL) {
-    printf("  'lineart' => '%s',\n",
-	   driver->lineart);
+    outputField(out, 2, "lineart",
+		driver->lineart);
   }
   if (driver->graphics != NULL) {
-    printf("  'graphics' => '%s',\n",
-	   driver->graphics);
+    outputField(out, 2, "graphics",
+		driver->graphics);
   }
   if (driver->photo != NULL) {
-    printf("  'photo' => '%s',\n",
-	   driver->photo);
+    outputField(out, 2, "photo",
+		driver->photo);
   }
   if (driver->load != NULL) {
-    printf("  'load' => '%s',\n",
-	   driver->load);
+    outputField(out, 2, "load",
+		driver->load);
   }
   if (driver->speed != NULL) {
-    printf("  'speed' => '%s',\n",
-	   driver->speed);
+    outputField(out, 2, "speed",
+		driver->speed);
   }
   if (driver->num_requires != 0) {
-    printf("  'requires' => [\n");
+    outputOpen(out, 2, "requires", PERL_ARRAY);
     for (i = 0;
 	 i < driver->num_requires; i ++) {
       if (driver->requires[i] != 
 	  NULL) {
-	printf("    {\n");
-	printf("      'driver' => '%s',\n",
-	       driver->requires[i]);
+	outputOpen(out, 4, NULL, PERL_HASH);
+	outputField(out, 6, "driver",
+		    driver->requires[i]);
 	if (driver->requiresversion[i]
 	    != NULL)
-	  printf("      'version' => '%s',\n",
-		 driver->requiresversion[i]);
-	printf("    },\n");
+	  outputField(out, 6, "version",
+		      driver->requiresversion[i]);
+	outputClose(out, 4, PERL_HASH, 0);
       }
     }
-    printf("  ],\n");
+    outputClose(out, 2, PERL_ARRAY, 0);
   }
   if (driver->driver_type) {
-    printf("  'type' => '%s',\n", driver->driver_type);
+    outputField(out, 2, "type", driver->driver_type);
   }
   if (driver->cmd) {
-    printf("  'cmd' => '%s',\n", driver->cmd);
+    outputField(out, 2, "cmd", driver->cmd);
   }
   if (driver->cmd_pdf) {
-    printf("  'cmd_cmd' => '%s',\n", driver->cmd_pdf);
+    outputField(out, 2, "cmd_cmd", driver->cmd_pdf);
   }
   if (driver->driverppdentry) {
-    printf("  'ppdentry' => '%s',\n", driver->driverppdentry);
+    outputField(out, 2, "ppdentry", driver->driverppdentry);
   } else {
-    printf("  'ppdentry' => undef,\n");
+    outputUndef(out, 2, "ppdentry");
   }
   if (driver->drivermargins) {
-    printf("  'margins' => {\n");
-    generateMarginsPerlData(driver->drivermargins, debug);
-    printf("  },\n");
+    outputOpen(out, 2, "margins", PERL_HASH);
+    generateMarginsPerlData(driver->drivermargins, out, debug);
+    outputClose(out, 2, PERL_HASH, 0);
   }
   if (driver->comment) {
-    printf("  'comment' => '%s',\n", driver->comment);
+    outputField(out, 2, "comment", driver->comment);
   }
   if (driver->num_printers > 0) {
-    printf("  'printers' => [\n");
+    outputOpen(out, 2, "printers", PERL_ARRAY);
     for (i = 0; i < driver->num_printers; i ++) {
-      printf("    {\n");
-      printf("      'id' => '%s',\n",
-	     driver->printers[i]->id);
+      outputOpen(out, 4, NULL, PERL_HASH);
+      outputField(out, 6, "id",
+		  driver->printers[i]->id);
       if (driver->printers[i]->comment) {
-	printf("      'comment' => '%s'\n",
-	       driver->printers[i]->comment);
+	outputField(out, 6, "comment",
+		    driver->printers[i]->comment);
       }
       if (driver->printers[i]->excmaxresx != NULL) {
-	printf("      'excmaxresx' => '%s',\n",
-	       driver->printers[i]->excmaxresx);
+	outputField(out, 6, "excmaxresx",
+		    driver->printers[i]->excmaxresx);
       }
       if (driver->printers[i]->excmaxresy != NULL) {
-	printf("      'excmaxresy' => '%s',\n",
-	       driver->printers[i]->excmaxresy);
+	outputField(out, 6, "excmaxresy",
+		    driver->printers[i]->excmaxresy);
       }
       if (driver->printers[i]->exccolor != NULL) {
-	printf("      'exccolor' => '%s',\n",
-	       driver->printers[i]->exccolor);
+	outputField(out, 6, "exccolor",
+		    driver->printers[i]->exccolor);
       }
       if (driver->printers[i]->exctext != NULL) {
-	printf("      'exctext' => '%s',\n",
-	       driver->printers[i]->exctext);
+	outputField(out, 6, "exctext",
+		    driver->printers[i]->exctext);
       }
       if (driver->printers[i]->exclineart != NULL) {
-	printf("      'exclineart' => '%s',\n",
-	       driver->printers[i]->exclineart);
+	outputField(out, 6, "exclineart",
+		    driver->printers[i]->exclineart);
       }
       if (driver->printers[i]->excgraphics != NULL) {
-	printf("      'excgraphics' => '%s',\n",
-	       driver->printers[i]->excgraphics);
+	outputField(out, 6, "excgraphics",
+		    driver->printers[i]->excgraphics);
       }
       if (driver->printers[i]->excphoto != NULL) {
-	printf("      'excphoto' => '%s',\n",
-	       driver->printers[i]->excphoto);
+	outputField(out, 6, "excphoto",
+		    driver->printers[i]->excphoto);
       }
       if (driver->printers[i]->excload != NULL) {
-	printf("      'excload' => '%s',\n",
-	       driver->printers[i]->excload);
+	outputField(out, 6, "excload",
+		    driver->printers[i]->excload);
       }
       if (driver->printers[i]->excspeed != NULL) {
-	printf("      'excspeed' => '%s',\n",
-	       driver->printers[i]->excspeed);
+	outputField(out, 6, "excspeed",
+		    driver->printers[i]->excspeed);
       }
-      printf("    },\n");
+      outputClose(out, 4, PERL_HASH, 0);
     }
-    printf("  ]\n");
+    outputClose(out, 2, PERL_ARRAY, 1);
   } else {
-    printf("  'printers' => []\n");
+    outputEmpty(out, 2, "printers", PERL_ARRAY, 1);
   }
-  printf("};\n");
+  outputEnd(out);
 
 }
 
@@ -5070,12 +6645,30 @@ main(int argc, char **argv) { /* I - Command line arguments */
   xmlChar       **defaultsettings = NULL; /* User-supplied option settings*/
   int           num_defaultsettings = 0;
   char          *filename = NULL;
+  const char    *pid = NULL;     /* Printer/driver combo to compute from */
+  const char    *drivername = NULL; /* the database, instead of reading */
+  const char    *libdir = NULL;  /* combo XML data */
+  const char    *batchfilename = NULL; /* List of combos to compute */
+  FILE          *batchfile;
+  char          line[1024], *t;
   int           datatype = 1;  /* Data type to parse: 0: Overview, 1: Combo 
 				  2: Printer, 3: Driver */
   comboDataPtr  combo;  /* C data structure of printer/driver combo */
-  overviewPtr   overview;  /* C data structure of printer/driver combo */
+  combodb_t     *cdb;   /* Database to compute the combo from */
+  const combopiece_t *pieces; /* Combo XML data of the database */
+  int           num_pieces;
+  int           result;
+  int           status = 0; /* Exit status, 1: a combo of the list failed */
   printerEntryPtr printer;  /* C data structure of printer entry */
   driverEntryPtr driver;  /* C data structure of driver entry*/
+  arena         data; /* Memory for the parsed data */
+  output        out;  /* Buffer for the generated data, on stdout */
+  output        perl; /* Generators' output into the converter */
+  outputPtr     perlout = &out; /* Where the Perl data goes */
+  converter     st;   /* Converter into Storable data or JSON */
+  int           convert = 0; /* Convert the Perl data? */
+  convertFormat format = CONVERT_STORABLE; /* ... into what */
+  statsclock_t  phasestart; /* Start of the current phase ("--stats") */
 
   /* COMPAT: Do not genrate nodes for formatting spaces */
   LIBXML_TEST_VERSION
@@ -5097,6 +6690,14 @@ main(int argc, char **argv) { /* I - Command line arguments */
       case 'D' : /* Parse driver */
 	datatype = 3;
 	break;
+      case 'S' : /* Storable output */
+	convert = 1;
+	format = CONVERT_STORABLE;
+	break;
+      case 'J' : /* JSON output */
+	convert = 1;
+	format = CONVERT_JSON;
+	break;
       case 'o' : /* option setting */
 	if (argv[i][2] != '\0')
 	  setting = (xmlChar *)(argv[i] + 2);
@@ -5110,6 +6711,41 @@ main(int argc, char **argv) { /* I - Command line arguments */
 			      sizeof(xmlChar *) * num_defaultsettings);
 	defaultsettings[num_defaultsettings-1] = xmlStrdup (setting);
 	break;
+      case 'p' : /* printer of the combo to compute */
+	if (argv[i][2] != '\0')
+	  pid = argv[i] + 2;
+	else {
+	  i ++;
+	  pid = argv[i];
+	}
+	datatype = 1;
+	break;
+      case 'd' : /* driver of the combo to compute */
+	if (argv[i][2] != '\0')
+	  drivername = argv[i] + 2;
+	else {
+	  i ++;
+	  drivername = argv[i];
+	}
+	datatype = 1;
+	break;
+      case 'b' : /* list of combos to compute */
+	if (argv[i][2] != '\0')
+	  batchfilename = argv[i] + 2;
+	else {
+	  i ++;
+	  batchfilename = argv[i];
+	}
+	datatype = 1;
+	break;
+      case 'L' : /* database location */
+	if (argv[i][2] != '\0')
+	  libdir = argv[i] + 2;
+	else {
+	  i ++;
+	  libdir = argv[i];
+	}
+	break;
       case 'l' : /* language */
 	if (argv[i][2] != '\0')
 	  language = (xmlChar *)(argv[i] + 2);
@@ -5128,24 +6764,49 @@ main(int argc, char **argv) { /* I - Command line arguments */
 	break;
       case '?' :
       case 'h' : /* Help */
-	fprintf(stderr, "Usage: foomatic-perl-data [ -O ] [ -C ] [ -P ] [ -D ]\n                          [ -o option=setting ] [ -o ... ] [ -l language ]\n                          [ -v ] [ -vv ] [ filename ]\n");
+	fprintf(stderr, "Usage: foomatic-perl-data [ -O ] [ -C ] [ -P ] [ -D ] [ -S | -J ]\n                          [ -o option=setting ] [ -o ... ] [ -l language ]\n                          [ --stats[=json] ] [ -v ] [ -vv ] [ filename ]\n       foomatic-perl-data -p printer -d driver [ -L libdir ] [ -S | -J ]\n                          [ -o option=setting ] [ -o ... ] [ -l language ]\n                          [ --stats[=json] ] [ -v ] [ -vv ]\n       foomatic-perl-data -b combofile [ -L libdir ] [ -S | -J ]\n                          [ -o option=setting ] [ -o ... ] [ -l language ]\n                          [ --stats[=json] ] [ -v ] [ -vv ]\n");
 	fprintf(stderr, "\n");
 	fprintf(stderr, "   -O           Parse overview XML data\n");
 	fprintf(stderr, "   -C           Parse printer/driver combo XML data (default)\n");
 	fprintf(stderr, "   -P           Parse printer entry XML data\n");
 	fprintf(stderr, "   -D           Parse driver entry XML data\n");
+	fprintf(stderr, "   -p printer   Compute the combo of the given printer and driver from\n");
+	fprintf(stderr, "   -d driver    the Foomatic database, instead of reading combo XML\n");
+	fprintf(stderr, "                data\n");
+	fprintf(stderr, "   -b combofile Compute the combos listed in the file (\"-\": standard\n");
+	fprintf(stderr, "                input), one \"printer,driver\" per line, each combo\n");
+	fprintf(stderr, "                preceded by a line \"COMBO printer,driver length\"\n");
+	fprintf(stderr, "   -L libdir    Directory where the Foomatic database is located\n");
+	fprintf(stderr, "                (with \"-p\" and \"-d\", or \"-b\")\n");
+	fprintf(stderr, "   -S           Put out the data in the network format of Perl's Storable\n");
+	fprintf(stderr, "                module (to be read with Storable::thaw()), not as Perl code\n");
+	fprintf(stderr, "   -J           Put out the data as JSON, with the same structure as the\n");
+	fprintf(stderr, "                Perl data\n");
 	fprintf(stderr, "   -o option=setting\n");
 	fprintf(stderr, "                Default option settings for the generated Perl data (combo\n");
 	fprintf(stderr, "                only, no range-checking)\n");
 	fprintf(stderr, "   -l language  Language in which the texts are returned, default is \"en\"\n");
 	fprintf(stderr, "                (English). If the text in the requested language is missing,\n");
 	fprintf(stderr, "                english text will be returned.\n");
+	fprintf(stderr, "   --stats      Put out the time of the phases of the run and\n");
+	fprintf(stderr, "                counters on standard error at the end, as\n");
+	fprintf(stderr, "                key=value pairs (\"--stats=json\": as JSON)\n");
 	fprintf(stderr, "   -v           Verbose (debug) mode\n");
 	fprintf(stderr, "   -vv          Very verbose (debug) mode\n");
 	fprintf(stderr, "   filename     Read input from a file and not from standard input\n");
 	fprintf(stderr, "\n");
 	exit(1);
        	break;
+      case '-' : /* long options */
+	if (strcmp(argv[i], "--stats") == 0)
+	  enablestats(0);
+	else if (strcmp(argv[i], "--stats=json") == 0)
+	  enablestats(1);
+	else {
+	  fprintf(stderr, "Unknown option \'%s\'!\n", argv[i]);
+	  exit(1);
+	}
+	break;
       default :
 	fprintf(stderr, "Unknown option \'-%c\'!\n", argv[i][1]);
 	exit(1);
@@ -5156,25 +6817,120 @@ main(int argc, char **argv) { /* I - Command line arguments */
   }
 
   if (debug) fprintf(stderr,"Language: %s\n", language);
+
+  arenaInit(&data);
+  /* In batch mode the data of every combo is collected, to be put out
+     after its length */
+  outputInit(&out, (batchfilename != NULL) ? NULL : fileSink, stdout);
+  if (convert) {
+    /* The generators build the values for the converter instead of
+       writing the Perl data */
+    converterInit(&st, format, &out);
+    outputInit(&perl, NULL, NULL);
+    perl.build = &st;
+    perlout = &perl;
+  }
+
+  /* The input file for "--stats", standard input is counted while it
+     is read */
+  if ((filename != NULL) &&
+      ((datatype != 1) || ((pid == NULL) && (drivername == NULL))))
+    countInputFile(filename);
   
   if (datatype == 0) { /* Parse overview data */
 
-    /* Parse the XML input */
-    overview = parseOverviewFile(filename, language, debug);
-
-    if (overview) {
-
-      /* Generate the Perl data structure on standard output */
-      generateOverviewPerlData(overview, debug);
-
-    } else {
+    /* Parse the XML input and generate the Perl data structure on
+       standard output, entry by entry */
+    if (streamOverviewFile(filename, language, perlout,
+			   convert ? &st : NULL, debug) != 0) {
+      outputFlush(&out);
+      exit(1);
+    }
+    startphase(&phasestart);
+
+  } else if ((datatype == 1) && (batchfilename != NULL)) {
+    /* Compute the listed combos */
+
+    /* The driver and option files are read once for all combos, and
+       every combo is put out as in the batch mode of foomatic-combo-xml,
+       with a length of 0 when it is not possible or failed */
+    if (strcmp(batchfilename, "-") == 0)
+      batchfile = stdin;
+    else
+      batchfile = fopen(batchfilename, "r");
+    if (batchfile == NULL) {
+      fprintf(stderr, "Cannot read combo list %s!\n", batchfilename);
       exit(1);
     }
+    cdb = opencombodb(libdir, 1, 1);
+    while (fgets(line, sizeof(line), batchfile) != NULL) {
+      line[strcspn(line, "\r\n")] = '\0';
+      if (line[0] == '\0') continue;
+      t = strchr(line, ',');
+      if ((t == NULL) || (t == line) || (t[1] == '\0')) {
+	fprintf(stderr, "Invalid combo \'%s\', must be \"printer,driver\"!\n",
+		line);
+	continue;
+      }
+      *t = '\0';
+      result = combopieces(cdb, line, t + 1, &pieces, &num_pieces,
+			   (debug > 1));
+      combo = ((result == 0) ?
+	       parseComboPieces(pieces, num_pieces, &data, language, debug) :
+	       NULL);
+      startphase(&phasestart);
+      if (combo) {
+	prepareComboData(combo, defaultsettings, num_defaultsettings,
+			 debug);
+	generateComboPerlData(combo, perlout, debug);
+	endphase(STATS_PERL, &phasestart);
+	if (convert) {
+	  /* Every combo is a Storable document of its own */
+	  st.tagnum = 0;
+	  if (convertPerlData(&st, 0, debug) != 0) {
+	    out.length = 0;
+	    combo = NULL;
+	  }
+	}
+      }
+      if ((combo == NULL) && (result != 1))
+	/* A broken database file or invalid data fails the combo, the
+	   others are still computed */
+	status = 1;
+      printf("COMBO %s,%s %lu\n", line, t + 1, (unsigned long)out.length);
+      if (fileSink(stdout, out.data, out.length) != 0) {
+	fprintf(stderr,"Could not write the output!\n");
+	exit(1);
+      }
+      fflush(stdout);
+      out.length = 0;
+      arenaReset(&data);
+      endphase(STATS_OUTPUT, &phasestart);
+    }
+    if (batchfile != stdin) fclose(batchfile);
+    closecombodb(cdb);
+    startphase(&phasestart);
 
   } else if (datatype == 1) { /* Parse printer/driver combo data */
   
-    /* Parse the XML input */
-    combo = parseComboFile(filename, language, debug);
+    /* Parse the XML input, or compute it from the database */
+    if ((pid != NULL) || (drivername != NULL)) {
+      if ((pid == NULL) || (drivername == NULL)) {
+	fprintf(stderr, "Both a printer ID and a driver name must be supplied!\n");
+	exit(1);
+      }
+      cdb = opencombodb(libdir, 1, 0);
+      combo = ((combopieces(cdb, pid, drivername, &pieces, &num_pieces,
+			    (debug > 1)) == 0) ?
+	       parseComboPieces(pieces, num_pieces, &data, language, debug) :
+	       NULL);
+      closecombodb(cdb);
+      startphase(&phasestart);
+    } else {
+      startphase(&phasestart);
+      combo = parseComboFile(filename, &data, language, debug);
+      endphase(STATS_XMLPARSE, &phasestart);
+    }
 
     if (combo) {
 
@@ -5182,7 +6938,10 @@ main(int argc, char **argv) { /* I - Command line arguments */
       prepareComboData(combo, defaultsettings, num_defaultsettings, debug);
 
       /* Generate the Perl data structure on standard output */
-      generateComboPerlData(combo, debug);
+      generateComboPerlData(combo, perlout, debug);
+      endphase(STATS_PERL, &phasestart);
+      if (convert && (convertPerlData(&st, 0, debug) != 0))
+	exit(1);
 
     } else {
       exit(1);
@@ -5191,12 +6950,17 @@ main(int argc, char **argv) { /* I - Command line arguments */
   } else if (datatype == 2) { /* Parse overview data */
 
     /* Parse the XML input */
-    printer = parsePrinterFile(filename, language, debug);
+    startphase(&phasestart);
+    printer = parsePrinterFile(filename, &data, language, debug);
+    endphase(STATS_XMLPARSE, &phasestart);
 
     if (printer) {
 
       /* Generate the Perl data structure on standard output */
-      generatePrinterPerlData(printer, debug);
+      generatePrinterPerlData(printer, perlout, debug);
+      endphase(STATS_PERL, &phasestart);
+      if (convert && (convertPerlData(&st, 0, debug) != 0))
+	exit(1);
 
     } else {
       exit(1);
@@ -5205,12 +6969,17 @@ main(int argc, char **argv) { /* I - Command line arguments */
   } else if (datatype == 3) { /* Parse overview data */
 
     /* Parse the XML input */
-    driver = parseDriverFile(filename, language, debug);
+    startphase(&phasestart);
+    driver = parseDriverFile(filename, &data, language, debug);
+    endphase(STATS_XMLPARSE, &phasestart);
 
     if (driver) {
 
       /* Generate the Perl data structure on standard output */
-      generateDriverPerlData(driver, debug);
+      generateDriverPerlData(driver, perlout, debug);
+      endphase(STATS_PERL, &phasestart);
+      if (convert && (convertPerlData(&st, 0, debug) != 0))
+	exit(1);
 
     } else {
       exit(1);
@@ -5218,8 +6987,23 @@ main(int argc, char **argv) { /* I - Command line arguments */
 
   }
 
+  /* Write what is left in the buffer */
+  outputFlush(&out);
+  endphase(STATS_OUTPUT, &phasestart);
+
+  /* Release the parsed data, all at once, and the buffers */
+  arenaFree(&data);
+  outputFree(&out);
+  if (convert) {
+    converterFree(&st);
+    outputFree(&perl);
+  }
+
   /* Clean up everything else before quitting. */
   xmlCleanupParser();
+
+  /* Statistics for "--stats" */
+  putstats(stderr);
   
-  return(0);
+  return(status);
 }
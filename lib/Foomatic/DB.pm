@@ -18,6 +18,11 @@ use strict;
 
 my $ver = '$Revision$ ';
 
+# With Perl's Storable module foomatic-perl-data puts out its data in
+# Storable's network format ("-S"), which is read much faster than Perl
+# code is "eval"uated
+my $storable = eval { require Storable; 1 };
+
 # constructor for Foomatic::DB
 sub new {
     my $type = shift(@_);
@@ -80,6 +85,106 @@ sub get_printerlist {
     return $this->_get_xml_filelist('source/printer');
 }
 
+# Socket of a "foomatic-combo-xml -S" server for this database, undef
+# if no server is running
+sub combo_socket {
+    my ($this) = @_;
+    my $socket = $this->{'combosocket'} || $ENV{FOOMATIC_COMBO_SOCKET} ||
+	"$libdir/db/combo-socket";
+    return (-S $socket ? $socket : undef);
+}
+
+# Send a request (list of fields) to the foomatic-combo-xml server and
+# return the XML data of the answer, "" if the combo is not possible, or
+# undef if there is no server, so that the caller runs foomatic-combo-xml
+# itself
+sub combo_request {
+    my ($this, @fields) = @_;
+    my $socket = $this->combo_socket() or return undef;
+    require IO::Socket::UNIX;
+    my $conn = IO::Socket::UNIX->new(Peer => $socket) or return undef;
+    print $conn join("\t", @fields), "\n";
+    my $header = <$conn>;
+    if (!defined($header) || $header !~ /^(\S+) (?:\S+ )?(\d+)\n$/ ||
+	$1 eq 'ERROR') {
+	close $conn;
+	return undef;
+    }
+    my $length = $2;
+    my $data = '';
+    while (length($data) < $length) {
+	read($conn, $data, $length - length($data), length($data)) or last;
+    }
+    close $conn;
+    return undef if length($data) < $length;
+    return $data;
+}
+
+# Run foomatic-perl-data with the given arguments, reading the output
+# of the command $pipe if given, and return the Perl data structure it
+# generates, undef on failure
+sub perl_data {
+    my ($this, $args, $pipe) = @_;
+    my $command = "$bindir/foomatic-perl-data $args -l $this->{'language'}";
+    $command .= ' -S' if $storable;
+    $command = "$pipe | $command" if defined($pipe);
+    my $output = `$command`;
+    return undef if !defined($output) || $output eq '';
+    return $this->perl_data_decode($output);
+}
+
+# Turn the output of foomatic-perl-data into the Perl data structure,
+# undef on failure
+sub perl_data_decode {
+    my ($this, $output) = @_;
+    return eval { Storable::thaw($output) } if $storable;
+    my $VAR1;
+    eval $output or return undef;
+    return $VAR1;
+}
+
+# Start "foomatic-perl-data -b -" on the list of combos on standard
+# input, one "printer,driver" per line, and return the file handle to
+# read the combos from with read_perl_data_batch(), undef on failure
+sub open_perl_data_batch {
+    my ($this) = @_;
+    my $command = "$bindir/foomatic-perl-data -b - -L '$libdir' " .
+	"-l $this->{'language'}";
+    $command .= ' -S' if $storable;
+    open(my $fh, "$command |") or return undef;
+    return $fh;
+}
+
+# Read the next combo from "foomatic-perl-data -b", return the printer,
+# the driver, and the Perl data of the combo (undef if it is not
+# possible), an empty list at the end
+sub read_perl_data_batch {
+    my ($this, $fh) = @_;
+    my $line = <$fh>;
+    return () if !defined($line);
+    my ($printer, $driver, $length) =
+	($line =~ /^COMBO ([^,]*),(\S*) (\d+)$/) or
+	die "\nInvalid output of foomatic-perl-data: $line\n";
+    my $output = '';
+    read($fh, $output, $length) == $length or
+	die "\nIncomplete output of foomatic-perl-data!\n";
+    return ($printer, $driver, undef) if $length == 0;
+    return ($printer, $driver, $this->perl_data_decode($output));
+}
+
+# Convert XML data from the foomatic-combo-xml server into a Perl data
+# structure with foomatic-perl-data ($type: '-O' or '-C')
+sub perl_data_from_xml {
+    my ($this, $type, $xml) = @_;
+    require File::Temp;
+    my ($fh, $filename) = File::Temp::tempfile(UNLINK => 1) or return undef;
+    print $fh $xml;
+    close $fh;
+    my $data = $this->perl_data("$type '$filename'");
+    unlink $filename;
+    return $data;
+}
+
 sub get_overview {
     my ($this, $rebuild, $cupsppds) = @_;
 
@@ -88,8 +193,16 @@ sub get_overview {
 	!$rebuild;
     $this->{'overview'} = undef;
 
-    # Read on-disk cache file if we have one
+    # Read on-disk cache file if we have one, written by Storable or,
+    # without it, by Data::Dumper
     if (defined($this->{'overviewfile'})) {
+	if (!$rebuild && $storable && (-r $this->{'overviewfile'})) {
+	    my $data = eval { Storable::retrieve($this->{'overviewfile'}) };
+	    if (ref($data) eq 'ARRAY') {
+		$this->{'overview'} = $data;
+		return $this->{'overview'};
+	    }
+	}
         if (!$rebuild && (-r $this->{'overviewfile'})) {
 	    if (open CFILE, "< $this->{'overviewfile'}") {
 		my $output = join('', <CFILE>);
@@ -113,17 +226,25 @@ sub get_overview {
     # Build a new overview
     my $otype = ($cupsppds ? '-C' : '-O');
     $otype .= ' -n' if ($cupsppds == 1);
-    # Generate overview Perl data structure from database
-    my $VAR1;
-    eval `$bindir/foomatic-combo-xml $otype -l '$libdir' | $bindir/foomatic-perl-data -O -l $this->{'language'}` || do {
+    # Generate overview Perl data structure from database, with the
+    # foomatic-combo-xml server if there is one
+    my $xml = $this->combo_request('OVERVIEW', split(' ', $otype));
+    my $data = (defined($xml) ?
+		$this->perl_data_from_xml('-O', $xml) :
+		$this->perl_data('-O',
+				 "$bindir/foomatic-combo-xml $otype -l '$libdir'"));
+    if (!defined($data)) {
 	warn ("Could not run \"foomatic-combo-xml\"/\"foomatic-perl-data\"!\n");
 	return undef;
-    };
-    $this->{'overview'} = $VAR1;
+    }
+    $this->{'overview'} = $data;
 
     # Write on-disk cache file if we have one
     if (defined($this->{'overviewfile'})) {
-	if (open CFILE, "> $this->{'overviewfile'}") {
+	if ($storable) {
+	    eval { Storable::nstore($this->{'overview'},
+				    $this->{'overviewfile'}) };
+	} elsif (open CFILE, "> $this->{'overviewfile'}") {
 	    print CFILE Dumper($this->{'overview'});
 	    close CFILE;
 	}
@@ -135,6 +256,8 @@ sub get_overview {
 sub get_overview_xml {
     my ($this, $compile) = @_;
 
+    my $xml = $this->combo_request('OVERVIEW');
+    return $xml if defined($xml);
     open( FCX, "$bindir/foomatic-combo-xml -O -l '$libdir'|") or do {
 	warn "Can't execute $bindir/foomatic-combo-xml -O -l '$libdir'\n";
 	return undef;
@@ -150,6 +273,7 @@ sub get_combo_data_xml {
     # Insert the default option settings if there are some and the user
     # desires it.
     my $options = "";
+    my @settings;
     if (($withoptions) && (defined($this->{'dat'}))) {
 	my $dat = $this->{'dat'};
 	for my $arg (@{$dat->{'args'}}) {
@@ -157,10 +281,13 @@ sub get_combo_data_xml {
 	    my $default = $arg->{'default'};
 	    if (($name) && ($default)) {
 		$options .= " -o '$name'='$default'";
+		push(@settings, "$name=$default");
 	    }
 	}
     }
 
+    my $xml = $this->combo_request('COMBO', $poid, $drv, @settings);
+    return $xml if defined($xml);
     open( FCX, "$bindir/foomatic-combo-xml -d '$drv' -p '$poid'$options -l '$libdir'|") or do {
 	warn "Can't execute $bindir/foomatic-combo-xml -d '$drv' -p '$poid'$options -l '$libdir'\n";
 	return undef;
@@ -175,12 +302,12 @@ sub get_printer {
     # Generate printer Perl data structure from database
     my $VAR1;
     if (-r "$poid") {
-	eval (`$bindir/foomatic-perl-data -P -l $this->{'language'} '$poid'`) || do {
+	$VAR1 = $this->perl_data("-P '$poid'") or do {
 	    warn ("Could not run \"foomatic-perl-data\"!\n");
 	    return undef;
 	};
     } elsif (-r "$libdir/db/source/printer/$poid.xml") {
-	eval (`$bindir/foomatic-perl-data -P -l $this->{'language'} '$libdir/db/source/printer/$poid.xml'`) || do {
+	$VAR1 = $this->perl_data("-P '$libdir/db/source/printer/$poid.xml'") or do {
 	    warn ("Could not run \"foomatic-perl-data\"!\n");
 	    return undef;
 	};
@@ -227,12 +354,12 @@ sub get_driver {
     # Generate driver Perl data structure from database
     my $VAR1;
     if (-r "$drv") {
-	eval (`$bindir/foomatic-perl-data -D -l $this->{'language'} '$drv'`) || do {
+	$VAR1 = $this->perl_data("-D '$drv'") or do {
 	    warn ("Could not run \"foomatic-perl-data\"!\n");
 	    return undef;
 	}
     } elsif (-r "$libdir/db/source/driver/$drv.xml") {
-	eval (`$bindir/foomatic-perl-data -D -l $this->{'language'} '$libdir/db/source/driver/$drv.xml'`) || do {
+	$VAR1 = $this->perl_data("-D '$libdir/db/source/driver/$drv.xml'") or do {
 	    warn ("Could not run \"foomatic-perl-data\"!\n");
 	    return undef;
 	}
@@ -1094,15 +1221,19 @@ sub sortvals {
 # they get presented more nicely on frontends which do not sort by
 # themselves
 
-sub getdat ($ $ $) {
-    my ($this, $drv, $poid) = @_;
+# @data: the Perl data of the combo (undef: combo not possible) when the
+# caller has it already, as foomatic-compiledb from "foomatic-perl-data
+# -b"
+sub getdat ($ $ $;$) {
+    my ($this, $drv, $poid, @data) = @_;
 
     my $ppdfile;
 
     # Do we have a link to a custom PPD file for this driver in the
-    # printer XML file? Then return the custom PPD
+    # printer XML file? Then return the custom PPD. The combo data has
+    # the links of the printer entry, too
 
-    my $p = $this->get_printer($poid);
+    my $p = (defined($data[0]) ? $data[0] : $this->get_printer($poid));
     if (defined($p->{'drivers'})) {
 	for my $d (@{$p->{'drivers'}}) {
 	    next if ($d->{'id'} ne $drv);
@@ -1134,8 +1265,14 @@ sub getdat ($ $ $) {
 
     # Generate Perl data structure from database
     my %dat;			# Our purpose in life...
-    my $VAR1;
-    eval (`$bindir/foomatic-combo-xml -d '$drv' -p '$poid' -l '$libdir' | $bindir/foomatic-perl-data -C -l $this->{'language'}`) || do {
+    my $VAR1 = $data[0];
+    if (!@data) {
+	my $xml = $this->combo_request('COMBO', $poid, $drv);
+	$VAR1 = (defined($xml) ?
+		 ($xml ne '' ? $this->perl_data_from_xml('-C', $xml) : undef) :
+		 $this->perl_data("-C -d '$drv' -p '$poid' -L '$libdir'"));
+    }
+    $VAR1 or do {
 	warn ("Could not run \"foomatic-combo-xml\"/" .
 	      "\"foomatic-perl-data\"!\n");
 	return undef;